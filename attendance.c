@@ -0,0 +1,414 @@
+#include "attendance.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+/* 每月起始天数(平年,从0开始),闰年2月之后加1 */
+static const int month_start[13] = {
+    0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365
+};
+
+/* 64位popcount: 优先使用编译器内建指令 */
+static int popcount64(unsigned long long x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return (int)__popcnt64(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/* 统计位图中[begin, end)区间内置位的个数 */
+static int popcount_range(const unsigned long long *bits, int begin, int end) {
+    int total = 0;
+    for (int w = begin / 64; w <= (end - 1) / 64 && w < ATTENDANCE_WORDS; w++) {
+        unsigned long long mask = ~0ULL;
+        int lo = w * 64;
+        if (begin > lo) {
+            mask &= ~0ULL << (begin - lo);
+        }
+        if (end < lo + 64) {
+            mask &= ~0ULL >> (lo + 64 - end);
+        }
+        total += popcount64(bits[w] & mask);
+    }
+    return total;
+}
+
+/* 计算某月在该年中的天数区间[begin, end) */
+static Bool month_range(int year, int month, int *begin, int *end) {
+    if (month < 1 || month > 12) {
+        return FALSE;
+    }
+    int leap = attendance_is_leap_year(year) ? 1 : 0;
+    *begin = month_start[month - 1] + ((month > 2) ? leap : 0);
+    *end = month_start[month] + ((month >= 2) ? leap : 0);
+    return TRUE;
+}
+
+/* ========== 日期工具 ========== */
+
+Bool attendance_is_leap_year(int year) {
+    return ((year % 4 == 0 && year % 100 != 0) || year % 400 == 0) ? TRUE : FALSE;
+}
+
+int attendance_day_of_year(int year, int month, int day) {
+    int leap = (month > 2 && attendance_is_leap_year(year)) ? 1 : 0;
+    return month_start[month - 1] + leap + day - 1;
+}
+
+Bool attendance_parse_date(const char *date, int *year, int *month, int *day) {
+    if (date == NULL || year == NULL || month == NULL || day == NULL) {
+        return FALSE;
+    }
+
+    /* 严格匹配 YYYY-MM-DD */
+    for (int i = 0; i < 10; i++) {
+        if (i == 4 || i == 7) {
+            if (date[i] != '-') {
+                return FALSE;
+            }
+        } else if (date[i] < '0' || date[i] > '9') {
+            return FALSE;
+        }
+    }
+    if (date[10] != '\0') {
+        return FALSE;
+    }
+
+    int y = (date[0] - '0') * 1000 + (date[1] - '0') * 100 + (date[2] - '0') * 10 + (date[3] - '0');
+    int m = (date[5] - '0') * 10 + (date[6] - '0');
+    int d = (date[8] - '0') * 10 + (date[9] - '0');
+
+    int begin, end;
+    if (!month_range(y, m, &begin, &end) || d < 1 || d > end - begin) {
+        return FALSE;
+    }
+
+    *year = y;
+    *month = m;
+    *day = d;
+    return TRUE;
+}
+
+/* ========== 哈希索引 ========== */
+
+static size_t attendance_hash(int employee_id, int year) {
+    unsigned long long key = ((unsigned long long)(unsigned int)employee_id << 32) |
+                             (unsigned int)year;
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (size_t)key;
+}
+
+/* 查找记录下标,不存在返回(size_t)-1 */
+static size_t attendance_lookup(const AttendanceBook *book, int employee_id, int year) {
+    if (book->slot_count == 0) {
+        return (size_t)-1;
+    }
+
+    size_t mask = book->slot_count - 1;
+    for (size_t pos = attendance_hash(employee_id, year) & mask;; pos = (pos + 1) & mask) {
+        size_t slot = book->slots[pos];
+        if (slot == 0) {
+            return (size_t)-1;
+        }
+        const AttendanceYear *entry = &book->entries[slot - 1];
+        if (entry->employee_id == employee_id && entry->year == year) {
+            return slot - 1;
+        }
+    }
+}
+
+static void attendance_index_insert(AttendanceBook *book, size_t index) {
+    size_t mask = book->slot_count - 1;
+    const AttendanceYear *entry = &book->entries[index];
+    size_t pos = attendance_hash(entry->employee_id, entry->year) & mask;
+    while (book->slots[pos] != 0) {
+        pos = (pos + 1) & mask;
+    }
+    book->slots[pos] = index + 1;
+}
+
+/* 负载因子超过1/2时将哈希槽扩容一倍并重建 */
+static ErrorCode attendance_grow_index(AttendanceBook *book) {
+    if ((book->count + 1) * 2 <= book->slot_count) {
+        return SUCCESS;
+    }
+
+    size_t new_count = (book->slot_count == 0) ? 64 : book->slot_count * 2;
+    size_t *slots = (size_t *)calloc(new_count, sizeof(size_t));
+    if (slots == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+
+    free(book->slots);
+    book->slots = slots;
+    book->slot_count = new_count;
+    for (size_t i = 0; i < book->count; i++) {
+        attendance_index_insert(book, i);
+    }
+    return SUCCESS;
+}
+
+/* 获取或创建某人某年的位图记录 */
+static AttendanceYear *attendance_get_or_create(AttendanceBook *book, int employee_id, int year) {
+    size_t index = attendance_lookup(book, employee_id, year);
+    if (index != (size_t)-1) {
+        return &book->entries[index];
+    }
+
+    if (attendance_grow_index(book) != SUCCESS) {
+        return NULL;
+    }
+
+    if (book->count >= book->capacity) {
+        size_t new_capacity = (book->capacity == 0) ? 16 : book->capacity * 2;
+        AttendanceYear *entries = (AttendanceYear *)realloc(book->entries,
+                                                            new_capacity * sizeof(AttendanceYear));
+        if (entries == NULL) {
+            return NULL;
+        }
+        book->entries = entries;
+        book->capacity = new_capacity;
+    }
+
+    AttendanceYear *entry = &book->entries[book->count];
+    memset(entry, 0, sizeof(AttendanceYear));
+    entry->employee_id = employee_id;
+    entry->year = year;
+    attendance_index_insert(book, book->count);
+    book->count++;
+    return entry;
+}
+
+/* ========== AttendanceBook 实现 ========== */
+
+AttendanceBook *attendance_book_create(void) {
+    AttendanceBook *book = (AttendanceBook *)calloc(1, sizeof(AttendanceBook));
+    return book;
+}
+
+void attendance_book_free(AttendanceBook *book) {
+    if (book != NULL) {
+        free(book->entries);
+        free(book->slots);
+        free(book);
+    }
+}
+
+const AttendanceYear *attendance_book_find(const AttendanceBook *book, int employee_id, int year) {
+    if (book == NULL) {
+        return NULL;
+    }
+    size_t index = attendance_lookup(book, employee_id, year);
+    return (index == (size_t)-1) ? NULL : &book->entries[index];
+}
+
+/* 设置或清除某日对应的位 */
+static ErrorCode attendance_set(AttendanceBook *book, int employee_id, const char *date, Bool present) {
+    if (book == NULL || date == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    int year, month, day;
+    if (!attendance_parse_date(date, &year, &month, &day)) {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    int bit = attendance_day_of_year(year, month, day);
+    if (!present) {
+        size_t index = attendance_lookup(book, employee_id, year);
+        if (index != (size_t)-1) {
+            book->entries[index].bits[bit / 64] &= ~(1ULL << (bit % 64));
+        }
+        return SUCCESS;
+    }
+
+    AttendanceYear *entry = attendance_get_or_create(book, employee_id, year);
+    if (entry == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    entry->bits[bit / 64] |= 1ULL << (bit % 64);
+    return SUCCESS;
+}
+
+ErrorCode attendance_mark(AttendanceBook *book, int employee_id, const char *date) {
+    return attendance_set(book, employee_id, date, TRUE);
+}
+
+ErrorCode attendance_clear(AttendanceBook *book, int employee_id, const char *date) {
+    return attendance_set(book, employee_id, date, FALSE);
+}
+
+ErrorCode attendance_book_merge(AttendanceBook *book, const AttendanceYear *entry) {
+    if (book == NULL || entry == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    AttendanceYear *target = attendance_get_or_create(book, entry->employee_id, entry->year);
+    if (target == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    for (int w = 0; w < ATTENDANCE_WORDS; w++) {
+        target->bits[w] |= entry->bits[w];
+    }
+    return SUCCESS;
+}
+
+Bool attendance_is_present(const AttendanceBook *book, int employee_id, const char *date) {
+    int year, month, day;
+    if (book == NULL || !attendance_parse_date(date, &year, &month, &day)) {
+        return FALSE;
+    }
+
+    const AttendanceYear *entry = attendance_book_find(book, employee_id, year);
+    if (entry == NULL) {
+        return FALSE;
+    }
+    int bit = attendance_day_of_year(year, month, day);
+    return ((entry->bits[bit / 64] >> (bit % 64)) & 1ULL) ? TRUE : FALSE;
+}
+
+int attendance_month_days(const AttendanceBook *book, int employee_id, int year, int month) {
+    int begin, end;
+    const AttendanceYear *entry = attendance_book_find(book, employee_id, year);
+    if (entry == NULL || !month_range(year, month, &begin, &end)) {
+        return 0;
+    }
+    return popcount_range(entry->bits, begin, end);
+}
+
+int attendance_year_days(const AttendanceBook *book, int employee_id, int year) {
+    const AttendanceYear *entry = attendance_book_find(book, employee_id, year);
+    if (entry == NULL) {
+        return 0;
+    }
+
+    int total = 0;
+    for (int w = 0; w < ATTENDANCE_WORDS; w++) {
+        total += popcount64(entry->bits[w]);
+    }
+    return total;
+}
+
+int attendance_longest_streak(const AttendanceBook *book, int employee_id, int year) {
+    const AttendanceYear *entry = attendance_book_find(book, employee_id, year);
+    if (entry == NULL) {
+        return 0;
+    }
+
+    /* 反复执行 x &= x >> 1,每轮把所有连续段缩短1,轮数即最长连续段长度 */
+    unsigned long long x[ATTENDANCE_WORDS];
+    memcpy(x, entry->bits, sizeof(x));
+    int streak = 0;
+    for (;;) {
+        unsigned long long any = 0;
+        for (int w = 0; w < ATTENDANCE_WORDS; w++) {
+            any |= x[w];
+        }
+        if (any == 0) {
+            break;
+        }
+        streak++;
+        for (int w = 0; w < ATTENDANCE_WORDS; w++) {
+            unsigned long long carry = (w + 1 < ATTENDANCE_WORDS) ? (x[w + 1] << 63) : 0;
+            x[w] &= (x[w] >> 1) | carry;
+        }
+    }
+    return streak;
+}
+
+int attendance_common_days(const AttendanceBook *book, const int *employee_ids,
+                           size_t id_count, int year) {
+    if (book == NULL || employee_ids == NULL || id_count == 0) {
+        return 0;
+    }
+
+    unsigned long long acc[ATTENDANCE_WORDS];
+    for (int w = 0; w < ATTENDANCE_WORDS; w++) {
+        acc[w] = ~0ULL;
+    }
+
+    for (size_t i = 0; i < id_count; i++) {
+        const AttendanceYear *entry = attendance_book_find(book, employee_ids[i], year);
+        if (entry == NULL) {
+            return 0;
+        }
+        for (int w = 0; w < ATTENDANCE_WORDS; w++) {
+            acc[w] &= entry->bits[w];
+        }
+    }
+
+    int total = 0;
+    for (int w = 0; w < ATTENDANCE_WORDS; w++) {
+        total += popcount64(acc[w]);
+    }
+    return total;
+}
+
+long long attendance_total_month(const AttendanceBook *book, int year, int month) {
+    int begin, end;
+    if (book == NULL || !month_range(year, month, &begin, &end)) {
+        return 0;
+    }
+
+    long long total = 0;
+    for (size_t i = 0; i < book->count; i++) {
+        if (book->entries[i].year == year) {
+            total += popcount_range(book->entries[i].bits, begin, end);
+        }
+    }
+    return total;
+}
+
+long long attendance_total_year(const AttendanceBook *book, int year) {
+    if (book == NULL) {
+        return 0;
+    }
+
+    long long total = 0;
+    for (size_t i = 0; i < book->count; i++) {
+        if (book->entries[i].year == year) {
+            for (int w = 0; w < ATTENDANCE_WORDS; w++) {
+                total += popcount64(book->entries[i].bits[w]);
+            }
+        }
+    }
+    return total;
+}
+
+int *attendance_present_on(const AttendanceBook *book, const char *date, size_t *count) {
+    int year, month, day;
+    if (count != NULL) {
+        *count = 0;
+    }
+    if (book == NULL || count == NULL || !attendance_parse_date(date, &year, &month, &day)) {
+        return NULL;
+    }
+
+    int bit = attendance_day_of_year(year, month, day);
+    int word = bit / 64;
+    unsigned long long mask = 1ULL << (bit % 64);
+
+    int *ids = (int *)malloc((book->count > 0 ? book->count : 1) * sizeof(int));
+    if (ids == NULL) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < book->count; i++) {
+        const AttendanceYear *entry = &book->entries[i];
+        if (entry->year == year && (entry->bits[word] & mask) != 0) {
+            ids[(*count)++] = entry->employee_id;
+        }
+    }
+    return ids;
+}
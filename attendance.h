@@ -0,0 +1,78 @@
+#ifndef ATTENDANCE_H
+#define ATTENDANCE_H
+
+#include "common.h"
+
+/* 每人每年的出勤位图字数: 6 * 64 = 384位,覆盖闰年366天 */
+#define ATTENDANCE_WORDS 6
+
+/* 每人每年一条出勤记录: 第d位表示该年第d天(从0开始)是否出勤 */
+PACK_PUSH
+typedef struct {
+    int employee_id;                               /* 工号 */
+    int year;                                      /* 年份 */
+    unsigned long long bits[ATTENDANCE_WORDS];     /* 出勤位图 */
+} AttendanceYear;
+PACK_POP
+
+/*
+ * 出勤簿: 连续存放的位图记录 + 按(工号,年份)的开放寻址索引。
+ * 独立的库组件,需要逐日出勤数据的调用方自行填充;职工记录只有出勤天数,
+ * 应用中的出勤统计不经过出勤簿
+ */
+typedef struct {
+    AttendanceYear *entries;  /* 位图记录数组 */
+    size_t count;             /* 记录数 */
+    size_t capacity;          /* 记录数组容量 */
+    size_t *slots;            /* 哈希槽: 存放记录下标+1, 0表示空 */
+    size_t slot_count;        /* 哈希槽数量(2的幂) */
+} AttendanceBook;
+
+/* ========== 日期工具 ========== */
+
+/* 解析"YYYY-MM-DD",成功返回TRUE */
+Bool attendance_parse_date(const char *date, int *year, int *month, int *day);
+
+/* 是否闰年 */
+Bool attendance_is_leap_year(int year);
+
+/* 计算某日是该年第几天(从0开始) */
+int attendance_day_of_year(int year, int month, int day);
+
+/* ========== AttendanceBook 方法 ========== */
+
+AttendanceBook *attendance_book_create(void);
+void attendance_book_free(AttendanceBook *book);
+
+/* 查找某人某年的位图,不存在返回NULL */
+const AttendanceYear *attendance_book_find(const AttendanceBook *book, int employee_id, int year);
+
+/* 标记/取消某日出勤(date格式YYYY-MM-DD) */
+ErrorCode attendance_mark(AttendanceBook *book, int employee_id, const char *date);
+ErrorCode attendance_clear(AttendanceBook *book, int employee_id, const char *date);
+
+/* 追加一条完整的位图记录(用于加载),已存在则按位或合并 */
+ErrorCode attendance_book_merge(AttendanceBook *book, const AttendanceYear *entry);
+
+/* 某人某日是否出勤 */
+Bool attendance_is_present(const AttendanceBook *book, int employee_id, const char *date);
+
+/* 某人某月/某年出勤天数(popcount) */
+int attendance_month_days(const AttendanceBook *book, int employee_id, int year, int month);
+int attendance_year_days(const AttendanceBook *book, int employee_id, int year);
+
+/* 某人某年最长连续出勤天数 */
+int attendance_longest_streak(const AttendanceBook *book, int employee_id, int year);
+
+/* 多名职工在某年共同出勤的天数(位图按位与后popcount) */
+int attendance_common_days(const AttendanceBook *book, const int *employee_ids,
+                           size_t id_count, int year);
+
+/* 全员某月/某年出勤总天数 */
+long long attendance_total_month(const AttendanceBook *book, int year, int month);
+long long attendance_total_year(const AttendanceBook *book, int year);
+
+/* 查询某日出勤的全部工号,返回由调用方free的数组,数量写入count */
+int *attendance_present_on(const AttendanceBook *book, const char *date, size_t *count);
+
+#endif /* ATTENDANCE_H */
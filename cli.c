@@ -0,0 +1,603 @@
+#include "cli.h"
+#include "model.h"
+#include "storage.h"
+#include "sync.h"
+#include "external_sort.h"
+#include "merge.h"
+#include "csv_import.h"
+#include "columnar.h"
+#include "compact_file.h"
+#include "csv.h"
+#include "controller.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+/* 未指定--db时使用的数据文件(与交互模式相同) */
+#define CLI_DEFAULT_DB "employees.db"
+
+/* 批处理脚本不登录,凭证库路径只用于满足controller_create */
+#define CLI_DEFAULT_AUTH "admin.auth"
+
+/* 位置参数的最大个数 */
+#define CLI_MAX_ARGS 256
+
+/* 查询结果写出的缓冲字节数 */
+#define CLI_FLUSH_BYTES (256 * 1024)
+
+/* 选项(按位组合表示子命令接受哪些选项) */
+enum {
+    CLI_OPT_DB = 1 << 0,
+    CLI_OPT_FORMAT = 1 << 1,
+    CLI_OPT_BY = 1 << 2,
+    CLI_OPT_OUT = 1 << 3,
+    CLI_OPT_ID_MAP = 1 << 4,
+    CLI_OPT_ID = 1 << 5,
+    CLI_OPT_NAME = 1 << 6,
+    CLI_OPT_DEPT = 1 << 7
+};
+
+/* 解析后的命令行 */
+typedef struct {
+    const char *command;             /* 子命令名 */
+    const char *db;                  /* --db */
+    const char *format;              /* --format */
+    const char *by;                  /* --by */
+    const char *out;                 /* --out */
+    const char *id_map;              /* --id-map */
+    const char *id;                  /* --id */
+    const char *name;                /* --name */
+    const char *dept;                /* --dept */
+    const char *args[CLI_MAX_ARGS];  /* 位置参数 */
+    size_t arg_count;
+} CliOptions;
+
+/* 选项表: 选项名、标志位与CliOptions中对应字段的偏移 */
+static const struct {
+    const char *name;
+    unsigned int flag;
+    size_t offset;
+} CLI_OPTIONS[] = {
+    {"--db", CLI_OPT_DB, offsetof(CliOptions, db)},
+    {"--format", CLI_OPT_FORMAT, offsetof(CliOptions, format)},
+    {"--by", CLI_OPT_BY, offsetof(CliOptions, by)},
+    {"--out", CLI_OPT_OUT, offsetof(CliOptions, out)},
+    {"--id-map", CLI_OPT_ID_MAP, offsetof(CliOptions, id_map)},
+    {"--id", CLI_OPT_ID, offsetof(CliOptions, id)},
+    {"--name", CLI_OPT_NAME, offsetof(CliOptions, name)},
+    {"--dept", CLI_OPT_DEPT, offsetof(CliOptions, dept)}
+};
+
+typedef int (*CliHandler)(const CliOptions *opts, FILE *out, FILE *err);
+
+/* 子命令表 */
+typedef struct {
+    const char *name;       /* 子命令名 */
+    CliHandler handler;     /* 处理函数 */
+    unsigned int options;   /* 接受的选项 */
+    size_t min_args;        /* 位置参数个数下限 */
+    size_t max_args;        /* 位置参数个数上限 */
+} CliCommand;
+
+/* ========== 输出与错误 ========== */
+
+int cli_exit_code(ErrorCode error) {
+    if (error == SUCCESS) {
+        return 0;
+    }
+    /* 错误码为-1~-11,取反即得退出码 */
+    return (error < 0 && error >= ERROR_NOT_FOUND) ? -(int)error : 1;
+}
+
+const char *cli_error_name(ErrorCode error) {
+    switch (error) {
+        case SUCCESS:
+            return "success";
+        case ERROR_NULL_POINTER:
+            return "null_pointer";
+        case ERROR_OUT_OF_MEMORY:
+            return "out_of_memory";
+        case ERROR_INDEX_OUT_OF_BOUNDS:
+            return "index_out_of_bounds";
+        case ERROR_INVALID_PARAMETER:
+            return "invalid_parameter";
+        case ERROR_FILE_NOT_FOUND:
+            return "file_not_found";
+        case ERROR_FILE_READ_FAILED:
+            return "file_read_failed";
+        case ERROR_FILE_WRITE_FAILED:
+            return "file_write_failed";
+        case ERROR_INVALID_FILE:
+            return "invalid_file";
+        case ERROR_DATA_CORRUPTION:
+            return "data_corruption";
+        case ERROR_AUTH_FAILED:
+            return "auth_failed";
+        case ERROR_NOT_FOUND:
+            return "not_found";
+    }
+    return "unknown";
+}
+
+void cli_print_usage(FILE *out) {
+    fputs("Usage: lsy_work <command> [options] [args...]\n"
+          "  import  --db <db> <file.csv>\n"
+          "  export  --db <db> [--format csv|columnar|compact] <output>\n"
+          "  query   --db <db> (--id <id> | --name <name> | --dept <department>)\n"
+          "  stats   --db <db> [YYYY | YYYY-MM]...\n"
+          "  sort    --db <db> --by id|name|department|date|days [--out <file> [--format db|csv]]\n"
+          "  compact --db <db>\n"
+          "  sync    --db <db> <replica>\n"
+          "  merge   [--id-map <map.csv>] <output.db> <input.db>...\n"
+          "  batch   --db <db> [script|-]\n"
+          "Without a command the interactive menu is started.\n", out);
+}
+
+/* 报告错误并返回对应的退出码 */
+static int cli_fail(FILE *err, const char *command, ErrorCode error, const char *message) {
+    fprintf(err, "error=%s code=%d command=%s %s\n", cli_error_name(error), (int)error,
+            command, message);
+    return cli_exit_code(error);
+}
+
+/* 报告用法错误 */
+static int cli_usage(FILE *err, const char *command, const char *message) {
+    fprintf(err, "error=usage command=%s %s\n", command, message);
+    cli_print_usage(err);
+    return CLI_EXIT_USAGE;
+}
+
+/* 加载整个库;allow_missing时文件不存在得到空管理器 */
+static ErrorCode cli_load(const char *db, Bool allow_missing, EmployeeManager **manager) {
+    *manager = employee_manager_create();
+    if (*manager == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    ErrorCode err = storage_load_employees(db, *manager);
+    if (err == ERROR_FILE_NOT_FOUND && allow_missing) {
+        err = SUCCESS;
+    }
+    if (err != SUCCESS) {
+        employee_manager_free(*manager);
+        *manager = NULL;
+    }
+    return err;
+}
+
+/* 以分页方式打开库(只读命令) */
+static PagedStore *cli_open_paged(const CliOptions *opts, FILE *err, int *code) {
+    ErrorCode error = SUCCESS;
+    PagedStore *store = storage_paged_open(opts->db, 0, &error);
+    if (store == NULL) {
+        *code = cli_fail(err, opts->command, error,
+                         (error == ERROR_INVALID_FILE) ? "message=not a v2 data file, run compact to upgrade"
+                                                       : "message=cannot open database");
+    }
+    return store;
+}
+
+/* ========== 子命令 ========== */
+
+static int cli_import(const CliOptions *opts, FILE *out, FILE *err) {
+    EmployeeManager *manager = NULL;
+    ErrorCode error = cli_load(opts->db, TRUE, &manager);
+    if (error != SUCCESS) {
+        return cli_fail(err, opts->command, error, "message=cannot load database");
+    }
+
+    CsvImportReport *report = (CsvImportReport *)malloc(sizeof(CsvImportReport));
+    if (report == NULL) {
+        employee_manager_free(manager);
+        return cli_fail(err, opts->command, ERROR_OUT_OF_MEMORY, "message=out of memory");
+    }
+    error = storage_import_csv(opts->args[0], manager, report);
+    if (error != SUCCESS) {
+        free(report);
+        employee_manager_free(manager);
+        return cli_fail(err, opts->command, error, "message=cannot read CSV file");
+    }
+    error = storage_save_employees(opts->db, manager);
+    if (error != SUCCESS) {
+        free(report);
+        employee_manager_free(manager);
+        return cli_fail(err, opts->command, error, "message=cannot save database");
+    }
+
+    fprintf(out, "imported=%zu\n", report->imported);
+    fprintf(out, "rejected=%zu\n", report->rejected);
+    for (size_t i = 0; i < report->error_count; i++) {
+        fprintf(out, "rejected.%zu=%s\n", report->errors[i].line,
+                storage_csv_line_error_message(report->errors[i].error));
+    }
+    fprintf(out, "records=%zu\n", vector_size(manager->employees));
+    free(report);
+    employee_manager_free(manager);
+    return 0;
+}
+
+static int cli_export(const CliOptions *opts, FILE *out, FILE *err) {
+    const char *format = (opts->format != NULL) ? opts->format : "csv";
+    ErrorCode error = SUCCESS;
+    size_t count = 0;
+
+    if (strcmp(format, "csv") == 0) {
+        int code = 0;
+        PagedStore *store = cli_open_paged(opts, err, &code);
+        if (store == NULL) {
+            return code;
+        }
+        count = storage_paged_record_count(store);
+        error = storage_paged_export_csv(store, opts->args[0]);
+        storage_paged_close(store);
+    } else if (strcmp(format, "columnar") == 0) {
+        EmployeeManager *manager = NULL;
+        error = cli_load(opts->db, FALSE, &manager);
+        if (error != SUCCESS) {
+            return cli_fail(err, opts->command, error, "message=cannot load database");
+        }
+        count = vector_size(manager->employees);
+        error = storage_export_columnar(opts->args[0], manager);
+        employee_manager_free(manager);
+    } else if (strcmp(format, "compact") == 0) {
+        EmployeeManager *manager = NULL;
+        error = cli_load(opts->db, FALSE, &manager);
+        if (error != SUCCESS) {
+            return cli_fail(err, opts->command, error, "message=cannot load database");
+        }
+        count = vector_size(manager->employees);
+        error = storage_save_compact(opts->args[0], manager);
+        employee_manager_free(manager);
+    } else {
+        return cli_usage(err, opts->command, "message=--format must be csv, columnar or compact");
+    }
+
+    if (error != SUCCESS) {
+        return cli_fail(err, opts->command, error, "message=export failed");
+    }
+    fprintf(out, "exported=%zu\n", count);
+    return 0;
+}
+
+/* 查询结果逐条格式化为CSV,缓冲满后写出 */
+typedef struct {
+    FILE *out;
+    CsvBuffer buffer;
+    ErrorCode error;
+} CliRows;
+
+static Bool cli_rows_flush(CliRows *rows) {
+    if (rows->buffer.size > 0 &&
+        fwrite(rows->buffer.data, 1, rows->buffer.size, rows->out) != rows->buffer.size) {
+        rows->error = ERROR_FILE_WRITE_FAILED;
+        return FALSE;
+    }
+    rows->buffer.size = 0;
+    return TRUE;
+}
+
+static Bool cli_rows_visit(void *ctx, const Employee *emp) {
+    CliRows *rows = (CliRows *)ctx;
+    rows->error = csv_append_employee(&rows->buffer, emp);
+    if (rows->error != SUCCESS) {
+        return FALSE;
+    }
+    return (rows->buffer.size < CLI_FLUSH_BYTES) ? TRUE : cli_rows_flush(rows);
+}
+
+/* 严格解析正整数工号 */
+static Bool cli_parse_id(const char *text, int *id) {
+    char *end = NULL;
+    long value = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || value <= 0 || value > 2147483647L) {
+        return FALSE;
+    }
+    *id = (int)value;
+    return TRUE;
+}
+
+static int cli_query(const CliOptions *opts, FILE *out, FILE *err) {
+    int criteria = (opts->id != NULL) + (opts->name != NULL) + (opts->dept != NULL);
+    if (criteria != 1) {
+        return cli_usage(err, opts->command, "message=exactly one of --id, --name, --dept is required");
+    }
+
+    SearchType type;
+    const void *keyword;
+    int id = 0;
+    if (opts->id != NULL) {
+        if (!cli_parse_id(opts->id, &id)) {
+            return cli_usage(err, opts->command, "message=--id must be a positive integer");
+        }
+        type = SEARCH_BY_ID;
+        keyword = &id;
+    } else if (opts->name != NULL) {
+        type = SEARCH_BY_NAME;
+        keyword = opts->name;
+    } else {
+        type = SEARCH_BY_DEPARTMENT;
+        keyword = opts->dept;
+    }
+
+    int code = 0;
+    PagedStore *store = cli_open_paged(opts, err, &code);
+    if (store == NULL) {
+        return code;
+    }
+
+    CliRows rows;
+    rows.out = out;
+    rows.error = csv_buffer_init(&rows.buffer, CLI_FLUSH_BYTES + CSV_MAX_ROW_LEN);
+    size_t matches = 0;
+    ErrorCode error = rows.error;
+    if (error == SUCCESS) {
+        fputs(CSV_HEADER, out);
+        error = storage_paged_search(store, type, keyword, cli_rows_visit, &rows, &matches);
+        if (error == SUCCESS && rows.error == SUCCESS) {
+            cli_rows_flush(&rows);
+        }
+        if (error == SUCCESS) {
+            error = rows.error;
+        }
+        csv_buffer_free(&rows.buffer);
+    }
+    storage_paged_close(store);
+
+    if (error != SUCCESS) {
+        return cli_fail(err, opts->command, error, "message=query failed");
+    }
+    if (matches == 0) {
+        return cli_fail(err, opts->command, ERROR_NOT_FOUND, "message=no matching records");
+    }
+    return 0;
+}
+
+static int cli_stats(const CliOptions *opts, FILE *out, FILE *err) {
+    int code = 0;
+    PagedStore *store = cli_open_paged(opts, err, &code);
+    if (store == NULL) {
+        return code;
+    }
+
+    fprintf(out, "records=%zu\n", storage_paged_record_count(store));
+    fprintf(out, "next_id=%d\n", storage_paged_next_id(store));
+    ErrorCode error = SUCCESS;
+    for (size_t i = 0; i < opts->arg_count && error == SUCCESS; i++) {
+        long long total = 0;
+        error = storage_paged_attendance(store, opts->args[i], &total);
+        if (error == SUCCESS) {
+            fprintf(out, "days.%s=%lld\n", opts->args[i], total);
+        }
+    }
+    storage_paged_close(store);
+
+    if (error != SUCCESS) {
+        return cli_fail(err, opts->command, error, "message=statistics failed");
+    }
+    return 0;
+}
+
+static Bool cli_parse_sort(const char *text, SortType *type) {
+    static const struct {
+        const char *name;
+        SortType type;
+    } keys[] = {
+        {"id", SORT_BY_ID},
+        {"name", SORT_BY_NAME},
+        {"department", SORT_BY_DEPARTMENT},
+        {"date", SORT_BY_ATTEND_DATE},
+        {"days", SORT_BY_ATTEND_DAYS}
+    };
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        if (strcmp(text, keys[i].name) == 0) {
+            *type = keys[i].type;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static int cli_sort(const CliOptions *opts, FILE *out, FILE *err) {
+    SortType type;
+    if (opts->by == NULL || !cli_parse_sort(opts->by, &type)) {
+        return cli_usage(err, opts->command, "message=--by must be id, name, department, date or days");
+    }
+
+    if (opts->out != NULL) {
+        /* 写出到新文件: 外部排序,内存占用与库大小无关 */
+        SortOutputFormat format = SORT_OUTPUT_DB;
+        if (opts->format != NULL && strcmp(opts->format, "csv") == 0) {
+            format = SORT_OUTPUT_CSV;
+        } else if (opts->format != NULL && strcmp(opts->format, "db") != 0) {
+            return cli_usage(err, opts->command, "message=--format must be db or csv");
+        }
+        ErrorCode error = storage_external_sort(opts->db, opts->out, type, format, 0);
+        if (error != SUCCESS) {
+            return cli_fail(err, opts->command, error, "message=sort failed");
+        }
+        fprintf(out, "output=%s\n", opts->out);
+        return 0;
+    }
+    if (opts->format != NULL) {
+        return cli_usage(err, opts->command, "message=--format requires --out");
+    }
+
+    /* 原地排序: 整体加载后排序写回 */
+    EmployeeManager *manager = NULL;
+    ErrorCode error = cli_load(opts->db, FALSE, &manager);
+    if (error != SUCCESS) {
+        return cli_fail(err, opts->command, error, "message=cannot load database");
+    }
+    employee_manager_sort(manager, type);
+    error = storage_save_employees(opts->db, manager);
+    size_t count = vector_size(manager->employees);
+    employee_manager_free(manager);
+    if (error != SUCCESS) {
+        return cli_fail(err, opts->command, error, "message=cannot save database");
+    }
+    fprintf(out, "records=%zu\n", count);
+    return 0;
+}
+
+static int cli_compact(const CliOptions *opts, FILE *out, FILE *err) {
+    EmployeeManager *manager = NULL;
+    ErrorCode error = cli_load(opts->db, FALSE, &manager);
+    if (error != SUCCESS) {
+        return cli_fail(err, opts->command, error, "message=cannot load database");
+    }
+
+    /* 清除同步基线,保存时退回完整写出 */
+    employee_manager_mark_synced(manager, manager->generation, 0);
+    error = storage_save_employees(opts->db, manager);
+    size_t count = vector_size(manager->employees);
+    employee_manager_free(manager);
+    if (error != SUCCESS) {
+        return cli_fail(err, opts->command, error, "message=cannot save database");
+    }
+    fprintf(out, "records=%zu\n", count);
+    return 0;
+}
+
+static int cli_sync(const CliOptions *opts, FILE *out, FILE *err) {
+    SyncStats stats;
+    ErrorCode error = storage_sync_file(opts->db, opts->args[0], &stats);
+    if (error != SUCCESS) {
+        return cli_fail(err, opts->command, error, "message=sync failed");
+    }
+    fprintf(out, "source_bytes=%llu\n", stats.source_bytes);
+    fprintf(out, "matched_bytes=%llu\n", stats.matched_bytes);
+    fprintf(out, "literal_bytes=%llu\n", stats.literal_bytes);
+    fprintf(out, "written_bytes=%llu\n", stats.written_bytes);
+    fprintf(out, "mode=%s\n", stats.full_copy ? "full_copy" : (stats.in_place ? "in_place" : "rebuilt"));
+    return 0;
+}
+
+static int cli_merge(const CliOptions *opts, FILE *out, FILE *err) {
+    MergeStats stats;
+    ErrorCode error = storage_merge_files((const char *const *)(opts->args + 1), opts->arg_count - 1, opts->args[0],
+                                          opts->id_map, 0, &stats);
+    if (error != SUCCESS) {
+        return cli_fail(err, opts->command, error, "message=merge failed");
+    }
+    fprintf(out, "input_records=%llu\n", stats.input_records);
+    fprintf(out, "output_records=%llu\n", stats.output_records);
+    fprintf(out, "duplicates=%llu\n", stats.duplicates);
+    fprintf(out, "remapped=%llu\n", stats.remapped);
+    fprintf(out, "sorted_inputs=%zu\n", stats.sorted_inputs);
+    return 0;
+}
+
+static int cli_batch(const CliOptions *opts, FILE *out, FILE *err) {
+    Bool from_stdin = (opts->arg_count == 0 || strcmp(opts->args[0], "-") == 0);
+    FILE *script = from_stdin ? stdin : fopen(opts->args[0], "rb");
+    if (script == NULL) {
+        return cli_fail(err, opts->command, ERROR_FILE_NOT_FOUND, "message=cannot open script");
+    }
+
+    Controller *ctrl = controller_create(opts->db, CLI_DEFAULT_AUTH);
+    AppView *view = (ctrl != NULL) ? view_create_batch(script, out) : NULL;
+    if (view == NULL) {
+        controller_free(ctrl);
+        if (!from_stdin) {
+            fclose(script);
+        }
+        return cli_fail(err, opts->command, ERROR_OUT_OF_MEMORY, "message=cannot create controller");
+    }
+    controller_set_view(ctrl, view);
+
+    /* 库不存在时从空库开始,与交互模式相同 */
+    ErrorCode error = controller_wait_load(ctrl);
+    size_t failed = 0;
+    if (error == SUCCESS || error == ERROR_FILE_NOT_FOUND) {
+        error = SUCCESS;
+        controller_run(ctrl);
+        failed = view_batch_errors(ctrl->view);
+    }
+    controller_free(ctrl);  /* 释放视图时写出缓冲的输出 */
+    if (!from_stdin) {
+        fclose(script);
+    }
+
+    if (error != SUCCESS) {
+        return cli_fail(err, opts->command, error, "message=cannot load database");
+    }
+    if (failed > 0) {
+        char message[64];
+        snprintf(message, sizeof(message), "message=%zu operations failed", failed);
+        return cli_fail(err, opts->command, ERROR_INVALID_PARAMETER, message);
+    }
+    return 0;
+}
+
+static const CliCommand CLI_COMMANDS[] = {
+    {"import", cli_import, CLI_OPT_DB, 1, 1},
+    {"export", cli_export, CLI_OPT_DB | CLI_OPT_FORMAT, 1, 1},
+    {"query", cli_query, CLI_OPT_DB | CLI_OPT_ID | CLI_OPT_NAME | CLI_OPT_DEPT, 0, 0},
+    {"stats", cli_stats, CLI_OPT_DB, 0, CLI_MAX_ARGS},
+    {"sort", cli_sort, CLI_OPT_DB | CLI_OPT_BY | CLI_OPT_OUT | CLI_OPT_FORMAT, 0, 0},
+    {"compact", cli_compact, CLI_OPT_DB, 0, 0},
+    {"sync", cli_sync, CLI_OPT_DB, 1, 1},
+    {"merge", cli_merge, CLI_OPT_ID_MAP, 2, CLI_MAX_ARGS},
+    {"batch", cli_batch, CLI_OPT_DB, 0, 1}
+};
+
+static const CliCommand *cli_find(const char *name) {
+    if (name == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < sizeof(CLI_COMMANDS) / sizeof(CLI_COMMANDS[0]); i++) {
+        if (strcmp(CLI_COMMANDS[i].name, name) == 0) {
+            return &CLI_COMMANDS[i];
+        }
+    }
+    return NULL;
+}
+
+Bool cli_is_command(const char *name) {
+    return (cli_find(name) != NULL) ? TRUE : FALSE;
+}
+
+/* ========== 入口 ========== */
+
+int cli_run(int argc, char **argv, FILE *out, FILE *err) {
+    if (argc < 1 || argv == NULL || out == NULL || err == NULL) {
+        return CLI_EXIT_USAGE;
+    }
+    const CliCommand *command = cli_find(argv[0]);
+    if (command == NULL) {
+        return cli_usage(err, argv[0], "message=unknown command");
+    }
+
+    CliOptions opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.command = command->name;
+    opts.db = CLI_DEFAULT_DB;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strncmp(arg, "--", 2) != 0) {
+            if (opts.arg_count == CLI_MAX_ARGS) {
+                return cli_usage(err, command->name, "message=too many arguments");
+            }
+            opts.args[opts.arg_count++] = arg;
+            continue;
+        }
+
+        size_t k = 0;
+        size_t option_count = sizeof(CLI_OPTIONS) / sizeof(CLI_OPTIONS[0]);
+        while (k < option_count && strcmp(CLI_OPTIONS[k].name, arg) != 0) {
+            k++;
+        }
+        if (k == option_count || (command->options & CLI_OPTIONS[k].flag) == 0) {
+            return cli_usage(err, command->name, "message=unsupported option");
+        }
+        if (i + 1 >= argc) {
+            return cli_usage(err, command->name, "message=option requires a value");
+        }
+        *(const char **)((char *)&opts + CLI_OPTIONS[k].offset) = argv[++i];
+    }
+
+    if (opts.arg_count < command->min_args || opts.arg_count > command->max_args) {
+        return cli_usage(err, command->name, "message=wrong number of arguments");
+    }
+    return command->handler(&opts, out, err);
+}
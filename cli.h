@@ -0,0 +1,50 @@
+#ifndef CLI_H
+#define CLI_H
+
+#include "common.h"
+#include <stdio.h>
+
+/*
+ * 无交互命令行模式: lsy_work <子命令> [选项] [参数...]
+ * 不经过登录与菜单,不等待回车,适合定时任务批量调用。
+ *
+ * 输出格式(写到out):
+ *   记录  - CSV,表头与列格式同storage_export_csv
+ *   汇总  - 每行一个"键=值",值一直到行尾
+ * 出错时向err写一行"error=<名称> code=<错误码> command=<子命令>"加说明。
+ * 退出码: 成功为0,失败为-ErrorCode(1~11),命令行用法错误为CLI_EXIT_USAGE。
+ *
+ * 子命令(--db默认为employees.db):
+ *   import  --db <库> <csv文件>                  导入CSV并保存
+ *   export  --db <库> [--format csv|columnar|compact] <输出文件>   compact为紧凑归档(约为定长格式的1/5)
+ *   query   --db <库> (--id <工号> | --name <姓名> | --dept <部门>)   无匹配时退出码为ERROR_NOT_FOUND
+ *   stats   --db <库> [日期前缀...]              记录数、下一工号及各前缀("YYYY"/"YYYY-MM")的出勤天数
+ *   sort    --db <库> --by id|name|department|date|days [--out <文件> [--format db|csv]]
+ *   compact --db <库>                            完整重写数据文件,清除增量保存追加的旧数据(v1文件同时升级为v2)
+ *   sync    --db <库> <备份文件>                  增量同步到备份
+ *   merge   [--id-map <对照表>] <输出库> <输入库>...
+ *   batch   --db <库> [脚本文件|-]               以批处理视图执行菜单脚本(默认读标准输入),
+ *                                                有操作失败时退出码为ERROR_INVALID_PARAMETER
+ * query/stats/csv导出逐页读取v2文件,不整体加载;sort不带--out时在内存中排序后写回原库,
+ * 带--out时外部排序写出到新文件,原库不变。
+ */
+
+/* 用法错误的退出码(同sysexits.h的EX_USAGE) */
+#define CLI_EXIT_USAGE 64
+
+/* 是否为已知的子命令 */
+Bool cli_is_command(const char *name);
+
+/* 执行子命令: argv[0]为子命令名,返回进程退出码 */
+int cli_run(int argc, char **argv, FILE *out, FILE *err);
+
+/* 错误码对应的退出码 */
+int cli_exit_code(ErrorCode error);
+
+/* 错误码的机器可读名称(如"file_not_found") */
+const char *cli_error_name(ErrorCode error);
+
+/* 打印用法 */
+void cli_print_usage(FILE *out);
+
+#endif /* CLI_H */
@@ -0,0 +1,695 @@
+/* 启用64位文件偏移(须在所有系统头文件之前定义) */
+#if !defined(_WIN32) && !defined(_FILE_OFFSET_BITS)
+    #define _FILE_OFFSET_BITS 64
+#endif
+
+#include "columnar.h"
+#include "compact.h"
+#include "storage_io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ========== 列式导出 ========== */
+
+/* 列定义: 写入文件头之后,读取时逐项核对 */
+static const ColumnSchema COLUMNAR_SCHEMA[COLUMN_COUNT] = {
+    {"id", COLUMN_TYPE_INT32},
+    {"name", COLUMN_TYPE_STRING},
+    {"department", COLUMN_TYPE_DICT16},
+    {"attend_date", COLUMN_TYPE_DATE32},
+    {"attend_days", COLUMN_TYPE_INT32}
+};
+
+/* 一个行组的列缓冲区 */
+typedef struct {
+    int *ids;
+    unsigned int *name_offsets;  /* rows + 1个 */
+    char *names;
+    unsigned short *codes;
+    int *dates;
+    int *days;
+    size_t rows;
+} ColumnarGroup;
+
+static void columnar_group_free(ColumnarGroup *group) {
+    free(group->ids);
+    free(group->name_offsets);
+    free(group->names);
+    free(group->codes);
+    free(group->dates);
+    free(group->days);
+}
+
+static Bool columnar_group_init(ColumnarGroup *group) {
+    group->rows = 0;
+    group->ids = (int *)malloc(COLUMNAR_GROUP_ROWS * sizeof(int));
+    group->name_offsets = (unsigned int *)malloc((COLUMNAR_GROUP_ROWS + 1) * sizeof(unsigned int));
+    group->names = (char *)malloc((size_t)COLUMNAR_GROUP_ROWS * MAX_NAME_LEN);
+    group->codes = (unsigned short *)malloc(COLUMNAR_GROUP_ROWS * sizeof(unsigned short));
+    group->dates = (int *)malloc(COLUMNAR_GROUP_ROWS * sizeof(int));
+    group->days = (int *)malloc(COLUMNAR_GROUP_ROWS * sizeof(int));
+    if (group->ids == NULL || group->name_offsets == NULL || group->names == NULL ||
+        group->codes == NULL || group->dates == NULL || group->days == NULL) {
+        columnar_group_free(group);
+        return FALSE;
+    }
+    group->name_offsets[0] = 0;
+    return TRUE;
+}
+
+/* 日期字符串转YYYYMMDD,空串或无法解析时为0 */
+static int columnar_date_key(const char *date) {
+    char buffer[MAX_DATE_LEN];
+    int year, month, day;
+    memcpy(buffer, date, MAX_DATE_LEN - 1);
+    buffer[MAX_DATE_LEN - 1] = '\0';
+    if (!attendance_parse_date(buffer, &year, &month, &day)) {
+        return 0;
+    }
+    return year * 10000 + month * 100 + day;
+}
+
+/* 整数数组的min/max */
+static void int_range(const int *values, size_t count, int *min, int *max) {
+    *min = 0;
+    *max = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (i == 0 || values[i] < *min) {
+            *min = values[i];
+        }
+        if (i == 0 || values[i] > *max) {
+            *max = values[i];
+        }
+    }
+}
+
+/* 写出一个列块并填写目录项 */
+static void write_column_chunk(ChunkWriter *writer, ColumnChunk *chunk,
+                               const void *data, size_t size, int min, int max) {
+    chunk->offset = writer->offset;
+    chunk->size = (unsigned int)size;
+    chunk->checksum = calculate_checksum(data, size);
+    chunk->min = min;
+    chunk->max = max;
+    chunk_writer_put(writer, data, size);
+}
+
+/* 写出一个行组的全部列块 */
+static void write_columnar_group(ChunkWriter *writer, ColumnChunk *chunks,
+                                 const ColumnarGroup *group) {
+    size_t rows = group->rows;
+    int min, max;
+    
+    int_range(group->ids, rows, &min, &max);
+    write_column_chunk(writer, &chunks[COLUMN_ID], group->ids, rows * sizeof(int), min, max);
+    
+    /* 字符串列: 偏移数组与字节拼接成一块,统计为字节长度范围 */
+    ColumnChunk *names = &chunks[COLUMN_NAME];
+    size_t offsets_size = (rows + 1) * sizeof(unsigned int);
+    size_t bytes = group->name_offsets[rows];
+    min = max = 0;
+    for (size_t i = 0; i < rows; i++) {
+        int length = (int)(group->name_offsets[i + 1] - group->name_offsets[i]);
+        if (i == 0 || length < min) {
+            min = length;
+        }
+        if (i == 0 || length > max) {
+            max = length;
+        }
+    }
+    names->offset = writer->offset;
+    names->size = (unsigned int)(offsets_size + bytes);
+    names->checksum = checksum_update(calculate_checksum(group->name_offsets, offsets_size),
+                                      group->names, bytes);
+    names->min = min;
+    names->max = max;
+    chunk_writer_put(writer, group->name_offsets, offsets_size);
+    chunk_writer_put(writer, group->names, bytes);
+    
+    min = max = 0;
+    for (size_t i = 0; i < rows; i++) {
+        if (i == 0 || group->codes[i] < min) {
+            min = group->codes[i];
+        }
+        if (i == 0 || group->codes[i] > max) {
+            max = group->codes[i];
+        }
+    }
+    write_column_chunk(writer, &chunks[COLUMN_DEPARTMENT], group->codes,
+                       rows * sizeof(unsigned short), min, max);
+    
+    int_range(group->dates, rows, &min, &max);
+    write_column_chunk(writer, &chunks[COLUMN_ATTEND_DATE], group->dates,
+                       rows * sizeof(int), min, max);
+    
+    int_range(group->days, rows, &min, &max);
+    write_column_chunk(writer, &chunks[COLUMN_ATTEND_DAYS], group->days,
+                       rows * sizeof(int), min, max);
+}
+
+/* 部门字典按字符串列编码: 偏移数组(dept_count + 1个) + 字节 */
+static char *encode_columnar_dictionary(const CompactTable *dict, size_t *size) {
+    size_t offsets_size = (dict->dept_count + 1) * sizeof(unsigned int);
+    size_t bytes = 0;
+    for (size_t d = 0; d < dict->dept_count; d++) {
+        bytes += dict->depts[d].length;
+    }
+    
+    char *blob = (char *)malloc(offsets_size + bytes);
+    if (blob == NULL) {
+        return NULL;
+    }
+    unsigned int *offsets = (unsigned int *)blob;
+    char *out = blob + offsets_size;
+    unsigned int offset = 0;
+    for (size_t d = 0; d < dict->dept_count; d++) {
+        offsets[d] = offset;
+        memcpy(out + offset, dict->arena + dict->depts[d].offset, dict->depts[d].length);
+        offset += dict->depts[d].length;
+    }
+    offsets[dict->dept_count] = offset;
+    *size = offsets_size + bytes;
+    return blob;
+}
+
+/* 将只读视图导出为列式文件 */
+static ErrorCode export_view_columnar(const char *filename, const EmployeeView *view) {
+    size_t group_count = (view->size + COLUMNAR_GROUP_ROWS - 1) / COLUMNAR_GROUP_ROWS;
+    ColumnChunk *chunks = (ColumnChunk *)calloc(group_count * COLUMN_COUNT + 1, sizeof(ColumnChunk));
+    CompactTable *dict = compact_table_create();  /* 只用其部门字典 */
+    ColumnarGroup group;
+    if (chunks == NULL || dict == NULL || !columnar_group_init(&group)) {
+        free(chunks);
+        compact_table_free(dict);
+        return ERROR_OUT_OF_MEMORY;
+    }
+    
+    AtomicFile file;
+    ErrorCode err = atomic_file_open(&file, filename, "wb");
+    ChunkWriter writer;
+    if (err == SUCCESS) {
+        err = chunk_writer_init(&writer, file.fp);
+        if (err != SUCCESS) {
+            atomic_file_abort(&file);
+        }
+    }
+    if (err != SUCCESS) {
+        columnar_group_free(&group);
+        free(chunks);
+        compact_table_free(dict);
+        return err;
+    }
+    
+    ColumnarHeader header;
+    memset(&header, 0, sizeof(ColumnarHeader));
+    chunk_writer_put(&writer, &header, sizeof(ColumnarHeader));
+    chunk_writer_put(&writer, COLUMNAR_SCHEMA, sizeof(COLUMNAR_SCHEMA));
+    
+    /* 逐行填入列缓冲区,满一组写出一组 */
+    size_t written = 0;
+    size_t span_count = employee_view_span_count(view);
+    for (size_t s = 0; s < span_count && err == SUCCESS; s++) {
+        Employee *const *records = NULL;
+        size_t count = employee_view_span(view, s, &records);
+        for (size_t i = 0; i < count; i++) {
+            const Employee *emp = records[i];
+            char department[MAX_DEPT_LEN];
+            memcpy(department, emp->department, MAX_DEPT_LEN - 1);
+            department[MAX_DEPT_LEN - 1] = '\0';
+            unsigned short code = 0;
+            err = compact_table_intern_department(dict, department, &code);
+            if (err != SUCCESS) {
+                break;
+            }
+            
+            size_t row = group.rows;
+            const char *name_end = (const char *)memchr(emp->name, '\0', MAX_NAME_LEN - 1);
+            size_t name_length = (name_end != NULL) ? (size_t)(name_end - emp->name) : MAX_NAME_LEN - 1;
+            memcpy(group.names + group.name_offsets[row], emp->name, name_length);
+            group.name_offsets[row + 1] = group.name_offsets[row] + (unsigned int)name_length;
+            group.ids[row] = emp->id;
+            group.codes[row] = code;
+            group.dates[row] = columnar_date_key(emp->attend_date);
+            group.days[row] = emp->attend_days;
+            group.rows++;
+            
+            if (group.rows == COLUMNAR_GROUP_ROWS) {
+                write_columnar_group(&writer, &chunks[written * COLUMN_COUNT], &group);
+                written++;
+                group.rows = 0;
+            }
+        }
+    }
+    if (err == SUCCESS && group.rows > 0) {
+        write_columnar_group(&writer, &chunks[written * COLUMN_COUNT], &group);
+        written++;
+    }
+    columnar_group_free(&group);
+    
+    /* 部门字典与列块目录放在末尾 */
+    size_t dict_size = 0;
+    char *dict_blob = (err == SUCCESS) ? encode_columnar_dictionary(dict, &dict_size) : NULL;
+    if (err == SUCCESS && dict_blob == NULL) {
+        err = ERROR_OUT_OF_MEMORY;
+    }
+    header.magic = COLUMNAR_MAGIC;
+    header.version = COLUMNAR_VERSION;
+    header.header_size = sizeof(ColumnarHeader);
+    header.column_count = COLUMN_COUNT;
+    header.group_rows = COLUMNAR_GROUP_ROWS;
+    header.group_count = (unsigned int)written;
+    header.row_count = view->size;
+    header.dict_offset = writer.offset;
+    header.dict_size = dict_size;
+    header.dict_count = (unsigned int)dict->dept_count;
+    header.next_id = view->next_id;
+    if (dict_blob != NULL) {
+        header.dict_checksum = calculate_checksum(dict_blob, dict_size);
+        chunk_writer_put(&writer, dict_blob, dict_size);
+        free(dict_blob);
+    }
+    header.footer_offset = writer.offset;
+    header.footer_checksum = calculate_checksum(chunks, written * COLUMN_COUNT * sizeof(ColumnChunk));
+    header.header_checksum = calculate_checksum(&header, offsetof(ColumnarHeader, header_checksum));
+    chunk_writer_put(&writer, chunks, written * COLUMN_COUNT * sizeof(ColumnChunk));
+    free(chunks);
+    compact_table_free(dict);
+    
+    if (!chunk_writer_finish(&writer) && err == SUCCESS) {
+        err = ERROR_FILE_WRITE_FAILED;
+    }
+    if (err == SUCCESS &&
+        (!file_seek(file.fp, 0) || fwrite(&header, sizeof(ColumnarHeader), 1, file.fp) != 1)) {
+        err = ERROR_FILE_WRITE_FAILED;
+    }
+    if (err != SUCCESS) {
+        atomic_file_abort(&file);
+        return err;
+    }
+    return atomic_file_commit(&file);
+}
+
+/* 导出为列式文件 */
+ErrorCode storage_export_columnar(const char *filename, EmployeeManager *manager) {
+    if (filename == NULL || manager == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    
+    EmployeeView view;
+    employee_manager_view_begin(manager, &view);
+    ErrorCode err = export_view_columnar(filename, &view);
+    employee_manager_view_end(manager, &view);
+    return err;
+}
+
+/* 将快照导出为列式文件 */
+ErrorCode storage_export_columnar_snapshot(const char *filename, const EmployeeSnapshot *snapshot) {
+    if (filename == NULL || snapshot == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    return export_view_columnar(filename, &snapshot->view);
+}
+
+/* ========== 列式读取 ========== */
+
+struct ColumnarReader {
+    FILE *fp;
+    ColumnarHeader header;
+    ColumnChunk *chunks;      /* 列块目录 */
+    char (*depts)[MAX_DEPT_LEN];  /* 部门字典(已补结尾符) */
+    unsigned char *scratch;   /* 列块读缓冲区 */
+    size_t scratch_size;
+};
+
+/* 校验并解码STRING编码的偏移数组,返回字节区起点;count为字符串数 */
+static const char *check_string_block(const unsigned char *data, size_t size, size_t count,
+                                      size_t max_length, const unsigned int **offsets) {
+    size_t offsets_size = (count + 1) * sizeof(unsigned int);
+    if (size < offsets_size) {
+        return NULL;
+    }
+    const unsigned int *table = (const unsigned int *)data;
+    if (table[0] != 0 || table[count] != size - offsets_size) {
+        return NULL;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (table[i + 1] < table[i] || table[i + 1] - table[i] > max_length) {
+            return NULL;
+        }
+    }
+    *offsets = table;
+    return (const char *)(data + offsets_size);
+}
+
+/* 读取第group组第column列的列块到scratch并校验 */
+static ErrorCode read_column_chunk(ColumnarReader *reader, size_t group, ColumnIndex column,
+                                   const unsigned char **data, size_t *size) {
+    if (group >= reader->header.group_count || (unsigned int)column >= COLUMN_COUNT) {
+        return ERROR_INDEX_OUT_OF_BOUNDS;
+    }
+    const ColumnChunk *chunk = &reader->chunks[group * COLUMN_COUNT + column];
+    if (chunk->size > reader->scratch_size) {
+        unsigned char *grown = (unsigned char *)realloc(reader->scratch, chunk->size);
+        if (grown == NULL) {
+            return ERROR_OUT_OF_MEMORY;
+        }
+        reader->scratch = grown;
+        reader->scratch_size = chunk->size;
+    }
+    if (!file_seek(reader->fp, chunk->offset) ||
+        fread(reader->scratch, 1, chunk->size, reader->fp) != chunk->size) {
+        return ERROR_FILE_READ_FAILED;
+    }
+    if (calculate_checksum(reader->scratch, chunk->size) != chunk->checksum) {
+        return ERROR_DATA_CORRUPTION;
+    }
+    *data = reader->scratch;
+    *size = chunk->size;
+    return SUCCESS;
+}
+
+/* 读取并校验列块目录: 所有列块落在行组区内,定宽列的大小与行数一致 */
+static ErrorCode read_columnar_footer(ColumnarReader *reader) {
+    const ColumnarHeader *header = &reader->header;
+    size_t count = (size_t)header->group_count * COLUMN_COUNT;
+    reader->chunks = (ColumnChunk *)malloc((count > 0 ? count : 1) * sizeof(ColumnChunk));
+    if (reader->chunks == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    if (!file_seek(reader->fp, header->footer_offset) ||
+        fread(reader->chunks, sizeof(ColumnChunk), count, reader->fp) != count) {
+        return ERROR_FILE_READ_FAILED;
+    }
+    if (calculate_checksum(reader->chunks, count * sizeof(ColumnChunk)) != header->footer_checksum) {
+        return ERROR_DATA_CORRUPTION;
+    }
+    
+    unsigned long long data_start = sizeof(ColumnarHeader) + sizeof(COLUMNAR_SCHEMA);
+    for (size_t g = 0; g < header->group_count; g++) {
+        size_t rows = storage_columnar_group_rows(reader, g);
+        for (size_t c = 0; c < COLUMN_COUNT; c++) {
+            const ColumnChunk *chunk = &reader->chunks[g * COLUMN_COUNT + c];
+            unsigned long long expected = 0;
+            switch (COLUMNAR_SCHEMA[c].type) {
+                case COLUMN_TYPE_INT32:
+                case COLUMN_TYPE_DATE32:
+                    expected = rows * sizeof(int);
+                    break;
+                case COLUMN_TYPE_DICT16:
+                    expected = rows * sizeof(unsigned short);
+                    break;
+                default:
+                    expected = chunk->size;
+                    break;
+            }
+            if (chunk->offset < data_start || chunk->size != expected ||
+                chunk->offset + chunk->size > header->dict_offset) {
+                return ERROR_DATA_CORRUPTION;
+            }
+        }
+    }
+    return SUCCESS;
+}
+
+/* 读取部门字典并转为定长字符串数组 */
+static ErrorCode read_columnar_dictionary(ColumnarReader *reader) {
+    const ColumnarHeader *header = &reader->header;
+    unsigned char *blob = (unsigned char *)malloc(header->dict_size > 0 ? (size_t)header->dict_size : 1);
+    reader->depts = (char (*)[MAX_DEPT_LEN])calloc(header->dict_count > 0 ? header->dict_count : 1,
+                                                  MAX_DEPT_LEN);
+    if (blob == NULL || reader->depts == NULL) {
+        free(blob);
+        return ERROR_OUT_OF_MEMORY;
+    }
+    
+    ErrorCode err = SUCCESS;
+    const unsigned int *offsets = NULL;
+    const char *bytes = NULL;
+    if (!file_seek(reader->fp, header->dict_offset) ||
+        fread(blob, 1, (size_t)header->dict_size, reader->fp) != header->dict_size) {
+        err = ERROR_FILE_READ_FAILED;
+    } else if (calculate_checksum(blob, (size_t)header->dict_size) != header->dict_checksum ||
+               (bytes = check_string_block(blob, (size_t)header->dict_size, header->dict_count,
+                                           MAX_DEPT_LEN - 1, &offsets)) == NULL) {
+        err = ERROR_DATA_CORRUPTION;
+    } else {
+        for (size_t d = 0; d < header->dict_count; d++) {
+            memcpy(reader->depts[d], bytes + offsets[d], offsets[d + 1] - offsets[d]);
+        }
+    }
+    free(blob);
+    return err;
+}
+
+ColumnarReader *storage_columnar_open(const char *filename, ErrorCode *err) {
+    ErrorCode result = SUCCESS;
+    ColumnarReader *reader = NULL;
+    if (err != NULL) {
+        *err = SUCCESS;
+    }
+    if (filename == NULL) {
+        result = ERROR_NULL_POINTER;
+    } else if ((reader = (ColumnarReader *)calloc(1, sizeof(ColumnarReader))) == NULL) {
+        result = ERROR_OUT_OF_MEMORY;
+    } else if ((reader->fp = fopen(filename, "rb")) == NULL) {
+        result = ERROR_FILE_NOT_FOUND;
+    }
+    
+    ColumnarHeader *header = (reader != NULL) ? &reader->header : NULL;
+    if (result == SUCCESS && fread(header, sizeof(ColumnarHeader), 1, reader->fp) != 1) {
+        result = ERROR_FILE_READ_FAILED;
+    }
+    if (result == SUCCESS &&
+        (header->magic != COLUMNAR_MAGIC || header->version != COLUMNAR_VERSION ||
+         header->header_size != sizeof(ColumnarHeader))) {
+        result = ERROR_INVALID_FILE;
+    }
+    if (result == SUCCESS &&
+        calculate_checksum(header, offsetof(ColumnarHeader, header_checksum)) != header->header_checksum) {
+        result = ERROR_DATA_CORRUPTION;
+    }
+    
+    /* 列定义须与本程序写出的一致 */
+    ColumnSchema schema[COLUMN_COUNT];
+    if (result == SUCCESS &&
+        (header->column_count != COLUMN_COUNT || header->group_rows == 0 ||
+         header->group_rows > COLUMNAR_GROUP_ROWS * 64 ||
+         fread(schema, sizeof(schema), 1, reader->fp) != 1 ||
+         memcmp(schema, COLUMNAR_SCHEMA, sizeof(schema)) != 0)) {
+        result = ERROR_INVALID_FILE;
+    }
+    
+    long long total = (result == SUCCESS) ? file_size(reader->fp) : -1;
+    if (result == SUCCESS &&
+        (total < 0 ||
+         header->group_count != (header->row_count + header->group_rows - 1) / header->group_rows ||
+         header->dict_count > COMPACT_MAX_DEPARTMENTS ||
+         header->dict_offset + header->dict_size != header->footer_offset ||
+         header->footer_offset + (unsigned long long)header->group_count * COLUMN_COUNT *
+             sizeof(ColumnChunk) != (unsigned long long)total)) {
+        result = ERROR_DATA_CORRUPTION;
+    }
+    if (result == SUCCESS) {
+        result = read_columnar_dictionary(reader);
+    }
+    if (result == SUCCESS) {
+        result = read_columnar_footer(reader);
+    }
+    
+    if (result != SUCCESS) {
+        storage_columnar_close(reader);
+        reader = NULL;
+    }
+    if (err != NULL) {
+        *err = result;
+    }
+    return reader;
+}
+
+void storage_columnar_close(ColumnarReader *reader) {
+    if (reader != NULL) {
+        if (reader->fp != NULL) {
+            fclose(reader->fp);
+        }
+        free(reader->chunks);
+        free(reader->depts);
+        free(reader->scratch);
+        free(reader);
+    }
+}
+
+size_t storage_columnar_row_count(const ColumnarReader *reader) {
+    return (reader != NULL) ? (size_t)reader->header.row_count : 0;
+}
+
+size_t storage_columnar_group_count(const ColumnarReader *reader) {
+    return (reader != NULL) ? reader->header.group_count : 0;
+}
+
+size_t storage_columnar_group_rows(const ColumnarReader *reader, size_t group) {
+    if (reader == NULL || group >= reader->header.group_count) {
+        return 0;
+    }
+    unsigned long long first = (unsigned long long)group * reader->header.group_rows;
+    unsigned long long rows = reader->header.row_count - first;
+    return (size_t)((rows < reader->header.group_rows) ? rows : reader->header.group_rows);
+}
+
+ErrorCode storage_columnar_stats(const ColumnarReader *reader, size_t group, ColumnIndex column,
+                                 int *min, int *max) {
+    if (reader == NULL || min == NULL || max == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    if (group >= reader->header.group_count || (unsigned int)column >= COLUMN_COUNT) {
+        return ERROR_INDEX_OUT_OF_BOUNDS;
+    }
+    const ColumnChunk *chunk = &reader->chunks[group * COLUMN_COUNT + column];
+    *min = chunk->min;
+    *max = chunk->max;
+    return SUCCESS;
+}
+
+ErrorCode storage_columnar_read_ints(ColumnarReader *reader, size_t group, ColumnIndex column,
+                                     int *out) {
+    if (reader == NULL || out == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    if ((unsigned int)column < COLUMN_COUNT && COLUMNAR_SCHEMA[column].type == COLUMN_TYPE_STRING) {
+        return ERROR_INVALID_PARAMETER;
+    }
+    
+    const unsigned char *data = NULL;
+    size_t size = 0;
+    ErrorCode err = read_column_chunk(reader, group, column, &data, &size);
+    if (err != SUCCESS) {
+        return err;
+    }
+    if (COLUMNAR_SCHEMA[column].type == COLUMN_TYPE_DICT16) {
+        const unsigned short *codes = (const unsigned short *)data;
+        size_t rows = size / sizeof(unsigned short);
+        for (size_t i = 0; i < rows; i++) {
+            if (codes[i] >= reader->header.dict_count) {
+                return ERROR_DATA_CORRUPTION;
+            }
+            out[i] = codes[i];
+        }
+    } else {
+        memcpy(out, data, size);
+    }
+    return SUCCESS;
+}
+
+const char *storage_columnar_department(const ColumnarReader *reader, int code) {
+    if (reader == NULL || code < 0 || (unsigned int)code >= reader->header.dict_count) {
+        return NULL;
+    }
+    return reader->depts[code];
+}
+
+/* 读出一个行组的全部列并还原为职工记录,追加到out */
+static ErrorCode load_columnar_group(ColumnarReader *reader, size_t group, int *columns[4],
+                                     Vector *out) {
+    static const ColumnIndex int_columns[4] = {
+        COLUMN_ID, COLUMN_DEPARTMENT, COLUMN_ATTEND_DATE, COLUMN_ATTEND_DAYS
+    };
+    for (size_t c = 0; c < 4; c++) {
+        ErrorCode err = storage_columnar_read_ints(reader, group, int_columns[c], columns[c]);
+        if (err != SUCCESS) {
+            return err;
+        }
+    }
+    
+    /* 姓名列最后读,scratch中保留其内容 */
+    size_t rows = storage_columnar_group_rows(reader, group);
+    const unsigned char *data = NULL;
+    size_t size = 0;
+    const unsigned int *offsets = NULL;
+    ErrorCode err = read_column_chunk(reader, group, COLUMN_NAME, &data, &size);
+    if (err != SUCCESS) {
+        return err;
+    }
+    const char *names = check_string_block(data, size, rows, MAX_NAME_LEN - 1, &offsets);
+    if (names == NULL) {
+        return ERROR_DATA_CORRUPTION;
+    }
+    
+    for (size_t i = 0; i < rows; i++) {
+        Employee *emp = (Employee *)calloc(1, sizeof(Employee));
+        if (emp == NULL) {
+            return ERROR_OUT_OF_MEMORY;
+        }
+        emp->id = columns[0][i];
+        memcpy(emp->name, names + offsets[i], offsets[i + 1] - offsets[i]);
+        strcpy(emp->department, reader->depts[columns[1][i]]);
+        int date = columns[2][i];
+        if (date > 0) {
+            snprintf(emp->attend_date, MAX_DATE_LEN, "%04d-%02d-%02d",
+                     date / 10000, date / 100 % 100, date % 100);
+        }
+        emp->attend_days = columns[3][i];
+        err = vector_push_back(out, emp);
+        if (err != SUCCESS) {
+            free(emp);
+            return err;
+        }
+    }
+    return SUCCESS;
+}
+
+/* 完整加载列式文件(无法解析的出勤日期导出时记为0,加载后为空串) */
+ErrorCode storage_load_columnar(const char *filename, EmployeeManager *manager) {
+    if (filename == NULL || manager == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    
+    ErrorCode result = SUCCESS;
+    ColumnarReader *reader = storage_columnar_open(filename, &result);
+    if (reader == NULL) {
+        return result;
+    }
+    
+    int *columns[4];
+    for (size_t c = 0; c < 4; c++) {
+        columns[c] = (int *)malloc(reader->header.group_rows * sizeof(int));
+        if (columns[c] == NULL) {
+            result = ERROR_OUT_OF_MEMORY;
+        }
+    }
+    
+    /* 先全部解码到临时数组,成功后一次性追加 */
+    Vector *loaded = vector_create();
+    if (loaded == NULL) {
+        result = ERROR_OUT_OF_MEMORY;
+    } else if (result == SUCCESS) {
+        result = vector_reserve(loaded, storage_columnar_row_count(reader));
+    }
+    for (size_t g = 0; result == SUCCESS && g < reader->header.group_count; g++) {
+        result = load_columnar_group(reader, g, columns, loaded);
+    }
+    
+    if (result == SUCCESS) {
+        employee_manager_begin_write(manager);
+        result = vector_reserve(manager->employees, manager->employees->size + loaded->size);
+        if (result == SUCCESS) {
+            for (size_t i = 0; i < loaded->size; i++) {
+                vector_push_back(manager->employees, loaded->data[i]);
+            }
+            loaded->size = 0;
+            manager->next_id = reader->header.next_id;
+        }
+        employee_manager_end_write(manager);
+    }
+    
+    if (loaded != NULL) {
+        for (size_t i = 0; i < loaded->size; i++) {
+            free(loaded->data[i]);
+        }
+        vector_free(loaded);
+    }
+    for (size_t c = 0; c < 4; c++) {
+        free(columns[c]);
+    }
+    storage_columnar_close(reader);
+    return result;
+}
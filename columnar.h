@@ -0,0 +1,104 @@
+#ifndef COLUMNAR_H
+#define COLUMNAR_H
+
+#include "common.h"
+#include "model.h"
+
+/*
+ * 列式导出文件:
+ * 文件头 | 列定义 | 行组... | 部门字典 | 列块目录
+ * 每个行组最多COLUMNAR_GROUP_ROWS行,组内每列单独成块并带min/max统计,
+ * 读取方可只读需要的列,并按统计跳过整个行组
+ */
+#define COLUMNAR_GROUP_ROWS 65536
+
+/* 列编号(文件中的列顺序) */
+typedef enum {
+    COLUMN_ID = 0,          /* 工号 */
+    COLUMN_NAME,            /* 姓名 */
+    COLUMN_DEPARTMENT,      /* 部门 */
+    COLUMN_ATTEND_DATE,     /* 出勤日期 */
+    COLUMN_ATTEND_DAYS,     /* 出勤天数 */
+    COLUMN_COUNT
+} ColumnIndex;
+
+/* 列类型 */
+typedef enum {
+    COLUMN_TYPE_INT32 = 1,   /* int数组 */
+    COLUMN_TYPE_DATE32 = 2,  /* int数组,YYYYMMDD,0为空或无法解析的日期 */
+    COLUMN_TYPE_DICT16 = 3,  /* unsigned short字典编码数组 */
+    COLUMN_TYPE_STRING = 4   /* unsigned int偏移数组(行数+1个) + 字节 */
+} ColumnType;
+
+/* 列式文件头 */
+PACK_PUSH
+typedef struct {
+    unsigned int magic;                /* 魔数: 0x4C4F4345 (ASCII: ECOL) */
+    unsigned int version;              /* 版本号 */
+    unsigned int header_size;          /* 文件头字节数 */
+    unsigned int column_count;         /* 列数 */
+    unsigned int group_rows;           /* 每个行组的最大行数 */
+    unsigned int group_count;          /* 行组数 */
+    unsigned long long row_count;      /* 总行数 */
+    unsigned long long dict_offset;    /* 部门字典偏移(STRING编码) */
+    unsigned long long dict_size;      /* 部门字典字节数 */
+    unsigned int dict_count;           /* 部门数 */
+    unsigned int dict_checksum;        /* 部门字典校验和 */
+    unsigned long long footer_offset;  /* 列块目录偏移 */
+    unsigned int footer_checksum;      /* 列块目录校验和 */
+    int next_id;                       /* 下一个可用工号 */
+    unsigned int header_checksum;      /* 以上字段的校验和 */
+} ColumnarHeader;
+PACK_POP
+
+/* 列定义: 紧随文件头,共column_count个 */
+PACK_PUSH
+typedef struct {
+    char name[16];      /* 列名 */
+    unsigned int type;  /* 列类型(ColumnType) */
+} ColumnSchema;
+PACK_POP
+
+/* 列块目录项: 按(行组, 列)顺序排列,共group_count * column_count个 */
+PACK_PUSH
+typedef struct {
+    unsigned long long offset;  /* 列块偏移 */
+    unsigned int size;          /* 列块字节数 */
+    unsigned int checksum;      /* 列块校验和 */
+    int min;                    /* 最小值(字典列为编码,字符串列为字节长度) */
+    int max;                    /* 最大值 */
+} ColumnChunk;
+PACK_POP
+
+/* 列式文件读取器 */
+typedef struct ColumnarReader ColumnarReader;
+
+/* 列式导出与完整加载 */
+ErrorCode storage_export_columnar(const char *filename, EmployeeManager *manager);
+ErrorCode storage_export_columnar_snapshot(const char *filename, const EmployeeSnapshot *snapshot);
+ErrorCode storage_load_columnar(const char *filename, EmployeeManager *manager);
+
+/* 打开列式文件: 只读入文件头、列定义、部门字典和列块目录,err可为NULL */
+ColumnarReader *storage_columnar_open(const char *filename, ErrorCode *err);
+void storage_columnar_close(ColumnarReader *reader);
+
+/* 总行数、行组数、第group组的行数 */
+size_t storage_columnar_row_count(const ColumnarReader *reader);
+size_t storage_columnar_group_count(const ColumnarReader *reader);
+size_t storage_columnar_group_rows(const ColumnarReader *reader, size_t group);
+
+/* 行组中某列的min/max统计(不读数据) */
+ErrorCode storage_columnar_stats(const ColumnarReader *reader, size_t group, ColumnIndex column,
+                                 int *min, int *max);
+
+/*
+ * 只读取行组中的一列整数: INT32/DATE32列原样输出,DICT16列输出部门编码;
+ * out至少容纳group_rows个int
+ */
+ErrorCode storage_columnar_read_ints(ColumnarReader *reader, size_t group, ColumnIndex column,
+                                     int *out);
+
+/* 部门编码对应的部门名,越界返回NULL */
+const char *storage_columnar_department(const ColumnarReader *reader, int code);
+
+#endif /* COLUMNAR_H */
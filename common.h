@@ -41,11 +41,23 @@ typedef enum {
 #define MAX_NAME_LEN 64
 #define MAX_DEPT_LEN 64
 #define MAX_DATE_LEN 16
+#define MAX_ATTEND_DAYS 366
 #define MAX_PASSWORD_LEN 64
 #define MAX_USERNAME_LEN 32
 
 /* 魔数定义 */
 #define MAGIC_NUMBER 0x454D5053  /* ASCII: EMPS */
-#define FILE_VERSION 1
+#define FILE_VERSION 2               /* 职工数据文件当前版本(分块+目录+索引段) */
+#define FILE_VERSION_V1 1            /* 旧版定长记录格式,仍可加载 */
+#define COMPACT_MAGIC 0x454D5043     /* ASCII: EMPC */
+#define COMPACT_VERSION 1
+#define ATTENDANCE_MAGIC 0x41545444  /* ASCII: ATTD */
+#define ATTENDANCE_VERSION 1
+#define COLUMNAR_MAGIC 0x4C4F4345    /* ASCII: ECOL */
+#define COLUMNAR_VERSION 1
+#define MANIFEST_MAGIC 0x54534D50    /* ASCII: PMST */
+#define MANIFEST_VERSION 1
+#define CREDENTIAL_MAGIC 0x41555448  /* ASCII: AUTH */
+#define CREDENTIAL_VERSION 1
 
 #endif /* COMMON_H */
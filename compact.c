@@ -0,0 +1,387 @@
+#include "compact.h"
+#include "attendance.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ========== 字符串区 ========== */
+
+/* 追加字符串(含结尾符),返回偏移 */
+static ErrorCode arena_append(CompactTable *table, const char *str, size_t length,
+                              unsigned int *offset) {
+    if (table->arena_size + length + 1 > 0xFFFFFFFFu) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+
+    if (table->arena_size + length + 1 > table->arena_capacity) {
+        size_t new_capacity = (table->arena_capacity == 0) ? 1024 : table->arena_capacity * 2;
+        while (new_capacity < table->arena_size + length + 1) {
+            new_capacity *= 2;
+        }
+        char *arena = (char *)realloc(table->arena, new_capacity);
+        if (arena == NULL) {
+            return ERROR_OUT_OF_MEMORY;
+        }
+        table->arena = arena;
+        table->arena_capacity = new_capacity;
+    }
+
+    *offset = (unsigned int)table->arena_size;
+    memcpy(table->arena + table->arena_size, str, length);
+    table->arena[table->arena_size + length] = '\0';
+    table->arena_size += length + 1;
+    return SUCCESS;
+}
+
+/* 引用是否落在字符串区内且以'\0'结尾 */
+static Bool arena_ref_valid(const CompactTable *table, size_t offset, size_t length) {
+    return (offset + length < table->arena_size && table->arena[offset + length] == '\0')
+               ? TRUE : FALSE;
+}
+
+/* 偏移处是否为字符串区内以'\0'结尾的字符串 */
+static Bool arena_string_valid(const CompactTable *table, size_t offset) {
+    return (offset < table->arena_size &&
+            memchr(table->arena + offset, '\0', table->arena_size - offset) != NULL)
+               ? TRUE : FALSE;
+}
+
+/* ========== 部门字典 ========== */
+
+static size_t dept_hash(const char *str, size_t length) {
+    size_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)str[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static void dept_index_insert(CompactTable *table, unsigned short code) {
+    const CompactString *dept = &table->depts[code];
+    size_t mask = table->slot_count - 1;
+    size_t pos = dept_hash(table->arena + dept->offset, dept->length) & mask;
+    while (table->slots[pos] != 0) {
+        pos = (pos + 1) & mask;
+    }
+    table->slots[pos] = (unsigned short)(code + 1);
+}
+
+/* 负载因子超过1/2时扩容并重建部门索引 */
+static ErrorCode dept_index_reserve(CompactTable *table, size_t count) {
+    if (count * 2 <= table->slot_count) {
+        return SUCCESS;
+    }
+
+    size_t new_count = (table->slot_count == 0) ? 16 : table->slot_count;
+    while (count * 2 > new_count) {
+        new_count *= 2;
+    }
+    unsigned short *slots = (unsigned short *)calloc(new_count, sizeof(unsigned short));
+    if (slots == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+
+    free(table->slots);
+    table->slots = slots;
+    table->slot_count = new_count;
+    for (size_t i = 0; i < table->dept_count; i++) {
+        dept_index_insert(table, (unsigned short)i);
+    }
+    return SUCCESS;
+}
+
+ErrorCode compact_table_intern_department(CompactTable *table, const char *department,
+                                          unsigned short *code) {
+    if (table == NULL || department == NULL || code == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    size_t length = strlen(department);
+    if (length >= MAX_DEPT_LEN) {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    if (table->slot_count > 0) {
+        size_t mask = table->slot_count - 1;
+        for (size_t pos = dept_hash(department, length) & mask;
+             table->slots[pos] != 0; pos = (pos + 1) & mask) {
+            const CompactString *dept = &table->depts[table->slots[pos] - 1];
+            if (dept->length == length &&
+                memcmp(table->arena + dept->offset, department, length) == 0) {
+                *code = (unsigned short)(table->slots[pos] - 1);
+                return SUCCESS;
+            }
+        }
+    }
+
+    if (table->dept_count >= COMPACT_MAX_DEPARTMENTS) {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    ErrorCode err = dept_index_reserve(table, table->dept_count + 1);
+    if (err != SUCCESS) {
+        return err;
+    }
+
+    if (table->dept_count >= table->dept_capacity) {
+        size_t new_capacity = (table->dept_capacity == 0) ? 16 : table->dept_capacity * 2;
+        CompactString *depts = (CompactString *)realloc(table->depts,
+                                                        new_capacity * sizeof(CompactString));
+        if (depts == NULL) {
+            return ERROR_OUT_OF_MEMORY;
+        }
+        table->depts = depts;
+        table->dept_capacity = new_capacity;
+    }
+
+    unsigned int offset;
+    err = arena_append(table, department, length, &offset);
+    if (err != SUCCESS) {
+        return err;
+    }
+
+    CompactString *dept = &table->depts[table->dept_count];
+    dept->offset = offset;
+    dept->length = (unsigned char)length;
+    *code = (unsigned short)table->dept_count;
+    table->dept_count++;
+    dept_index_insert(table, *code);
+    return SUCCESS;
+}
+
+/* ========== CompactTable 实现 ========== */
+
+CompactTable *compact_table_create(void) {
+    CompactTable *table = (CompactTable *)calloc(1, sizeof(CompactTable));
+    if (table != NULL) {
+        table->next_id = 1001;
+    }
+    return table;
+}
+
+void compact_table_free(CompactTable *table) {
+    if (table != NULL) {
+        free(table->rows);
+        free(table->arena);
+        free(table->depts);
+        free(table->slots);
+        free(table);
+    }
+}
+
+/* 日期编码: 合法的YYYY-MM-DD转为整数,其余原样存入字符串区 */
+static ErrorCode encode_date(CompactTable *table, const char *date, int *code) {
+    int year, month, day;
+    if (date[0] == '\0') {
+        *code = 0;
+        return SUCCESS;
+    }
+    if (attendance_parse_date(date, &year, &month, &day)) {
+        *code = year * 10000 + month * 100 + day;
+        return SUCCESS;
+    }
+
+    unsigned int offset;
+    ErrorCode err = arena_append(table, date, strlen(date), &offset);
+    if (err != SUCCESS) {
+        return err;
+    }
+    *code = -(int)offset - 1;
+    return SUCCESS;
+}
+
+ErrorCode compact_table_append(CompactTable *table, const Employee *emp) {
+    if (table == NULL || emp == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    if (table->count >= table->capacity) {
+        size_t new_capacity = (table->capacity == 0) ? 64 : table->capacity * 2;
+        CompactEmployee *rows = (CompactEmployee *)realloc(table->rows,
+                                                           new_capacity * sizeof(CompactEmployee));
+        if (rows == NULL) {
+            return ERROR_OUT_OF_MEMORY;
+        }
+        table->rows = rows;
+        table->capacity = new_capacity;
+    }
+
+    /* Employee中的字符串可能未以'\0'结尾(如从文件读入),按定长截断 */
+    size_t name_length = 0;
+    while (name_length < MAX_NAME_LEN - 1 && emp->name[name_length] != '\0') {
+        name_length++;
+    }
+    char department[MAX_DEPT_LEN];
+    char date[MAX_DATE_LEN];
+    memcpy(department, emp->department, MAX_DEPT_LEN - 1);
+    department[MAX_DEPT_LEN - 1] = '\0';
+    memcpy(date, emp->attend_date, MAX_DATE_LEN - 1);
+    date[MAX_DATE_LEN - 1] = '\0';
+
+    /* 打包结构体的成员不能取地址,先写入局部变量 */
+    unsigned int name_offset = 0;
+    unsigned short dept_code = 0;
+    int attend_date = 0;
+    ErrorCode err = arena_append(table, emp->name, name_length, &name_offset);
+    if (err == SUCCESS) {
+        err = compact_table_intern_department(table, department, &dept_code);
+    }
+    if (err == SUCCESS) {
+        err = encode_date(table, date, &attend_date);
+    }
+    if (err != SUCCESS) {
+        return err;
+    }
+
+    CompactEmployee row;
+    row.id = emp->id;
+    row.name_offset = name_offset;
+    row.name_length = (unsigned char)name_length;
+    row.dept_code = dept_code;
+    row.attend_date = attend_date;
+    row.attend_days = emp->attend_days;
+    table->rows[table->count++] = row;
+    return SUCCESS;
+}
+
+ErrorCode compact_table_build(CompactTable *table, const EmployeeView *view) {
+    if (table == NULL || view == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    size_t span_count = employee_view_span_count(view);
+    for (size_t s = 0; s < span_count; s++) {
+        Employee *const *records = NULL;
+        size_t count = employee_view_span(view, s, &records);
+        for (size_t i = 0; i < count; i++) {
+            ErrorCode err = compact_table_append(table, records[i]);
+            if (err != SUCCESS) {
+                return err;
+            }
+        }
+    }
+
+    table->next_id = view->next_id;
+    return SUCCESS;
+}
+
+ErrorCode compact_table_attach(CompactTable *table, CompactEmployee *rows, size_t count,
+                               char *arena, size_t arena_size,
+                               CompactString *depts, size_t dept_count) {
+    if (table == NULL) {
+        free(rows);
+        free(arena);
+        free(depts);
+        return ERROR_NULL_POINTER;
+    }
+
+    free(table->rows);
+    free(table->arena);
+    free(table->depts);
+    free(table->slots);
+    table->rows = rows;
+    table->count = count;
+    table->capacity = count;
+    table->arena = arena;
+    table->arena_size = arena_size;
+    table->arena_capacity = arena_size;
+    table->depts = depts;
+    table->dept_count = dept_count;
+    table->dept_capacity = dept_count;
+    table->slots = NULL;
+    table->slot_count = 0;
+
+    ErrorCode result = SUCCESS;
+    if (dept_count > COMPACT_MAX_DEPARTMENTS) {
+        result = ERROR_DATA_CORRUPTION;
+    }
+    for (size_t i = 0; result == SUCCESS && i < dept_count; i++) {
+        if (!arena_ref_valid(table, depts[i].offset, depts[i].length)) {
+            result = ERROR_DATA_CORRUPTION;
+        }
+    }
+    for (size_t i = 0; result == SUCCESS && i < count; i++) {
+        const CompactEmployee *row = &rows[i];
+        if (!arena_ref_valid(table, row->name_offset, row->name_length) ||
+            row->dept_code >= dept_count ||
+            (row->attend_date < 0 &&
+             !arena_string_valid(table, (size_t)(-(long long)row->attend_date - 1)))) {
+            result = ERROR_DATA_CORRUPTION;
+        }
+    }
+    if (result == SUCCESS) {
+        result = dept_index_reserve(table, dept_count);
+    }
+
+    if (result != SUCCESS) {
+        free(table->rows);
+        free(table->arena);
+        free(table->depts);
+        free(table->slots);
+        memset(table, 0, sizeof(CompactTable));
+        table->next_id = 1001;
+    }
+    return result;
+}
+
+/* ========== 访问函数 ========== */
+
+const char *compact_table_name(const CompactTable *table, size_t index) {
+    if (table == NULL || index >= table->count) {
+        return NULL;
+    }
+    return table->arena + table->rows[index].name_offset;
+}
+
+const char *compact_table_department(const CompactTable *table, size_t index) {
+    if (table == NULL || index >= table->count) {
+        return NULL;
+    }
+    return table->arena + table->depts[table->rows[index].dept_code].offset;
+}
+
+void compact_table_date(const CompactTable *table, size_t index, char *buffer) {
+    if (buffer == NULL) {
+        return;
+    }
+    buffer[0] = '\0';
+    if (table == NULL || index >= table->count) {
+        return;
+    }
+
+    int code = table->rows[index].attend_date;
+    if (code > 0) {
+        snprintf(buffer, MAX_DATE_LEN, "%04d-%02d-%02d",
+                 code / 10000, code / 100 % 100, code % 100);
+    } else if (code < 0) {
+        strncpy(buffer, table->arena + (size_t)(-(long long)code - 1), MAX_DATE_LEN - 1);
+        buffer[MAX_DATE_LEN - 1] = '\0';
+    }
+}
+
+ErrorCode compact_table_get(const CompactTable *table, size_t index, Employee *out) {
+    if (table == NULL || out == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    if (index >= table->count) {
+        return ERROR_INDEX_OUT_OF_BOUNDS;
+    }
+
+    const CompactEmployee *row = &table->rows[index];
+    memset(out, 0, sizeof(Employee));
+    out->id = row->id;
+    memcpy(out->name, table->arena + row->name_offset, row->name_length);
+    strncpy(out->department, compact_table_department(table, index), MAX_DEPT_LEN - 1);
+    compact_table_date(table, index, out->attend_date);
+    out->attend_days = row->attend_days;
+    return SUCCESS;
+}
+
+size_t compact_table_memory_usage(const CompactTable *table) {
+    if (table == NULL) {
+        return 0;
+    }
+    return table->count * sizeof(CompactEmployee) + table->arena_size +
+           table->dept_count * sizeof(CompactString) +
+           table->slot_count * sizeof(unsigned short);
+}
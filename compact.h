@@ -0,0 +1,90 @@
+#ifndef COMPACT_H
+#define COMPACT_H
+
+#include "common.h"
+#include "model.h"
+
+/*
+ * 紧凑职工表
+ * 姓名与部门名存放在只追加的字符串区中,记录只保存(偏移, 长度);
+ * 部门名经字典去重后以编码引用;出勤日期编码为整数YYYYMMDD。
+ * 单条记录19字节(定长Employee为152字节),
+ * 原Employee视图可通过访问函数按需还原。
+ */
+
+/* 字符串区引用: 字符串以'\0'结尾,length不含结尾符 */
+PACK_PUSH
+typedef struct {
+    unsigned int offset;    /* 在字符串区中的偏移 */
+    unsigned char length;   /* 字节长度 */
+} CompactString;
+PACK_POP
+
+/* 紧凑职工记录 */
+PACK_PUSH
+typedef struct {
+    int id;                     /* 工号 */
+    unsigned int name_offset;   /* 姓名在字符串区中的偏移 */
+    unsigned char name_length;  /* 姓名字节长度 */
+    unsigned short dept_code;   /* 部门字典编码 */
+    int attend_date;            /* YYYYMMDD; 0为空; 负数为-(原始字符串偏移+1) */
+    int attend_days;            /* 出勤天数 */
+} CompactEmployee;
+PACK_POP
+
+/* 部门字典中的最大编码数 */
+#define COMPACT_MAX_DEPARTMENTS 65535
+
+typedef struct {
+    CompactEmployee *rows;    /* 记录数组 */
+    size_t count;             /* 记录数 */
+    size_t capacity;          /* 记录数组容量 */
+    char *arena;              /* 只追加的字符串区 */
+    size_t arena_size;        /* 字符串区已用字节 */
+    size_t arena_capacity;    /* 字符串区容量 */
+    CompactString *depts;     /* 部门字典: 编码 -> 部门名 */
+    size_t dept_count;        /* 部门数 */
+    size_t dept_capacity;     /* 部门字典容量 */
+    unsigned short *slots;    /* 部门名哈希槽: 存放编码+1, 0表示空 */
+    size_t slot_count;        /* 哈希槽数量(2的幂) */
+    int next_id;              /* 下一个可用工号 */
+} CompactTable;
+
+/* ========== CompactTable 方法 ========== */
+
+CompactTable *compact_table_create(void);
+void compact_table_free(CompactTable *table);
+
+/* 追加一条职工记录 */
+ErrorCode compact_table_append(CompactTable *table, const Employee *emp);
+
+/* 从只读视图构建(追加视图中的全部记录并记录next_id) */
+ErrorCode compact_table_build(CompactTable *table, const EmployeeView *view);
+
+/*
+ * 接管从文件读出的各段缓冲区(必须由malloc分配,失败时也会被释放),
+ * 校验所有引用均落在字符串区内并重建部门索引
+ */
+ErrorCode compact_table_attach(CompactTable *table, CompactEmployee *rows, size_t count,
+                               char *arena, size_t arena_size,
+                               CompactString *depts, size_t dept_count);
+
+/* 取部门编码,不存在时加入字典 */
+ErrorCode compact_table_intern_department(CompactTable *table, const char *department,
+                                          unsigned short *code);
+
+/* ========== 访问函数 ========== */
+
+const char *compact_table_name(const CompactTable *table, size_t index);
+const char *compact_table_department(const CompactTable *table, size_t index);
+
+/* 还原出勤日期字符串,buffer至少MAX_DATE_LEN字节 */
+void compact_table_date(const CompactTable *table, size_t index, char *buffer);
+
+/* 还原完整的Employee */
+ErrorCode compact_table_get(const CompactTable *table, size_t index, Employee *out);
+
+/* 当前占用的内存字节数(不含未使用的容量) */
+size_t compact_table_memory_usage(const CompactTable *table);
+
+#endif /* COMPACT_H */
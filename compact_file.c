@@ -0,0 +1,178 @@
+/* 启用64位文件偏移(须在所有系统头文件之前定义) */
+#if !defined(_WIN32) && !defined(_FILE_OFFSET_BITS)
+    #define _FILE_OFFSET_BITS 64
+#endif
+
+#include "compact_file.h"
+#include "storage.h"
+#include "storage_io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 将紧凑表写入文件 */
+static ErrorCode save_compact_table(const char *filename, const CompactTable *table) {
+    AtomicFile file;
+    ErrorCode err = atomic_file_open(&file, filename, "wb");
+    if (err != SUCCESS) {
+        return err;
+    }
+    FILE *fp = file.fp;
+
+    CompactFileInfo info;
+    info.arena_size = (unsigned int)table->arena_size;
+    info.dept_count = (unsigned int)table->dept_count;
+    info.next_id = table->next_id;
+
+    FileHeader header;
+    header.magic = COMPACT_MAGIC;
+    header.version = COMPACT_VERSION;
+    header.count = (unsigned int)table->count;
+    header.checksum = calculate_checksum(&info, sizeof(info)) +
+                      calculate_checksum(table->rows, table->count * sizeof(CompactEmployee)) +
+                      calculate_checksum(table->depts, table->dept_count * sizeof(CompactString)) +
+                      calculate_checksum(table->arena, table->arena_size);
+
+    Bool ok = (fwrite(&header, sizeof(FileHeader), 1, fp) == 1 &&
+               fwrite(&info, sizeof(info), 1, fp) == 1) ? TRUE : FALSE;
+    if (ok && table->count > 0) {
+        ok = (fwrite(table->rows, sizeof(CompactEmployee), table->count, fp) == table->count)
+                 ? TRUE : FALSE;
+    }
+    if (ok && table->dept_count > 0) {
+        ok = (fwrite(table->depts, sizeof(CompactString), table->dept_count, fp) ==
+              table->dept_count) ? TRUE : FALSE;
+    }
+    if (ok && table->arena_size > 0) {
+        ok = (fwrite(table->arena, 1, table->arena_size, fp) == table->arena_size) ? TRUE : FALSE;
+    }
+
+    if (!ok) {
+        atomic_file_abort(&file);
+        return ERROR_FILE_WRITE_FAILED;
+    }
+    return atomic_file_commit(&file);
+}
+
+/* 以紧凑格式保存职工数据 */
+ErrorCode storage_save_compact(const char *filename, EmployeeManager *manager) {
+    if (filename == NULL || manager == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    CompactTable *table = compact_table_create();
+    if (table == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+
+    EmployeeView view;
+    employee_manager_view_begin(manager, &view);
+    ErrorCode err = compact_table_build(table, &view);
+    employee_manager_view_end(manager, &view);
+
+    if (err == SUCCESS) {
+        err = save_compact_table(filename, table);
+    }
+    compact_table_free(table);
+    return err;
+}
+
+/* 读取紧凑格式文件到紧凑表 */
+ErrorCode storage_load_compact_table(const char *filename, CompactTable *table) {
+    if (filename == NULL || table == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) {
+        return ERROR_FILE_NOT_FOUND;
+    }
+
+    FileHeader header;
+    CompactFileInfo info;
+    if (fread(&header, sizeof(FileHeader), 1, fp) != 1 ||
+        fread(&info, sizeof(info), 1, fp) != 1) {
+        fclose(fp);
+        return ERROR_FILE_READ_FAILED;
+    }
+
+    if (header.magic != COMPACT_MAGIC || header.version != COMPACT_VERSION) {
+        fclose(fp);
+        return ERROR_INVALID_FILE;
+    }
+
+    /* 多分配1个元素,避免零长度malloc返回NULL被误判为内存不足 */
+    CompactEmployee *rows = (CompactEmployee *)malloc(((size_t)header.count + 1) *
+                                                      sizeof(CompactEmployee));
+    CompactString *depts = (CompactString *)malloc(((size_t)info.dept_count + 1) *
+                                                   sizeof(CompactString));
+    char *arena = (char *)malloc((size_t)info.arena_size + 1);
+    ErrorCode result = SUCCESS;
+    if (rows == NULL || depts == NULL || arena == NULL) {
+        result = ERROR_OUT_OF_MEMORY;
+    } else if (fread(rows, sizeof(CompactEmployee), header.count, fp) != header.count ||
+               fread(depts, sizeof(CompactString), info.dept_count, fp) != info.dept_count ||
+               fread(arena, 1, info.arena_size, fp) != info.arena_size) {
+        result = ERROR_FILE_READ_FAILED;
+    } else if (calculate_checksum(&info, sizeof(info)) +
+               calculate_checksum(rows, header.count * sizeof(CompactEmployee)) +
+               calculate_checksum(depts, info.dept_count * sizeof(CompactString)) +
+               calculate_checksum(arena, info.arena_size) != header.checksum) {
+        result = ERROR_DATA_CORRUPTION;
+    }
+    fclose(fp);
+
+    if (result != SUCCESS) {
+        free(rows);
+        free(depts);
+        free(arena);
+        return result;
+    }
+
+    result = compact_table_attach(table, rows, header.count, arena, info.arena_size,
+                                  depts, info.dept_count);
+    if (result == SUCCESS) {
+        table->next_id = info.next_id;
+    }
+    return result;
+}
+
+/* 从紧凑格式文件加载职工数据 */
+ErrorCode storage_load_compact(const char *filename, EmployeeManager *manager) {
+    if (filename == NULL || manager == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    CompactTable *table = compact_table_create();
+    if (table == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+
+    ErrorCode result = storage_load_compact_table(filename, table);
+    if (result != SUCCESS) {
+        compact_table_free(table);
+        return result;
+    }
+
+    employee_manager_begin_write(manager);
+    result = vector_reserve(manager->employees, manager->employees->size + table->count);
+    for (size_t i = 0; result == SUCCESS && i < table->count; i++) {
+        Employee *emp = (Employee *)malloc(sizeof(Employee));
+        if (emp == NULL) {
+            result = ERROR_OUT_OF_MEMORY;
+            break;
+        }
+        compact_table_get(table, i, emp);
+        result = vector_push_back(manager->employees, emp);
+        if (result != SUCCESS) {
+            free(emp);
+        }
+    }
+    if (result == SUCCESS) {
+        manager->next_id = table->next_id;
+    }
+    employee_manager_end_write(manager);
+
+    compact_table_free(table);
+    return result;
+}
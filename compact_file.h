@@ -0,0 +1,24 @@
+#ifndef COMPACT_FILE_H
+#define COMPACT_FILE_H
+
+#include "common.h"
+#include "model.h"
+#include "compact.h"
+
+/* 紧凑格式文件信息: 紧随FileHeader之后,其后依次为记录、部门字典、字符串区 */
+PACK_PUSH
+typedef struct {
+    unsigned int arena_size;   /* 字符串区字节数 */
+    unsigned int dept_count;   /* 部门数 */
+    int next_id;               /* 下一个可用工号 */
+} CompactFileInfo;
+PACK_POP
+
+/* 紧凑格式保存/加载: 变长字符串区+部门字典+整数日期,文件体积约为定长格式的1/5 */
+ErrorCode storage_save_compact(const char *filename, EmployeeManager *manager);
+ErrorCode storage_load_compact(const char *filename, EmployeeManager *manager);
+
+/* 直接读入紧凑表(不还原为Employee),table须为空表 */
+ErrorCode storage_load_compact_table(const char *filename, CompactTable *table);
+
+#endif /* COMPACT_FILE_H */
@@ -1,9 +1,19 @@
 #include "controller.h"
 #include "view.h"
+#include "csv_import.h"
+#include "columnar.h"
+#include "compact_file.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+/* 后台加载线程: 读入到独立的管理器,不与主线程共享数据 */
+static void controller_load_task(void *arg) {
+    Controller *ctrl = (Controller *)arg;
+    ctrl->load_result = storage_load_employees(ctrl->data_file, ctrl->loading);
+    atomic_long_store(&ctrl->load_finished, 1);
+}
+
 /* 创建控制器 */
 Controller *controller_create(const char *data_file, const char *auth_file) {
     if (data_file == NULL || auth_file == NULL) {
@@ -28,10 +38,17 @@ Controller *controller_create(const char *data_file, const char *auth_file) {
         return NULL;
     }
     
+    ctrl->saver = background_saver_create();
+    ctrl->indexer = background_indexer_create();
     ctrl->data_file = (char *)malloc(strlen(data_file) + 1);
     ctrl->auth_file = (char *)malloc(strlen(auth_file) + 1);
     
-    if (ctrl->data_file == NULL || ctrl->auth_file == NULL) {
+    if (ctrl->saver == NULL || ctrl->indexer == NULL ||
+        ctrl->data_file == NULL || ctrl->auth_file == NULL) {
+        background_saver_free(ctrl->saver);
+        background_indexer_free(ctrl->indexer);
+        free(ctrl->data_file);
+        free(ctrl->auth_file);
         view_free(ctrl->view);
         employee_manager_free(ctrl->manager);
         free(ctrl);
@@ -40,14 +57,49 @@ Controller *controller_create(const char *data_file, const char *auth_file) {
     
     strcpy(ctrl->data_file, data_file);
     strcpy(ctrl->auth_file, auth_file);
+    ctrl->credentials = NULL;
     ctrl->is_running = TRUE;
+    ctrl->indexed_generation = 0;
+    ctrl->index_submitted = FALSE;
+    ctrl->observed_generation = 0;
+    
+    /* 登录期间在后台加载数据;线程无法启动时由controller_wait_load同步加载 */
+    ctrl->loader = NULL;
+    ctrl->load_result = SUCCESS;
+    ctrl->load_finished = 0;
+    ctrl->load_done = FALSE;
+    ctrl->loading = employee_manager_create();
+    if (ctrl->loading != NULL) {
+        ctrl->loader = thread_create(controller_load_task, ctrl);
+        if (ctrl->loader == NULL) {
+            employee_manager_free(ctrl->loading);
+            ctrl->loading = NULL;
+        }
+    }
     
     return ctrl;
 }
 
+/* 更换视图(接管所有权),用于批处理等非交互视图 */
+void controller_set_view(Controller *ctrl, AppView *view) {
+    if (ctrl == NULL || view == NULL) {
+        return;
+    }
+    view_free(ctrl->view);
+    ctrl->view = view;
+}
+
 /* 释放控制器 */
 void controller_free(Controller *ctrl) {
     if (ctrl != NULL) {
+        /* 未取回的后台加载须先结束 */
+        if (ctrl->loader != NULL) {
+            thread_join(ctrl->loader);
+            employee_manager_free(ctrl->loading);
+        }
+        /* 保存器和索引构建器持有管理器的快照,须先于管理器释放 */
+        background_saver_free(ctrl->saver);
+        background_indexer_free(ctrl->indexer);
         if (ctrl->manager != NULL) {
             employee_manager_free(ctrl->manager);
         }
@@ -60,6 +112,7 @@ void controller_free(Controller *ctrl) {
         if (ctrl->auth_file != NULL) {
             free(ctrl->auth_file);
         }
+        storage_credentials_close(ctrl->credentials);
         free(ctrl);
     }
 }
@@ -73,73 +126,120 @@ Bool controller_login(Controller *ctrl) {
     char username[MAX_USERNAME_LEN];
     char password[MAX_PASSWORD_LEN];
     
-    printf("\n========================================\n");
-    printf("         System Login\n");
-    printf("========================================\n");
+    ctrl->view->vptr->show_text(ctrl->view,
+                                "\n========================================\n"
+                                "         System Login\n"
+                                "========================================\n");
+    
+    /* 凭证库只读入一次,之后的验证都在内存中完成 */
+    if (ctrl->credentials == NULL) {
+        ctrl->credentials = storage_credentials_open(ctrl->auth_file, NULL);
+        if (ctrl->credentials == NULL) {
+            ctrl->view->vptr->show_message(ctrl->view, "Failed to read credential file!", TRUE);
+            return FALSE;
+        }
+    }
     
     /* 检查是否已有管理员账号 */
-    if (storage_verify_credential(ctrl->auth_file, "", "") == FALSE) {
+    if (storage_credentials_count(ctrl->credentials) == 0) {
         /* 首次运行,创建管理员账号 */
-        printf("\nFirst run detected, please create admin account:\n");
-        ctrl->view->vptr->get_input_string("Enter username: ", username, MAX_USERNAME_LEN);
-        ctrl->view->vptr->get_input_string("Enter password: ", password, MAX_PASSWORD_LEN);
+        ctrl->view->vptr->show_text(ctrl->view, "\nFirst run detected, please create admin account:\n");
+        ctrl->view->vptr->get_input_string(ctrl->view, "Enter username: ", username, MAX_USERNAME_LEN);
+        ctrl->view->vptr->get_input_string(ctrl->view, "Enter password: ", password, MAX_PASSWORD_LEN);
         
-        if (storage_save_credential(ctrl->auth_file, username, password) != SUCCESS) {
-            ctrl->view->vptr->show_message("Failed to create admin account!", TRUE);
+        if (storage_credentials_add(ctrl->credentials, username, password) != SUCCESS) {
+            ctrl->view->vptr->show_message(ctrl->view, "Failed to create admin account!", TRUE);
             return FALSE;
         }
         
-        ctrl->view->vptr->show_message("Admin account created successfully!", FALSE);
+        ctrl->view->vptr->show_message(ctrl->view, "Admin account created successfully!", FALSE);
         return TRUE;
     }
     
     /* 登录验证 */
     int attempts = 3;
     while (attempts > 0) {
-        ctrl->view->vptr->get_input_string("Username: ", username, MAX_USERNAME_LEN);
-        ctrl->view->vptr->get_input_string("Password: ", password, MAX_PASSWORD_LEN);
+        ctrl->view->vptr->get_input_string(ctrl->view, "Username: ", username, MAX_USERNAME_LEN);
+        ctrl->view->vptr->get_input_string(ctrl->view, "Password: ", password, MAX_PASSWORD_LEN);
         
-        if (storage_verify_credential(ctrl->auth_file, username, password)) {
-            ctrl->view->vptr->show_message("Login successful!", FALSE);
+        if (storage_credentials_verify(ctrl->credentials, username, password)) {
+            ctrl->view->vptr->show_message(ctrl->view, "Login successful!", FALSE);
             return TRUE;
         }
         
         attempts--;
         if (attempts > 0) {
-            printf("\n[ERROR] Invalid username or password! %d attempts remaining\n", attempts);
+            char msg[100];
+            snprintf(msg, 100, "Invalid username or password! %d attempts remaining", attempts);
+            ctrl->view->vptr->show_message(ctrl->view, msg, TRUE);
         }
     }
     
-    ctrl->view->vptr->show_message("Too many failed login attempts, exiting!", TRUE);
+    ctrl->view->vptr->show_message(ctrl->view, "Too many failed login attempts, exiting!", TRUE);
     return FALSE;
 }
 
+/* 等待后台加载并换入管理器 */
+ErrorCode controller_wait_load(Controller *ctrl) {
+    if (ctrl == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    if (ctrl->load_done) {
+        return ctrl->load_result;
+    }
+    
+    if (ctrl->loader != NULL) {
+        thread_join(ctrl->loader);
+        ctrl->loader = NULL;
+        if (ctrl->load_result == SUCCESS) {
+            employee_manager_free(ctrl->manager);
+            ctrl->manager = ctrl->loading;
+        } else {
+            employee_manager_free(ctrl->loading);
+        }
+        ctrl->loading = NULL;
+    } else {
+        ctrl->load_result = storage_load_employees(ctrl->data_file, ctrl->manager);
+    }
+    
+    /* 数据就绪后一次性切换到并发模式,后台保存和索引构建都基于快照 */
+    ErrorCode err = employee_manager_enable_concurrency(ctrl->manager);
+    if (err != SUCCESS && ctrl->load_result == SUCCESS) {
+        ctrl->load_result = err;
+    }
+    ctrl->load_done = TRUE;
+    return ctrl->load_result;
+}
+
 /* 启动系统 */
 ErrorCode controller_start(Controller *ctrl) {
     if (ctrl == NULL) {
         return ERROR_NULL_POINTER;
     }
     
-    /* 用户登录 */
+    /* 用户登录(数据已在后台加载) */
     if (!controller_login(ctrl)) {
         return ERROR_AUTH_FAILED;
     }
     
-    /* 尝试加载数据 */
-    ErrorCode err = storage_load_employees(ctrl->data_file, ctrl->manager);
+    /* 登录通过且加载完成后才进入菜单 */
+    if (ctrl->loader != NULL && atomic_long_load(&ctrl->load_finished) == 0) {
+        ctrl->view->vptr->show_message(ctrl->view, "Loading data, please wait...", FALSE);
+    }
+    ErrorCode err = controller_wait_load(ctrl);
     if (err == ERROR_FILE_NOT_FOUND) {
-        ctrl->view->vptr->show_message("Data file not found, will create new file", FALSE);
+        ctrl->view->vptr->show_message(ctrl->view, "Data file not found, will create new file", FALSE);
     } else if (err != SUCCESS) {
-        ctrl->view->vptr->show_message("Failed to load data!", TRUE);
+        ctrl->view->vptr->show_message(ctrl->view, "Failed to load data!", TRUE);
         return err;
     } else {
         char msg[100];
         snprintf(msg, 100, "Successfully loaded %zu employee records", 
                  ctrl->manager->employees->size);
-        ctrl->view->vptr->show_message(msg, FALSE);
+        ctrl->view->vptr->show_message(ctrl->view, msg, FALSE);
     }
     
-    view_pause();
+    VIEW_PAUSE(ctrl->view);
     return SUCCESS;
 }
 
@@ -150,8 +250,13 @@ void controller_run(Controller *ctrl) {
     }
     
     while (ctrl->is_running) {
+        controller_report_saves(ctrl);
+        /* 批处理连续执行大量修改,每条命令后重建索引得不偿失 */
+        if (ctrl->view->interactive) {
+            controller_refresh_indexes(ctrl);
+        }
         VIEW_SHOW_MENU(ctrl->view);
-        int choice = ctrl->view->vptr->get_input_int("Select option (0-9): ");
+        int choice = ctrl->view->vptr->get_input_int(ctrl->view, "Select option (0-11): ");
         controller_handle_menu(ctrl, choice);
     }
 }
@@ -190,12 +295,18 @@ void controller_handle_menu(Controller *ctrl, int choice) {
         case 9:
             controller_save_and_exit(ctrl);
             break;
+        case 10:
+            controller_save_background(ctrl);
+            break;
+        case 11:
+            controller_import_csv(ctrl);
+            break;
         case 0:
-            ctrl->view->vptr->show_message("Exit without saving", FALSE);
+            ctrl->view->vptr->show_message(ctrl->view, "Exit without saving", FALSE);
             ctrl->is_running = FALSE;
             break;
         default:
-            ctrl->view->vptr->show_message("Invalid option!", TRUE);
+            ctrl->view->vptr->show_message(ctrl->view, "Invalid option!", TRUE);
             break;
     }
 }
@@ -210,21 +321,21 @@ void controller_add_employee(Controller *ctrl) {
     char department[MAX_DEPT_LEN];
     char attend_date[MAX_DATE_LEN];
     
-    printf("\n========== Add Employee ==========\n");
-    ctrl->view->vptr->get_input_string("Name: ", name, MAX_NAME_LEN);
-    ctrl->view->vptr->get_input_string("Department: ", department, MAX_DEPT_LEN);
-    ctrl->view->vptr->get_input_string("Attendance Date (YYYY-MM-DD): ", attend_date, MAX_DATE_LEN);
-    int attend_days = ctrl->view->vptr->get_input_int("Attendance Days: ");
+    ctrl->view->vptr->show_title(ctrl->view, "Add Employee");
+    ctrl->view->vptr->get_input_string(ctrl->view, "Name: ", name, MAX_NAME_LEN);
+    ctrl->view->vptr->get_input_string(ctrl->view, "Department: ", department, MAX_DEPT_LEN);
+    ctrl->view->vptr->get_input_string(ctrl->view, "Attendance Date (YYYY-MM-DD): ", attend_date, MAX_DATE_LEN);
+    int attend_days = ctrl->view->vptr->get_input_int(ctrl->view, "Attendance Days: ");
     
     ErrorCode err = employee_manager_add(ctrl->manager, name, department, 
                                          attend_date, attend_days);
     if (err == SUCCESS) {
-        ctrl->view->vptr->show_message("Employee added successfully!", FALSE);
+        ctrl->view->vptr->show_message(ctrl->view, "Employee added successfully!", FALSE);
     } else {
-        ctrl->view->vptr->show_message("Failed to add employee!", TRUE);
+        ctrl->view->vptr->show_message(ctrl->view, "Failed to add employee!", TRUE);
     }
     
-    view_pause();
+    VIEW_PAUSE(ctrl->view);
 }
 
 /* 删除职工 */
@@ -233,19 +344,19 @@ void controller_remove_employee(Controller *ctrl) {
         return;
     }
     
-    printf("\n========== Remove Employee ==========\n");
-    int id = ctrl->view->vptr->get_input_int("Enter employee ID to remove: ");
+    ctrl->view->vptr->show_title(ctrl->view, "Remove Employee");
+    int id = ctrl->view->vptr->get_input_int(ctrl->view, "Enter employee ID to remove: ");
     
     ErrorCode err = employee_manager_remove_by_id(ctrl->manager, id);
     if (err == SUCCESS) {
-        ctrl->view->vptr->show_message("Employee removed successfully!", FALSE);
+        ctrl->view->vptr->show_message(ctrl->view, "Employee removed successfully!", FALSE);
     } else if (err == ERROR_NOT_FOUND) {
-        ctrl->view->vptr->show_message("Employee ID not found!", TRUE);
+        ctrl->view->vptr->show_message(ctrl->view, "Employee ID not found!", TRUE);
     } else {
-        ctrl->view->vptr->show_message("Failed to remove employee!", TRUE);
+        ctrl->view->vptr->show_message(ctrl->view, "Failed to remove employee!", TRUE);
     }
     
-    view_pause();
+    VIEW_PAUSE(ctrl->view);
 }
 
 /* 修改职工信息 */
@@ -258,25 +369,25 @@ void controller_update_employee(Controller *ctrl) {
     char department[MAX_DEPT_LEN];
     char attend_date[MAX_DATE_LEN];
     
-    printf("\n========== Update Employee ==========\n");
-    int id = ctrl->view->vptr->get_input_int("Enter employee ID to update: ");
+    ctrl->view->vptr->show_title(ctrl->view, "Update Employee");
+    int id = ctrl->view->vptr->get_input_int(ctrl->view, "Enter employee ID to update: ");
     
-    ctrl->view->vptr->get_input_string("New Name: ", name, MAX_NAME_LEN);
-    ctrl->view->vptr->get_input_string("New Department: ", department, MAX_DEPT_LEN);
-    ctrl->view->vptr->get_input_string("New Attendance Date (YYYY-MM-DD): ", attend_date, MAX_DATE_LEN);
-    int attend_days = ctrl->view->vptr->get_input_int("New Attendance Days: ");
+    ctrl->view->vptr->get_input_string(ctrl->view, "New Name: ", name, MAX_NAME_LEN);
+    ctrl->view->vptr->get_input_string(ctrl->view, "New Department: ", department, MAX_DEPT_LEN);
+    ctrl->view->vptr->get_input_string(ctrl->view, "New Attendance Date (YYYY-MM-DD): ", attend_date, MAX_DATE_LEN);
+    int attend_days = ctrl->view->vptr->get_input_int(ctrl->view, "New Attendance Days: ");
     
     ErrorCode err = employee_manager_update(ctrl->manager, id, name, 
                                             department, attend_date, attend_days);
     if (err == SUCCESS) {
-        ctrl->view->vptr->show_message("Employee updated successfully!", FALSE);
+        ctrl->view->vptr->show_message(ctrl->view, "Employee updated successfully!", FALSE);
     } else if (err == ERROR_NOT_FOUND) {
-        ctrl->view->vptr->show_message("Employee ID not found!", TRUE);
+        ctrl->view->vptr->show_message(ctrl->view, "Employee ID not found!", TRUE);
     } else {
-        ctrl->view->vptr->show_message("Failed to update employee!", TRUE);
+        ctrl->view->vptr->show_message(ctrl->view, "Failed to update employee!", TRUE);
     }
     
-    view_pause();
+    VIEW_PAUSE(ctrl->view);
 }
 
 /* 查询职工 */
@@ -285,55 +396,58 @@ void controller_search_employee(Controller *ctrl) {
         return;
     }
     
-    printf("\n========== Search Employee ==========\n");
-    printf("1. Search by ID\n");
-    printf("2. Search by Name\n");
-    printf("3. Search by Department\n");
+    ctrl->view->vptr->show_title(ctrl->view, "Search Employee");
+    ctrl->view->vptr->show_text(ctrl->view,
+                                "1. Search by ID\n"
+                                "2. Search by Name\n"
+                                "3. Search by Department\n");
     
-    int choice = ctrl->view->vptr->get_input_int("Select search method: ");
+    int choice = ctrl->view->vptr->get_input_int(ctrl->view, "Select search method: ");
     
     Vector *results = NULL;
     
     switch (choice) {
         case 1: {
-            int id = ctrl->view->vptr->get_input_int("Enter ID: ");
+            int id = ctrl->view->vptr->get_input_int(ctrl->view, "Enter ID: ");
             results = employee_manager_search(ctrl->manager, SEARCH_BY_ID, &id);
             break;
         }
         case 2: {
             char name[MAX_NAME_LEN];
-            ctrl->view->vptr->get_input_string("Enter name (fuzzy search supported): ", name, MAX_NAME_LEN);
+            ctrl->view->vptr->get_input_string(ctrl->view, "Enter name (fuzzy search supported): ", name, MAX_NAME_LEN);
             results = employee_manager_search(ctrl->manager, SEARCH_BY_NAME, name);
             break;
         }
         case 3: {
             char dept[MAX_DEPT_LEN];
-            ctrl->view->vptr->get_input_string("Enter department: ", dept, MAX_DEPT_LEN);
+            ctrl->view->vptr->get_input_string(ctrl->view, "Enter department: ", dept, MAX_DEPT_LEN);
             results = employee_manager_search(ctrl->manager, SEARCH_BY_DEPARTMENT, dept);
             break;
         }
         default:
-            ctrl->view->vptr->show_message("Invalid option!", TRUE);
-            view_pause();
+            ctrl->view->vptr->show_message(ctrl->view, "Invalid option!", TRUE);
+            VIEW_PAUSE(ctrl->view);
             return;
     }
     
     if (results != NULL && results->size > 0) {
-        printf("\nSearch results (%zu found):\n", results->size);
-        ctrl->view->vptr->show_table_header();
+        char caption[64];
+        snprintf(caption, 64, "\nSearch results (%zu found):\n", results->size);
+        ctrl->view->vptr->show_text(ctrl->view, caption);
+        ctrl->view->vptr->show_table_header(ctrl->view);
         for (size_t i = 0; i < results->size; i++) {
             Employee *emp = (Employee *)results->data[i];
-            ctrl->view->vptr->render_row(emp);
+            ctrl->view->vptr->render_row(ctrl->view, emp);
         }
         vector_free(results);
     } else {
-        ctrl->view->vptr->show_message("No matching employees found!", FALSE);
+        ctrl->view->vptr->show_message(ctrl->view, "No matching employees found!", FALSE);
         if (results != NULL) {
             vector_free(results);
         }
     }
     
-    view_pause();
+    VIEW_PAUSE(ctrl->view);
 }
 
 /* 显示所有职工 */
@@ -345,17 +459,19 @@ void controller_show_all_employees(Controller *ctrl) {
     Vector *employees = employee_manager_get_all(ctrl->manager);
     
     if (employees == NULL || employees->size == 0) {
-        ctrl->view->vptr->show_message("No employee records!", FALSE);
+        ctrl->view->vptr->show_message(ctrl->view, "No employee records!", FALSE);
     } else {
-        printf("\nAll Employees (%zu total):\n", employees->size);
-        ctrl->view->vptr->show_table_header();
+        char caption[64];
+        snprintf(caption, 64, "\nAll Employees (%zu total):\n", employees->size);
+        ctrl->view->vptr->show_text(ctrl->view, caption);
+        ctrl->view->vptr->show_table_header(ctrl->view);
         for (size_t i = 0; i < employees->size; i++) {
             Employee *emp = (Employee *)employees->data[i];
-            ctrl->view->vptr->render_row(emp);
+            ctrl->view->vptr->render_row(ctrl->view, emp);
         }
     }
     
-    view_pause();
+    VIEW_PAUSE(ctrl->view);
 }
 
 /* 排序职工 */
@@ -364,14 +480,15 @@ void controller_sort_employees(Controller *ctrl) {
         return;
     }
     
-    printf("\n========== Sort Employees ==========\n");
-    printf("1. Sort by ID\n");
-    printf("2. Sort by Name\n");
-    printf("3. Sort by Department\n");
-    printf("4. Sort by Attendance Date\n");
-    printf("5. Sort by Attendance Days (Descending)\n");
+    ctrl->view->vptr->show_title(ctrl->view, "Sort Employees");
+    ctrl->view->vptr->show_text(ctrl->view,
+                                "1. Sort by ID\n"
+                                "2. Sort by Name\n"
+                                "3. Sort by Department\n"
+                                "4. Sort by Attendance Date\n"
+                                "5. Sort by Attendance Days (Descending)\n");
     
-    int choice = ctrl->view->vptr->get_input_int("Select sort method: ");
+    int choice = ctrl->view->vptr->get_input_int(ctrl->view, "Select sort method: ");
     
     SortType type;
     switch (choice) {
@@ -391,13 +508,13 @@ void controller_sort_employees(Controller *ctrl) {
             type = SORT_BY_ATTEND_DAYS;
             break;
         default:
-            ctrl->view->vptr->show_message("Invalid option!", TRUE);
-            view_pause();
+            ctrl->view->vptr->show_message(ctrl->view, "Invalid option!", TRUE);
+            VIEW_PAUSE(ctrl->view);
             return;
     }
     
     employee_manager_sort(ctrl->manager, type);
-    ctrl->view->vptr->show_message("Sort completed!", FALSE);
+    ctrl->view->vptr->show_message(ctrl->view, "Sort completed!", FALSE);
     
     /* 显示排序结果 */
     controller_show_all_employees(ctrl);
@@ -409,40 +526,41 @@ void controller_statistics(Controller *ctrl) {
         return;
     }
     
-    printf("\n========== Attendance Statistics ==========\n");
-    printf("1. Monthly Statistics\n");
-    printf("2. Yearly Statistics\n");
+    ctrl->view->vptr->show_title(ctrl->view, "Attendance Statistics");
+    ctrl->view->vptr->show_text(ctrl->view,
+                                "1. Monthly Statistics\n"
+                                "2. Yearly Statistics\n");
     
-    int choice = ctrl->view->vptr->get_input_int("Select statistics type: ");
+    int choice = ctrl->view->vptr->get_input_int(ctrl->view, "Select statistics type: ");
     
     char msg[200];
     
     switch (choice) {
         case 1: {
             char year_month[8];
-            ctrl->view->vptr->get_input_string("Enter year-month (YYYY-MM): ", year_month, 8);
+            ctrl->view->vptr->get_input_string(ctrl->view, "Enter year-month (YYYY-MM): ", year_month, 8);
             int total = employee_manager_monthly_attendance(ctrl->manager, year_month);
             snprintf(msg, 200, "%s total attendance days: %d", year_month, total);
-            ctrl->view->vptr->show_message(msg, FALSE);
+            ctrl->view->vptr->show_message(ctrl->view, msg, FALSE);
             break;
         }
         case 2: {
             char year[5];
-            ctrl->view->vptr->get_input_string("Enter year (YYYY): ", year, 5);
+            ctrl->view->vptr->get_input_string(ctrl->view, "Enter year (YYYY): ", year, 5);
             int total = employee_manager_yearly_attendance(ctrl->manager, year);
             snprintf(msg, 200, "%s total attendance days: %d", year, total);
-            ctrl->view->vptr->show_message(msg, FALSE);
+            ctrl->view->vptr->show_message(ctrl->view, msg, FALSE);
             break;
         }
         default:
-            ctrl->view->vptr->show_message("Invalid option!", TRUE);
+            ctrl->view->vptr->show_message(ctrl->view, "Invalid option!", TRUE);
             break;
     }
     
-    view_pause();
+    VIEW_PAUSE(ctrl->view);
 }
 
-/* 导出CSV */
+/* 导出(CSV、列式或紧凑归档) */
 void controller_export_csv(Controller *ctrl) {
     if (ctrl == NULL) {
         return;
@@ -450,30 +568,149 @@ void controller_export_csv(Controller *ctrl) {
     
     char filename[256];
     
-    printf("\n========== Export to CSV ==========\n");
-    ctrl->view->vptr->get_input_string("Enter export filename: ", filename, 256);
+    ctrl->view->vptr->show_title(ctrl->view, "Export");
+    ctrl->view->vptr->show_text(ctrl->view,
+                                "1. CSV\n"
+                                "2. Columnar (for analytics)\n"
+                                "3. Compact (small archive)\n");
+    int format = ctrl->view->vptr->get_input_int(ctrl->view, "Select format: ");
+    if (format < 1 || format > 3) {
+        ctrl->view->vptr->show_message(ctrl->view, "Invalid option!", TRUE);
+        VIEW_PAUSE(ctrl->view);
+        return;
+    }
+    ctrl->view->vptr->get_input_string(ctrl->view, "Enter export filename: ", filename, 256);
     
-    ErrorCode err = storage_export_csv(filename, ctrl->manager);
+    ErrorCode err;
+    if (format == 2) {
+        err = storage_export_columnar(filename, ctrl->manager);
+    } else if (format == 3) {
+        err = storage_save_compact(filename, ctrl->manager);
+    } else {
+        err = storage_export_csv(filename, ctrl->manager);
+    }
     if (err == SUCCESS) {
-        ctrl->view->vptr->show_message("Export successful!", FALSE);
+        ctrl->view->vptr->show_message(ctrl->view, "Export successful!", FALSE);
     } else {
-        ctrl->view->vptr->show_message("Export failed!", TRUE);
+        ctrl->view->vptr->show_message(ctrl->view, "Export failed!", TRUE);
     }
     
-    view_pause();
+    VIEW_PAUSE(ctrl->view);
 }
 
-/* 保存并退出 */
+/* 从CSV导入 */
+void controller_import_csv(Controller *ctrl) {
+    if (ctrl == NULL) {
+        return;
+    }
+    
+    char filename[256];
+    
+    ctrl->view->vptr->show_title(ctrl->view, "Import from CSV");
+    ctrl->view->vptr->get_input_string(ctrl->view, "Enter import filename: ", filename, 256);
+    
+    CsvImportReport report;
+    ErrorCode err = storage_import_csv(filename, ctrl->manager, &report);
+    if (err != SUCCESS) {
+        ctrl->view->vptr->show_message(ctrl->view, "Import failed!", TRUE);
+        VIEW_PAUSE(ctrl->view);
+        return;
+    }
+    
+    char line[128];
+    for (size_t i = 0; i < report.error_count; i++) {
+        snprintf(line, 128, "  Line %zu: %s\n", report.errors[i].line,
+                 storage_csv_line_error_message(report.errors[i].error));
+        ctrl->view->vptr->show_text(ctrl->view, line);
+    }
+    if (report.rejected > report.error_count) {
+        snprintf(line, 128, "  ... %zu more rejected lines\n", report.rejected - report.error_count);
+        ctrl->view->vptr->show_text(ctrl->view, line);
+    }
+    
+    char msg[100];
+    snprintf(msg, 100, "Imported %zu records, rejected %zu lines",
+             report.imported, report.rejected);
+    ctrl->view->vptr->show_message(ctrl->view, msg, report.rejected > 0 ? TRUE : FALSE);
+    VIEW_PAUSE(ctrl->view);
+}
+
+/* 保存并退出: 经由后台写线程保存,等待完成后再退出 */
 void controller_save_and_exit(Controller *ctrl) {
     if (ctrl == NULL) {
         return;
     }
     
-    ErrorCode err = storage_save_employees(ctrl->data_file, ctrl->manager);
+    ErrorCode err = background_saver_submit(ctrl->saver, ctrl->manager, ctrl->data_file);
+    if (err == SUCCESS) {
+        err = background_saver_wait(ctrl->saver);
+        background_saver_poll(ctrl->saver, NULL);
+    }
     if (err == SUCCESS) {
-        ctrl->view->vptr->show_message("Data saved successfully!", FALSE);
+        ctrl->view->vptr->show_message(ctrl->view, "Data saved successfully!", FALSE);
         ctrl->is_running = FALSE;
     } else {
-        ctrl->view->vptr->show_message("Failed to save data!", TRUE);
+        ctrl->view->vptr->show_message(ctrl->view, "Failed to save data!", TRUE);
+    }
+}
+
+/* 后台保存: 提交快照后立即返回,完成消息在下次显示菜单前输出 */
+void controller_save_background(Controller *ctrl) {
+    if (ctrl == NULL) {
+        return;
+    }
+    
+    if (background_saver_submit(ctrl->saver, ctrl->manager, ctrl->data_file) == SUCCESS) {
+        ctrl->view->vptr->show_message(ctrl->view, "Saving in background...", FALSE);
+    } else {
+        ctrl->view->vptr->show_message(ctrl->view, "Failed to start background save!", TRUE);
+    }
+}
+
+/* 显示已完成的后台保存结果 */
+void controller_report_saves(Controller *ctrl) {
+    if (ctrl == NULL) {
+        return;
+    }
+    
+    SaveResult result;
+    if (background_saver_poll(ctrl->saver, &result)) {
+        char msg[100];
+        if (result.error == SUCCESS) {
+            snprintf(msg, 100, "Background save completed (%zu records)", result.count);
+            ctrl->view->vptr->show_message(ctrl->view, msg, FALSE);
+        } else {
+            ctrl->view->vptr->show_message(ctrl->view, "Background save failed!", TRUE);
+        }
+    }
+}
+
+/* 提交后台索引构建: 首次进入菜单时不等待建索引,修改后在后台重建 */
+void controller_refresh_indexes(Controller *ctrl) {
+    if (ctrl == NULL || !ctrl->load_done) {
+        return;
+    }
+    
+    unsigned long generation = ctrl->manager->generation;
+    if (ctrl->index_submitted && ctrl->indexed_generation == generation) {
+        return;
+    }
+    /* 防抖: 数据仍在变化时先不提交,两次刷新之间代数不变后再重建,连续编辑只触发一次构建 */
+    if (ctrl->index_submitted && ctrl->observed_generation != generation) {
+        ctrl->observed_generation = generation;
+        return;
+    }
+    
+    /* 只提交与当前版本不一致的种类 */
+    unsigned int kinds = 0;
+    for (int kind = 0; kind < INDEX_KIND_COUNT; kind++) {
+        if (!employee_manager_index_ready(ctrl->manager, (IndexKind)kind)) {
+            kinds |= 1u << kind;
+        }
+    }
+    if (kinds == 0 || background_indexer_submit(ctrl->indexer, ctrl->manager, kinds) == SUCCESS) {
+        ctrl->indexed_generation = generation;
+        ctrl->observed_generation = generation;
+        ctrl->index_submitted = TRUE;
     }
 }
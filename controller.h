@@ -5,6 +5,9 @@
 #include "model.h"
 #include "view.h"
 #include "storage.h"
+#include "credential.h"
+#include "saver.h"
+#include "indexer.h"
 
 /* 控制器结构 */
 typedef struct {
@@ -12,21 +15,41 @@ typedef struct {
     AppView *view;             /* 视图 */
     char *data_file;           /* 数据文件路径 */
     char *auth_file;           /* 认证文件路径 */
+    CredentialStore *credentials;  /* 凭证库(登录时打开) */
     Bool is_running;           /* 运行状态 */
+    BackgroundSaver *saver;    /* 后台保存器 */
+    BackgroundIndexer *indexer;  /* 后台索引构建器 */
+    unsigned long indexed_generation;  /* 最近一次提交索引构建时的修改代数 */
+    Bool index_submitted;      /* 是否已提交过索引构建 */
+    unsigned long observed_generation;  /* 上一次刷新索引时看到的修改代数(防抖用) */
+    Thread *loader;            /* 启动时的后台加载线程 */
+    EmployeeManager *loading;  /* 后台加载的目标,完成后取代manager */
+    ErrorCode load_result;     /* 加载结果 */
+    volatile long load_finished;  /* 后台加载是否已结束(原子访问) */
+    Bool load_done;            /* 加载结果是否已取回 */
 } Controller;
 
-/* 创建控制器 */
+/* 创建控制器: 同时在后台线程开始加载数据文件,与登录输入重叠 */
 Controller *controller_create(const char *data_file, const char *auth_file);
 
 /* 释放控制器 */
 void controller_free(Controller *ctrl);
 
+/* 更换视图(接管所有权,原视图被释放),如换成view_create_batch创建的批处理视图 */
+void controller_set_view(Controller *ctrl, AppView *view);
+
 /* 启动系统 */
 ErrorCode controller_start(Controller *ctrl);
 
 /* 用户登录 */
 Bool controller_login(Controller *ctrl);
 
+/*
+ * 等待后台加载结束并换入加载好的管理器(须在使用manager之前调用),返回加载结果;
+ * 后台线程未能启动时在此同步加载。可重复调用,之后直接返回同一结果
+ */
+ErrorCode controller_wait_load(Controller *ctrl);
+
 /* 主循环 */
 void controller_run(Controller *ctrl);
 
@@ -42,6 +65,17 @@ void controller_show_all_employees(Controller *ctrl);
 void controller_sort_employees(Controller *ctrl);
 void controller_statistics(Controller *ctrl);
 void controller_export_csv(Controller *ctrl);
+void controller_import_csv(Controller *ctrl);
 void controller_save_and_exit(Controller *ctrl);
+void controller_save_background(Controller *ctrl);
+
+/* 显示已完成的后台保存结果(非阻塞) */
+void controller_report_saves(Controller *ctrl);
+
+/*
+ * 数据自上次提交以来有变化时,提交后台索引构建(非阻塞)。
+ * 首次调用立即提交;之后数据仍在变化时推迟到下一次调用,只重建不是最新的种类
+ */
+void controller_refresh_indexes(Controller *ctrl);
 
 #endif /* CONTROLLER_H */
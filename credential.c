@@ -0,0 +1,573 @@
+#include "credential.h"
+#include "storage_io.h"
+#include "crypto.h"
+#include "thread.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 旧版单账号文件使用的字符串哈希(djb2),仅用于验证并迁移旧账号 */
+static unsigned int simple_hash(const char *str) {
+    unsigned int hash = 5381;
+    int c;
+    
+    while ((c = *str++)) {
+        hash = ((hash << 5) + hash) + c;  /* hash * 33 + c */
+    }
+    
+    return hash;
+}
+
+/* 新建文件的初始槽数 */
+#define CREDENTIAL_INITIAL_CAPACITY 64
+
+struct CredentialStore {
+    char *filename;
+    FILE *fp;                   /* 以"r+b"打开,槽在原位改写;文件尚未创建时为NULL */
+    CredentialSlot *slots;      /* 整张哈希表常驻内存 */
+    size_t capacity;            /* 槽数(2的幂),0表示文件尚未创建 */
+    size_t used;                /* 有效账号数 */
+    size_t deleted;             /* 删除标记数 */
+    unsigned int iterations;    /* 新口令的PBKDF2迭代次数 */
+    Mutex *lock;
+};
+
+/*
+ * 用户名哈希: FNV-1a 64位。槽的位置由它决定,是文件格式的一部分,
+ * 修改后已有文件中的账号将无法找到
+ */
+static unsigned long long credential_name_hash(const char *username) {
+    unsigned long long hash = 0xcbf29ce484222325ULL;
+    for (const unsigned char *p = (const unsigned char *)username; *p != '\0'; p++) {
+        hash ^= *p;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static Bool credential_name_valid(const char *username) {
+    size_t length = strlen(username);
+    return (length > 0 && length < MAX_USERNAME_LEN) ? TRUE : FALSE;
+}
+
+static unsigned int credential_slot_checksum(const CredentialSlot *slot) {
+    return calculate_checksum(slot, offsetof(CredentialSlot, checksum));
+}
+
+/*
+ * 线性探测: 找到时返回账号所在槽并置found;否则返回可插入的槽(探测路径上第一个删除标记或空槽)。
+ * 调用方保证表中至少有一个空槽
+ */
+static size_t credential_probe(const CredentialStore *store, const char *username, Bool *found) {
+    size_t mask = store->capacity - 1;
+    size_t index = (size_t)credential_name_hash(username) & mask;
+    size_t reusable = (size_t)-1;
+    *found = FALSE;
+    for (;;) {
+        const CredentialSlot *slot = &store->slots[index];
+        if (slot->state == CREDENTIAL_SLOT_EMPTY) {
+            return (reusable != (size_t)-1) ? reusable : index;
+        }
+        if (slot->state == CREDENTIAL_SLOT_USED) {
+            if (strncmp(slot->username, username, MAX_USERNAME_LEN) == 0) {
+                *found = TRUE;
+                return index;
+            }
+        } else if (reusable == (size_t)-1) {
+            reusable = index;
+        }
+        index = (index + 1) & mask;
+    }
+}
+
+static Bool credential_lookup(const CredentialStore *store, const char *username, size_t *index) {
+    if (store->capacity == 0) {
+        return FALSE;
+    }
+    Bool found;
+    *index = credential_probe(store, username, &found);
+    return found;
+}
+
+/* 用新的随机盐和给定代价计算口令哈希 */
+static ErrorCode credential_hash_password(CredentialSlot *slot, const char *password,
+                                          unsigned int iterations) {
+    ErrorCode err = crypto_random_bytes(slot->salt, CREDENTIAL_SALT_LEN);
+    if (err != SUCCESS) {
+        return err;
+    }
+    slot->iterations = iterations;
+    pbkdf2_sha256(password, strlen(password), slot->salt, CREDENTIAL_SALT_LEN, iterations,
+                  slot->hash, CREDENTIAL_HASH_LEN);
+    return SUCCESS;
+}
+
+/* 校验口令: iterations为0的槽保存的是旧版djb2哈希的十进制字符串 */
+static Bool credential_check(const CredentialSlot *slot, const char *password) {
+    if (slot->iterations == 0) {
+        char legacy[CREDENTIAL_HASH_LEN];
+        snprintf(legacy, sizeof(legacy), "%u", simple_hash(password));
+        return (strncmp((const char *)slot->hash, legacy, CREDENTIAL_HASH_LEN) == 0) ? TRUE : FALSE;
+    }
+    unsigned char hash[CREDENTIAL_HASH_LEN];
+    pbkdf2_sha256(password, strlen(password), slot->salt, CREDENTIAL_SALT_LEN, slot->iterations,
+                  hash, CREDENTIAL_HASH_LEN);
+    return crypto_equal(hash, slot->hash, CREDENTIAL_HASH_LEN);
+}
+
+static CredentialFileHeader credential_header(const CredentialStore *store, size_t capacity) {
+    CredentialFileHeader header;
+    memset(&header, 0, sizeof(CredentialFileHeader));
+    header.magic = CREDENTIAL_MAGIC;
+    header.version = CREDENTIAL_VERSION;
+    header.header_size = sizeof(CredentialFileHeader);
+    header.slot_size = sizeof(CredentialSlot);
+    header.capacity = (unsigned int)capacity;
+    header.iterations = store->iterations;
+    header.header_checksum = calculate_checksum(&header, offsetof(CredentialFileHeader, header_checksum));
+    return header;
+}
+
+/* 原位改写一个槽并落盘 */
+static ErrorCode credential_write_slot(CredentialStore *store, size_t index) {
+    CredentialSlot *slot = &store->slots[index];
+    slot->checksum = credential_slot_checksum(slot);
+    unsigned long long offset = sizeof(CredentialFileHeader) + (unsigned long long)index * sizeof(CredentialSlot);
+    if (store->fp == NULL || !file_seek(store->fp, offset) ||
+        fwrite(slot, sizeof(CredentialSlot), 1, store->fp) != 1 || !sync_file(store->fp)) {
+        return ERROR_FILE_WRITE_FAILED;
+    }
+    return SUCCESS;
+}
+
+/*
+ * 按新槽数重建哈希表(丢弃删除标记)并整体原子写出,只在创建文件、表过满或迁移旧文件时发生;
+ * 失败时内存中的表保持不变
+ */
+static ErrorCode credential_rebuild(CredentialStore *store, size_t capacity) {
+    CredentialSlot *slots = (CredentialSlot *)calloc(capacity, sizeof(CredentialSlot));
+    if (slots == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    CredentialStore rebuilt = *store;
+    rebuilt.slots = slots;
+    rebuilt.capacity = capacity;
+    for (size_t i = 0; i < store->capacity; i++) {
+        if (store->slots[i].state == CREDENTIAL_SLOT_USED) {
+            Bool found;
+            size_t index = credential_probe(&rebuilt, store->slots[i].username, &found);
+            slots[index] = store->slots[i];
+        }
+    }
+
+    AtomicFile file;
+    ErrorCode err = atomic_file_open(&file, store->filename, "wb");
+    if (err != SUCCESS) {
+        free(slots);
+        return err;
+    }
+    CredentialFileHeader header = credential_header(store, capacity);
+    Bool ok = (fwrite(&header, sizeof(CredentialFileHeader), 1, file.fp) == 1) ? TRUE : FALSE;
+    for (size_t i = 0; i < capacity && ok; i++) {
+        if (slots[i].state != CREDENTIAL_SLOT_EMPTY) {
+            slots[i].checksum = credential_slot_checksum(&slots[i]);
+        }
+        ok = (fwrite(&slots[i], sizeof(CredentialSlot), 1, file.fp) == 1) ? TRUE : FALSE;
+    }
+    if (!ok) {
+        atomic_file_abort(&file);
+        free(slots);
+        return ERROR_FILE_WRITE_FAILED;
+    }
+    err = atomic_file_commit(&file);
+    if (err != SUCCESS) {
+        free(slots);
+        return err;
+    }
+
+    if (store->fp != NULL) {
+        fclose(store->fp);
+    }
+    store->fp = fopen(store->filename, "r+b");
+    free(store->slots);
+    store->slots = slots;
+    store->capacity = capacity;
+    store->deleted = 0;
+    return (store->fp != NULL) ? SUCCESS : ERROR_FILE_WRITE_FAILED;
+}
+
+/* 读入旧版单账号文件,保留其哈希,首次登录成功时升级为PBKDF2 */
+static ErrorCode credential_load_legacy(CredentialStore *store) {
+    UserCredential cred;
+    if (!file_seek(store->fp, 0) || fread(&cred, sizeof(UserCredential), 1, store->fp) != 1) {
+        return ERROR_FILE_READ_FAILED;
+    }
+    cred.username[MAX_USERNAME_LEN - 1] = '\0';
+    cred.password[MAX_PASSWORD_LEN - 1] = '\0';
+    if (!credential_name_valid(cred.username) || strlen(cred.password) >= CREDENTIAL_HASH_LEN) {
+        return ERROR_INVALID_FILE;
+    }
+
+    CredentialSlot legacy;
+    memset(&legacy, 0, sizeof(CredentialSlot));
+    legacy.state = CREDENTIAL_SLOT_USED;
+    legacy.iterations = 0;
+    memcpy(legacy.username, cred.username, MAX_USERNAME_LEN);
+    memcpy(legacy.hash, cred.password, strlen(cred.password));
+    store->slots = (CredentialSlot *)malloc(sizeof(CredentialSlot));
+    if (store->slots == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    store->slots[0] = legacy;
+    store->capacity = 1;
+    store->used = 1;
+    return credential_rebuild(store, CREDENTIAL_INITIAL_CAPACITY);
+}
+
+static ErrorCode credential_load(CredentialStore *store) {
+    long long size = file_size(store->fp);
+    if (size == (long long)sizeof(UserCredential)) {
+        return credential_load_legacy(store);
+    }
+
+    CredentialFileHeader header;
+    if (size < (long long)sizeof(CredentialFileHeader) ||
+        fread(&header, sizeof(CredentialFileHeader), 1, store->fp) != 1) {
+        return ERROR_INVALID_FILE;
+    }
+    if (header.magic != CREDENTIAL_MAGIC || header.version != CREDENTIAL_VERSION ||
+        header.header_size != sizeof(CredentialFileHeader) || header.slot_size != sizeof(CredentialSlot)) {
+        return ERROR_INVALID_FILE;
+    }
+    if (header.header_checksum != calculate_checksum(&header, offsetof(CredentialFileHeader, header_checksum))) {
+        return ERROR_DATA_CORRUPTION;
+    }
+    if (header.capacity == 0 || (header.capacity & (header.capacity - 1)) != 0 ||
+        header.iterations < CREDENTIAL_MIN_ITERATIONS ||
+        size != (long long)(sizeof(CredentialFileHeader) + (unsigned long long)header.capacity * sizeof(CredentialSlot))) {
+        return ERROR_INVALID_FILE;
+    }
+
+    store->slots = (CredentialSlot *)malloc(header.capacity * sizeof(CredentialSlot));
+    if (store->slots == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    if (fread(store->slots, sizeof(CredentialSlot), header.capacity, store->fp) != header.capacity) {
+        return ERROR_FILE_READ_FAILED;
+    }
+    store->capacity = header.capacity;
+    store->iterations = header.iterations;
+
+    size_t empty = 0;
+    for (size_t i = 0; i < store->capacity; i++) {
+        CredentialSlot *slot = &store->slots[i];
+        if (slot->state == CREDENTIAL_SLOT_EMPTY) {
+            empty++;
+            continue;
+        }
+        /* 校验失败的槽(如改写中途崩溃)按删除处理,不截断其后的探测链 */
+        if ((slot->state != CREDENTIAL_SLOT_USED && slot->state != CREDENTIAL_SLOT_DELETED) ||
+            slot->checksum != credential_slot_checksum(slot) ||
+            (slot->state == CREDENTIAL_SLOT_USED && slot->username[MAX_USERNAME_LEN - 1] != '\0')) {
+            memset(slot, 0, sizeof(CredentialSlot));
+            slot->state = CREDENTIAL_SLOT_DELETED;
+        }
+        if (slot->state == CREDENTIAL_SLOT_USED) {
+            store->used++;
+        } else {
+            store->deleted++;
+        }
+    }
+    /* 探测依赖空槽结束,没有空槽的表视为损坏 */
+    return (empty > 0) ? SUCCESS : ERROR_DATA_CORRUPTION;
+}
+
+CredentialStore *storage_credentials_open(const char *filename, ErrorCode *err) {
+    ErrorCode result = SUCCESS;
+    CredentialStore *store = NULL;
+    if (filename == NULL) {
+        result = ERROR_NULL_POINTER;
+    } else if ((store = (CredentialStore *)calloc(1, sizeof(CredentialStore))) == NULL ||
+               (store->filename = (char *)malloc(strlen(filename) + 1)) == NULL ||
+               (store->lock = mutex_create()) == NULL) {
+        result = ERROR_OUT_OF_MEMORY;
+    } else {
+        strcpy(store->filename, filename);
+        store->iterations = CREDENTIAL_DEFAULT_ITERATIONS;
+        store->fp = fopen(filename, "r+b");
+        if (store->fp == NULL) {
+            /* 文件不存在时为空库,首次添加账号时创建;存在但不可写时按错误处理 */
+            FILE *probe = fopen(filename, "rb");
+            if (probe != NULL) {
+                fclose(probe);
+                result = ERROR_FILE_WRITE_FAILED;
+            }
+        } else {
+            result = credential_load(store);
+        }
+    }
+
+    if (result != SUCCESS) {
+        storage_credentials_close(store);
+        store = NULL;
+    }
+    if (err != NULL) {
+        *err = result;
+    }
+    return store;
+}
+
+void storage_credentials_close(CredentialStore *store) {
+    if (store == NULL) {
+        return;
+    }
+    if (store->fp != NULL) {
+        fclose(store->fp);
+    }
+    mutex_free(store->lock);
+    free(store->slots);
+    free(store->filename);
+    free(store);
+}
+
+size_t storage_credentials_count(CredentialStore *store) {
+    if (store == NULL) {
+        return 0;
+    }
+    mutex_lock(store->lock);
+    size_t count = store->used;
+    mutex_unlock(store->lock);
+    return count;
+}
+
+Bool storage_credentials_contains(CredentialStore *store, const char *username) {
+    if (store == NULL || username == NULL) {
+        return FALSE;
+    }
+    mutex_lock(store->lock);
+    size_t index;
+    Bool found = credential_lookup(store, username, &index);
+    mutex_unlock(store->lock);
+    return found;
+}
+
+ErrorCode storage_credentials_add(CredentialStore *store, const char *username, const char *password) {
+    if (store == NULL || username == NULL || password == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    if (!credential_name_valid(username)) {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    /* 哈希计算不持锁,其他线程的验证不必等待 */
+    CredentialSlot slot;
+    memset(&slot, 0, sizeof(CredentialSlot));
+    slot.state = CREDENTIAL_SLOT_USED;
+    strcpy(slot.username, username);
+    mutex_lock(store->lock);
+    unsigned int iterations = store->iterations;
+    mutex_unlock(store->lock);
+    ErrorCode err = credential_hash_password(&slot, password, iterations);
+    if (err != SUCCESS) {
+        return err;
+    }
+
+    mutex_lock(store->lock);
+    size_t index;
+    if (credential_lookup(store, username, &index)) {
+        err = ERROR_INVALID_PARAMETER;
+    } else if (store->capacity == 0 || (store->used + store->deleted + 1) * 4 > store->capacity * 3) {
+        /* 装载率(含删除标记)超过3/4时扩容重建,新表的装载率不超过1/2 */
+        size_t capacity = CREDENTIAL_INITIAL_CAPACITY;
+        while ((store->used + 1) * 2 > capacity) {
+            capacity *= 2;
+        }
+        err = credential_rebuild(store, capacity);
+    }
+    if (err == SUCCESS) {
+        Bool found;
+        index = credential_probe(store, username, &found);
+        if (store->slots[index].state == CREDENTIAL_SLOT_DELETED) {
+            store->deleted--;
+        }
+        CredentialSlot previous = store->slots[index];
+        store->slots[index] = slot;
+        err = credential_write_slot(store, index);
+        if (err == SUCCESS) {
+            store->used++;
+        } else {
+            if (previous.state == CREDENTIAL_SLOT_DELETED) {
+                store->deleted++;
+            }
+            store->slots[index] = previous;
+        }
+    }
+    mutex_unlock(store->lock);
+    return err;
+}
+
+ErrorCode storage_credentials_remove(CredentialStore *store, const char *username) {
+    if (store == NULL || username == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    mutex_lock(store->lock);
+    size_t index;
+    ErrorCode err = ERROR_NOT_FOUND;
+    if (credential_lookup(store, username, &index)) {
+        CredentialSlot previous = store->slots[index];
+        memset(&store->slots[index], 0, sizeof(CredentialSlot));
+        store->slots[index].state = CREDENTIAL_SLOT_DELETED;
+        err = credential_write_slot(store, index);
+        if (err == SUCCESS) {
+            store->used--;
+            store->deleted++;
+        } else {
+            store->slots[index] = previous;
+        }
+    }
+    mutex_unlock(store->lock);
+    return err;
+}
+
+/* 用预先算好的槽替换账号,expected不为NULL时要求槽内容未被其他线程改动 */
+static ErrorCode credential_replace(CredentialStore *store, const CredentialSlot *slot,
+                                    const CredentialSlot *expected) {
+    mutex_lock(store->lock);
+    size_t index;
+    ErrorCode err = ERROR_NOT_FOUND;
+    if (credential_lookup(store, slot->username, &index) &&
+        (expected == NULL || memcmp(&store->slots[index], expected, sizeof(CredentialSlot)) == 0)) {
+        CredentialSlot previous = store->slots[index];
+        store->slots[index] = *slot;
+        err = credential_write_slot(store, index);
+        if (err != SUCCESS) {
+            store->slots[index] = previous;
+        }
+    }
+    mutex_unlock(store->lock);
+    return err;
+}
+
+ErrorCode storage_credentials_set_password(CredentialStore *store, const char *username,
+                                           const char *password) {
+    if (store == NULL || username == NULL || password == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    if (!credential_name_valid(username)) {
+        return ERROR_NOT_FOUND;
+    }
+    CredentialSlot slot;
+    memset(&slot, 0, sizeof(CredentialSlot));
+    slot.state = CREDENTIAL_SLOT_USED;
+    strcpy(slot.username, username);
+    mutex_lock(store->lock);
+    unsigned int iterations = store->iterations;
+    mutex_unlock(store->lock);
+    ErrorCode err = credential_hash_password(&slot, password, iterations);
+    return (err == SUCCESS) ? credential_replace(store, &slot, NULL) : err;
+}
+
+Bool storage_credentials_verify(CredentialStore *store, const char *username, const char *password) {
+    if (store == NULL || username == NULL || password == NULL) {
+        return FALSE;
+    }
+
+    /* 只在持锁时复制槽,哈希计算在锁外进行 */
+    mutex_lock(store->lock);
+    size_t index;
+    Bool found = credential_lookup(store, username, &index);
+    CredentialSlot slot;
+    if (found) {
+        slot = store->slots[index];
+    }
+    unsigned int iterations = store->iterations;
+    mutex_unlock(store->lock);
+
+    if (!found) {
+        /* 用户不存在时也做一次同等代价的哈希,耗时不暴露用户名是否存在 */
+        unsigned char dummy[CREDENTIAL_HASH_LEN];
+        pbkdf2_sha256(password, strlen(password), "", 0, iterations, dummy, sizeof(dummy));
+        return FALSE;
+    }
+    if (!credential_check(&slot, password)) {
+        return FALSE;
+    }
+
+    /* 旧格式或代价低于当前设置的哈希在验证成功后重新计算(失败不影响本次登录) */
+    if (slot.iterations < iterations) {
+        CredentialSlot upgraded = slot;
+        if (credential_hash_password(&upgraded, password, iterations) == SUCCESS) {
+            credential_replace(store, &upgraded, &slot);
+        }
+    }
+    return TRUE;
+}
+
+ErrorCode storage_credentials_set_cost(CredentialStore *store, unsigned int iterations) {
+    if (store == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    if (iterations < CREDENTIAL_MIN_ITERATIONS) {
+        return ERROR_INVALID_PARAMETER;
+    }
+    mutex_lock(store->lock);
+    unsigned int previous = store->iterations;
+    store->iterations = iterations;
+    ErrorCode err = SUCCESS;
+    if (store->fp != NULL) {
+        CredentialFileHeader header = credential_header(store, store->capacity);
+        if (!file_seek(store->fp, 0) ||
+            fwrite(&header, sizeof(CredentialFileHeader), 1, store->fp) != 1 || !sync_file(store->fp)) {
+            store->iterations = previous;
+            err = ERROR_FILE_WRITE_FAILED;
+        }
+    }
+    mutex_unlock(store->lock);
+    return err;
+}
+
+unsigned int storage_credentials_cost(CredentialStore *store) {
+    if (store == NULL) {
+        return 0;
+    }
+    mutex_lock(store->lock);
+    unsigned int iterations = store->iterations;
+    mutex_unlock(store->lock);
+    return iterations;
+}
+
+/* 保存用户凭证: 账号已存在时修改口令 */
+ErrorCode storage_save_credential(const char *filename, const char *username,
+                                   const char *password) {
+    if (filename == NULL || username == NULL || password == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    
+    ErrorCode err;
+    CredentialStore *store = storage_credentials_open(filename, &err);
+    if (store == NULL) {
+        return err;
+    }
+    err = storage_credentials_contains(store, username)
+              ? storage_credentials_set_password(store, username, password)
+              : storage_credentials_add(store, username, password);
+    storage_credentials_close(store);
+    return err;
+}
+
+/* 验证用户凭证 */
+Bool storage_verify_credential(const char *filename, const char *username, 
+                                const char *password) {
+    if (filename == NULL || username == NULL || password == NULL) {
+        return FALSE;
+    }
+    
+    CredentialStore *store = storage_credentials_open(filename, NULL);
+    if (store == NULL) {
+        return FALSE;
+    }
+    Bool ok = storage_credentials_verify(store, username, password);
+    storage_credentials_close(store);
+    return ok;
+}
@@ -0,0 +1,101 @@
+#ifndef CREDENTIAL_H
+#define CREDENTIAL_H
+
+#include "common.h"
+
+/* 旧版单账号凭证文件的结构(仅用于迁移) */
+PACK_PUSH
+typedef struct {
+    char username[MAX_USERNAME_LEN];
+    char password[MAX_PASSWORD_LEN];
+} UserCredential;
+PACK_POP
+
+/* 口令哈希参数: PBKDF2-HMAC-SHA256,每个账号独立的随机盐 */
+#define CREDENTIAL_SALT_LEN 16
+#define CREDENTIAL_HASH_LEN 32
+#define CREDENTIAL_DEFAULT_ITERATIONS 100000
+#define CREDENTIAL_MIN_ITERATIONS 1000
+
+/*
+ * 多用户凭证文件: 文件头 | capacity个定长槽
+ * 槽组成按用户名哈希、线性探测的开放寻址表,添加、删除、改口令只原位改写一个槽;
+ * 表过满时才整体重建。探测起点为用户名字节的FNV-1a 64位哈希取低位(属于文件格式,不可更改)
+ */
+PACK_PUSH
+typedef struct {
+    unsigned int magic;            /* 魔数: 0x41555448 (ASCII: AUTH) */
+    unsigned int version;          /* 版本号 */
+    unsigned int header_size;      /* 文件头字节数 */
+    unsigned int slot_size;        /* 每个槽的字节数 */
+    unsigned int capacity;         /* 槽数(2的幂) */
+    unsigned int iterations;       /* 新口令的PBKDF2迭代次数 */
+    unsigned char reserved[36];    /* 保留,写0 */
+    unsigned int header_checksum;  /* 以上字段的校验和 */
+} CredentialFileHeader;
+PACK_POP
+
+/* 槽状态 */
+typedef enum {
+    CREDENTIAL_SLOT_EMPTY = 0,    /* 空槽: 探测到此结束 */
+    CREDENTIAL_SLOT_USED = 1,     /* 有效账号 */
+    CREDENTIAL_SLOT_DELETED = 2   /* 删除标记: 探测继续,添加时可复用 */
+} CredentialSlotState;
+
+/* 凭证槽(128字节) */
+PACK_PUSH
+typedef struct {
+    unsigned int state;                        /* 槽状态(CredentialSlotState) */
+    unsigned int iterations;                   /* 迭代次数,0表示旧版哈希(首次登录成功时升级) */
+    char username[MAX_USERNAME_LEN];           /* 用户名 */
+    unsigned char salt[CREDENTIAL_SALT_LEN];   /* 盐 */
+    unsigned char hash[CREDENTIAL_HASH_LEN];   /* 口令哈希 */
+    unsigned char reserved[36];                /* 保留,写0 */
+    unsigned int checksum;                     /* 以上字段的校验和 */
+} CredentialSlot;
+PACK_POP
+
+/* 凭证库 */
+typedef struct CredentialStore CredentialStore;
+
+/*
+ * 打开凭证库: 整个哈希表一次读入内存,此后验证不再读文件。文件不存在时为空库,
+ * 首次添加账号时创建;旧版单账号文件就地迁移为新格式。各函数可在多个线程中同时调用,
+ * 口令哈希在锁外计算。err可为NULL
+ */
+CredentialStore *storage_credentials_open(const char *filename, ErrorCode *err);
+void storage_credentials_close(CredentialStore *store);
+
+/* 账号数与是否存在 */
+size_t storage_credentials_count(CredentialStore *store);
+Bool storage_credentials_contains(CredentialStore *store, const char *username);
+
+/* 添加账号(用户名为空、过长或已存在时返回ERROR_INVALID_PARAMETER) */
+ErrorCode storage_credentials_add(CredentialStore *store, const char *username, const char *password);
+
+/* 删除账号(不存在时返回ERROR_NOT_FOUND) */
+ErrorCode storage_credentials_remove(CredentialStore *store, const char *username);
+
+/* 修改口令(不存在时返回ERROR_NOT_FOUND) */
+ErrorCode storage_credentials_set_password(CredentialStore *store, const char *username,
+                                           const char *password);
+
+/*
+ * 验证口令: 内存中查表后计算哈希并等时比较;用户不存在时同样计算一次哈希。
+ * 旧版哈希或迭代次数低于当前设置的账号在验证成功后按当前设置重新哈希
+ */
+Bool storage_credentials_verify(CredentialStore *store, const char *username, const char *password);
+
+/* 设置/读取新口令的迭代次数(不小于CREDENTIAL_MIN_ITERATIONS),已有账号在下次登录时升级 */
+ErrorCode storage_credentials_set_cost(CredentialStore *store, unsigned int iterations);
+unsigned int storage_credentials_cost(CredentialStore *store);
+
+/* 保存用户凭证: 打开凭证库添加账号,已存在时修改口令 */
+ErrorCode storage_save_credential(const char *filename, const char *username, 
+                                   const char *password);
+
+/* 验证用户凭证: 每次打开凭证库,反复验证应使用storage_credentials_verify */
+Bool storage_verify_credential(const char *filename, const char *username, 
+                                const char *password);
+
+#endif /* CREDENTIAL_H */
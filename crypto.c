@@ -0,0 +1,249 @@
+#if defined(_WIN32)
+    #define _CRT_RAND_S  /* 启用rand_s */
+#endif
+#include "crypto.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ========== SHA-256 ========== */
+
+static const unsigned int SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void sha256_compress(unsigned int state[8], const unsigned char *block) {
+    unsigned int w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = ((unsigned int)block[i * 4] << 24) | ((unsigned int)block[i * 4 + 1] << 16) |
+               ((unsigned int)block[i * 4 + 2] << 8) | (unsigned int)block[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        unsigned int s0 = ROTR32(w[i - 15], 7) ^ ROTR32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        unsigned int s1 = ROTR32(w[i - 2], 17) ^ ROTR32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    unsigned int a = state[0], b = state[1], c = state[2], d = state[3];
+    unsigned int e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; i++) {
+        unsigned int t1 = h + (ROTR32(e, 6) ^ ROTR32(e, 11) ^ ROTR32(e, 25)) +
+                          ((e & f) ^ (~e & g)) + SHA256_K[i] + w[i];
+        unsigned int t2 = (ROTR32(a, 2) ^ ROTR32(a, 13) ^ ROTR32(a, 22)) +
+                          ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+void sha256_init(Sha256 *ctx) {
+    static const unsigned int initial[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    memcpy(ctx->state, initial, sizeof(initial));
+    ctx->length = 0;
+    ctx->used = 0;
+}
+
+void sha256_update(Sha256 *ctx, const void *data, size_t size) {
+    const unsigned char *p = (const unsigned char *)data;
+    ctx->length += size;
+    if (ctx->used > 0) {
+        size_t take = SHA256_BLOCK_LEN - ctx->used;
+        if (take > size) {
+            take = size;
+        }
+        memcpy(ctx->block + ctx->used, p, take);
+        ctx->used += take;
+        p += take;
+        size -= take;
+        if (ctx->used < SHA256_BLOCK_LEN) {
+            return;
+        }
+        sha256_compress(ctx->state, ctx->block);
+        ctx->used = 0;
+    }
+    while (size >= SHA256_BLOCK_LEN) {
+        sha256_compress(ctx->state, p);
+        p += SHA256_BLOCK_LEN;
+        size -= SHA256_BLOCK_LEN;
+    }
+    memcpy(ctx->block, p, size);
+    ctx->used = size;
+}
+
+void sha256_final(Sha256 *ctx, unsigned char digest[SHA256_DIGEST_LEN]) {
+    unsigned long long bits = ctx->length * 8;
+    ctx->block[ctx->used++] = 0x80;
+    if (ctx->used > SHA256_BLOCK_LEN - 8) {
+        memset(ctx->block + ctx->used, 0, SHA256_BLOCK_LEN - ctx->used);
+        sha256_compress(ctx->state, ctx->block);
+        ctx->used = 0;
+    }
+    memset(ctx->block + ctx->used, 0, SHA256_BLOCK_LEN - 8 - ctx->used);
+    for (int i = 0; i < 8; i++) {
+        ctx->block[SHA256_BLOCK_LEN - 1 - i] = (unsigned char)(bits >> (i * 8));
+    }
+    sha256_compress(ctx->state, ctx->block);
+
+    for (int i = 0; i < 8; i++) {
+        digest[i * 4] = (unsigned char)(ctx->state[i] >> 24);
+        digest[i * 4 + 1] = (unsigned char)(ctx->state[i] >> 16);
+        digest[i * 4 + 2] = (unsigned char)(ctx->state[i] >> 8);
+        digest[i * 4 + 3] = (unsigned char)ctx->state[i];
+    }
+}
+
+void sha256(const void *data, size_t size, unsigned char digest[SHA256_DIGEST_LEN]) {
+    Sha256 ctx;
+    sha256_init(&ctx);
+    sha256_update(&ctx, data, size);
+    sha256_final(&ctx, digest);
+}
+
+/* ========== HMAC与PBKDF2 ========== */
+
+/* 密钥确定后的内外两层初始状态,PBKDF2每次迭代从这里复制,省去重复处理填充块 */
+typedef struct {
+    Sha256 inner;
+    Sha256 outer;
+} HmacKey;
+
+static void hmac_key_init(HmacKey *hk, const void *key, size_t key_len) {
+    unsigned char block[SHA256_BLOCK_LEN];
+    memset(block, 0, sizeof(block));
+    if (key_len > SHA256_BLOCK_LEN) {
+        sha256(key, key_len, block);
+    } else if (key_len > 0) {
+        memcpy(block, key, key_len);
+    }
+
+    unsigned char pad[SHA256_BLOCK_LEN];
+    for (int i = 0; i < SHA256_BLOCK_LEN; i++) {
+        pad[i] = block[i] ^ 0x36;
+    }
+    sha256_init(&hk->inner);
+    sha256_update(&hk->inner, pad, sizeof(pad));
+    for (int i = 0; i < SHA256_BLOCK_LEN; i++) {
+        pad[i] = block[i] ^ 0x5c;
+    }
+    sha256_init(&hk->outer);
+    sha256_update(&hk->outer, pad, sizeof(pad));
+}
+
+static void hmac_finish(const HmacKey *hk, Sha256 *inner, unsigned char mac[SHA256_DIGEST_LEN]) {
+    unsigned char digest[SHA256_DIGEST_LEN];
+    sha256_final(inner, digest);
+    Sha256 outer = hk->outer;
+    sha256_update(&outer, digest, sizeof(digest));
+    sha256_final(&outer, mac);
+}
+
+void hmac_sha256(const void *key, size_t key_len, const void *data, size_t size,
+                 unsigned char mac[SHA256_DIGEST_LEN]) {
+    HmacKey hk;
+    hmac_key_init(&hk, key, key_len);
+    Sha256 inner = hk.inner;
+    sha256_update(&inner, data, size);
+    hmac_finish(&hk, &inner, mac);
+}
+
+void pbkdf2_sha256(const void *password, size_t password_len, const void *salt, size_t salt_len,
+                   unsigned int iterations, unsigned char *out, size_t out_len) {
+    HmacKey hk;
+    hmac_key_init(&hk, password, password_len);
+
+    for (unsigned int block = 1; out_len > 0; block++) {
+        unsigned char counter[4] = {
+            (unsigned char)(block >> 24), (unsigned char)(block >> 16),
+            (unsigned char)(block >> 8), (unsigned char)block
+        };
+        unsigned char u[SHA256_DIGEST_LEN];
+        unsigned char t[SHA256_DIGEST_LEN];
+
+        /* U1 = HMAC(P, S || INT(i)) */
+        Sha256 inner = hk.inner;
+        sha256_update(&inner, salt, salt_len);
+        sha256_update(&inner, counter, sizeof(counter));
+        hmac_finish(&hk, &inner, u);
+        memcpy(t, u, sizeof(t));
+
+        /* Uj = HMAC(P, Uj-1),T为各U的异或 */
+        for (unsigned int j = 1; j < iterations; j++) {
+            inner = hk.inner;
+            sha256_update(&inner, u, sizeof(u));
+            hmac_finish(&hk, &inner, u);
+            for (int k = 0; k < SHA256_DIGEST_LEN; k++) {
+                t[k] ^= u[k];
+            }
+        }
+
+        size_t take = (out_len < SHA256_DIGEST_LEN) ? out_len : SHA256_DIGEST_LEN;
+        memcpy(out, t, take);
+        out += take;
+        out_len -= take;
+    }
+}
+
+/* ========== 随机数与比较 ========== */
+
+ErrorCode crypto_random_bytes(void *buffer, size_t size) {
+    if (buffer == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    unsigned char *p = (unsigned char *)buffer;
+#if defined(_WIN32)
+    while (size > 0) {
+        unsigned int value;
+        if (rand_s(&value) != 0) {
+            return ERROR_FILE_READ_FAILED;
+        }
+        size_t take = (size < sizeof(value)) ? size : sizeof(value);
+        memcpy(p, &value, take);
+        p += take;
+        size -= take;
+    }
+    return SUCCESS;
+#else
+    FILE *fp = fopen("/dev/urandom", "rb");
+    if (fp == NULL) {
+        return ERROR_FILE_NOT_FOUND;
+    }
+    size_t got = fread(p, 1, size, fp);
+    fclose(fp);
+    return (got == size) ? SUCCESS : ERROR_FILE_READ_FAILED;
+#endif
+}
+
+Bool crypto_equal(const void *a, const void *b, size_t size) {
+    const volatile unsigned char *x = (const volatile unsigned char *)a;
+    const volatile unsigned char *y = (const volatile unsigned char *)b;
+    unsigned char diff = 0;
+    for (size_t i = 0; i < size; i++) {
+        diff |= (unsigned char)(x[i] ^ y[i]);
+    }
+    return (diff == 0) ? TRUE : FALSE;
+}
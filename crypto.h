@@ -0,0 +1,42 @@
+#ifndef CRYPTO_H
+#define CRYPTO_H
+
+#include "common.h"
+
+/*
+ * 口令哈希用的密码学原语: SHA-256、HMAC-SHA256与PBKDF2-HMAC-SHA256(RFC 8018),
+ * 以及系统随机数与等时比较。只依赖C标准库与操作系统的随机源
+ */
+
+#define SHA256_DIGEST_LEN 32
+#define SHA256_BLOCK_LEN 64
+
+/* SHA-256增量计算状态 */
+typedef struct {
+    unsigned int state[8];
+    unsigned long long length;               /* 已输入的字节数 */
+    unsigned char block[SHA256_BLOCK_LEN];   /* 未满一块的输入 */
+    size_t used;                             /* block中的字节数 */
+} Sha256;
+
+void sha256_init(Sha256 *ctx);
+void sha256_update(Sha256 *ctx, const void *data, size_t size);
+void sha256_final(Sha256 *ctx, unsigned char digest[SHA256_DIGEST_LEN]);
+
+/* 一次性计算 */
+void sha256(const void *data, size_t size, unsigned char digest[SHA256_DIGEST_LEN]);
+
+void hmac_sha256(const void *key, size_t key_len, const void *data, size_t size,
+                 unsigned char mac[SHA256_DIGEST_LEN]);
+
+/* PBKDF2-HMAC-SHA256: 输出out_len字节,iterations至少为1 */
+void pbkdf2_sha256(const void *password, size_t password_len, const void *salt, size_t salt_len,
+                   unsigned int iterations, unsigned char *out, size_t out_len);
+
+/* 从操作系统随机源读取size字节 */
+ErrorCode crypto_random_bytes(void *buffer, size_t size);
+
+/* 等时比较: 耗时与内容无关,用于比对口令哈希 */
+Bool crypto_equal(const void *a, const void *b, size_t size);
+
+#endif /* CRYPTO_H */
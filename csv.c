@@ -0,0 +1,425 @@
+#include "csv.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define CSV_USE_SSE2
+#elif defined(__ARM_NEON) || defined(__aarch64__) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define CSV_USE_NEON
+#endif
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+/* 两位一组的十进制查表,每次除法产生两位数字 */
+static const char DIGIT_PAIRS[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+ErrorCode csv_buffer_init(CsvBuffer *buffer, size_t capacity) {
+    if (buffer == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    buffer->size = 0;
+    buffer->capacity = (capacity > CSV_MAX_ROW_LEN) ? capacity : CSV_MAX_ROW_LEN;
+    buffer->data = (char *)malloc(buffer->capacity);
+    if (buffer->data == NULL) {
+        buffer->capacity = 0;
+        return ERROR_OUT_OF_MEMORY;
+    }
+    return SUCCESS;
+}
+
+void csv_buffer_free(CsvBuffer *buffer) {
+    if (buffer != NULL) {
+        free(buffer->data);
+        buffer->data = NULL;
+        buffer->size = 0;
+        buffer->capacity = 0;
+    }
+}
+
+ErrorCode csv_buffer_reserve(CsvBuffer *buffer, size_t extra) {
+    if (buffer->capacity - buffer->size >= extra) {
+        return SUCCESS;
+    }
+    size_t capacity = (buffer->capacity > 0) ? buffer->capacity : CSV_MAX_ROW_LEN;
+    while (capacity - buffer->size < extra) {
+        capacity *= 2;
+    }
+    char *data = (char *)realloc(buffer->data, capacity);
+    if (data == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return SUCCESS;
+}
+
+ErrorCode csv_buffer_append(CsvBuffer *buffer, const char *data, size_t size) {
+    if (buffer == NULL || (data == NULL && size > 0)) {
+        return ERROR_NULL_POINTER;
+    }
+    ErrorCode err = csv_buffer_reserve(buffer, size);
+    if (err != SUCCESS) {
+        return err;
+    }
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+    return SUCCESS;
+}
+
+size_t csv_format_int(char *out, int value) {
+    char digits[10];
+    char *p = digits + sizeof(digits);
+    size_t length = 0;
+    /* 先转为无符号,INT_MIN取负也不会溢出 */
+    unsigned int x = (value < 0) ? 0u - (unsigned int)value : (unsigned int)value;
+
+    while (x >= 100) {
+        unsigned int pair = (x % 100) * 2;
+        x /= 100;
+        *--p = DIGIT_PAIRS[pair + 1];
+        *--p = DIGIT_PAIRS[pair];
+    }
+    if (x >= 10) {
+        *--p = DIGIT_PAIRS[x * 2 + 1];
+        *--p = DIGIT_PAIRS[x * 2];
+    } else {
+        *--p = (char)('0' + x);
+    }
+
+    if (value < 0) {
+        out[length++] = '-';
+    }
+    size_t count = (size_t)(digits + sizeof(digits) - p);
+    memcpy(out + length, p, count);
+    return length + count;
+}
+
+/* 追加一个字符串字段(定长数组,最多max字节),需要时按RFC 4180加引号 */
+static char *put_field(char *out, const char *field, size_t max) {
+    const char *end = (const char *)memchr(field, '\0', max);
+    size_t length = (end != NULL) ? (size_t)(end - field) : max;
+    Bool quote = FALSE;
+
+    for (size_t i = 0; i < length; i++) {
+        char c = field[i];
+        if (c == ',' || c == '"' || c == '\n' || c == '\r') {
+            quote = TRUE;
+            break;
+        }
+    }
+
+    if (!quote) {
+        memcpy(out, field, length);
+        return out + length;
+    }
+
+    *out++ = '"';
+    for (size_t i = 0; i < length; i++) {
+        if (field[i] == '"') {
+            *out++ = '"';
+        }
+        *out++ = field[i];
+    }
+    *out++ = '"';
+    return out;
+}
+
+ErrorCode csv_append_employee(CsvBuffer *buffer, const Employee *emp) {
+    if (buffer == NULL || emp == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    ErrorCode err = csv_buffer_reserve(buffer, CSV_MAX_ROW_LEN);
+    if (err != SUCCESS) {
+        return err;
+    }
+
+    char *start = buffer->data + buffer->size;
+    char *out = start;
+    out += csv_format_int(out, emp->id);
+    *out++ = ',';
+    out = put_field(out, emp->name, MAX_NAME_LEN);
+    *out++ = ',';
+    out = put_field(out, emp->department, MAX_DEPT_LEN);
+    *out++ = ',';
+    out = put_field(out, emp->attend_date, MAX_DATE_LEN);
+    *out++ = ',';
+    out += csv_format_int(out, emp->attend_days);
+    *out++ = '\n';
+
+    buffer->size += (size_t)(out - start);
+    return SUCCESS;
+}
+
+/* ========== 解析 ========== */
+
+#if defined(CSV_USE_SSE2)
+/* 16位掩码中最低置位的下标 */
+static unsigned int lowest_bit(unsigned int mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned int)__builtin_ctz(mask);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned int)index;
+#else
+    unsigned int index = 0;
+    while ((mask & 1u) == 0) {
+        mask >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+#endif
+
+static int is_special(char c) {
+    return c == ',' || c == '"' || c == '\n' || c == '\r';
+}
+
+const char *csv_scan_special(const char *p, const char *end) {
+#if defined(CSV_USE_SSE2)
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, comma),
+                                                 _mm_cmpeq_epi8(chunk, quote)),
+                                    _mm_or_si128(_mm_cmpeq_epi8(chunk, lf),
+                                                 _mm_cmpeq_epi8(chunk, cr)));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(hits);
+        if (mask != 0) {
+            return p + lowest_bit(mask);
+        }
+        p += 16;
+    }
+#elif defined(CSV_USE_NEON)
+    const uint8x16_t comma = vdupq_n_u8(',');
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t lf = vdupq_n_u8('\n');
+    const uint8x16_t cr = vdupq_n_u8('\r');
+    while (end - p >= 16) {
+        uint8x16_t chunk = vld1q_u8((const uint8_t *)p);
+        uint8x16_t hits = vorrq_u8(vorrq_u8(vceqq_u8(chunk, comma), vceqq_u8(chunk, quote)),
+                                   vorrq_u8(vceqq_u8(chunk, lf), vceqq_u8(chunk, cr)));
+        /* 每字节收窄为4位,得到64位掩码 */
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(
+            vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0);
+        if (mask != 0) {
+            unsigned int bit = 0;
+            while (((mask >> bit) & 0xFu) == 0) {
+                bit += 4;
+            }
+            return p + bit / 4;
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && !is_special(*p)) {
+        p++;
+    }
+    return p;
+}
+
+/* 出错时跳到下一个换行之后; 缓冲区内没有换行且输入未结束时返回FALSE(需读入更多数据) */
+static Bool skip_line(const char **cursor, const char *p, const char *end, Bool final,
+                      size_t *lines) {
+    const char *newline = (const char *)memchr(p, '\n', (size_t)(end - p));
+    if (newline == NULL) {
+        if (!final) {
+            return FALSE;
+        }
+        *cursor = end;
+        return TRUE;
+    }
+    (*lines)++;
+    *cursor = newline + 1;
+    return TRUE;
+}
+
+/* 统计[p, end)中的换行数(引号内的字段跨行时使用) */
+static size_t count_newlines(const char *p, const char *end) {
+    size_t count = 0;
+    while ((p = (const char *)memchr(p, '\n', (size_t)(end - p))) != NULL) {
+        count++;
+        p++;
+    }
+    return count;
+}
+
+CsvRecordStatus csv_next_record(const char **cursor, const char *end, Bool final,
+                                CsvField *fields, size_t max_fields,
+                                size_t *field_count, size_t *lines) {
+    const char *p = *cursor;
+    size_t count = 0;
+    size_t newlines = 0;
+    Bool too_many = FALSE;
+
+    *field_count = 0;
+    if (p >= end) {
+        return CSV_RECORD_END;
+    }
+
+    for (;;) {
+        CsvField field;
+        field.escaped = FALSE;
+
+        if (p < end && *p == '"') {
+            /* 引号字段: 找到不成对的结束引号 */
+            const char *start = ++p;
+            for (;;) {
+                const char *q = (const char *)memchr(p, '"', (size_t)(end - p));
+                if (q == NULL || (q + 1 == end && !final)) {
+                    if (!final) {
+                        return CSV_RECORD_INCOMPLETE;
+                    }
+                    *lines += newlines + count_newlines(start, end);
+                    *cursor = end;
+                    return CSV_RECORD_BAD_QUOTE;
+                }
+                if (q + 1 < end && q[1] == '"') {
+                    field.escaped = TRUE;
+                    p = q + 2;
+                    continue;
+                }
+                field.data = start;
+                field.length = (size_t)(q - start);
+                newlines += count_newlines(start, q);
+                p = q + 1;
+                break;
+            }
+            if (p < end && *p != ',' && *p != '\n' && *p != '\r') {
+                if (!skip_line(cursor, p, end, final, &newlines)) {
+                    return CSV_RECORD_INCOMPLETE;
+                }
+                *lines += newlines;
+                return CSV_RECORD_BAD_QUOTE;
+            }
+        } else {
+            const char *q = csv_scan_special(p, end);
+            if (q < end && *q == '"') {
+                if (!skip_line(cursor, q, end, final, &newlines)) {
+                    return CSV_RECORD_INCOMPLETE;
+                }
+                *lines += newlines;
+                return CSV_RECORD_BAD_QUOTE;
+            }
+            field.data = p;
+            field.length = (size_t)(q - p);
+            p = q;
+        }
+
+        if (count < max_fields) {
+            fields[count] = field;
+        } else {
+            too_many = TRUE;
+        }
+        count++;
+
+        if (p == end) {
+            if (!final) {
+                return CSV_RECORD_INCOMPLETE;
+            }
+            break;
+        }
+        if (*p == ',') {
+            p++;
+            continue;
+        }
+        /* 行尾: 支持\n与\r\n */
+        if (*p == '\r') {
+            if (p + 1 == end && !final) {
+                return CSV_RECORD_INCOMPLETE;
+            }
+            p++;
+            if (p < end && *p == '\n') {
+                p++;
+            }
+        } else {
+            p++;
+        }
+        newlines++;
+        break;
+    }
+
+    *lines += newlines;
+    *cursor = p;
+    if (too_many) {
+        return CSV_RECORD_TOO_MANY_FIELDS;
+    }
+    *field_count = count;
+    return CSV_RECORD_OK;
+}
+
+Bool csv_field_copy(const CsvField *field, char *out, size_t capacity) {
+    size_t length = 0;
+    for (size_t i = 0; i < field->length; i++) {
+        if (length + 1 >= capacity) {
+            return FALSE;
+        }
+        out[length++] = field->data[i];
+        if (field->escaped && field->data[i] == '"') {
+            i++;  /* 跳过双写引号的第二个 */
+        }
+    }
+    if (length >= capacity) {
+        return FALSE;
+    }
+    out[length] = '\0';
+    return TRUE;
+}
+
+Bool csv_field_to_int(const CsvField *field, int *value) {
+    size_t i = 0;
+    Bool negative = FALSE;
+    if (field->length > 0 && field->data[0] == '-') {
+        negative = TRUE;
+        i = 1;
+    }
+    if (i == field->length) {
+        return FALSE;
+    }
+
+    /* 以负数累加,INT_MIN也能表示 */
+    long long result = 0;
+    for (; i < field->length; i++) {
+        char c = field->data[i];
+        if (c < '0' || c > '9') {
+            return FALSE;
+        }
+        result = result * 10 - (c - '0');
+        if (result < (long long)INT_MIN) {
+            return FALSE;
+        }
+    }
+    if (!negative) {
+        if (-result > (long long)INT_MAX) {
+            return FALSE;
+        }
+        result = -result;
+    }
+    *value = (int)result;
+    return TRUE;
+}
+
+Bool csv_field_equals(const CsvField *field, const char *text) {
+    size_t length = strlen(text);
+    return (!field->escaped && field->length == length &&
+            memcmp(field->data, text, length) == 0) ? TRUE : FALSE;
+}
@@ -0,0 +1,84 @@
+#ifndef CSV_H
+#define CSV_H
+
+#include "common.h"
+#include "model.h"
+
+/*
+ * CSV格式化与解析
+ * 格式化不经过printf: 整数手工转十进制,定长字段按已知长度memcpy,
+ * 逐行追加到可复用的输出缓冲区。字段含逗号、双引号或换行时
+ * 按RFC 4180加双引号并把内部双引号写成两个,其余字段原样输出。
+ * 解析用SIMD(SSE2/NEON,其他平台逐字节)一次扫描16字节查找分隔符,
+ * 字段只记录在输入缓冲区中的位置,不做逐字段分配。
+ */
+
+/* 导出文件的表头行 */
+#define CSV_HEADER "工号,姓名,部门,出勤日期,出勤天数\n"
+
+/* 单行最大字节数: 三个字符串字段全部转义后的长度 + 两个整数 + 分隔符 */
+#define CSV_MAX_ROW_LEN ((MAX_NAME_LEN + MAX_DEPT_LEN + MAX_DATE_LEN) * 2 + 6 + 2 * 11 + 5)
+
+/* 可增长的输出缓冲区 */
+typedef struct {
+    char *data;       /* 已格式化的字节 */
+    size_t size;      /* 已用字节数 */
+    size_t capacity;  /* 容量 */
+} CsvBuffer;
+
+ErrorCode csv_buffer_init(CsvBuffer *buffer, size_t capacity);
+void csv_buffer_free(CsvBuffer *buffer);
+
+/* 确保至少还能追加extra字节 */
+ErrorCode csv_buffer_reserve(CsvBuffer *buffer, size_t extra);
+
+/* 追加任意字节 */
+ErrorCode csv_buffer_append(CsvBuffer *buffer, const char *data, size_t size);
+
+/* 把整数写成十进制,返回写入的字节数(out至少11字节,不写结尾符) */
+size_t csv_format_int(char *out, int value);
+
+/* 追加一行职工记录(含换行) */
+ErrorCode csv_append_employee(CsvBuffer *buffer, const Employee *emp);
+
+/* 导出/导入的列数 */
+#define CSV_COLUMN_COUNT 5
+
+/* 解析出的字段: 指向输入缓冲区,escaped表示引号内含有需还原的双写引号 */
+typedef struct {
+    const char *data;
+    size_t length;
+    Bool escaped;
+} CsvField;
+
+/* 记录解析结果 */
+typedef enum {
+    CSV_RECORD_OK = 0,          /* 解析出一条记录 */
+    CSV_RECORD_END,             /* 输入已结束 */
+    CSV_RECORD_INCOMPLETE,      /* 缓冲区内记录不完整,需读入更多数据 */
+    CSV_RECORD_BAD_QUOTE,       /* 引号不匹配(已跳到下一行) */
+    CSV_RECORD_TOO_MANY_FIELDS  /* 字段数超过上限(已跳到下一行) */
+} CsvRecordStatus;
+
+/* 返回[p, end)中第一个逗号、双引号、回车或换行的位置,没有则返回end */
+const char *csv_scan_special(const char *p, const char *end);
+
+/*
+ * 从*cursor开始解析一条记录,字段写入fields(最多max_fields个)。
+ * final为FALSE时,缓冲区末尾没有换行的记录返回INCOMPLETE且不移动*cursor;
+ * 其他情况*cursor移到下一条记录开头,lines累加消耗的物理行数。
+ */
+CsvRecordStatus csv_next_record(const char **cursor, const char *end, Bool final,
+                                CsvField *fields, size_t max_fields,
+                                size_t *field_count, size_t *lines);
+
+/* 把字段拷入定长数组(还原双写引号并补结尾符),超长返回FALSE */
+Bool csv_field_copy(const CsvField *field, char *out, size_t capacity);
+
+/* 解析十进制整数(可带负号,不允许空白),溢出或含非数字返回FALSE */
+Bool csv_field_to_int(const CsvField *field, int *value);
+
+/* 字段是否等于给定字符串 */
+Bool csv_field_equals(const CsvField *field, const char *text);
+
+#endif /* CSV_H */
@@ -0,0 +1,385 @@
+#include "csv_import.h"
+#include "csv.h"
+#include "storage_io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 导入时的工号集合: 开放寻址,0为空槽(合法工号均为正数) */
+typedef struct {
+    int *slots;
+    size_t capacity;  /* 2的幂 */
+    size_t count;
+} IdSet;
+
+static size_t id_set_hash(int id) {
+    unsigned int x = (unsigned int)id;
+    x ^= x >> 16;
+    x *= 0x45d9f3bu;
+    x ^= x >> 16;
+    return (size_t)x;
+}
+
+static Bool id_set_init(IdSet *set, size_t expected) {
+    set->capacity = 64;
+    while (set->capacity < expected * 2) {
+        set->capacity *= 2;
+    }
+    set->count = 0;
+    set->slots = (int *)calloc(set->capacity, sizeof(int));
+    return (set->slots != NULL) ? TRUE : FALSE;
+}
+
+static Bool id_set_contains(const IdSet *set, int id) {
+    size_t mask = set->capacity - 1;
+    for (size_t pos = id_set_hash(id) & mask; set->slots[pos] != 0; pos = (pos + 1) & mask) {
+        if (set->slots[pos] == id) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/* 插入工号(调用方已确认不存在),负载超过1/2时扩容 */
+static Bool id_set_insert(IdSet *set, int id) {
+    if ((set->count + 1) * 2 > set->capacity) {
+        IdSet grown;
+        grown.capacity = set->capacity * 2;
+        grown.count = 0;
+        grown.slots = (int *)calloc(grown.capacity, sizeof(int));
+        if (grown.slots == NULL) {
+            return FALSE;
+        }
+        for (size_t i = 0; i < set->capacity; i++) {
+            if (set->slots[i] != 0) {
+                id_set_insert(&grown, set->slots[i]);
+            }
+        }
+        free(set->slots);
+        *set = grown;
+    }
+    size_t mask = set->capacity - 1;
+    size_t pos = id_set_hash(id) & mask;
+    while (set->slots[pos] != 0) {
+        pos = (pos + 1) & mask;
+    }
+    set->slots[pos] = id;
+    set->count++;
+    return TRUE;
+}
+
+static void report_line_error(CsvImportReport *report, size_t line, CsvLineError error) {
+    if (report == NULL) {
+        return;
+    }
+    report->rejected++;
+    if (report->error_count < CSV_IMPORT_MAX_ERRORS) {
+        report->errors[report->error_count].line = line;
+        report->errors[report->error_count].error = error;
+        report->error_count++;
+    }
+}
+
+/* 是否为导出时写入的表头行 */
+static Bool is_csv_header(const CsvField *fields, size_t count) {
+    static const char *const columns[CSV_COLUMN_COUNT] = {
+        "工号", "姓名", "部门", "出勤日期", "出勤天数"
+    };
+    if (count != CSV_COLUMN_COUNT) {
+        return FALSE;
+    }
+    for (size_t i = 0; i < CSV_COLUMN_COUNT; i++) {
+        if (!csv_field_equals(&fields[i], columns[i])) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/* 校验一行并生成职工记录(工号为空时id为0,稍后统一分配);ids为文件中前面各行的工号 */
+static CsvLineError parse_csv_employee(const CsvField *fields, const IdSet *ids, Employee *emp) {
+    memset(emp, 0, sizeof(Employee));
+    
+    int id = 0;
+    if (fields[0].length > 0 && (!csv_field_to_int(&fields[0], &id) || id <= 0)) {
+        return CSV_LINE_BAD_ID;
+    }
+    if (id != 0 && id_set_contains(ids, id)) {
+        return CSV_LINE_DUPLICATE_ID;
+    }
+    emp->id = id;
+    
+    /* 超长字段复制失败,按对应字段报错;其余规则与添加/修改相同 */
+    if (!csv_field_copy(&fields[1], emp->name, MAX_NAME_LEN)) {
+        return CSV_LINE_BAD_NAME;
+    }
+    if (!csv_field_copy(&fields[2], emp->department, MAX_DEPT_LEN)) {
+        return CSV_LINE_BAD_DEPARTMENT;
+    }
+    if (!csv_field_copy(&fields[3], emp->attend_date, MAX_DATE_LEN)) {
+        return CSV_LINE_BAD_DATE;
+    }
+    if (!csv_field_to_int(&fields[4], &emp->attend_days)) {
+        return CSV_LINE_BAD_DAYS;
+    }
+    switch (employee_check_fields(emp->name, emp->department, emp->attend_date, emp->attend_days)) {
+        case EMPLOYEE_BAD_NAME:
+            return CSV_LINE_BAD_NAME;
+        case EMPLOYEE_BAD_DEPARTMENT:
+            return CSV_LINE_BAD_DEPARTMENT;
+        case EMPLOYEE_BAD_DATE:
+            return CSV_LINE_BAD_DATE;
+        case EMPLOYEE_BAD_DAYS:
+            return CSV_LINE_BAD_DAYS;
+        case EMPLOYEE_FIELDS_OK:
+            break;
+    }
+    return (CsvLineError)0;
+}
+
+/* 按行号排序报告中的出错行(与已有工号重复的行在最后才检出) */
+static void sort_line_errors(CsvImportReport *report) {
+    for (size_t i = 1; i < report->error_count; i++) {
+        size_t line = report->errors[i].line;
+        CsvLineError error = report->errors[i].error;
+        size_t j = i;
+        while (j > 0 && report->errors[j - 1].line > line) {
+            report->errors[j] = report->errors[j - 1];
+            j--;
+        }
+        report->errors[j].line = line;
+        report->errors[j].error = error;
+    }
+}
+
+/* 释放待导入的记录 */
+static void free_pending(Vector *pending) {
+    for (size_t i = 0; i < pending->size; i++) {
+        free(pending->data[i]);
+    }
+    vector_free(pending);
+}
+
+ErrorCode storage_import_csv(const char *filename, EmployeeManager *manager,
+                             CsvImportReport *report) {
+    if (filename == NULL || manager == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    if (report != NULL) {
+        memset(report, 0, sizeof(CsvImportReport));
+    }
+    
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) {
+        return ERROR_FILE_NOT_FOUND;
+    }
+    setvbuf(fp, NULL, _IONBF, 0);
+    
+    /*
+     * 解析阶段不读管理器(其他写者可能同时修改),只查文件内的重复工号;
+     * 与已有记录的重复在持有写锁追加时再检查
+     */
+    IdSet ids;
+    if (!id_set_init(&ids, 0)) {
+        fclose(fp);
+        return ERROR_OUT_OF_MEMORY;
+    }
+    ErrorCode result = SUCCESS;
+    
+    Vector *pending = vector_create();
+    size_t *lines = NULL;  /* 各待导入记录的行号 */
+    size_t lines_capacity = 0;
+    size_t capacity = STORAGE_CHUNK_SIZE;
+    char *buffer = (char *)malloc(capacity);
+    if (pending == NULL || buffer == NULL) {
+        result = ERROR_OUT_OF_MEMORY;
+    }
+    
+    /* 分块读入,缓冲区末尾不完整的记录留到下一块继续解析 */
+    size_t used = 0;
+    size_t line = 1;
+    Bool final = FALSE;
+    Bool at_start = TRUE;
+    Bool first_record = TRUE;
+    while (result == SUCCESS && !final) {
+        if (used == capacity) {
+            /* 单条记录超过缓冲区,扩大一倍 */
+            char *grown = (char *)realloc(buffer, capacity * 2);
+            if (grown == NULL) {
+                result = ERROR_OUT_OF_MEMORY;
+                break;
+            }
+            buffer = grown;
+            capacity *= 2;
+        }
+        size_t n = fread(buffer + used, 1, capacity - used, fp);
+        if (n < capacity - used) {
+            if (ferror(fp)) {
+                result = ERROR_FILE_READ_FAILED;
+                break;
+            }
+            final = TRUE;
+        }
+        used += n;
+        
+        const char *cursor = buffer;
+        const char *end = buffer + used;
+        if (at_start && used >= 3 && memcmp(buffer, "\xEF\xBB\xBF", 3) == 0) {
+            cursor += 3;  /* 跳过UTF-8 BOM */
+        }
+        at_start = FALSE;
+        
+        for (;;) {
+            CsvField fields[CSV_COLUMN_COUNT];
+            size_t count = 0;
+            size_t record_line = line;
+            CsvRecordStatus status = csv_next_record(&cursor, end, final, fields,
+                                                     CSV_COLUMN_COUNT, &count, &line);
+            if (status == CSV_RECORD_END || status == CSV_RECORD_INCOMPLETE) {
+                break;
+            }
+            if (status == CSV_RECORD_BAD_QUOTE) {
+                report_line_error(report, record_line, CSV_LINE_BAD_QUOTE);
+                first_record = FALSE;
+                continue;
+            }
+            if (status == CSV_RECORD_TOO_MANY_FIELDS) {
+                report_line_error(report, record_line, CSV_LINE_FIELD_COUNT);
+                first_record = FALSE;
+                continue;
+            }
+            
+            /* 首行为导出表头时跳过;空行忽略 */
+            Bool header = (first_record && is_csv_header(fields, count)) ? TRUE : FALSE;
+            first_record = FALSE;
+            if (header || (count == 1 && fields[0].length == 0)) {
+                continue;
+            }
+            if (count != CSV_COLUMN_COUNT) {
+                report_line_error(report, record_line, CSV_LINE_FIELD_COUNT);
+                continue;
+            }
+            
+            Employee emp;
+            CsvLineError error = parse_csv_employee(fields, &ids, &emp);
+            if (error != 0) {
+                report_line_error(report, record_line, error);
+                continue;
+            }
+            
+            Employee *copy = (Employee *)malloc(sizeof(Employee));
+            if (copy == NULL || (emp.id != 0 && !id_set_insert(&ids, emp.id))) {
+                free(copy);
+                result = ERROR_OUT_OF_MEMORY;
+                break;
+            }
+            memcpy(copy, &emp, sizeof(Employee));
+            if (pending->size == lines_capacity) {
+                size_t grown_capacity = (lines_capacity > 0) ? lines_capacity * 2 : 1024;
+                size_t *grown = (size_t *)realloc(lines, grown_capacity * sizeof(size_t));
+                if (grown == NULL) {
+                    free(copy);
+                    result = ERROR_OUT_OF_MEMORY;
+                    break;
+                }
+                lines = grown;
+                lines_capacity = grown_capacity;
+            }
+            lines[pending->size] = record_line;
+            if (vector_push_back(pending, copy) != SUCCESS) {
+                free(copy);
+                result = ERROR_OUT_OF_MEMORY;
+                break;
+            }
+        }
+        
+        used = (size_t)(end - cursor);
+        memmove(buffer, cursor, used);
+    }
+    free(buffer);
+    free(ids.slots);
+    fclose(fp);
+    
+    if (result != SUCCESS) {
+        if (pending != NULL) {
+            free_pending(pending);
+        }
+        free(lines);
+        return result;
+    }
+    
+    /* 一次性追加: 先剔除与已有工号重复的行,工号为空的行从max(next_id, 最大导入工号+1)开始分配 */
+    IdSet existing;
+    employee_manager_begin_write(manager);
+    if (!id_set_init(&existing, manager->employees->size)) {
+        result = ERROR_OUT_OF_MEMORY;
+        existing.slots = NULL;
+    }
+    for (size_t i = 0; result == SUCCESS && i < manager->employees->size; i++) {
+        int id = ((Employee *)manager->employees->data[i])->id;
+        if (id > 0 && !id_set_contains(&existing, id) && !id_set_insert(&existing, id)) {
+            result = ERROR_OUT_OF_MEMORY;
+        }
+    }
+    if (result == SUCCESS) {
+        result = vector_reserve(manager->employees, manager->employees->size + pending->size);
+    }
+    if (result == SUCCESS) {
+        int next_id = manager->next_id;
+        size_t kept = 0;
+        for (size_t i = 0; i < pending->size; i++) {
+            Employee *emp = (Employee *)pending->data[i];
+            if (emp->id != 0 && id_set_contains(&existing, emp->id)) {
+                report_line_error(report, lines[i], CSV_LINE_DUPLICATE_ID);
+                free(emp);
+                continue;
+            }
+            if (emp->id >= next_id) {
+                next_id = emp->id + 1;
+            }
+            pending->data[kept++] = emp;
+        }
+        pending->size = kept;
+        for (size_t i = 0; i < pending->size; i++) {
+            Employee *emp = (Employee *)pending->data[i];
+            if (emp->id == 0) {
+                emp->id = next_id++;
+            }
+            vector_push_back(manager->employees, emp);
+        }
+        manager->next_id = next_id;
+        if (report != NULL) {
+            report->imported = pending->size;
+            sort_line_errors(report);
+        }
+        pending->size = 0;
+    }
+    employee_manager_end_write(manager);
+    
+    free(existing.slots);
+    free(lines);
+    free_pending(pending);
+    return result;
+}
+
+const char *storage_csv_line_error_message(CsvLineError error) {
+    switch (error) {
+        case CSV_LINE_FIELD_COUNT:
+            return "wrong number of columns";
+        case CSV_LINE_BAD_QUOTE:
+            return "unbalanced quotes";
+        case CSV_LINE_BAD_ID:
+            return "invalid employee ID";
+        case CSV_LINE_DUPLICATE_ID:
+            return "duplicate employee ID";
+        case CSV_LINE_BAD_NAME:
+            return "empty or too long name";
+        case CSV_LINE_BAD_DEPARTMENT:
+            return "empty or too long department";
+        case CSV_LINE_BAD_DATE:
+            return "invalid attendance date";
+        case CSV_LINE_BAD_DAYS:
+            return "attendance days out of range";
+    }
+    return "unknown error";
+}
@@ -0,0 +1,45 @@
+#ifndef CSV_IMPORT_H
+#define CSV_IMPORT_H
+
+#include "common.h"
+#include "model.h"
+
+/* CSV导入中被拒绝的行的原因 */
+typedef enum {
+    CSV_LINE_FIELD_COUNT = 1,  /* 列数不是5 */
+    CSV_LINE_BAD_QUOTE,        /* 引号不匹配 */
+    CSV_LINE_BAD_ID,           /* 工号不是正整数 */
+    CSV_LINE_DUPLICATE_ID,     /* 工号与已有或前面的行重复 */
+    CSV_LINE_BAD_NAME,         /* 姓名为空或过长 */
+    CSV_LINE_BAD_DEPARTMENT,   /* 部门为空或过长 */
+    CSV_LINE_BAD_DATE,         /* 出勤日期过长 */
+    CSV_LINE_BAD_DAYS          /* 出勤天数不是整数或不在0~MAX_ATTEND_DAYS */
+} CsvLineError;
+
+/* 最多记录的出错行数(超出部分只计数) */
+#define CSV_IMPORT_MAX_ERRORS 100
+
+/* CSV导入结果 */
+typedef struct {
+    size_t imported;     /* 导入的记录数 */
+    size_t rejected;     /* 被拒绝的行数 */
+    size_t error_count;  /* errors中的有效项数 */
+    struct {
+        size_t line;         /* 行号(从1开始,含表头) */
+        CsvLineError error;  /* 原因 */
+    } errors[CSV_IMPORT_MAX_ERRORS];
+} CsvImportReport;
+
+/*
+ * 从CSV导入职工: 接受本程序导出的表头行,工号为空时自动分配。字段规则与添加/修改相同
+ * (employee_check_fields),与已有记录的工号重复在持有写锁时检查。
+ * 合法的行一次性批量追加,非法的行跳过并按行号记入report(可为NULL);
+ * 只要文件可读即返回SUCCESS,即使部分行被拒绝
+ */
+ErrorCode storage_import_csv(const char *filename, EmployeeManager *manager,
+                             CsvImportReport *report);
+
+/* 出错原因的说明文字 */
+const char *storage_csv_line_error_message(CsvLineError error);
+
+#endif /* CSV_IMPORT_H */
@@ -0,0 +1,144 @@
+#include "epoch.h"
+#include "thread.h"
+#include <stdlib.h>
+
+/* 退役对象链表节点 */
+typedef struct RetiredNode {
+    void *ptr;
+    EpochFreeFunc free_func;
+    struct RetiredNode *next;
+} RetiredNode;
+
+struct EpochDomain {
+    volatile long epoch;        /* 当前纪元奇偶位(0或1) */
+    volatile long readers[2];   /* 各奇偶位上的活跃读者数 */
+    RetiredNode *pending;       /* 纪元翻转前退役的对象 */
+    RetiredNode *waiting;       /* 等待旧奇偶位读者清零的对象 */
+    long waiting_parity;        /* waiting链表对应的旧奇偶位 */
+    size_t pending_count;       /* pending与waiting中的对象总数 */
+};
+
+static void retired_list_free(RetiredNode *node) {
+    while (node != NULL) {
+        RetiredNode *next = node->next;
+        node->free_func(node->ptr);
+        free(node);
+        node = next;
+    }
+}
+
+static size_t retired_list_length(const RetiredNode *node) {
+    size_t count = 0;
+    for (; node != NULL; node = node->next) {
+        count++;
+    }
+    return count;
+}
+
+EpochDomain *epoch_domain_create(void) {
+    EpochDomain *domain = (EpochDomain *)calloc(1, sizeof(EpochDomain));
+    return domain;
+}
+
+void epoch_domain_free(EpochDomain *domain) {
+    if (domain != NULL) {
+        retired_list_free(domain->waiting);
+        retired_list_free(domain->pending);
+        free(domain);
+    }
+}
+
+int epoch_enter(EpochDomain *domain) {
+    for (;;) {
+        long parity = atomic_long_load(&domain->epoch);
+        atomic_long_add(&domain->readers[parity], 1);
+        /* 计数后再次确认纪元未翻转,否则写者可能已不再等待该奇偶位 */
+        if (atomic_long_load(&domain->epoch) == parity) {
+            return (int)parity;
+        }
+        atomic_long_add(&domain->readers[parity], -1);
+    }
+}
+
+void epoch_exit(EpochDomain *domain, int token) {
+    atomic_long_add(&domain->readers[token & 1], -1);
+}
+
+ErrorCode epoch_retire(EpochDomain *domain, void *ptr, EpochFreeFunc free_func) {
+    if (domain == NULL || free_func == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    if (ptr == NULL) {
+        return SUCCESS;
+    }
+
+    RetiredNode *node = (RetiredNode *)malloc(sizeof(RetiredNode));
+    if (node == NULL) {
+        /* 无法延迟回收时退化为同步等待: 清空已有队列后翻转纪元并等待旧读者离开 */
+        epoch_synchronize(domain);
+        long old_parity = atomic_long_load(&domain->epoch);
+        atomic_long_store(&domain->epoch, old_parity ^ 1);
+        while (atomic_long_load(&domain->readers[old_parity]) != 0) {
+            thread_yield();
+        }
+        free_func(ptr);
+        return SUCCESS;
+    }
+
+    node->ptr = ptr;
+    node->free_func = free_func;
+    node->next = domain->pending;
+    domain->pending = node;
+    domain->pending_count++;
+    return SUCCESS;
+}
+
+void epoch_reclaim(EpochDomain *domain) {
+    if (domain == NULL) {
+        return;
+    }
+
+    if (domain->waiting != NULL &&
+        atomic_long_load(&domain->readers[domain->waiting_parity]) == 0) {
+        domain->pending_count -= retired_list_length(domain->waiting);
+        retired_list_free(domain->waiting);
+        domain->waiting = NULL;
+    }
+
+    if (domain->waiting == NULL && domain->pending != NULL) {
+        /* 翻转纪元: 此后进入的读者计入新奇偶位,只可能看到新发布的数据 */
+        long old_parity = atomic_long_load(&domain->epoch);
+        atomic_long_store(&domain->epoch, old_parity ^ 1);
+        domain->waiting = domain->pending;
+        domain->waiting_parity = old_parity;
+        domain->pending = NULL;
+
+        if (atomic_long_load(&domain->readers[old_parity]) == 0) {
+            domain->pending_count -= retired_list_length(domain->waiting);
+            retired_list_free(domain->waiting);
+            domain->waiting = NULL;
+        }
+    }
+}
+
+void epoch_synchronize(EpochDomain *domain) {
+    if (domain == NULL) {
+        return;
+    }
+
+    for (;;) {
+        epoch_reclaim(domain);
+        if (domain->pending == NULL && domain->waiting == NULL) {
+            break;
+        }
+        thread_yield();
+    }
+}
+
+size_t epoch_pending_count(const EpochDomain *domain) {
+    if (domain == NULL) {
+        return 0;
+    }
+    return domain->pending_count;
+}
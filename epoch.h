@@ -0,0 +1,38 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include "common.h"
+
+/*
+ * 基于纪元的内存回收(EBR)
+ * 读者进入/退出临界区只做原子计数,永不阻塞;
+ * 写者(由调用方保证互斥)把不再发布的对象交给retire,
+ * 待所有可能看到该对象的读者离开后再真正释放。
+ * 读临界区不绑定线程,可在一个线程进入、另一个线程退出。
+ */
+
+typedef void (*EpochFreeFunc)(void *ptr);
+
+typedef struct EpochDomain EpochDomain;
+
+/* 创建/释放回收域,释放时直接回收所有待回收对象(调用方保证已无读者) */
+EpochDomain *epoch_domain_create(void);
+void epoch_domain_free(EpochDomain *domain);
+
+/* 读者: 进入临界区返回令牌,退出时原样交回 */
+int epoch_enter(EpochDomain *domain);
+void epoch_exit(EpochDomain *domain, int token);
+
+/* 写者: 退役对象,宽限期结束后调用free_func释放 */
+ErrorCode epoch_retire(EpochDomain *domain, void *ptr, EpochFreeFunc free_func);
+
+/* 写者: 非阻塞地推进纪元并回收已过宽限期的对象 */
+void epoch_reclaim(EpochDomain *domain);
+
+/* 写者: 阻塞直到所有已退役对象被回收 */
+void epoch_synchronize(EpochDomain *domain);
+
+/* 待回收对象数量 */
+size_t epoch_pending_count(const EpochDomain *domain);
+
+#endif /* EPOCH_H */
@@ -0,0 +1,304 @@
+/* 启用64位文件偏移(须在所有系统头文件之前定义) */
+#if !defined(_WIN32) && !defined(_FILE_OFFSET_BITS)
+    #define _FILE_OFFSET_BITS 64
+#endif
+
+#include "external_sort.h"
+#include "storage.h"
+#include "storage_io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 有序段临时文件名"<output>.run<序号>",由调用方释放 */
+static char *sort_run_path(const char *output, size_t run) {
+    size_t length = strlen(output) + 32;
+    char *path = (char *)malloc(length);
+    if (path != NULL) {
+        snprintf(path, length, "%s.run%lu", output, (unsigned long)run);
+    }
+    return path;
+}
+
+static void remove_sort_run(const char *output, size_t run) {
+    char *path = sort_run_path(output, run);
+    if (path != NULL) {
+        remove(path);
+        free(path);
+    }
+}
+
+/* 生成有序段: 记录读满预算后排序写出一段 */
+typedef struct {
+    const char *output;
+    Comparator compare;
+    Employee *records;
+    Employee **order;   /* 排序的是指针,记录本身不移动 */
+    size_t capacity;
+    size_t count;
+    size_t run_count;   /* 已写出的段数 */
+    ErrorCode err;
+} SortRunBuilder;
+
+static ErrorCode write_sorted_run(SortRunBuilder *builder) {
+    qsort(builder->order, builder->count, sizeof(Employee *), builder->compare);
+
+    char *path = sort_run_path(builder->output, builder->run_count);
+    if (path == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    FILE *fp = fopen(path, "wb");
+    if (fp == NULL) {
+        free(path);
+        return ERROR_FILE_WRITE_FAILED;
+    }
+    Bool ok = TRUE;
+    for (size_t i = 0; i < builder->count && ok; i++) {
+        ok = (fwrite(builder->order[i], sizeof(Employee), 1, fp) == 1) ? TRUE : FALSE;
+    }
+    if (fclose(fp) != 0) {
+        ok = FALSE;
+    }
+    if (!ok) {
+        remove(path);
+    }
+    free(path);
+    if (!ok) {
+        return ERROR_FILE_WRITE_FAILED;
+    }
+
+    builder->run_count++;
+    builder->count = 0;
+    return SUCCESS;
+}
+
+static Bool sort_run_collect(void *ctx, const Employee *emp) {
+    SortRunBuilder *builder = (SortRunBuilder *)ctx;
+    builder->records[builder->count] = *emp;
+    builder->order[builder->count] = &builder->records[builder->count];
+    builder->count++;
+    if (builder->count == builder->capacity) {
+        builder->err = write_sorted_run(builder);
+    }
+    return (builder->err == SUCCESS) ? TRUE : FALSE;
+}
+
+/* 把有序段写成新的有序段(中间归并趟的输出) */
+typedef struct {
+    FILE *fp;
+    Bool ok;
+} SortRunWriter;
+
+static Bool sort_run_put(void *ctx, const Employee *emp) {
+    SortRunWriter *out = (SortRunWriter *)ctx;
+    out->ok = (fwrite(emp, sizeof(Employee), 1, out->fp) == 1) ? TRUE : FALSE;
+    return out->ok;
+}
+
+static Bool v2_writer_visit(void *ctx, const Employee *emp) {
+    V2Writer *out = (V2Writer *)ctx;
+    v2_writer_put(out, emp);
+    return out->ok;
+}
+
+/* 用败者树k路归并[first, first + count)号段,按序交给emit;emit返回FALSE时以ERROR_FILE_WRITE_FAILED结束 */
+static ErrorCode merge_sorted_runs(const char *output, size_t first, size_t count, Comparator compare,
+                                   PagedVisitor emit, void *ctx) {
+    FILE **files = (FILE **)calloc(count, sizeof(FILE *));
+    Employee *current = (Employee *)malloc(count * sizeof(Employee));
+    void **heads = (void **)malloc(count * sizeof(void *));
+    LoserTree *tree = loser_tree_create(count, compare);
+    ErrorCode err = (files != NULL && current != NULL && heads != NULL && tree != NULL)
+                        ? SUCCESS : ERROR_OUT_OF_MEMORY;
+
+    for (size_t i = 0; i < count && err == SUCCESS; i++) {
+        char *path = sort_run_path(output, first + i);
+        if (path == NULL) {
+            err = ERROR_OUT_OF_MEMORY;
+            break;
+        }
+        files[i] = fopen(path, "rb");
+        free(path);
+        if (files[i] == NULL) {
+            err = ERROR_FILE_READ_FAILED;
+            break;
+        }
+        setvbuf(files[i], NULL, _IOFBF, EXTERNAL_SORT_RUN_BUFFER);
+        heads[i] = (fread(&current[i], sizeof(Employee), 1, files[i]) == 1) ? &current[i] : NULL;
+    }
+
+    if (err == SUCCESS) {
+        loser_tree_build(tree, heads);
+        size_t run;
+        while ((run = loser_tree_top(tree)) != LOSER_TREE_EMPTY) {
+            if (!emit(ctx, &current[run])) {
+                err = ERROR_FILE_WRITE_FAILED;
+                break;
+            }
+            void *next = NULL;
+            if (fread(&current[run], sizeof(Employee), 1, files[run]) == 1) {
+                next = &current[run];
+            } else if (ferror(files[run])) {
+                err = ERROR_FILE_READ_FAILED;
+                break;
+            }
+            loser_tree_replace(tree, next);
+        }
+    }
+
+    if (files != NULL) {
+        for (size_t i = 0; i < count; i++) {
+            if (files[i] != NULL) {
+                fclose(files[i]);
+            }
+            remove_sort_run(output, first + i);
+        }
+    }
+    loser_tree_free(tree);
+    free(heads);
+    free(current);
+    free(files);
+    return err;
+}
+
+/*
+ * 多趟归并: 段数超过一趟能归并的路数时,每次把最早的fan_in段归并成一个新段,
+ * 直到剩余段数不超过fan_in,再把最后一趟输出给emit
+ */
+static ErrorCode merge_all_runs(const char *output, size_t run_count, size_t fan_in,
+                                Comparator compare, PagedVisitor emit, void *ctx) {
+    size_t first = 0;
+    size_t total = run_count;
+    ErrorCode err = SUCCESS;
+    while (err == SUCCESS && total - first > fan_in) {
+        char *path = sort_run_path(output, total);
+        if (path == NULL) {
+            err = ERROR_OUT_OF_MEMORY;
+            break;
+        }
+        SortRunWriter writer;
+        writer.fp = fopen(path, "wb");
+        writer.ok = TRUE;
+        free(path);
+        if (writer.fp == NULL) {
+            err = ERROR_FILE_WRITE_FAILED;
+            break;
+        }
+        err = merge_sorted_runs(output, first, fan_in, compare, sort_run_put, &writer);
+        if (fclose(writer.fp) != 0 && err == SUCCESS) {
+            err = ERROR_FILE_WRITE_FAILED;
+        }
+        first += fan_in;
+        total++;
+    }
+    if (err == SUCCESS && total > first) {
+        err = merge_sorted_runs(output, first, total - first, compare, emit, ctx);
+    }
+
+    /* 出错时清理尚未归并的段 */
+    if (err != SUCCESS) {
+        for (size_t run = first; run <= total; run++) {
+            remove_sort_run(output, run);
+        }
+    }
+    return err;
+}
+
+ErrorCode storage_external_sort(const char *input, const char *output, SortType type,
+                                SortOutputFormat format, size_t memory_budget) {
+    if (input == NULL || output == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    Comparator compare = employee_comparator(type);
+    if (compare == NULL || (format != SORT_OUTPUT_DB && format != SORT_OUTPUT_CSV)) {
+        return ERROR_INVALID_PARAMETER;
+    }
+    if (memory_budget == 0) {
+        memory_budget = EXTERNAL_SORT_DEFAULT_BUDGET;
+    } else if (memory_budget < EXTERNAL_SORT_MIN_BUDGET) {
+        memory_budget = EXTERNAL_SORT_MIN_BUDGET;
+    }
+
+    ErrorCode err;
+    PagedStore *store = storage_paged_open(input, 2, &err);
+    if (store == NULL) {
+        return err;
+    }
+    int next_id = storage_paged_next_id(store);
+
+    /* 第一阶段: 逐页读入,每满预算排序写出一个有序段 */
+    SortRunBuilder builder;
+    memset(&builder, 0, sizeof(SortRunBuilder));
+    builder.output = output;
+    builder.compare = compare;
+    builder.capacity = memory_budget / (sizeof(Employee) + sizeof(Employee *));
+    builder.records = (Employee *)malloc(builder.capacity * sizeof(Employee));
+    builder.order = (Employee **)malloc(builder.capacity * sizeof(Employee *));
+    if (builder.records == NULL || builder.order == NULL) {
+        err = ERROR_OUT_OF_MEMORY;
+    } else {
+        err = storage_paged_scan(store, sort_run_collect, &builder);
+        if (err == SUCCESS) {
+            err = builder.err;
+        }
+    }
+    storage_paged_close(store);
+    /* 全部记录都在预算内时不写临时文件,直接在内存中排序输出 */
+    if (err == SUCCESS && builder.run_count > 0) {
+        if (builder.count > 0) {
+            err = write_sorted_run(&builder);
+        }
+        free(builder.records);
+        free(builder.order);
+        builder.records = NULL;
+        builder.order = NULL;
+    } else if (err == SUCCESS) {
+        qsort(builder.order, builder.count, sizeof(Employee *), compare);
+    }
+
+    /* 第二阶段: 归并输出 */
+    V2Writer db;
+    CsvStream csv;
+    PagedVisitor emit = (format == SORT_OUTPUT_DB) ? v2_writer_visit : csv_stream_put;
+    void *sink = (format == SORT_OUTPUT_DB) ? (void *)&db : (void *)&csv;
+    Bool opened = FALSE;
+    if (err == SUCCESS) {
+        err = (format == SORT_OUTPUT_DB) ? v2_writer_open(&db, output) : csv_stream_open(&csv, output);
+        opened = (err == SUCCESS) ? TRUE : FALSE;
+    }
+    if (err == SUCCESS) {
+        if (builder.run_count > 0) {
+            size_t fan_in = memory_budget / EXTERNAL_SORT_RUN_BUFFER;
+            if (fan_in > EXTERNAL_SORT_MAX_FAN_IN) {
+                fan_in = EXTERNAL_SORT_MAX_FAN_IN;
+            } else if (fan_in < 2) {
+                fan_in = 2;
+            }
+            err = merge_all_runs(output, builder.run_count, fan_in, compare, emit, sink);
+        } else {
+            for (size_t i = 0; i < builder.count && err == SUCCESS; i++) {
+                if (!emit(sink, builder.order[i])) {
+                    err = ERROR_FILE_WRITE_FAILED;
+                }
+            }
+        }
+    } else {
+        for (size_t run = 0; run < builder.run_count; run++) {
+            remove_sort_run(output, run);
+        }
+    }
+    free(builder.records);
+    free(builder.order);
+
+    if (!opened) {
+        return err;
+    }
+    if (format == SORT_OUTPUT_CSV) {
+        return csv_stream_commit(&csv, err);
+    }
+    if (err != SUCCESS) {
+        v2_writer_abort(&db);
+        return err;
+    }
+    return v2_writer_commit(&db, next_id);
+}
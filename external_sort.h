@@ -0,0 +1,35 @@
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include "common.h"
+#include "model.h"
+
+/* 外部排序的输出格式 */
+typedef enum {
+    SORT_OUTPUT_DB = 0,   /* v2文件(不含索引段,加载时重建) */
+    SORT_OUTPUT_CSV = 1   /* CSV,格式与storage_export_csv相同 */
+} SortOutputFormat;
+
+/* 外部排序的默认与最小内存预算(字节) */
+#define EXTERNAL_SORT_DEFAULT_BUDGET (64u << 20)
+#define EXTERNAL_SORT_MIN_BUDGET (64u << 10)
+
+/* 每个归并输入段的读缓冲区大小,内存预算除以它即一趟归并的最大路数 */
+#define EXTERNAL_SORT_RUN_BUFFER (16u << 10)
+
+/*
+ * 一趟归并的路数上限: 每路占用一个打开的文件,默认64 MiB预算按读缓冲计算可达4096路,
+ * 会超出常见的打开文件数限制(Linux默认1024,Windows CRT默认512)
+ */
+#define EXTERNAL_SORT_MAX_FAN_IN 256
+
+/*
+ * 外部排序: 逐页读入v2文件input,每满memory_budget字节(0取默认值)排序写出一个有序段
+ * "<output>.run<N>",再用败者树多路归并,结果直接流式写入output。
+ * 归并路数为预算除以每段16 KiB读缓冲,且不超过EXTERNAL_SORT_MAX_FAN_IN,
+ * 段数过多时分多趟归并;临时段在结束时删除
+ */
+ErrorCode storage_external_sort(const char *input, const char *output, SortType type,
+                                SortOutputFormat format, size_t memory_budget);
+
+#endif /* EXTERNAL_SORT_H */
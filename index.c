@@ -0,0 +1,659 @@
+#include "index.h"
+#include "thread.h"
+#include <stdlib.h>
+#include <string.h>
+
+static size_t id_hash(int id) {
+    unsigned int x = (unsigned int)id;
+    x ^= x >> 16;
+    x *= 0x45d9f3bu;
+    x ^= x >> 16;
+    return (size_t)x;
+}
+
+static size_t string_hash(const char *str) {
+    size_t hash = 5381;
+    for (; *str != '\0'; str++) {
+        hash = hash * 33 + (unsigned char)*str;
+    }
+    return hash;
+}
+
+static int compare_dept_entry(const void *a, const void *b) {
+    return strcmp(((const IndexDeptEntry *)a)->name, ((const IndexDeptEntry *)b)->name);
+}
+
+/* 按位置升序插入: 同一工号后插入的必然落在探测链更靠后的位置 */
+static void id_slots_insert(IndexIdSlot *slots, size_t slot_count, int id, unsigned int position) {
+    size_t mask = slot_count - 1;
+    size_t pos = id_hash(id) & mask;
+    while (slots[pos].position != INDEX_EMPTY_POSITION) {
+        pos = (pos + 1) & mask;
+    }
+    slots[pos].id = id;
+    slots[pos].position = position;
+}
+
+/* 分区: 一段连续位置的部门编码(编号为分区内的部门字典下标) */
+struct IndexPartial {
+    size_t first;              /* 首条记录的全局位置 */
+    size_t count;              /* 已登记的记录数 */
+    size_t capacity;
+    unsigned int *codes;       /* 每条记录的部门编号 */
+    IndexDeptEntry *depts;     /* 分区内部门字典,count为记录数 */
+    size_t dept_count;
+    size_t dept_capacity;
+    size_t *slots;             /* 部门名哈希: 编号+1, 0为空 */
+    size_t slot_count;         /* 2的幂,保持至少一半为空 */
+};
+
+#if defined(INDEX_FAULT_INJECTION)
+/*
+ * 故障注入(只在测试构建中定义INDEX_FAULT_INJECTION时编译): 此后第n次创建分区起失败,
+ * 0为恢复正常。并行加载的工作线程会同时创建分区,计数用原子操作
+ */
+static volatile long partial_create_armed = 0;
+static volatile long partial_create_budget = 0;
+
+void index_partial_fail_after(size_t n) {
+    atomic_long_store(&partial_create_budget, (long)n);
+    atomic_long_store(&partial_create_armed, (n > 0) ? 1 : 0);
+}
+#endif
+
+IndexPartial *index_partial_create(size_t first, size_t capacity) {
+#if defined(INDEX_FAULT_INJECTION)
+    if (atomic_long_load(&partial_create_armed) &&
+        atomic_long_add(&partial_create_budget, -1) <= 0) {
+        return NULL;
+    }
+#endif
+    IndexPartial *partial = (IndexPartial *)calloc(1, sizeof(IndexPartial));
+    if (partial == NULL) {
+        return NULL;
+    }
+    partial->first = first;
+    partial->capacity = capacity;
+    partial->dept_capacity = 16;
+    partial->slot_count = 32;
+    partial->codes = (unsigned int *)malloc((capacity > 0 ? capacity : 1) * sizeof(unsigned int));
+    partial->depts = (IndexDeptEntry *)malloc(partial->dept_capacity * sizeof(IndexDeptEntry));
+    partial->slots = (size_t *)calloc(partial->slot_count, sizeof(size_t));
+    if (partial->codes == NULL || partial->depts == NULL || partial->slots == NULL) {
+        index_partial_free(partial);
+        return NULL;
+    }
+    return partial;
+}
+
+void index_partial_free(IndexPartial *partial) {
+    if (partial != NULL) {
+        free(partial->codes);
+        free(partial->depts);
+        free(partial->slots);
+        free(partial);
+    }
+}
+
+/* 部门字典过半时加倍哈希表 */
+static Bool partial_grow_slots(IndexPartial *partial) {
+    size_t slot_count = partial->slot_count * 2;
+    size_t *slots = (size_t *)calloc(slot_count, sizeof(size_t));
+    if (slots == NULL) {
+        return FALSE;
+    }
+    for (size_t d = 0; d < partial->dept_count; d++) {
+        size_t pos = string_hash(partial->depts[d].name) & (slot_count - 1);
+        while (slots[pos] != 0) {
+            pos = (pos + 1) & (slot_count - 1);
+        }
+        slots[pos] = d + 1;
+    }
+    free(partial->slots);
+    partial->slots = slots;
+    partial->slot_count = slot_count;
+    return TRUE;
+}
+
+/* 查找部门的编号,不存在时加入字典 */
+static ErrorCode partial_lookup(IndexPartial *partial, const char *department, unsigned int *code) {
+    char name[MAX_DEPT_LEN];
+    memcpy(name, department, MAX_DEPT_LEN - 1);
+    name[MAX_DEPT_LEN - 1] = '\0';
+
+    size_t mask = partial->slot_count - 1;
+    size_t pos = string_hash(name) & mask;
+    while (partial->slots[pos] != 0 && strcmp(partial->depts[partial->slots[pos] - 1].name, name) != 0) {
+        pos = (pos + 1) & mask;
+    }
+    if (partial->slots[pos] != 0) {
+        *code = (unsigned int)(partial->slots[pos] - 1);
+        return SUCCESS;
+    }
+
+    if (partial->dept_count == partial->dept_capacity) {
+        IndexDeptEntry *depts = (IndexDeptEntry *)realloc(
+            partial->depts, partial->dept_capacity * 2 * sizeof(IndexDeptEntry));
+        if (depts == NULL) {
+            return ERROR_OUT_OF_MEMORY;
+        }
+        partial->depts = depts;
+        partial->dept_capacity *= 2;
+    }
+    IndexDeptEntry *entry = &partial->depts[partial->dept_count];
+    memset(entry, 0, sizeof(IndexDeptEntry));
+    strcpy(entry->name, name);
+    partial->slots[pos] = ++partial->dept_count;
+    *code = (unsigned int)(partial->dept_count - 1);
+    if (partial->dept_count * 2 >= partial->slot_count && !partial_grow_slots(partial)) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    return SUCCESS;
+}
+
+ErrorCode index_partial_add(IndexPartial *partial, const char *department) {
+    if (partial == NULL || department == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    if (partial->count == partial->capacity) {
+        return ERROR_INDEX_OUT_OF_BOUNDS;
+    }
+
+    unsigned int code = 0;
+    ErrorCode err = partial_lookup(partial, department, &code);
+    if (err != SUCCESS) {
+        return err;
+    }
+    partial->codes[partial->count++] = code;
+    partial->depts[code].count++;
+    return SUCCESS;
+}
+
+/*
+ * 合并各分区的部门字典: 分区部门依次映射为全局编号并累计记录数,前缀和得到每个部门
+ * 的起始下标;各分区按位置顺序填入,保证每段内位置升序;最后按部门名排序
+ */
+static Bool merge_department_postings(EmployeeIndex *index, IndexPartial *const *partials,
+                                      size_t partial_count) {
+    size_t n = index->record_count;
+    IndexPartial *global = index_partial_create(0, 0);  /* 只使用其部门字典 */
+    unsigned int **maps = (unsigned int **)calloc(partial_count + 1, sizeof(unsigned int *));
+    index->postings = (unsigned int *)malloc((n > 0 ? n : 1) * sizeof(unsigned int));
+    Bool ok = (global != NULL && maps != NULL && index->postings != NULL) ? TRUE : FALSE;
+
+    for (size_t p = 0; ok && p < partial_count; p++) {
+        const IndexPartial *partial = partials[p];
+        maps[p] = (unsigned int *)malloc((partial->dept_count + 1) * sizeof(unsigned int));
+        ok = (maps[p] != NULL) ? TRUE : FALSE;
+        for (size_t d = 0; ok && d < partial->dept_count; d++) {
+            ok = (partial_lookup(global, partial->depts[d].name, &maps[p][d]) == SUCCESS) ? TRUE : FALSE;
+            if (ok) {
+                global->depts[maps[p][d]].count += partial->depts[d].count;
+            }
+        }
+    }
+
+    if (ok) {
+        unsigned int first = 0;
+        for (size_t d = 0; d < global->dept_count; d++) {
+            global->depts[d].first = first;
+            first += global->depts[d].count;
+            global->depts[d].count = 0;
+        }
+        for (size_t p = 0; p < partial_count; p++) {
+            const IndexPartial *partial = partials[p];
+            for (size_t i = 0; i < partial->count; i++) {
+                IndexDeptEntry *entry = &global->depts[maps[p][partial->codes[i]]];
+                index->postings[entry->first + entry->count++] = (unsigned int)(partial->first + i);
+            }
+        }
+        qsort(global->depts, global->dept_count, sizeof(IndexDeptEntry), compare_dept_entry);
+        index->depts = global->depts;
+        index->dept_count = global->dept_count;
+        global->depts = NULL;
+    }
+
+    for (size_t p = 0; maps != NULL && p < partial_count; p++) {
+        free(maps[p]);
+    }
+    free(maps);
+    index_partial_free(global);
+    return ok;
+}
+
+/* 分配并清空工号哈希槽(至少为记录数的两倍) */
+static Bool allocate_id_slots(EmployeeIndex *index) {
+    index->id_slot_count = 16;
+    while (index->id_slot_count < index->record_count * 2) {
+        index->id_slot_count *= 2;
+    }
+    index->id_slots = (IndexIdSlot *)malloc(index->id_slot_count * sizeof(IndexIdSlot));
+    if (index->id_slots == NULL) {
+        return FALSE;
+    }
+    for (size_t i = 0; i < index->id_slot_count; i++) {
+        index->id_slots[i].id = 0;
+        index->id_slots[i].position = INDEX_EMPTY_POSITION;
+    }
+    return TRUE;
+}
+
+EmployeeIndex *employee_index_build(const EmployeeView *view) {
+    if (view == NULL || view->size >= INDEX_EMPTY_POSITION) {
+        return NULL;
+    }
+
+    EmployeeIndex *index = (EmployeeIndex *)calloc(1, sizeof(EmployeeIndex));
+    if (index == NULL) {
+        return NULL;
+    }
+    index->version = view->version;
+    index->record_count = view->size;
+    IndexPartial *partial = index_partial_create(0, view->size);
+    Bool ok = (partial != NULL && allocate_id_slots(index)) ? TRUE : FALSE;
+
+    unsigned int position = 0;
+    size_t span_count = employee_view_span_count(view);
+    for (size_t s = 0; ok && s < span_count; s++) {
+        Employee *const *records = NULL;
+        size_t count = employee_view_span(view, s, &records);
+        for (size_t i = 0; ok && i < count; i++, position++) {
+            id_slots_insert(index->id_slots, index->id_slot_count, records[i]->id, position);
+            ok = (index_partial_add(partial, records[i]->department) == SUCCESS) ? TRUE : FALSE;
+        }
+    }
+
+    ok = ok && merge_department_postings(index, &partial, 1);
+    index_partial_free(partial);
+    if (!ok) {
+        employee_index_free(index);
+        return NULL;
+    }
+    return index;
+}
+
+EmployeeIndex *employee_index_merge(IndexPartial *const *partials, size_t partial_count,
+                                    Employee *const *records, size_t record_count,
+                                    unsigned long version) {
+    if (partials == NULL || (records == NULL && record_count > 0) ||
+        record_count >= INDEX_EMPTY_POSITION) {
+        return NULL;
+    }
+    /* 分区须首尾相接覆盖全部位置 */
+    size_t covered = 0;
+    for (size_t p = 0; p < partial_count; p++) {
+        if (partials[p] == NULL || partials[p]->first != covered) {
+            return NULL;
+        }
+        covered += partials[p]->count;
+    }
+    if (covered != record_count) {
+        return NULL;
+    }
+
+    EmployeeIndex *index = (EmployeeIndex *)calloc(1, sizeof(EmployeeIndex));
+    if (index == NULL) {
+        return NULL;
+    }
+    index->version = version;
+    index->record_count = record_count;
+    if (!allocate_id_slots(index) || !merge_department_postings(index, partials, partial_count)) {
+        employee_index_free(index);
+        return NULL;
+    }
+    for (size_t i = 0; i < record_count; i++) {
+        id_slots_insert(index->id_slots, index->id_slot_count, records[i]->id, (unsigned int)i);
+    }
+    return index;
+}
+
+EmployeeIndex *employee_index_from_sections(size_t record_count,
+                                            IndexIdSlot *id_slots, size_t id_slot_count,
+                                            IndexDeptEntry *depts, size_t dept_count,
+                                            unsigned int *postings) {
+    EmployeeIndex *index = (EmployeeIndex *)calloc(1, sizeof(EmployeeIndex));
+    if (index == NULL) {
+        free(id_slots);
+        free(depts);
+        free(postings);
+        return NULL;
+    }
+    index->record_count = record_count;
+    index->id_slots = id_slots;
+    index->id_slot_count = id_slot_count;
+    index->depts = depts;
+    index->dept_count = dept_count;
+    index->postings = postings;
+
+    Bool ok = (record_count < INDEX_EMPTY_POSITION && id_slot_count >= record_count &&
+               id_slot_count > 0 && (id_slot_count & (id_slot_count - 1)) == 0 &&
+               id_slots != NULL && (postings != NULL || record_count == 0)) ? TRUE : FALSE;
+    size_t used = 0;
+    for (size_t i = 0; ok && i < id_slot_count; i++) {
+        if (id_slots[i].position != INDEX_EMPTY_POSITION) {
+            used++;
+            ok = (id_slots[i].position < record_count) ? TRUE : FALSE;
+        }
+    }
+    ok = (ok && used == record_count && used < id_slot_count) ? TRUE : FALSE;
+
+    size_t covered = 0;
+    for (size_t d = 0; ok && d < dept_count; d++) {
+        IndexDeptEntry *entry = &depts[d];
+        ok = (memchr(entry->name, '\0', MAX_DEPT_LEN) != NULL &&
+              (size_t)entry->first + entry->count <= record_count &&
+              (d == 0 || strcmp(depts[d - 1].name, entry->name) < 0)) ? TRUE : FALSE;
+        covered += entry->count;
+    }
+    for (size_t i = 0; ok && i < record_count; i++) {
+        ok = (postings[i] < record_count) ? TRUE : FALSE;
+    }
+    if (!ok || covered != record_count) {
+        employee_index_free(index);
+        return NULL;
+    }
+    return index;
+}
+
+void employee_index_free(EmployeeIndex *index) {
+    if (index != NULL) {
+        free(index->id_slots);
+        free(index->depts);
+        free(index->postings);
+        free(index);
+    }
+}
+
+size_t employee_index_find_id(const EmployeeIndex *index, int id,
+                              unsigned int *positions, size_t max_positions) {
+    if (index == NULL || index->id_slot_count == 0) {
+        return 0;
+    }
+
+    size_t found = 0;
+    size_t mask = index->id_slot_count - 1;
+    for (size_t pos = id_hash(id) & mask;
+         index->id_slots[pos].position != INDEX_EMPTY_POSITION; pos = (pos + 1) & mask) {
+        if (index->id_slots[pos].id == id) {
+            if (positions != NULL && found < max_positions) {
+                positions[found] = index->id_slots[pos].position;
+            }
+            found++;
+        }
+    }
+    return found;
+}
+
+const unsigned int *employee_index_find_department(const EmployeeIndex *index,
+                                                   const char *department, size_t *count) {
+    if (count != NULL) {
+        *count = 0;
+    }
+    if (index == NULL || department == NULL || count == NULL) {
+        return NULL;
+    }
+
+    size_t lo = 0;
+    size_t hi = index->dept_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(index->depts[mid].name, department);
+        if (cmp == 0) {
+            *count = index->depts[mid].count;
+            return index->postings + index->depts[mid].first;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
+/* ========== 姓名索引 ========== */
+
+static int compare_u64(const void *a, const void *b) {
+    unsigned long long x = *(const unsigned long long *)a;
+    unsigned long long y = *(const unsigned long long *)b;
+    return (x < y) ? -1 : (x > y) ? 1 : 0;
+}
+
+static unsigned int gram_at(const char *p) {
+    return ((unsigned int)(unsigned char)p[0] << 16) | ((unsigned int)(unsigned char)p[1] << 8) |
+           (unsigned int)(unsigned char)p[2];
+}
+
+static size_t name_length(const char *name) {
+    size_t length = 0;
+    while (length < MAX_NAME_LEN && name[length] != '\0') {
+        length++;
+    }
+    return length;
+}
+
+NameIndex *name_index_build(const EmployeeView *view) {
+    if (view == NULL || view->size >= INDEX_EMPTY_POSITION) {
+        return NULL;
+    }
+    NameIndex *index = (NameIndex *)calloc(1, sizeof(NameIndex));
+    if (index == NULL) {
+        return NULL;
+    }
+    index->version = view->version;
+    index->record_count = view->size;
+
+    /* 先收集(字节组, 位置)对,排序后相同字节组相邻、位置升序,同一记录内重复的字节组相邻 */
+    size_t total = 0;
+    size_t span_count = employee_view_span_count(view);
+    for (size_t s = 0; s < span_count; s++) {
+        Employee *const *records = NULL;
+        size_t count = employee_view_span(view, s, &records);
+        for (size_t i = 0; i < count; i++) {
+            size_t length = name_length(records[i]->name);
+            total += (length >= NAME_INDEX_GRAM_LEN) ? length - NAME_INDEX_GRAM_LEN + 1 : 0;
+        }
+    }
+    unsigned long long *pairs = (unsigned long long *)malloc((total > 0 ? total : 1) * sizeof(unsigned long long));
+    if (pairs == NULL) {
+        name_index_free(index);
+        return NULL;
+    }
+    size_t pair_count = 0;
+    unsigned int position = 0;
+    for (size_t s = 0; s < span_count; s++) {
+        Employee *const *records = NULL;
+        size_t count = employee_view_span(view, s, &records);
+        for (size_t i = 0; i < count; i++, position++) {
+            const char *name = records[i]->name;
+            size_t length = name_length(name);
+            for (size_t j = 0; j + NAME_INDEX_GRAM_LEN <= length; j++) {
+                pairs[pair_count++] = ((unsigned long long)gram_at(name + j) << 32) | position;
+            }
+        }
+    }
+    qsort(pairs, pair_count, sizeof(unsigned long long), compare_u64);
+
+    /* 去重后生成倒排 */
+    size_t unique = 0;
+    size_t gram_count = 0;
+    for (size_t i = 0; i < pair_count; i++) {
+        if (i == 0 || pairs[i] != pairs[i - 1]) {
+            if (i == 0 || (pairs[i] >> 32) != (pairs[unique - 1] >> 32)) {
+                gram_count++;
+            }
+            pairs[unique++] = pairs[i];
+        }
+    }
+    index->grams = (IndexGramEntry *)malloc((gram_count > 0 ? gram_count : 1) * sizeof(IndexGramEntry));
+    index->postings = (unsigned int *)malloc((unique > 0 ? unique : 1) * sizeof(unsigned int));
+    if (index->grams == NULL || index->postings == NULL) {
+        free(pairs);
+        name_index_free(index);
+        return NULL;
+    }
+    for (size_t i = 0; i < unique; i++) {
+        unsigned int gram = (unsigned int)(pairs[i] >> 32);
+        if (index->gram_count == 0 || index->grams[index->gram_count - 1].gram != gram) {
+            IndexGramEntry *entry = &index->grams[index->gram_count++];
+            entry->gram = gram;
+            entry->first = (unsigned int)i;
+            entry->count = 0;
+        }
+        index->grams[index->gram_count - 1].count++;
+        index->postings[i] = (unsigned int)(pairs[i] & 0xFFFFFFFFu);
+    }
+    free(pairs);
+    return index;
+}
+
+void name_index_free(NameIndex *index) {
+    if (index != NULL) {
+        free(index->grams);
+        free(index->postings);
+        free(index);
+    }
+}
+
+static const IndexGramEntry *find_gram(const NameIndex *index, unsigned int gram) {
+    size_t lo = 0;
+    size_t hi = index->gram_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (index->grams[mid].gram == gram) {
+            return &index->grams[mid];
+        }
+        if (index->grams[mid].gram < gram) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
+Bool name_index_candidates(const NameIndex *index, const char *keyword,
+                           const unsigned int **positions, size_t *count) {
+    if (index == NULL || keyword == NULL || positions == NULL || count == NULL) {
+        return FALSE;
+    }
+    size_t length = strlen(keyword);
+    if (length < NAME_INDEX_GRAM_LEN) {
+        return FALSE;
+    }
+
+    const IndexGramEntry *best = NULL;
+    for (size_t j = 0; j + NAME_INDEX_GRAM_LEN <= length; j++) {
+        const IndexGramEntry *entry = find_gram(index, gram_at(keyword + j));
+        if (entry == NULL) {
+            *positions = NULL;
+            *count = 0;
+            return TRUE;
+        }
+        if (best == NULL || entry->count < best->count) {
+            best = entry;
+        }
+    }
+    *positions = index->postings + best->first;
+    *count = best->count;
+    return TRUE;
+}
+
+/* ========== 出勤汇总 ========== */
+
+/* 把一条记录的出勤天数计入其日期前缀,前缀表按key有序插入(月份数很少) */
+static Bool date_aggregate_add(DateAggregate *aggregate, const char *date, int days) {
+    char key[DATE_AGGREGATE_KEY_LEN + 1];
+    size_t length = 0;
+    while (length < DATE_AGGREGATE_KEY_LEN && length < MAX_DATE_LEN && date[length] != '\0') {
+        key[length] = date[length];
+        length++;
+    }
+    key[length] = '\0';
+
+    size_t lo = 0;
+    size_t hi = aggregate->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(aggregate->entries[mid].key, key);
+        if (cmp == 0) {
+            aggregate->entries[mid].days += days;
+            return TRUE;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (aggregate->count == aggregate->capacity) {
+        size_t capacity = (aggregate->capacity > 0) ? aggregate->capacity * 2 : 64;
+        DateAggregateEntry *grown = (DateAggregateEntry *)realloc(aggregate->entries,
+                                                                   capacity * sizeof(DateAggregateEntry));
+        if (grown == NULL) {
+            return FALSE;
+        }
+        aggregate->entries = grown;
+        aggregate->capacity = capacity;
+    }
+    memmove(&aggregate->entries[lo + 1], &aggregate->entries[lo],
+            (aggregate->count - lo) * sizeof(DateAggregateEntry));
+    memcpy(aggregate->entries[lo].key, key, length + 1);
+    aggregate->entries[lo].days = days;
+    aggregate->count++;
+    return TRUE;
+}
+
+DateAggregate *date_aggregate_build(const EmployeeView *view) {
+    if (view == NULL) {
+        return NULL;
+    }
+    DateAggregate *aggregate = (DateAggregate *)calloc(1, sizeof(DateAggregate));
+    if (aggregate == NULL) {
+        return NULL;
+    }
+    aggregate->version = view->version;
+    aggregate->record_count = view->size;
+
+    Bool ok = TRUE;
+    size_t span_count = employee_view_span_count(view);
+    for (size_t s = 0; ok && s < span_count; s++) {
+        Employee *const *records = NULL;
+        size_t count = employee_view_span(view, s, &records);
+        for (size_t i = 0; ok && i < count; i++) {
+            ok = date_aggregate_add(aggregate, records[i]->attend_date, records[i]->attend_days);
+        }
+    }
+    if (!ok) {
+        date_aggregate_free(aggregate);
+        return NULL;
+    }
+    return aggregate;
+}
+
+void date_aggregate_free(DateAggregate *aggregate) {
+    if (aggregate != NULL) {
+        free(aggregate->entries);
+        free(aggregate);
+    }
+}
+
+Bool date_aggregate_sum(const DateAggregate *aggregate, const char *prefix, long long *total) {
+    if (aggregate == NULL || prefix == NULL || total == NULL) {
+        return FALSE;
+    }
+    size_t length = strlen(prefix);
+    if (length > DATE_AGGREGATE_KEY_LEN) {
+        return FALSE;
+    }
+    /* key是日期的前缀,长度不超过7时strncmp(key)与strncmp(日期)结果相同 */
+    long long sum = 0;
+    for (size_t i = 0; i < aggregate->count; i++) {
+        if (strncmp(aggregate->entries[i].key, prefix, length) == 0) {
+            sum += aggregate->entries[i].days;
+        }
+    }
+    *total = sum;
+    return TRUE;
+}
@@ -0,0 +1,143 @@
+#ifndef INDEX_H
+#define INDEX_H
+
+#include "common.h"
+#include "model.h"
+
+/*
+ * 职工索引: 工号哈希 + 部门倒排表
+ * 索引中的位置是某个视图版本中的全局下标,只对构建时的version有效;
+ * 任何修改都会使管理器的修改代数前进,旧索引随之失效。
+ * 构建后只读,可随v2数据文件持久化,加载时直接读入而无需重建。
+ */
+
+/* 空槽标记 */
+#define INDEX_EMPTY_POSITION 0xFFFFFFFFu
+
+/* 工号哈希槽 */
+PACK_PUSH
+typedef struct {
+    int id;                 /* 工号 */
+    unsigned int position;  /* 记录位置, INDEX_EMPTY_POSITION表示空槽 */
+} IndexIdSlot;
+PACK_POP
+
+/* 部门倒排项: 按部门名排序,指向postings中的一段升序位置 */
+PACK_PUSH
+typedef struct {
+    char name[MAX_DEPT_LEN];  /* 部门名 */
+    unsigned int first;       /* 在postings中的起始下标 */
+    unsigned int count;       /* 该部门的记录数 */
+} IndexDeptEntry;
+PACK_POP
+
+typedef struct EmployeeIndex {
+    unsigned long version;     /* 对应的视图版本(修改代数) */
+    size_t record_count;       /* 构建时的记录数 */
+    IndexIdSlot *id_slots;     /* 工号哈希槽(线性探测) */
+    size_t id_slot_count;      /* 槽数(2的幂) */
+    IndexDeptEntry *depts;     /* 部门倒排项 */
+    size_t dept_count;         /* 部门数 */
+    unsigned int *postings;    /* 按部门分组的记录位置,共record_count个 */
+} EmployeeIndex;
+
+/* 基于视图构建索引,记录数超过32位位置范围时返回NULL */
+EmployeeIndex *employee_index_build(const EmployeeView *view);
+
+/*
+ * 由持久化的各段数组组装索引(接管所有数组,失败时一并释放),
+ * 校验槽数为2的幂、所有位置不越界、倒排区间互不越界
+ */
+EmployeeIndex *employee_index_from_sections(size_t record_count,
+                                            IndexIdSlot *id_slots, size_t id_slot_count,
+                                            IndexDeptEntry *depts, size_t dept_count,
+                                            unsigned int *postings);
+
+void employee_index_free(EmployeeIndex *index);
+
+/*
+ * 分区并行构建: 每个线程负责一段连续位置,先在分区内把部门名编码为分区字典的编号;
+ * 全部完成后employee_index_merge按位置顺序合并各分区字典,生成倒排与工号哈希
+ */
+typedef struct IndexPartial IndexPartial;
+
+/* 创建分区: 负责从first开始的至多capacity条记录 */
+IndexPartial *index_partial_create(size_t first, size_t capacity);
+void index_partial_free(IndexPartial *partial);
+
+/* 按位置顺序登记下一条记录的部门 */
+ErrorCode index_partial_add(IndexPartial *partial, const char *department);
+
+/*
+ * 合并分区构建索引: 各分区须依次首尾相接覆盖[0, record_count),
+ * records为全部记录(用于工号哈希);分区不被释放
+ */
+EmployeeIndex *employee_index_merge(IndexPartial *const *partials, size_t partial_count,
+                                    Employee *const *records, size_t record_count,
+                                    unsigned long version);
+
+/* 按工号查找,依次把位置(升序)写入positions,返回匹配总数 */
+size_t employee_index_find_id(const EmployeeIndex *index, int id,
+                              unsigned int *positions, size_t max_positions);
+
+/* 按部门查找,返回该部门的升序位置数组及数量,不存在返回NULL */
+const unsigned int *employee_index_find_department(const EmployeeIndex *index,
+                                                   const char *department, size_t *count);
+
+/*
+ * 姓名索引: 姓名中每个连续3字节组(UTF-8下即一个汉字)的倒排表,只在内存中构建。
+ * 子串查询取关键字中倒排最短的字节组,候选位置再逐条确认
+ */
+#define NAME_INDEX_GRAM_LEN 3
+
+/* 字节组倒排项: 按gram升序,指向postings中的一段升序位置 */
+typedef struct {
+    unsigned int gram;   /* 3个字节拼成的整数 */
+    unsigned int first;  /* 在postings中的起始下标 */
+    unsigned int count;  /* 含该字节组的记录数 */
+} IndexGramEntry;
+
+typedef struct NameIndex {
+    unsigned long version;     /* 对应的视图版本 */
+    size_t record_count;       /* 构建时的记录数 */
+    IndexGramEntry *grams;     /* 字节组倒排项 */
+    size_t gram_count;
+    unsigned int *postings;    /* 按字节组分组的记录位置 */
+} NameIndex;
+
+NameIndex *name_index_build(const EmployeeView *view);
+void name_index_free(NameIndex *index);
+
+/*
+ * 子串查询的候选位置(升序,须逐条确认): 关键字不足NAME_INDEX_GRAM_LEN字节时返回FALSE,
+ * 表示索引不适用;某个字节组不存在时count为0
+ */
+Bool name_index_candidates(const NameIndex *index, const char *keyword,
+                           const unsigned int **positions, size_t *count);
+
+/* 出勤汇总: 按出勤日期的前7个字符("YYYY-MM")累计出勤天数,只在内存中构建 */
+#define DATE_AGGREGATE_KEY_LEN 7
+
+typedef struct {
+    char key[DATE_AGGREGATE_KEY_LEN + 1];  /* 日期前缀(日期不足7个字符时为整个日期) */
+    long long days;                        /* 出勤天数之和 */
+} DateAggregateEntry;
+
+typedef struct DateAggregate {
+    unsigned long version;         /* 对应的视图版本 */
+    size_t record_count;           /* 构建时的记录数 */
+    DateAggregateEntry *entries;   /* 按key升序 */
+    size_t count;
+    size_t capacity;
+} DateAggregate;
+
+DateAggregate *date_aggregate_build(const EmployeeView *view);
+void date_aggregate_free(DateAggregate *aggregate);
+
+/*
+ * 出勤日期以prefix开头的出勤天数之和,结果与逐条strncmp比较相同;
+ * prefix超过DATE_AGGREGATE_KEY_LEN个字符时返回FALSE
+ */
+Bool date_aggregate_sum(const DateAggregate *aggregate, const char *prefix, long long *total);
+
+#endif /* INDEX_H */
@@ -0,0 +1,201 @@
+#include "indexer.h"
+#include "index.h"
+#include "thread.h"
+#include <stdlib.h>
+
+struct BackgroundIndexer {
+    Thread *thread;               /* 构建线程 */
+    Mutex *lock;                  /* 保护以下字段 */
+    CondVar *cond;                /* 有新请求/请求完成/停止时广播 */
+    EmployeeSnapshot *pending;    /* 排队中的快照(只保留最新一个) */
+    unsigned int pending_kinds;   /* 排队请求要构建的种类 */
+    Bool running;                 /* 构建线程正在工作 */
+    Bool stopping;                /* 要求构建线程退出 */
+    ErrorCode last_error;         /* 最近一次构建的结果 */
+};
+
+/* 当前发布的版本 */
+static unsigned long current_version(EmployeeManager *manager) {
+    EmployeeView view;
+    employee_manager_view_begin(manager, &view);
+    unsigned long version = view.version;
+    employee_manager_view_end(manager, &view);
+    return version;
+}
+
+/* 从快照构建一种索引并附加,内存不足时返回错误 */
+static ErrorCode build_stage(EmployeeSnapshot *snapshot, IndexKind kind) {
+    EmployeeManager *manager = snapshot->manager;
+    if (kind == INDEX_KIND_PRIMARY) {
+        EmployeeIndex *index = employee_index_build(&snapshot->view);
+        return (index != NULL) ? employee_manager_attach_index(manager, index) : ERROR_OUT_OF_MEMORY;
+    }
+    if (kind == INDEX_KIND_NAME) {
+        NameIndex *index = name_index_build(&snapshot->view);
+        return (index != NULL) ? employee_manager_attach_name_index(manager, index) : ERROR_OUT_OF_MEMORY;
+    }
+    DateAggregate *aggregate = date_aggregate_build(&snapshot->view);
+    return (aggregate != NULL) ? employee_manager_attach_date_aggregate(manager, aggregate)
+                               : ERROR_OUT_OF_MEMORY;
+}
+
+/* 按顺序构建请求的各种索引;快照已过时(管理器又被修改)或要求停止时放弃剩余种类 */
+static ErrorCode build_all(BackgroundIndexer *indexer, EmployeeSnapshot *snapshot, unsigned int kinds) {
+    ErrorCode result = SUCCESS;
+    for (int kind = 0; kind < INDEX_KIND_COUNT; kind++) {
+        if ((kinds & (1u << kind)) == 0) {
+            continue;
+        }
+
+        mutex_lock(indexer->lock);
+        Bool stopping = indexer->stopping;
+        mutex_unlock(indexer->lock);
+        if (stopping || current_version(snapshot->manager) != snapshot->version) {
+            break;
+        }
+        if (employee_manager_index_ready(snapshot->manager, (IndexKind)kind)) {
+            continue;
+        }
+
+        ErrorCode err = build_stage(snapshot, (IndexKind)kind);
+        if (err != SUCCESS) {
+            result = err;
+        }
+    }
+    return result;
+}
+
+/* 构建线程: 逐个取出排队的快照构建 */
+static void indexer_thread_main(void *arg) {
+    BackgroundIndexer *indexer = (BackgroundIndexer *)arg;
+
+    mutex_lock(indexer->lock);
+    for (;;) {
+        while (indexer->pending == NULL && !indexer->stopping) {
+            cond_wait(indexer->cond, indexer->lock);
+        }
+        if (indexer->pending == NULL || indexer->stopping) {
+            break;
+        }
+
+        EmployeeSnapshot *snapshot = indexer->pending;
+        unsigned int kinds = indexer->pending_kinds;
+        indexer->pending = NULL;
+        indexer->pending_kinds = 0;
+        indexer->running = TRUE;
+        mutex_unlock(indexer->lock);
+
+        ErrorCode err = build_all(indexer, snapshot, kinds);
+        employee_snapshot_release(snapshot);
+
+        mutex_lock(indexer->lock);
+        indexer->running = FALSE;
+        indexer->last_error = err;
+        cond_broadcast(indexer->cond);
+    }
+    mutex_unlock(indexer->lock);
+}
+
+BackgroundIndexer *background_indexer_create(void) {
+    BackgroundIndexer *indexer = (BackgroundIndexer *)calloc(1, sizeof(BackgroundIndexer));
+    if (indexer == NULL) {
+        return NULL;
+    }
+
+    indexer->last_error = SUCCESS;
+    indexer->lock = mutex_create();
+    indexer->cond = cond_create();
+    if (indexer->lock == NULL || indexer->cond == NULL) {
+        mutex_free(indexer->lock);
+        cond_free(indexer->cond);
+        free(indexer);
+        return NULL;
+    }
+
+    indexer->thread = thread_create(indexer_thread_main, indexer);
+    if (indexer->thread == NULL) {
+        mutex_free(indexer->lock);
+        cond_free(indexer->cond);
+        free(indexer);
+        return NULL;
+    }
+    return indexer;
+}
+
+void background_indexer_free(BackgroundIndexer *indexer) {
+    if (indexer == NULL) {
+        return;
+    }
+
+    /* 索引可随时重建,排队的请求直接丢弃 */
+    mutex_lock(indexer->lock);
+    indexer->stopping = TRUE;
+    EmployeeSnapshot *pending = indexer->pending;
+    indexer->pending = NULL;
+    cond_broadcast(indexer->cond);
+    mutex_unlock(indexer->lock);
+
+    if (pending != NULL) {
+        employee_snapshot_release(pending);
+    }
+    thread_join(indexer->thread);
+    mutex_free(indexer->lock);
+    cond_free(indexer->cond);
+    free(indexer);
+}
+
+ErrorCode background_indexer_submit(BackgroundIndexer *indexer, EmployeeManager *manager,
+                                    unsigned int kinds) {
+    if (indexer == NULL || manager == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    if (!manager->concurrent) {
+        return ERROR_INVALID_PARAMETER;
+    }
+    if ((kinds & INDEX_KINDS_ALL) == 0) {
+        return SUCCESS;
+    }
+
+    EmployeeSnapshot *snapshot = employee_manager_snapshot(manager);
+    if (snapshot == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+
+    mutex_lock(indexer->lock);
+    EmployeeSnapshot *replaced = indexer->pending;
+    indexer->pending = snapshot;
+    indexer->pending_kinds |= kinds & INDEX_KINDS_ALL;
+    cond_broadcast(indexer->cond);
+    mutex_unlock(indexer->lock);
+
+    /* 被取代的旧请求尚未开始,其种类已并入新请求 */
+    if (replaced != NULL) {
+        employee_snapshot_release(replaced);
+    }
+    return SUCCESS;
+}
+
+Bool background_indexer_busy(BackgroundIndexer *indexer) {
+    if (indexer == NULL) {
+        return FALSE;
+    }
+
+    mutex_lock(indexer->lock);
+    Bool busy = (indexer->pending != NULL || indexer->running) ? TRUE : FALSE;
+    mutex_unlock(indexer->lock);
+    return busy;
+}
+
+ErrorCode background_indexer_wait(BackgroundIndexer *indexer) {
+    if (indexer == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    mutex_lock(indexer->lock);
+    while (indexer->pending != NULL || indexer->running) {
+        cond_wait(indexer->cond, indexer->lock);
+    }
+    ErrorCode err = indexer->last_error;
+    mutex_unlock(indexer->lock);
+    return err;
+}
@@ -0,0 +1,34 @@
+#ifndef INDEXER_H
+#define INDEXER_H
+
+#include "common.h"
+#include "model.h"
+
+/*
+ * 后台索引构建器
+ * 专用线程从快照依次构建各种索引(工号/部门、姓名、出勤汇总),每完成一种立即附加到管理器,
+ * 查询在对应索引就绪前照常走全表扫描,就绪后自动改用索引,提交方无需等待。
+ * 与当前版本一致的索引(如随数据文件读入的)不会重建;尚未开始的请求会被更新的请求取代。
+ * 构建器必须先于其引用的管理器释放。
+ */
+
+typedef struct BackgroundIndexer BackgroundIndexer;
+
+/* 创建/释放构建器,释放时放弃尚未开始的种类并等待进行中的一种完成 */
+BackgroundIndexer *background_indexer_create(void);
+void background_indexer_free(BackgroundIndexer *indexer);
+
+/*
+ * 为管理器当前状态创建快照,按kinds(INDEX_KIND_*对应位的组合)提交构建
+ * (管理器须已启用并发模式)
+ */
+ErrorCode background_indexer_submit(BackgroundIndexer *indexer, EmployeeManager *manager,
+                                    unsigned int kinds);
+
+/* 是否有排队或进行中的构建 */
+Bool background_indexer_busy(BackgroundIndexer *indexer);
+
+/* 阻塞直到所有已提交的构建完成,返回最后一次构建的结果 */
+ErrorCode background_indexer_wait(BackgroundIndexer *indexer);
+
+#endif /* INDEXER_H */
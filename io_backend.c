@@ -0,0 +1,649 @@
+/* 启用64位文件偏移(须在所有系统头文件之前定义) */
+#if !defined(_WIN32) && !defined(_FILE_OFFSET_BITS)
+    #define _FILE_OFFSET_BITS 64
+#endif
+
+#include "io_backend.h"
+#include "thread.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+    #include <windows.h>
+    #include <io.h>
+    #include <malloc.h>
+#else
+    #include <errno.h>
+    #include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+    #if __has_include(<linux/io_uring.h>)
+        #define IO_HAVE_URING 1
+    #endif
+#endif
+
+#if defined(IO_HAVE_URING)
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #include <sys/uio.h>
+#endif
+
+/* ========== 对齐缓冲区 ========== */
+
+static void *io_buffer_alloc(size_t size) {
+#if defined(_WIN32)
+    return _aligned_malloc(size, IO_BUFFER_ALIGN);
+#else
+    void *buffer = NULL;
+    return (posix_memalign(&buffer, IO_BUFFER_ALIGN, size) == 0) ? buffer : NULL;
+#endif
+}
+
+static void io_buffer_free(void *buffer) {
+#if defined(_WIN32)
+    _aligned_free(buffer);
+#else
+    free(buffer);
+#endif
+}
+
+/* 请求失败时的错误码 */
+static ErrorCode io_error(IoOp op) {
+    return (op == IO_OP_READ) ? ERROR_FILE_READ_FAILED : ERROR_FILE_WRITE_FAILED;
+}
+
+/* 按传输结果推进槽: n<0为失败,0为读到文件末尾;返回请求是否已结束 */
+static Bool io_slot_advance(IoSlot *slot, long long n) {
+    if (n < 0) {
+        slot->result = io_error(slot->op);
+        return TRUE;
+    }
+    if (n == 0) {
+        slot->result = (slot->op == IO_OP_READ) ? SUCCESS : ERROR_FILE_WRITE_FAILED;
+        return TRUE;
+    }
+    slot->done += (size_t)n;
+    if (slot->done >= slot->size) {
+        slot->result = SUCCESS;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/* ========== pread后端 ========== */
+
+/* 位置读写,不改变文件位置;返回传输字节数,失败返回-1 */
+static long long io_positional(int fd, IoOp op, void *data, size_t size, unsigned long long offset) {
+#if defined(_WIN32)
+    HANDLE handle = (HANDLE)_get_osfhandle(fd);
+    OVERLAPPED overlapped;
+    DWORD count = 0;
+    DWORD chunk = (size > 0x40000000u) ? 0x40000000u : (DWORD)size;
+    memset(&overlapped, 0, sizeof(overlapped));
+    overlapped.Offset = (DWORD)(offset & 0xFFFFFFFFu);
+    overlapped.OffsetHigh = (DWORD)(offset >> 32);
+    BOOL ok = (op == IO_OP_READ) ? ReadFile(handle, data, chunk, &count, &overlapped)
+                                 : WriteFile(handle, data, chunk, &count, &overlapped);
+    if (!ok) {
+        return (op == IO_OP_READ && GetLastError() == ERROR_HANDLE_EOF) ? 0 : -1;
+    }
+    return (long long)count;
+#else
+    ssize_t n;
+    do {
+        n = (op == IO_OP_READ) ? pread(fd, data, size, (off_t)offset)
+                               : pwrite(fd, data, size, (off_t)offset);
+    } while (n < 0 && errno == EINTR);
+    return (long long)n;
+#endif
+}
+
+/* 工作线程数上限 */
+#define IO_PREAD_MAX_THREADS 4
+
+typedef struct {
+    Mutex *lock;
+    CondVar *work;       /* 有新请求或关闭 */
+    CondVar *finished;   /* 有请求完成 */
+    size_t *pending;     /* 待执行的槽(环形队列,容量depth) */
+    size_t pending_head;
+    size_t pending_count;
+    size_t *completed;   /* 已完成未取走的槽(环形队列,容量depth) */
+    size_t completed_head;
+    size_t completed_count;
+    Thread *threads[IO_PREAD_MAX_THREADS];
+    size_t thread_count;
+    Bool stopping;
+} PreadState;
+
+static void pread_worker(void *arg) {
+    IoQueue *queue = (IoQueue *)arg;
+    PreadState *state = (PreadState *)queue->backend_data;
+
+    mutex_lock(state->lock);
+    for (;;) {
+        while (state->pending_count == 0 && !state->stopping) {
+            cond_wait(state->work, state->lock);
+        }
+        if (state->pending_count == 0) {
+            break;
+        }
+        size_t index = state->pending[state->pending_head];
+        state->pending_head = (state->pending_head + 1) % queue->depth;
+        state->pending_count--;
+        mutex_unlock(state->lock);
+
+        /* 槽在完成前只由本线程访问 */
+        IoSlot *slot = &queue->slots[index];
+        Bool done = FALSE;
+        while (!done) {
+            long long n = io_positional(queue->fd, slot->op, slot->buffer + slot->done,
+                                        slot->size - slot->done, slot->offset + slot->done);
+            done = io_slot_advance(slot, n);
+        }
+
+        mutex_lock(state->lock);
+        state->completed[(state->completed_head + state->completed_count) % queue->depth] = index;
+        state->completed_count++;
+        cond_signal(state->finished);
+    }
+    mutex_unlock(state->lock);
+}
+
+static void pread_close(IoQueue *queue) {
+    PreadState *state = (PreadState *)queue->backend_data;
+    if (state == NULL) {
+        return;
+    }
+    if (state->lock != NULL && state->work != NULL) {
+        mutex_lock(state->lock);
+        state->stopping = TRUE;
+        cond_broadcast(state->work);
+        mutex_unlock(state->lock);
+        for (size_t i = 0; i < state->thread_count; i++) {
+            thread_join(state->threads[i]);
+        }
+    }
+    cond_free(state->finished);
+    cond_free(state->work);
+    mutex_free(state->lock);
+    free(state->pending);
+    free(state->completed);
+    free(state);
+    queue->backend_data = NULL;
+}
+
+static ErrorCode pread_open(IoQueue *queue) {
+    PreadState *state = (PreadState *)calloc(1, sizeof(PreadState));
+    if (state == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    queue->backend_data = state;
+    state->lock = mutex_create();
+    state->work = cond_create();
+    state->finished = cond_create();
+    state->pending = (size_t *)malloc(queue->depth * sizeof(size_t));
+    state->completed = (size_t *)malloc(queue->depth * sizeof(size_t));
+    if (state->lock == NULL || state->work == NULL || state->finished == NULL ||
+        state->pending == NULL || state->completed == NULL) {
+        pread_close(queue);
+        return ERROR_OUT_OF_MEMORY;
+    }
+
+    size_t wanted = (queue->depth < IO_PREAD_MAX_THREADS) ? queue->depth : IO_PREAD_MAX_THREADS;
+    for (size_t i = 0; i < wanted; i++) {
+        state->threads[i] = thread_create(pread_worker, queue);
+        if (state->threads[i] == NULL) {
+            break;
+        }
+        state->thread_count++;
+    }
+    if (state->thread_count == 0) {
+        pread_close(queue);
+        return ERROR_OUT_OF_MEMORY;
+    }
+    return SUCCESS;
+}
+
+static ErrorCode pread_submit(IoQueue *queue, size_t slot) {
+    PreadState *state = (PreadState *)queue->backend_data;
+    mutex_lock(state->lock);
+    state->pending[(state->pending_head + state->pending_count) % queue->depth] = slot;
+    state->pending_count++;
+    cond_signal(state->work);
+    mutex_unlock(state->lock);
+    return SUCCESS;
+}
+
+static ErrorCode pread_reap(IoQueue *queue, size_t *slot) {
+    PreadState *state = (PreadState *)queue->backend_data;
+    mutex_lock(state->lock);
+    while (state->completed_count == 0) {
+        cond_wait(state->finished, state->lock);
+    }
+    *slot = state->completed[state->completed_head];
+    state->completed_head = (state->completed_head + 1) % queue->depth;
+    state->completed_count--;
+    mutex_unlock(state->lock);
+    return SUCCESS;
+}
+
+static const IoBackendInterface PREAD_BACKEND = {
+    "pread",
+    pread_open,
+    pread_submit,
+    pread_reap,
+    pread_close
+};
+
+const IoBackendInterface *io_backend_pread(void) {
+    return &PREAD_BACKEND;
+}
+
+/* ========== io_uring后端 ========== */
+
+#if defined(IO_HAVE_URING)
+
+static int uring_setup(unsigned entries, struct io_uring_params *params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int uring_enter(int fd, unsigned submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, submit, min_complete, flags, NULL, 0);
+}
+
+static int uring_register(int fd, unsigned opcode, const void *arg, unsigned count) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, count);
+}
+
+typedef struct {
+    int ring_fd;
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;            /* 与sq_ring共用一次映射时二者相同 */
+    size_t cq_ring_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+    unsigned *sq_tail;
+    unsigned sq_mask;
+    unsigned *sq_array;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe *cqes;
+    Bool fixed;               /* 缓冲区已注册为固定缓冲区 */
+} UringState;
+
+static void uring_close(IoQueue *queue) {
+    UringState *state = (UringState *)queue->backend_data;
+    if (state == NULL) {
+        return;
+    }
+    if (state->sqes != NULL) {
+        munmap(state->sqes, state->sqes_size);
+    }
+    if (state->cq_ring != NULL && state->cq_ring != state->sq_ring) {
+        munmap(state->cq_ring, state->cq_ring_size);
+    }
+    if (state->sq_ring != NULL) {
+        munmap(state->sq_ring, state->sq_ring_size);
+    }
+    if (state->ring_fd >= 0) {
+        close(state->ring_fd);  /* 关闭时内核同时注销固定缓冲区 */
+    }
+    free(state);
+    queue->backend_data = NULL;
+}
+
+static ErrorCode uring_open(IoQueue *queue) {
+    UringState *state = (UringState *)calloc(1, sizeof(UringState));
+    if (state == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    queue->backend_data = state;
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    state->ring_fd = uring_setup((unsigned)queue->depth, &params);
+    if (state->ring_fd < 0) {
+        uring_close(queue);
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    /* 映射提交环、完成环与SQE数组 */
+    state->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    state->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    Bool single = (params.features & IORING_FEAT_SINGLE_MMAP) ? TRUE : FALSE;
+    if (single && state->cq_ring_size > state->sq_ring_size) {
+        state->sq_ring_size = state->cq_ring_size;
+    }
+    void *sq = mmap(NULL, state->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    state->ring_fd, IORING_OFF_SQ_RING);
+    if (sq == MAP_FAILED) {
+        uring_close(queue);
+        return ERROR_OUT_OF_MEMORY;
+    }
+    state->sq_ring = sq;
+    if (single) {
+        state->cq_ring = sq;
+    } else {
+        void *cq = mmap(NULL, state->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        state->ring_fd, IORING_OFF_CQ_RING);
+        if (cq == MAP_FAILED) {
+            uring_close(queue);
+            return ERROR_OUT_OF_MEMORY;
+        }
+        state->cq_ring = cq;
+    }
+    state->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void *sqes = mmap(NULL, state->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      state->ring_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        uring_close(queue);
+        return ERROR_OUT_OF_MEMORY;
+    }
+    state->sqes = (struct io_uring_sqe *)sqes;
+
+    unsigned char *sq_base = (unsigned char *)state->sq_ring;
+    unsigned char *cq_base = (unsigned char *)state->cq_ring;
+    state->sq_tail = (unsigned *)(sq_base + params.sq_off.tail);
+    state->sq_mask = *(unsigned *)(sq_base + params.sq_off.ring_mask);
+    state->sq_array = (unsigned *)(sq_base + params.sq_off.array);
+    state->cq_head = (unsigned *)(cq_base + params.cq_off.head);
+    state->cq_tail = (unsigned *)(cq_base + params.cq_off.tail);
+    state->cq_mask = *(unsigned *)(cq_base + params.cq_off.ring_mask);
+    state->cqes = (struct io_uring_cqe *)(cq_base + params.cq_off.cqes);
+
+    /* 注册固定缓冲区,受RLIMIT_MEMLOCK限制失败时使用普通读写 */
+    struct iovec *iov = (struct iovec *)malloc(queue->depth * sizeof(struct iovec));
+    if (iov != NULL) {
+        for (size_t i = 0; i < queue->depth; i++) {
+            iov[i].iov_base = queue->slots[i].buffer;
+            iov[i].iov_len = queue->buffer_size;
+        }
+        state->fixed = (uring_register(state->ring_fd, IORING_REGISTER_BUFFERS, iov,
+                                       (unsigned)queue->depth) == 0) ? TRUE : FALSE;
+        free(iov);
+    }
+    return SUCCESS;
+}
+
+/* 填写SQE提交槽中剩余的部分 */
+static ErrorCode uring_submit(IoQueue *queue, size_t index) {
+    UringState *state = (UringState *)queue->backend_data;
+    IoSlot *slot = &queue->slots[index];
+
+    unsigned tail = *state->sq_tail;
+    unsigned entry = tail & state->sq_mask;
+    struct io_uring_sqe *sqe = &state->sqes[entry];
+    memset(sqe, 0, sizeof(*sqe));
+    if (state->fixed) {
+        sqe->opcode = (slot->op == IO_OP_READ) ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+        sqe->buf_index = (unsigned short)index;
+    } else {
+        sqe->opcode = (slot->op == IO_OP_READ) ? IORING_OP_READ : IORING_OP_WRITE;
+    }
+    sqe->fd = queue->fd;
+    sqe->off = slot->offset + slot->done;
+    sqe->addr = (unsigned long long)(unsigned long)(slot->buffer + slot->done);
+    sqe->len = (unsigned)(slot->size - slot->done);
+    sqe->user_data = index;
+    state->sq_array[entry] = entry;
+    __atomic_store_n(state->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    int ret;
+    do {
+        ret = uring_enter(state->ring_fd, 1, 0, 0);
+    } while (ret < 0 && errno == EINTR);
+    return (ret == 1) ? SUCCESS : io_error(slot->op);
+}
+
+/* 取一个完成事件;部分完成时续传剩余部分,直到某个请求结束 */
+static ErrorCode uring_reap(IoQueue *queue, size_t *slot) {
+    UringState *state = (UringState *)queue->backend_data;
+    for (;;) {
+        unsigned head = *state->cq_head;
+        if (head == __atomic_load_n(state->cq_tail, __ATOMIC_ACQUIRE)) {
+            int ret = uring_enter(state->ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+            if (ret < 0 && errno != EINTR) {
+                return ERROR_FILE_READ_FAILED;
+            }
+            continue;
+        }
+
+        struct io_uring_cqe *cqe = &state->cqes[head & state->cq_mask];
+        size_t index = (size_t)cqe->user_data;
+        int res = cqe->res;
+        __atomic_store_n(state->cq_head, head + 1, __ATOMIC_RELEASE);
+
+        IoSlot *io = &queue->slots[index];
+        if (!io_slot_advance(io, res)) {
+            if (uring_submit(queue, index) == SUCCESS) {
+                continue;
+            }
+            io->result = io_error(io->op);  /* 续传提交失败 */
+        }
+        *slot = index;
+        return SUCCESS;
+    }
+}
+
+static const IoBackendInterface URING_BACKEND = {
+    "io_uring",
+    uring_open,
+    uring_submit,
+    uring_reap,
+    uring_close
+};
+
+#endif /* IO_HAVE_URING */
+
+/* 探测结果: 0未探测,1可用,-1不可用 */
+static volatile long uring_probe_state = 0;
+
+const IoBackendInterface *io_backend_uring(void) {
+#if defined(IO_HAVE_URING)
+    long probe = atomic_long_load(&uring_probe_state);
+    if (probe == 0) {
+        struct io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        int fd = uring_setup(1, &params);
+        /* 需要IORING_OP_READ/WRITE,以同在5.6引入的IORING_FEAT_RW_CUR_POS为准 */
+        probe = (fd >= 0 && (params.features & IORING_FEAT_RW_CUR_POS)) ? 1 : -1;
+        if (fd >= 0) {
+            close(fd);
+        }
+        atomic_long_store(&uring_probe_state, probe);
+    }
+    return (probe > 0) ? &URING_BACKEND : NULL;
+#else
+    (void)uring_probe_state;
+    return NULL;
+#endif
+}
+
+const IoBackendInterface *io_backend_default(void) {
+    const IoBackendInterface *backend = io_backend_uring();
+    return (backend != NULL) ? backend : io_backend_pread();
+}
+
+/* ========== 队列 ========== */
+
+IoQueue *io_queue_create(const IoBackendInterface *backend, int fd, size_t depth,
+                         size_t buffer_size, ErrorCode *err) {
+    ErrorCode result = SUCCESS;
+    IoQueue *queue = NULL;
+    if (backend == NULL || fd < 0 || depth == 0 || buffer_size == 0) {
+        result = ERROR_INVALID_PARAMETER;
+    } else if ((queue = (IoQueue *)calloc(1, sizeof(IoQueue))) == NULL ||
+               (queue->slots = (IoSlot *)calloc(depth, sizeof(IoSlot))) == NULL) {
+        result = ERROR_OUT_OF_MEMORY;
+    } else {
+        queue->vptr = backend;
+        queue->fd = fd;
+        queue->depth = depth;
+        queue->buffer_size = (buffer_size + IO_BUFFER_ALIGN - 1) / IO_BUFFER_ALIGN * IO_BUFFER_ALIGN;
+        for (size_t i = 0; i < depth && result == SUCCESS; i++) {
+            queue->slots[i].buffer = (unsigned char *)io_buffer_alloc(queue->buffer_size);
+            if (queue->slots[i].buffer == NULL) {
+                result = ERROR_OUT_OF_MEMORY;
+            }
+        }
+        if (result == SUCCESS) {
+            result = backend->open(queue);
+            if (result != SUCCESS) {
+                queue->vptr = NULL;  /* 后端已自行清理 */
+            }
+        }
+    }
+
+    if (result != SUCCESS && queue != NULL) {
+        io_queue_free(queue);
+        queue = NULL;
+    }
+    if (err != NULL) {
+        *err = result;
+    }
+    return queue;
+}
+
+void io_queue_free(IoQueue *queue) {
+    if (queue == NULL) {
+        return;
+    }
+    if (queue->vptr != NULL) {
+        io_queue_drain(queue);
+        queue->vptr->close(queue);
+    }
+    if (queue->slots != NULL) {
+        for (size_t i = 0; i < queue->depth; i++) {
+            io_buffer_free(queue->slots[i].buffer);
+        }
+    }
+    free(queue->slots);
+    free(queue);
+}
+
+void *io_queue_buffer(IoQueue *queue, size_t slot) {
+    if (queue == NULL || slot >= queue->depth) {
+        return NULL;
+    }
+    return queue->slots[slot].buffer;
+}
+
+Bool io_queue_busy(const IoQueue *queue, size_t slot) {
+    if (queue == NULL || slot >= queue->depth) {
+        return FALSE;
+    }
+    return queue->slots[slot].busy;
+}
+
+ErrorCode io_queue_submit(IoQueue *queue, size_t slot, IoOp op,
+                          unsigned long long offset, size_t size) {
+    if (queue == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    if (slot >= queue->depth || size > queue->buffer_size || queue->slots[slot].busy) {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    IoSlot *io = &queue->slots[slot];
+    io->op = op;
+    io->offset = offset;
+    io->size = size;
+    io->done = 0;
+    io->result = SUCCESS;
+    io->finished = (size == 0) ? TRUE : FALSE;
+    io->busy = TRUE;
+    if (size == 0) {
+        return SUCCESS;
+    }
+
+    ErrorCode err = queue->vptr->submit(queue, slot);
+    if (err != SUCCESS) {
+        io->busy = FALSE;
+    }
+    return err;
+}
+
+ErrorCode io_queue_wait(IoQueue *queue, size_t slot, size_t *bytes) {
+    if (queue == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    if (slot >= queue->depth || !queue->slots[slot].busy) {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    /* 其他槽先完成时只记录结果,留给它们各自的io_queue_wait */
+    IoSlot *io = &queue->slots[slot];
+    while (!io->finished) {
+        size_t done_slot = 0;
+        ErrorCode err = queue->vptr->reap(queue, &done_slot);
+        if (err != SUCCESS) {
+            return err;
+        }
+        queue->slots[done_slot].finished = TRUE;
+    }
+
+    io->busy = FALSE;
+    if (bytes != NULL) {
+        *bytes = io->done;
+    }
+    return io->result;
+}
+
+ErrorCode io_queue_drain(IoQueue *queue) {
+    if (queue == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    ErrorCode first = SUCCESS;
+    for (size_t i = 0; i < queue->depth; i++) {
+        if (queue->slots[i].busy) {
+            ErrorCode err = io_queue_wait(queue, i, NULL);
+            if (first == SUCCESS) {
+                first = err;
+            }
+        }
+    }
+    return first;
+}
+
+ErrorCode io_read_at(int fd, void *buffer, size_t size, unsigned long long offset, size_t *bytes) {
+    if (buffer == NULL && size > 0) {
+        return ERROR_NULL_POINTER;
+    }
+    size_t done = 0;
+    while (done < size) {
+        long long n = io_positional(fd, IO_OP_READ, (unsigned char *)buffer + done, size - done,
+                                    offset + done);
+        if (n < 0) {
+            return ERROR_FILE_READ_FAILED;
+        }
+        if (n == 0) {
+            break;
+        }
+        done += (size_t)n;
+    }
+    if (bytes != NULL) {
+        *bytes = done;
+    }
+    return SUCCESS;
+}
+
+ErrorCode io_write_at(int fd, const void *buffer, size_t size, unsigned long long offset) {
+    if (buffer == NULL && size > 0) {
+        return ERROR_NULL_POINTER;
+    }
+    size_t done = 0;
+    while (done < size) {
+        long long n = io_positional(fd, IO_OP_WRITE, (unsigned char *)buffer + done, size - done,
+                                    offset + done);
+        if (n <= 0) {
+            return ERROR_FILE_WRITE_FAILED;
+        }
+        done += (size_t)n;
+    }
+    return SUCCESS;
+}
@@ -0,0 +1,96 @@
+#ifndef IO_BACKEND_H
+#define IO_BACKEND_H
+
+#include "common.h"
+
+/*
+ * 可替换的异步块I/O后端
+ * I/O队列拥有depth个对齐的缓冲区(槽),每个槽同一时刻最多一个在途请求。
+ * 提交后立即返回,调用方可在等待期间处理其他槽的数据(如计算校验和);
+ * io_queue_wait等待指定槽完成。读写都使用显式偏移,不改变文件位置。
+ *
+ * 后端:
+ *   io_uring - Linux下通过原始系统调用使用io_uring,缓冲区尽量注册为固定缓冲区
+ *   pread    - 可移植实现,工作线程执行pread/pwrite
+ * io_backend_default在运行时探测io_uring,不可用(内核过旧、被禁用)时退回pread
+ */
+
+/* 缓冲区对齐字节数(满足O_DIRECT的要求) */
+#define IO_BUFFER_ALIGN 4096
+
+typedef enum {
+    IO_OP_READ = 0,
+    IO_OP_WRITE = 1
+} IoOp;
+
+struct IoQueue;
+
+/* 后端接口 */
+typedef struct {
+    const char *name;                                        /* 后端名称 */
+    ErrorCode (*open)(struct IoQueue *queue);                /* 建立后端状态(环、线程等) */
+    ErrorCode (*submit)(struct IoQueue *queue, size_t slot); /* 提交槽中描述的请求 */
+    ErrorCode (*reap)(struct IoQueue *queue, size_t *slot);  /* 等待任一请求完成 */
+    void (*close)(struct IoQueue *queue);                    /* 释放后端状态(此时无在途请求) */
+} IoBackendInterface;
+
+/* 槽: 缓冲区与当前请求 */
+typedef struct {
+    unsigned char *buffer;       /* 对齐的缓冲区 */
+    IoOp op;                     /* 请求类型 */
+    unsigned long long offset;   /* 文件偏移 */
+    size_t size;                 /* 请求字节数 */
+    size_t done;                 /* 已完成字节数 */
+    ErrorCode result;            /* 完成结果 */
+    Bool busy;                   /* 已提交且尚未被io_queue_wait取走 */
+    Bool finished;               /* 后端已报告完成 */
+} IoSlot;
+
+/* I/O队列 */
+typedef struct IoQueue {
+    const IoBackendInterface *vptr;  /* 后端 */
+    int fd;                          /* 文件描述符(调用方负责关闭) */
+    size_t depth;                    /* 槽数 */
+    size_t buffer_size;              /* 每个槽的缓冲区字节数 */
+    IoSlot *slots;
+    void *backend_data;              /* 后端私有状态 */
+} IoQueue;
+
+/* 后端: io_uring不可用时返回NULL */
+const IoBackendInterface *io_backend_uring(void);
+const IoBackendInterface *io_backend_pread(void);
+const IoBackendInterface *io_backend_default(void);
+
+/* 创建队列: depth个槽,每槽buffer_size字节(向上取整到IO_BUFFER_ALIGN),err可为NULL */
+IoQueue *io_queue_create(const IoBackendInterface *backend, int fd, size_t depth,
+                         size_t buffer_size, ErrorCode *err);
+
+/* 等待所有在途请求后释放 */
+void io_queue_free(IoQueue *queue);
+
+/* 槽的缓冲区 */
+void *io_queue_buffer(IoQueue *queue, size_t slot);
+
+/* 槽是否有未取走的请求 */
+Bool io_queue_busy(const IoQueue *queue, size_t slot);
+
+/* 提交请求: 槽必须空闲,size不超过缓冲区大小 */
+ErrorCode io_queue_submit(IoQueue *queue, size_t slot, IoOp op,
+                          unsigned long long offset, size_t size);
+
+/*
+ * 等待槽的请求完成并取走结果,bytes返回实际传输的字节数(可为NULL)。
+ * 读到文件末尾时bytes小于请求大小,结果仍为SUCCESS
+ */
+ErrorCode io_queue_wait(IoQueue *queue, size_t slot, size_t *bytes);
+
+/* 等待所有在途请求,返回第一个错误 */
+ErrorCode io_queue_drain(IoQueue *queue);
+
+/* 同步位置读(不改变文件位置): 读满size字节或到文件末尾,bytes返回实际读取的字节数 */
+ErrorCode io_read_at(int fd, void *buffer, size_t size, unsigned long long offset, size_t *bytes);
+
+/* 同步位置写(不改变文件位置): 写满size字节 */
+ErrorCode io_write_at(int fd, const void *buffer, size_t size, unsigned long long offset);
+
+#endif /* IO_BACKEND_H */
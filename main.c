@@ -1,7 +1,17 @@
 #include "controller.h"
+#include "cli.h"
 #include <stdio.h>
 
-int main(void) {
+int main(int argc, char **argv) {
+    /* 带子命令时以无交互模式执行后退出(见cli.h) */
+    if (argc >= 2) {
+        if (!cli_is_command(argv[1])) {
+            cli_print_usage(stderr);
+            return CLI_EXIT_USAGE;
+        }
+        return cli_run(argc - 1, argv + 1, stdout, stderr);
+    }
+
     /* 创建控制器 */
     Controller *ctrl = controller_create("employees.db", "admin.auth");
     if (ctrl == NULL) {
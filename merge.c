@@ -0,0 +1,399 @@
+/* 启用64位文件偏移(须在所有系统头文件之前定义) */
+#if !defined(_WIN32) && !defined(_FILE_OFFSET_BITS)
+    #define _FILE_OFFSET_BITS 64
+#endif
+
+#include "merge.h"
+#include "external_sort.h"
+#include "storage.h"
+#include "storage_io.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 合并输入: 逐页读取一个按工号有序的v2文件 */
+typedef struct {
+    PagedStore *store;
+    size_t page;              /* 当前(或下一个要钉住的)页 */
+    PageHandle handle;
+    Bool pinned;
+    const Employee *records;  /* 当前页的记录 */
+    size_t count;             /* 当前页的记录数 */
+    size_t position;          /* 下一条记录在页内的下标 */
+} MergeCursor;
+
+/* 取下一条记录,读完或出错时返回NULL(出错时设置err);返回的指针在下次调用前有效 */
+static const Employee *merge_cursor_next(MergeCursor *cursor, ErrorCode *err) {
+    while (cursor->position >= cursor->count) {
+        if (cursor->pinned) {
+            storage_paged_unpin(cursor->store, &cursor->handle);
+            cursor->pinned = FALSE;
+            cursor->page++;
+        }
+        if (cursor->page >= storage_paged_page_count(cursor->store)) {
+            return NULL;
+        }
+        *err = storage_paged_pin(cursor->store, cursor->page, &cursor->handle);
+        if (*err != SUCCESS) {
+            return NULL;
+        }
+        cursor->pinned = TRUE;
+        cursor->count = storage_paged_page_records(&cursor->handle, &cursor->records);
+        cursor->position = 0;
+    }
+    return &cursor->records[cursor->position++];
+}
+
+static void merge_cursor_close(MergeCursor *cursor) {
+    if (cursor->pinned) {
+        storage_paged_unpin(cursor->store, &cursor->handle);
+        cursor->pinned = FALSE;
+    }
+    storage_paged_close(cursor->store);
+    cursor->store = NULL;
+}
+
+/* 预扫描: 检查输入是否按工号非降序,并求最大工号 */
+typedef struct {
+    int last_id;
+    int max_id;
+    size_t count;
+    Bool sorted;
+} MergeProbe;
+
+static Bool merge_probe_visit(void *ctx, const Employee *emp) {
+    MergeProbe *probe = (MergeProbe *)ctx;
+    if (probe->count > 0 && emp->id < probe->last_id) {
+        probe->sorted = FALSE;
+    }
+    if (probe->count == 0 || emp->id > probe->max_id) {
+        probe->max_id = emp->id;
+    }
+    probe->last_id = emp->id;
+    probe->count++;
+    return TRUE;
+}
+
+/* 同一工号已出现过的不同记录 */
+typedef struct {
+    Employee record;          /* 原记录 */
+    unsigned long long hash;  /* 内容哈希(不含工号) */
+    int output_id;            /* 写出时使用的工号 */
+} MergeSeen;
+
+typedef struct {
+    const char *output;
+    MergeCursor *cursors;
+    char **temp_paths;      /* 先经外部排序的输入的临时文件,其余为NULL */
+    size_t count;
+    int next_id;            /* 下一个可分配给冲突记录的工号 */
+    MergeSeen *seen;        /* 当前工号的记录,只保留一个工号的,内存与总记录数无关 */
+    size_t seen_count;
+    size_t seen_capacity;
+    V2Writer out;
+    FILE *remap;            /* 改号记录的临时文件"<output>.remap" */
+    char *remap_path;
+    AtomicFile id_map;      /* 工号对照表 */
+    Bool has_id_map;
+    MergeStats stats;
+} MergeState;
+
+/* 临时文件名"<output><suffix>",由调用方释放 */
+static char *merge_temp_path(const char *output, const char *suffix) {
+    size_t length = strlen(output) + strlen(suffix) + 1;
+    char *path = (char *)malloc(length);
+    if (path != NULL) {
+        snprintf(path, length, "%s%s", output, suffix);
+    }
+    return path;
+}
+
+/* 字符串字段按实际长度参与哈希,长度一并计入以区分字段边界 */
+static unsigned long long merge_hash_string(unsigned long long hash, const char *str, size_t capacity) {
+    size_t length = 0;
+    while (length < capacity && str[length] != '\0') {
+        length++;
+    }
+    hash = fnv64_update(hash, &length, sizeof(length));
+    return fnv64_update(hash, str, length);
+}
+
+static unsigned long long merge_record_hash(const Employee *emp) {
+    unsigned long long hash = FNV64_INIT;
+    hash = merge_hash_string(hash, emp->name, MAX_NAME_LEN);
+    hash = merge_hash_string(hash, emp->department, MAX_DEPT_LEN);
+    hash = merge_hash_string(hash, emp->attend_date, MAX_DATE_LEN);
+    return fnv64_update(hash, &emp->attend_days, sizeof(emp->attend_days));
+}
+
+/* 除工号外内容是否相同(哈希相同后再逐字段确认) */
+static Bool merge_records_equal(const Employee *a, const Employee *b) {
+    return (a->attend_days == b->attend_days &&
+            strncmp(a->name, b->name, MAX_NAME_LEN) == 0 &&
+            strncmp(a->department, b->department, MAX_DEPT_LEN) == 0 &&
+            strncmp(a->attend_date, b->attend_date, MAX_DATE_LEN) == 0) ? TRUE : FALSE;
+}
+
+/* 打开第source个输入: 预扫描一遍,不按工号有序时先外部排序到"<output>.in<N>" */
+static ErrorCode merge_open_input(MergeState *state, size_t source, const char *input,
+                                  size_t memory_budget) {
+    MergeCursor *cursor = &state->cursors[source];
+    ErrorCode err;
+    cursor->store = storage_paged_open(input, 2, &err);
+    if (cursor->store == NULL) {
+        return err;
+    }
+
+    MergeProbe probe;
+    memset(&probe, 0, sizeof(MergeProbe));
+    probe.sorted = TRUE;
+    err = storage_paged_scan(cursor->store, merge_probe_visit, &probe);
+    if (err != SUCCESS) {
+        return err;
+    }
+    int next_id = storage_paged_next_id(cursor->store);
+    if (probe.count > 0 && probe.max_id != INT_MAX && probe.max_id + 1 > next_id) {
+        next_id = probe.max_id + 1;
+    }
+    if (next_id > state->next_id) {
+        state->next_id = next_id;
+    }
+    state->stats.input_records += probe.count;
+    if (probe.sorted) {
+        return SUCCESS;
+    }
+
+    storage_paged_close(cursor->store);
+    cursor->store = NULL;
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".in%lu", (unsigned long)source);
+    state->temp_paths[source] = merge_temp_path(state->output, suffix);
+    if (state->temp_paths[source] == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    err = storage_external_sort(input, state->temp_paths[source], SORT_BY_ID,
+                                SORT_OUTPUT_DB, memory_budget);
+    if (err != SUCCESS) {
+        return err;
+    }
+    state->stats.sorted_inputs++;
+    cursor->store = storage_paged_open(state->temp_paths[source], 2, &err);
+    return (cursor->store != NULL) ? SUCCESS : err;
+}
+
+/* 写一行工号对照: 输入序号,原工号,新工号 */
+static ErrorCode merge_map_id(MergeState *state, size_t source, int old_id, int new_id) {
+    if (!state->has_id_map) {
+        return SUCCESS;
+    }
+    return (fprintf(state->id_map.fp, "%lu,%d,%d\n", (unsigned long)source, old_id, new_id) > 0)
+               ? SUCCESS : ERROR_FILE_WRITE_FAILED;
+}
+
+/*
+ * 处理归并出的一条记录: 同工号的记录相邻到达,与其中内容相同者视为重复丢弃;
+ * 内容不同时先到的保留原工号,其余分配新工号写入临时文件,最后追加到输出末尾
+ */
+static ErrorCode merge_take(MergeState *state, size_t source, const Employee *emp) {
+    if (state->seen_count > 0 && state->seen[0].record.id != emp->id) {
+        state->seen_count = 0;
+    }
+    unsigned long long hash = merge_record_hash(emp);
+    for (size_t i = 0; i < state->seen_count; i++) {
+        const MergeSeen *seen = &state->seen[i];
+        if (seen->hash == hash && merge_records_equal(&seen->record, emp)) {
+            state->stats.duplicates++;
+            return (seen->output_id != emp->id) ? merge_map_id(state, source, emp->id, seen->output_id)
+                                                : SUCCESS;
+        }
+    }
+
+    if (state->seen_count == state->seen_capacity) {
+        size_t capacity = (state->seen_capacity > 0) ? state->seen_capacity * 2 : 8;
+        MergeSeen *grown = (MergeSeen *)realloc(state->seen, capacity * sizeof(MergeSeen));
+        if (grown == NULL) {
+            return ERROR_OUT_OF_MEMORY;
+        }
+        state->seen = grown;
+        state->seen_capacity = capacity;
+    }
+    MergeSeen *seen = &state->seen[state->seen_count++];
+    seen->record = *emp;
+    seen->hash = hash;
+
+    if (state->seen_count == 1) {
+        seen->output_id = emp->id;
+        v2_writer_put(&state->out, emp);
+        state->stats.output_records++;
+        return state->out.ok ? SUCCESS : ERROR_OUT_OF_MEMORY;
+    }
+
+    /* 工号冲突 */
+    if (state->next_id == INT_MAX) {
+        return ERROR_INVALID_PARAMETER;
+    }
+    if (state->remap == NULL) {
+        state->remap_path = merge_temp_path(state->output, ".remap");
+        if (state->remap_path == NULL) {
+            return ERROR_OUT_OF_MEMORY;
+        }
+        state->remap = fopen(state->remap_path, "w+b");
+        if (state->remap == NULL) {
+            return ERROR_FILE_WRITE_FAILED;
+        }
+        setvbuf(state->remap, NULL, _IOFBF, EXTERNAL_SORT_RUN_BUFFER);
+    }
+    seen->output_id = state->next_id++;
+    Employee moved = *emp;
+    moved.id = seen->output_id;
+    if (fwrite(&moved, sizeof(Employee), 1, state->remap) != 1) {
+        return ERROR_FILE_WRITE_FAILED;
+    }
+    state->stats.remapped++;
+    return merge_map_id(state, source, emp->id, seen->output_id);
+}
+
+/* 败者树k路归并各输入,工号相同时序号小的输入在前 */
+static ErrorCode merge_inputs(MergeState *state) {
+    const Employee **heads = (const Employee **)malloc(state->count * sizeof(Employee *));
+    LoserTree *tree = loser_tree_create(state->count, employee_comparator(SORT_BY_ID));
+    ErrorCode err = (heads != NULL && tree != NULL) ? SUCCESS : ERROR_OUT_OF_MEMORY;
+
+    for (size_t i = 0; i < state->count && err == SUCCESS; i++) {
+        heads[i] = merge_cursor_next(&state->cursors[i], &err);
+    }
+    if (err == SUCCESS) {
+        loser_tree_build(tree, (void *const *)heads);
+        size_t source;
+        while ((source = loser_tree_top(tree)) != LOSER_TREE_EMPTY) {
+            err = merge_take(state, source, (const Employee *)loser_tree_top_item(tree));
+            if (err != SUCCESS) {
+                break;
+            }
+            const Employee *next = merge_cursor_next(&state->cursors[source], &err);
+            if (err != SUCCESS) {
+                break;
+            }
+            loser_tree_replace(tree, (void *)next);
+        }
+    }
+
+    loser_tree_free(tree);
+    free(heads);
+    return err;
+}
+
+/* 把改号记录追加到输出末尾(新工号大于所有原工号,输出仍按工号有序) */
+static ErrorCode merge_append_remapped(MergeState *state) {
+    if (state->remap == NULL) {
+        return SUCCESS;
+    }
+    if (fflush(state->remap) != 0 || !file_seek(state->remap, 0)) {
+        return ERROR_FILE_READ_FAILED;
+    }
+    Employee emp;
+    while (fread(&emp, sizeof(Employee), 1, state->remap) == 1) {
+        v2_writer_put(&state->out, &emp);
+        state->stats.output_records++;
+    }
+    if (ferror(state->remap)) {
+        return ERROR_FILE_READ_FAILED;
+    }
+    return state->out.ok ? SUCCESS : ERROR_OUT_OF_MEMORY;
+}
+
+static void merge_state_free(MergeState *state) {
+    for (size_t i = 0; i < state->count; i++) {
+        merge_cursor_close(&state->cursors[i]);
+        if (state->temp_paths[i] != NULL) {
+            remove(state->temp_paths[i]);
+            free(state->temp_paths[i]);
+        }
+    }
+    if (state->remap != NULL) {
+        fclose(state->remap);
+        remove(state->remap_path);
+    }
+    free(state->remap_path);
+    free(state->seen);
+    free(state->cursors);
+    free(state->temp_paths);
+}
+
+ErrorCode storage_merge_files(const char *const *inputs, size_t count, const char *output,
+                              const char *id_map, size_t memory_budget, MergeStats *stats) {
+    if (stats != NULL) {
+        memset(stats, 0, sizeof(MergeStats));
+    }
+    if (inputs == NULL || output == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    if (count == 0) {
+        return ERROR_INVALID_PARAMETER;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (inputs[i] == NULL) {
+            return ERROR_NULL_POINTER;
+        }
+    }
+
+    MergeState state;
+    memset(&state, 0, sizeof(MergeState));
+    state.output = output;
+    state.count = count;
+    state.next_id = 1;
+    state.cursors = (MergeCursor *)calloc(count, sizeof(MergeCursor));
+    state.temp_paths = (char **)calloc(count, sizeof(char *));
+    ErrorCode err = (state.cursors != NULL && state.temp_paths != NULL) ? SUCCESS : ERROR_OUT_OF_MEMORY;
+    if (err != SUCCESS) {
+        state.count = 0;
+    }
+
+    /* 第一阶段: 打开各输入,确定新工号的起点 */
+    for (size_t i = 0; i < count && err == SUCCESS; i++) {
+        err = merge_open_input(&state, i, inputs[i], memory_budget);
+    }
+
+    /* 第二阶段: 归并写出,改号记录暂存后追加 */
+    Bool opened = FALSE;
+    if (err == SUCCESS && id_map != NULL) {
+        err = atomic_file_open(&state.id_map, id_map, "w");
+        if (err == SUCCESS) {
+            state.has_id_map = TRUE;
+            if (fputs("输入序号,原工号,新工号\n", state.id_map.fp) == EOF) {
+                err = ERROR_FILE_WRITE_FAILED;
+            }
+        }
+    }
+    if (err == SUCCESS) {
+        err = v2_writer_open(&state.out, output);
+        opened = (err == SUCCESS) ? TRUE : FALSE;
+    }
+    if (err == SUCCESS) {
+        err = merge_inputs(&state);
+    }
+    if (err == SUCCESS) {
+        err = merge_append_remapped(&state);
+    }
+
+    if (opened) {
+        if (err == SUCCESS) {
+            err = v2_writer_commit(&state.out, state.next_id);
+        } else {
+            v2_writer_abort(&state.out);
+        }
+    }
+    if (state.has_id_map) {
+        if (err == SUCCESS) {
+            err = atomic_file_commit(&state.id_map);
+        } else {
+            atomic_file_abort(&state.id_map);
+        }
+    }
+    if (stats != NULL) {
+        *stats = state.stats;
+    }
+    merge_state_free(&state);
+    return err;
+}
@@ -0,0 +1,27 @@
+#ifndef MERGE_H
+#define MERGE_H
+
+#include "common.h"
+
+/* 多库合并统计 */
+typedef struct {
+    unsigned long long input_records;   /* 各输入的记录总数 */
+    unsigned long long output_records;  /* 写出的记录数 */
+    unsigned long long duplicates;      /* 与同工号记录内容相同而去掉的记录数 */
+    unsigned long long remapped;        /* 因工号冲突改用新工号的记录数 */
+    size_t sorted_inputs;               /* 不按工号有序、先经外部排序的输入数 */
+} MergeStats;
+
+/*
+ * 多库合并: 各分支机构的v2文件逐页流式读入,用败者树按工号k路归并写入output。
+ * 同一工号的记录相邻到达,只需记住当前工号的记录: 内容哈希相同(再逐字段确认)的视为重复
+ * 只保留一条;内容不同时序号小的输入保留原工号,其余改用不小于各输入next_id的新工号,
+ * 暂存于"<output>.remap"并追加到输出末尾。id_map不为NULL时写出CSV对照表
+ * "输入序号,原工号,新工号"(序号为inputs下标)。不按工号有序的输入先按memory_budget
+ * (0取默认值)外部排序到"<output>.in<N>"。内存占用与记录总数无关;stats可为NULL,
+ * 不为NULL时在任何返回路径上都已填写(参数错误时为0)
+ */
+ErrorCode storage_merge_files(const char *const *inputs, size_t count, const char *output,
+                              const char *id_map, size_t memory_budget, MergeStats *stats);
+
+#endif /* MERGE_H */
@@ -1,7 +1,20 @@
 #include "model.h"
+#include "thread.h"
+#include "thread_pool.h"
+#include "index.h"
+#include "query_cache.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <assert.h>
+
+/* 并行扫描参数: 记录数达到阈值才启用线程池,每块至少PARALLEL_SCAN_MIN_CHUNK条 */
+#define PARALLEL_SCAN_THRESHOLD 65536
+#define PARALLEL_SCAN_MIN_CHUNK 8192
+#define PARALLEL_SCAN_OVERSUBSCRIBE 4
+
+/* 出勤统计在结果缓存中的查询类型(与SearchType的取值不重叠) */
+#define CACHE_QUERY_ATTENDANCE 16
 
 /* ========== Employee 工具函数实现 ========== */
 
@@ -28,6 +41,25 @@ Employee *employee_create(int id, const char *name, const char *department,
     return emp;
 }
 
+EmployeeFieldError employee_check_fields(const char *name, const char *department,
+                                         const char *attend_date, int attend_days) {
+    size_t name_len = strlen(name);
+    if (name_len == 0 || name_len >= MAX_NAME_LEN) {
+        return EMPLOYEE_BAD_NAME;
+    }
+    size_t dept_len = strlen(department);
+    if (dept_len == 0 || dept_len >= MAX_DEPT_LEN) {
+        return EMPLOYEE_BAD_DEPARTMENT;
+    }
+    if (strlen(attend_date) >= MAX_DATE_LEN) {
+        return EMPLOYEE_BAD_DATE;
+    }
+    if (attend_days < 0 || attend_days > MAX_ATTEND_DAYS) {
+        return EMPLOYEE_BAD_DAYS;
+    }
+    return EMPLOYEE_FIELDS_OK;
+}
+
 void employee_free(Employee *emp) {
     if (emp != NULL) {
         free(emp);
@@ -42,6 +74,404 @@ void employee_print(const Employee *emp) {
     }
 }
 
+/* ========== 表版本(写时复制) ========== */
+
+/* 回收回调: 释放单条记录 */
+static void retired_record_free(void *ptr) {
+    employee_free((Employee *)ptr);
+}
+
+/* 回收回调: 释放记录块(不释放块内记录) */
+static void retired_block_free(void *ptr) {
+    free(ptr);
+}
+
+/* 回收回调: 释放表版本本身(不释放共享的记录块) */
+static void retired_table_free(void *ptr) {
+    EmployeeTable *table = (EmployeeTable *)ptr;
+    if (table != NULL) {
+        free(table->blocks);
+        free(table->block_starts);
+        free(table);
+    }
+}
+
+/* 回收回调: 释放被替换的索引 */
+static void retired_index_free(void *ptr) {
+    employee_index_free((EmployeeIndex *)ptr);
+}
+
+static void retired_name_index_free(void *ptr) {
+    name_index_free((NameIndex *)ptr);
+}
+
+static void retired_date_aggregate_free(void *ptr) {
+    date_aggregate_free((DateAggregate *)ptr);
+}
+
+/* 分配可容纳block_capacity个块的空表 */
+static EmployeeTable *table_alloc(size_t block_capacity) {
+    EmployeeTable *table = (EmployeeTable *)calloc(1, sizeof(EmployeeTable));
+    if (table == NULL) {
+        return NULL;
+    }
+    
+    if (block_capacity > 0) {
+        table->blocks = (EmployeeBlock **)malloc(block_capacity * sizeof(EmployeeBlock *));
+        table->block_starts = (size_t *)malloc(block_capacity * sizeof(size_t));
+        if (table->blocks == NULL || table->block_starts == NULL) {
+            retired_table_free(table);
+            return NULL;
+        }
+    }
+    return table;
+}
+
+/* 释放表版本及其全部记录块(仅在无读者时使用) */
+static void table_free_deep(EmployeeTable *table) {
+    if (table != NULL) {
+        for (size_t b = 0; b < table->block_count; b++) {
+            free(table->blocks[b]);
+        }
+        retired_table_free(table);
+    }
+}
+
+/* 复制块指针数组,额外预留extra个块的空间 */
+static EmployeeTable *table_clone(const EmployeeTable *src, size_t extra) {
+    EmployeeTable *table = table_alloc(src->block_count + extra);
+    if (table == NULL) {
+        return NULL;
+    }
+    
+    if (src->block_count > 0) {
+        memcpy(table->blocks, src->blocks, src->block_count * sizeof(EmployeeBlock *));
+        memcpy(table->block_starts, src->block_starts, src->block_count * sizeof(size_t));
+    }
+    table->block_count = src->block_count;
+    table->size = src->size;
+    return table;
+}
+
+/* 由连续职工数组构建全新的表版本 */
+static EmployeeTable *table_build(Employee **records, size_t size) {
+    size_t block_count = (size + EMPLOYEE_BLOCK_SIZE - 1) / EMPLOYEE_BLOCK_SIZE;
+    EmployeeTable *table = table_alloc(block_count);
+    if (table == NULL) {
+        return NULL;
+    }
+    
+    for (size_t b = 0; b < block_count; b++) {
+        EmployeeBlock *block = (EmployeeBlock *)malloc(sizeof(EmployeeBlock));
+        if (block == NULL) {
+            table_free_deep(table);
+            return NULL;
+        }
+        size_t start = b * EMPLOYEE_BLOCK_SIZE;
+        block->count = (size - start < EMPLOYEE_BLOCK_SIZE) ? size - start : EMPLOYEE_BLOCK_SIZE;
+        memcpy(block->records, records + start, block->count * sizeof(Employee *));
+        table->blocks[b] = block;
+        table->block_starts[b] = start;
+        table->block_count++;
+    }
+    table->size = size;
+    return table;
+}
+
+/* 二分查找全局下标所在的块 */
+static size_t table_find_block(const EmployeeTable *table, size_t index) {
+    size_t low = 0;
+    size_t high = table->block_count;
+    while (high - low > 1) {
+        size_t mid = low + (high - low) / 2;
+        if (table->block_starts[mid] <= index) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/* 复制一个记录块 */
+static EmployeeBlock *block_clone(const EmployeeBlock *src) {
+    EmployeeBlock *block = (EmployeeBlock *)malloc(sizeof(EmployeeBlock));
+    if (block != NULL) {
+        block->count = src->count;
+        memcpy(block->records, src->records, src->count * sizeof(Employee *));
+    }
+    return block;
+}
+
+/* ========== 并发模式: 写者侧 ========== */
+
+static void manager_lock(EmployeeManager *manager) {
+    if (manager->concurrent) {
+        mutex_lock(manager->write_lock);
+    }
+}
+
+static void manager_unlock(EmployeeManager *manager) {
+    if (manager->concurrent) {
+        mutex_unlock(manager->write_lock);
+    }
+}
+
+/* 重新检查写者数组是否按工号严格递增(排序、批量写入后调用,调用方已持有写锁) */
+static void manager_check_id_order(EmployeeManager *manager) {
+    Employee **records = (Employee **)manager->employees->data;
+    size_t size = vector_size(manager->employees);
+    manager->ids_ascending = TRUE;
+    for (size_t i = 1; i < size; i++) {
+        if (records[i - 1]->id >= records[i]->id) {
+            manager->ids_ascending = FALSE;
+            return;
+        }
+    }
+}
+
+/*
+ * 按工号查找记录位置(调用方已持有写锁),找不到时返回记录数。数组按工号严格
+ * 递增时二分查找以缩短持锁时间,此时工号不重复,结果与顺序扫描相同;
+ * 否则顺序扫描,返回第一个匹配的记录
+ */
+static size_t manager_find_id_locked(const EmployeeManager *manager, int id) {
+    Employee **records = (Employee **)manager->employees->data;
+    size_t size = vector_size(manager->employees);
+    
+    if (!manager->ids_ascending) {
+        for (size_t i = 0; i < size; i++) {
+            if (records[i]->id == id) {
+                return i;
+            }
+        }
+        return size;
+    }
+    
+    size_t low = 0;
+    size_t high = size;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (records[mid]->id < id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return (low < size && records[low]->id == id) ? low : size;
+}
+
+/* 发布新表版本,旧版本交给纪元回收 */
+static void manager_publish(EmployeeManager *manager, EmployeeTable *table) {
+    EmployeeTable *old = (EmployeeTable *)manager->published;
+    table->version = manager->generation;
+    table->next_id = manager->next_id;
+    atomic_ptr_store(&manager->published, table);
+    epoch_retire(manager->epoch, old, retired_table_free);
+    epoch_reclaim(manager->epoch);
+}
+
+/* 按当前职工数组重建并发布整张表(排序、批量写入后使用) */
+static ErrorCode manager_republish_all(EmployeeManager *manager) {
+    EmployeeTable *table = table_build((Employee **)manager->employees->data,
+                                       manager->employees->size);
+    if (table == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    
+    EmployeeTable *old = (EmployeeTable *)manager->published;
+    for (size_t b = 0; b < old->block_count; b++) {
+        epoch_retire(manager->epoch, old->blocks[b], retired_block_free);
+    }
+    manager_publish(manager, table);
+    return SUCCESS;
+}
+
+/* 准备追加一条记录后的表版本: 只复制最后一个块 */
+static EmployeeTable *table_prepare_append(const EmployeeTable *old, Employee *emp,
+                                           EmployeeBlock **replaced) {
+    EmployeeTable *table = table_clone(old, 1);
+    if (table == NULL) {
+        return NULL;
+    }
+    
+    size_t last = old->block_count;
+    if (last > 0 && old->blocks[last - 1]->count < EMPLOYEE_BLOCK_SIZE) {
+        EmployeeBlock *block = block_clone(old->blocks[last - 1]);
+        if (block == NULL) {
+            retired_table_free(table);
+            return NULL;
+        }
+        block->records[block->count++] = emp;
+        table->blocks[last - 1] = block;
+        *replaced = old->blocks[last - 1];
+    } else {
+        EmployeeBlock *block = (EmployeeBlock *)malloc(sizeof(EmployeeBlock));
+        if (block == NULL) {
+            retired_table_free(table);
+            return NULL;
+        }
+        block->count = 1;
+        block->records[0] = emp;
+        table->blocks[last] = block;
+        table->block_starts[last] = old->size;
+        table->block_count++;
+        *replaced = NULL;
+    }
+    table->size++;
+    return table;
+}
+
+/* 准备替换第index条记录后的表版本: 只复制所在块 */
+static EmployeeTable *table_prepare_replace(const EmployeeTable *old, size_t index,
+                                            Employee *emp, EmployeeBlock **replaced) {
+    size_t b = table_find_block(old, index);
+    EmployeeTable *table = table_clone(old, 0);
+    EmployeeBlock *block = (table != NULL) ? block_clone(old->blocks[b]) : NULL;
+    if (block == NULL) {
+        retired_table_free(table);
+        return NULL;
+    }
+    
+    block->records[index - old->block_starts[b]] = emp;
+    table->blocks[b] = block;
+    *replaced = old->blocks[b];
+    return table;
+}
+
+/* 准备删除第index条记录后的表版本: 只复制所在块,后续块仅调整起始下标 */
+static EmployeeTable *table_prepare_remove(const EmployeeTable *old, size_t index,
+                                           EmployeeBlock **replaced) {
+    size_t b = table_find_block(old, index);
+    EmployeeTable *table = table_clone(old, 0);
+    if (table == NULL) {
+        return NULL;
+    }
+    
+    const EmployeeBlock *src = old->blocks[b];
+    size_t offset = index - old->block_starts[b];
+    *replaced = old->blocks[b];
+    
+    if (src->count == 1) {
+        /* 块被删空: 直接从块数组中移除 */
+        memmove(table->blocks + b, table->blocks + b + 1,
+                (table->block_count - b - 1) * sizeof(EmployeeBlock *));
+        memmove(table->block_starts + b, table->block_starts + b + 1,
+                (table->block_count - b - 1) * sizeof(size_t));
+        table->block_count--;
+    } else {
+        EmployeeBlock *block = block_clone(src);
+        if (block == NULL) {
+            retired_table_free(table);
+            return NULL;
+        }
+        memmove(block->records + offset, block->records + offset + 1,
+                (block->count - offset - 1) * sizeof(Employee *));
+        block->count--;
+        table->blocks[b] = block;
+        b++;
+    }
+    
+    for (; b < table->block_count; b++) {
+        table->block_starts[b]--;
+    }
+    table->size--;
+    return table;
+}
+
+/* ========== 变更跟踪 ========== */
+
+/* 标记第position条记录所在的块已修改(调用方持有写锁);没有同步基线时无需跟踪 */
+static void manager_mark_dirty(EmployeeManager *manager, size_t position) {
+    size_t block = position / DIRTY_BLOCK_RECORDS;
+    if (manager->sync_stamp == 0 || block >= manager->dirty_from) {
+        return;
+    }
+    if (block >= manager->dirty_capacity) {
+        size_t capacity = (manager->dirty_capacity == 0) ? 64 : manager->dirty_capacity;
+        while (capacity <= block) {
+            capacity *= 2;
+        }
+        unsigned char *blocks = (unsigned char *)realloc(manager->dirty_blocks, capacity);
+        if (blocks == NULL) {
+            manager->sync_stamp = 0;  /* 无法跟踪时放弃基线,下次完整保存 */
+            return;
+        }
+        memset(blocks + manager->dirty_capacity, 0, capacity - manager->dirty_capacity);
+        manager->dirty_blocks = blocks;
+        manager->dirty_capacity = capacity;
+    }
+    manager->dirty_blocks[block] = 1;
+}
+
+/* 第position条及之后的记录位置都已改变 */
+static void manager_mark_dirty_from(EmployeeManager *manager, size_t position) {
+    size_t block = position / DIRTY_BLOCK_RECORDS;
+    if (block < manager->dirty_from) {
+        manager->dirty_from = block;
+    }
+}
+
+void employee_manager_mark_synced(EmployeeManager *manager, unsigned long version,
+                                  unsigned long long stamp) {
+    if (manager == NULL) {
+        return;
+    }
+    
+    manager_lock(manager);
+    if (stamp != 0 && manager->generation == version) {
+        if (manager->dirty_blocks != NULL) {
+            memset(manager->dirty_blocks, 0, manager->dirty_capacity);
+        }
+        manager->dirty_from = (size_t)-1;
+        manager->synced_size = manager->employees->size;
+        manager->sync_stamp = stamp;
+    } else {
+        manager->sync_stamp = 0;
+    }
+    manager_unlock(manager);
+}
+
+ErrorCode employee_manager_changes(EmployeeManager *manager, EmployeeChanges *changes) {
+    if (manager == NULL || changes == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    
+    manager_lock(manager);
+    changes->stamp = manager->sync_stamp;
+    changes->version = manager->generation;
+    changes->synced_size = manager->synced_size;
+    changes->dirty_from = manager->dirty_from;
+    changes->block_count = 0;
+    changes->blocks = NULL;
+    if (manager->sync_stamp != 0 && manager->dirty_capacity > 0) {
+        changes->blocks = (unsigned char *)malloc(manager->dirty_capacity);
+        if (changes->blocks == NULL) {
+            manager_unlock(manager);
+            return ERROR_OUT_OF_MEMORY;
+        }
+        memcpy(changes->blocks, manager->dirty_blocks, manager->dirty_capacity);
+        changes->block_count = manager->dirty_capacity;
+    }
+    manager_unlock(manager);
+    return SUCCESS;
+}
+
+void employee_changes_free(EmployeeChanges *changes) {
+    if (changes != NULL) {
+        free(changes->blocks);
+        changes->blocks = NULL;
+        changes->block_count = 0;
+    }
+}
+
+Bool employee_changes_dirty(const EmployeeChanges *changes, size_t block) {
+    if (changes == NULL || block >= changes->dirty_from) {
+        return TRUE;
+    }
+    return (block < changes->block_count && changes->blocks[block]) ? TRUE : FALSE;
+}
+
 /* ========== EmployeeManager 实现 ========== */
 
 EmployeeManager *employee_manager_create(void) {
@@ -51,17 +481,45 @@ EmployeeManager *employee_manager_create(void) {
     }
     
     manager->employees = vector_create();
-    if (manager->employees == NULL) {
+    manager->cache = query_cache_create(QUERY_CACHE_DEFAULT_ENTRIES, QUERY_CACHE_DEFAULT_POINTERS);
+    if (manager->employees == NULL || manager->cache == NULL) {
+        vector_free(manager->employees);
+        query_cache_free(manager->cache);
         free(manager);
         return NULL;
     }
     
     manager->next_id = 1001;  /* 工号从1001开始 */
+    manager->generation = 0;
+    manager->concurrent = FALSE;
+    manager->ids_ascending = TRUE;
+    manager->write_lock = NULL;
+    manager->epoch = NULL;
+    manager->published = NULL;
+    manager->index = NULL;
+    manager->name_index = NULL;
+    manager->date_index = NULL;
+    manager->dirty_blocks = NULL;
+    manager->dirty_capacity = 0;
+    manager->dirty_from = (size_t)-1;
+    manager->synced_size = 0;
+    manager->sync_stamp = 0;
     return manager;
 }
 
 void employee_manager_free(EmployeeManager *manager) {
     if (manager != NULL) {
+        if (manager->concurrent) {
+            /* 先回收已退役的块和记录,再释放当前版本的块;记录由职工数组统一释放 */
+            epoch_domain_free(manager->epoch);
+            table_free_deep((EmployeeTable *)manager->published);
+            mutex_free(manager->write_lock);
+        }
+        employee_index_free((EmployeeIndex *)manager->index);
+        name_index_free((NameIndex *)manager->name_index);
+        date_aggregate_free((DateAggregate *)manager->date_index);
+        query_cache_free(manager->cache);
+        free(manager->dirty_blocks);
         if (manager->employees != NULL) {
             /* 释放所有职工对象 */
             size_t size = vector_size(manager->employees);
@@ -75,6 +533,69 @@ void employee_manager_free(EmployeeManager *manager) {
     }
 }
 
+ErrorCode employee_manager_enable_concurrency(EmployeeManager *manager) {
+    if (manager == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    
+    /* 只能启用一次: 重复启用说明调用方对管理器所处模式的假设有误 */
+    assert(!manager->concurrent);
+    if (manager->concurrent) {
+        return ERROR_INVALID_PARAMETER;
+    }
+    
+    Mutex *lock = mutex_create();
+    EpochDomain *epoch = epoch_domain_create();
+    EmployeeTable *table = table_build((Employee **)manager->employees->data,
+                                       manager->employees->size);
+    if (lock == NULL || epoch == NULL || table == NULL) {
+        mutex_free(lock);
+        epoch_domain_free(epoch);
+        table_free_deep(table);
+        return ERROR_OUT_OF_MEMORY;
+    }
+    
+    table->version = manager->generation;
+    table->next_id = manager->next_id;
+    manager->write_lock = lock;
+    manager->epoch = epoch;
+    manager->published = table;
+    manager->concurrent = TRUE;
+    return SUCCESS;
+}
+
+int employee_manager_read_lock(EmployeeManager *manager) {
+    if (manager == NULL || !manager->concurrent) {
+        return 0;
+    }
+    return epoch_enter(manager->epoch);
+}
+
+void employee_manager_read_unlock(EmployeeManager *manager, int token) {
+    if (manager != NULL && manager->concurrent) {
+        epoch_exit(manager->epoch, token);
+    }
+}
+
+void employee_manager_begin_write(EmployeeManager *manager) {
+    if (manager != NULL) {
+        manager_lock(manager);
+    }
+}
+
+void employee_manager_end_write(EmployeeManager *manager) {
+    if (manager != NULL) {
+        /* 批量写入可能改动任意位置 */
+        manager_mark_dirty_from(manager, 0);
+        manager_check_id_order(manager);
+        manager->generation++;
+        if (manager->concurrent) {
+            manager_republish_all(manager);
+        }
+        manager_unlock(manager);
+    }
+}
+
 ErrorCode employee_manager_add(EmployeeManager *manager, const char *name,
                                const char *department, const char *attend_date,
                                int attend_days) {
@@ -82,39 +603,98 @@ ErrorCode employee_manager_add(EmployeeManager *manager, const char *name,
         return ERROR_NULL_POINTER;
     }
     
-    if (attend_days < 0) {
+    if (employee_check_fields(name, department, attend_date, attend_days) != EMPLOYEE_FIELDS_OK) {
         return ERROR_INVALID_PARAMETER;
     }
     
+    manager_lock(manager);
+    
     Employee *emp = employee_create(manager->next_id, name, department,
                                     attend_date, attend_days);
     if (emp == NULL) {
+        manager_unlock(manager);
         return ERROR_OUT_OF_MEMORY;
     }
     
+    EmployeeTable *table = NULL;
+    EmployeeBlock *replaced = NULL;
+    if (manager->concurrent) {
+        table = table_prepare_append((EmployeeTable *)manager->published, emp, &replaced);
+        if (table == NULL) {
+            employee_free(emp);
+            manager_unlock(manager);
+            return ERROR_OUT_OF_MEMORY;
+        }
+    }
+    
+    size_t size = vector_size(manager->employees);
+    Bool ascending = (size == 0 ||
+                      ((Employee *)manager->employees->data[size - 1])->id < emp->id) ? TRUE : FALSE;
     ErrorCode err = vector_push_back(manager->employees, emp);
     if (err != SUCCESS) {
+        if (table != NULL) {
+            /* 新版本中最后一个块是刚复制或新建的 */
+            free(table->blocks[table->block_count - 1]);
+            retired_table_free(table);
+        }
         employee_free(emp);
+        manager_unlock(manager);
         return err;
     }
     
     manager->next_id++;
+    manager->ids_ascending = (manager->ids_ascending && ascending) ? TRUE : FALSE;
+    manager->generation++;
+    manager_mark_dirty(manager, manager->employees->size - 1);
+    if (table != NULL) {
+        epoch_retire(manager->epoch, replaced, retired_block_free);
+        manager_publish(manager, table);
+    }
+    
+    manager_unlock(manager);
     return SUCCESS;
 }
 
-ErrorCode employee_manager_remove_at(EmployeeManager *manager, size_t index) {
-    if (manager == NULL) {
-        return ERROR_NULL_POINTER;
-    }
-    
+/* 删除第index条记录(调用方已持有写锁) */
+static ErrorCode manager_remove_at_locked(EmployeeManager *manager, size_t index) {
     if (index >= vector_size(manager->employees)) {
         return ERROR_INDEX_OUT_OF_BOUNDS;
     }
     
     Employee *emp = (Employee *)manager->employees->data[index];
-    employee_free(emp);
+    manager_mark_dirty_from(manager, index);
+    
+    if (!manager->concurrent) {
+        employee_free(emp);
+        manager->generation++;
+        return vector_remove_at(manager->employees, index);
+    }
+    
+    EmployeeBlock *replaced = NULL;
+    EmployeeTable *table = table_prepare_remove((EmployeeTable *)manager->published,
+                                                index, &replaced);
+    if (table == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
     
-    return vector_remove_at(manager->employees, index);
+    ErrorCode err = vector_remove_at(manager->employees, index);
+    manager->generation++;
+    /* 读者可能仍在访问旧块和被删记录,交给纪元回收 */
+    epoch_retire(manager->epoch, replaced, retired_block_free);
+    epoch_retire(manager->epoch, emp, retired_record_free);
+    manager_publish(manager, table);
+    return err;
+}
+
+ErrorCode employee_manager_remove_at(EmployeeManager *manager, size_t index) {
+    if (manager == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    
+    manager_lock(manager);
+    ErrorCode err = manager_remove_at_locked(manager, index);
+    manager_unlock(manager);
+    return err;
 }
 
 ErrorCode employee_manager_remove_by_id(EmployeeManager *manager, int id) {
@@ -122,15 +702,16 @@ ErrorCode employee_manager_remove_by_id(EmployeeManager *manager, int id) {
         return ERROR_NULL_POINTER;
     }
     
-    size_t size = vector_size(manager->employees);
-    for (size_t i = 0; i < size; i++) {
-        Employee *emp = (Employee *)manager->employees->data[i];
-        if (emp->id == id) {
-            return employee_manager_remove_at(manager, i);
-        }
+    manager_lock(manager);
+    
+    ErrorCode err = ERROR_NOT_FOUND;
+    size_t i = manager_find_id_locked(manager, id);
+    if (i < vector_size(manager->employees)) {
+        err = manager_remove_at_locked(manager, i);
     }
     
-    return ERROR_NOT_FOUND;
+    manager_unlock(manager);
+    return err;
 }
 
 ErrorCode employee_manager_update(EmployeeManager *manager, int id,
@@ -140,14 +721,17 @@ ErrorCode employee_manager_update(EmployeeManager *manager, int id,
         return ERROR_NULL_POINTER;
     }
     
-    if (attend_days < 0) {
+    if (employee_check_fields(name, department, attend_date, attend_days) != EMPLOYEE_FIELDS_OK) {
         return ERROR_INVALID_PARAMETER;
     }
     
-    size_t size = vector_size(manager->employees);
-    for (size_t i = 0; i < size; i++) {
+    manager_lock(manager);
+    
+    size_t i = manager_find_id_locked(manager, id);
+    if (i < vector_size(manager->employees)) {
         Employee *emp = (Employee *)manager->employees->data[i];
-        if (emp->id == id) {
+        
+        if (!manager->concurrent) {
             strncpy(emp->name, name, MAX_NAME_LEN - 1);
             emp->name[MAX_NAME_LEN - 1] = '\0';
             strncpy(emp->department, department, MAX_DEPT_LEN - 1);
@@ -155,52 +739,465 @@ ErrorCode employee_manager_update(EmployeeManager *manager, int id,
             strncpy(emp->attend_date, attend_date, MAX_DATE_LEN - 1);
             emp->attend_date[MAX_DATE_LEN - 1] = '\0';
             emp->attend_days = attend_days;
+            manager->generation++;
+            manager_mark_dirty(manager, i);
+            manager_unlock(manager);
             return SUCCESS;
         }
+        
+        /* 并发模式: 已发布的记录不可原地修改,写入新副本后替换 */
+        Employee *copy = employee_create(id, name, department, attend_date, attend_days);
+        EmployeeBlock *replaced = NULL;
+        EmployeeTable *table = (copy != NULL)
+            ? table_prepare_replace((EmployeeTable *)manager->published, i, copy, &replaced)
+            : NULL;
+        if (table == NULL) {
+            employee_free(copy);
+            manager_unlock(manager);
+            return ERROR_OUT_OF_MEMORY;
+        }
+        
+        manager->employees->data[i] = copy;
+        manager->generation++;
+        manager_mark_dirty(manager, i);
+        epoch_retire(manager->epoch, replaced, retired_block_free);
+        epoch_retire(manager->epoch, emp, retired_record_free);
+        manager_publish(manager, table);
+        manager_unlock(manager);
+        return SUCCESS;
     }
     
+    manager_unlock(manager);
     return ERROR_NOT_FOUND;
 }
 
-Vector *employee_manager_search(EmployeeManager *manager, SearchType type,
-                                const void *keyword) {
-    if (manager == NULL || keyword == NULL) {
+/* ========== 只读视图 ========== */
+
+ErrorCode employee_manager_view_begin(EmployeeManager *manager, EmployeeView *view) {
+    if (manager == NULL || view == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    
+    if (manager->concurrent) {
+        view->token = epoch_enter(manager->epoch);
+        view->table = (const EmployeeTable *)atomic_ptr_load(&manager->published);
+        view->records = NULL;
+        view->size = view->table->size;
+        view->next_id = view->table->next_id;
+        view->version = view->table->version;
+    } else {
+        view->token = 0;
+        view->table = NULL;
+        view->records = (Employee **)manager->employees->data;
+        view->size = manager->employees->size;
+        view->next_id = manager->next_id;
+        view->version = manager->generation;
+    }
+    return SUCCESS;
+}
+
+void employee_manager_view_end(EmployeeManager *manager, EmployeeView *view) {
+    if (manager != NULL && view != NULL && view->table != NULL) {
+        epoch_exit(manager->epoch, view->token);
+        view->table = NULL;
+    }
+}
+
+size_t employee_view_span_count(const EmployeeView *view) {
+    if (view == NULL) {
+        return 0;
+    }
+    if (view->table != NULL) {
+        return view->table->block_count;
+    }
+    return (view->size + EMPLOYEE_BLOCK_SIZE - 1) / EMPLOYEE_BLOCK_SIZE;
+}
+
+size_t employee_view_span(const EmployeeView *view, size_t index, Employee *const **records) {
+    if (view == NULL || records == NULL) {
+        return 0;
+    }
+    
+    if (view->table != NULL) {
+        if (index >= view->table->block_count) {
+            return 0;
+        }
+        *records = view->table->blocks[index]->records;
+        return view->table->blocks[index]->count;
+    }
+    
+    size_t start = index * EMPLOYEE_BLOCK_SIZE;
+    if (start >= view->size) {
+        return 0;
+    }
+    *records = view->records + start;
+    return (view->size - start < EMPLOYEE_BLOCK_SIZE) ? view->size - start : EMPLOYEE_BLOCK_SIZE;
+}
+
+const Employee *employee_view_get(const EmployeeView *view, size_t index) {
+    if (view == NULL || index >= view->size) {
         return NULL;
     }
     
+    if (view->table != NULL) {
+        size_t b = table_find_block(view->table, index);
+        return view->table->blocks[b]->records[index - view->table->block_starts[b]];
+    }
+    return view->records[index];
+}
+
+/* ========== MVCC快照 ========== */
+
+/* 替换slot中的索引: 并发模式下读者可能仍在使用旧索引,经纪元延迟回收 */
+static void manager_attach(EmployeeManager *manager, void *volatile *slot, void *index,
+                           void (*release)(void *)) {
+    manager_lock(manager);
+    void *old = *slot;
+    atomic_ptr_store(slot, index);
+    if (manager->concurrent) {
+        epoch_retire(manager->epoch, old, release);
+    } else {
+        release(old);
+    }
+    manager_unlock(manager);
+}
+
+ErrorCode employee_manager_attach_index(EmployeeManager *manager, EmployeeIndex *index) {
+    if (manager == NULL) {
+        employee_index_free(index);
+        return ERROR_NULL_POINTER;
+    }
+    
+    manager_attach(manager, &manager->index, index, retired_index_free);
+    return SUCCESS;
+}
+
+ErrorCode employee_manager_attach_name_index(EmployeeManager *manager, NameIndex *index) {
+    if (manager == NULL) {
+        name_index_free(index);
+        return ERROR_NULL_POINTER;
+    }
+    
+    manager_attach(manager, &manager->name_index, index, retired_name_index_free);
+    return SUCCESS;
+}
+
+ErrorCode employee_manager_attach_date_aggregate(EmployeeManager *manager,
+                                                 DateAggregate *aggregate) {
+    if (manager == NULL) {
+        date_aggregate_free(aggregate);
+        return ERROR_NULL_POINTER;
+    }
+    
+    manager_attach(manager, &manager->date_index, aggregate, retired_date_aggregate_free);
+    return SUCCESS;
+}
+
+Bool employee_manager_index_ready(EmployeeManager *manager, IndexKind kind) {
+    if (manager == NULL) {
+        return FALSE;
+    }
+    
+    EmployeeView view;
+    employee_manager_view_begin(manager, &view);
+    Bool ready = FALSE;
+    if (kind == INDEX_KIND_PRIMARY) {
+        const EmployeeIndex *index = (const EmployeeIndex *)atomic_ptr_load(&manager->index);
+        ready = (index != NULL && index->version == view.version &&
+                 index->record_count == view.size) ? TRUE : FALSE;
+    } else if (kind == INDEX_KIND_NAME) {
+        const NameIndex *index = (const NameIndex *)atomic_ptr_load(&manager->name_index);
+        ready = (index != NULL && index->version == view.version &&
+                 index->record_count == view.size) ? TRUE : FALSE;
+    } else if (kind == INDEX_KIND_DATE) {
+        const DateAggregate *aggregate = (const DateAggregate *)atomic_ptr_load(&manager->date_index);
+        ready = (aggregate != NULL && aggregate->version == view.version &&
+                 aggregate->record_count == view.size) ? TRUE : FALSE;
+    }
+    employee_manager_view_end(manager, &view);
+    return ready;
+}
+
+EmployeeSnapshot *employee_manager_snapshot(EmployeeManager *manager) {
+    if (manager == NULL) {
+        return NULL;
+    }
+    
+    /* 非并发模式下的数组会被原地修改,快照只能基于发布的表版本 */
+    if (!manager->concurrent) {
+        return NULL;
+    }
+    
+    EmployeeSnapshot *snapshot = (EmployeeSnapshot *)malloc(sizeof(EmployeeSnapshot));
+    if (snapshot == NULL) {
+        return NULL;
+    }
+    
+    snapshot->manager = manager;
+    employee_manager_view_begin(manager, &snapshot->view);
+    snapshot->version = snapshot->view.table->version;
+    return snapshot;
+}
+
+void employee_snapshot_release(EmployeeSnapshot *snapshot) {
+    if (snapshot != NULL) {
+        employee_manager_view_end(snapshot->manager, &snapshot->view);
+        free(snapshot);
+    }
+}
+
+size_t employee_snapshot_size(const EmployeeSnapshot *snapshot) {
+    if (snapshot == NULL) {
+        return 0;
+    }
+    return snapshot->view.size;
+}
+
+const Employee *employee_snapshot_get(const EmployeeSnapshot *snapshot, size_t index) {
+    if (snapshot == NULL) {
+        return NULL;
+    }
+    return employee_view_get(&snapshot->view, index);
+}
+
+/* ========== 查询 ========== */
+
+/* 判断职工是否满足查询条件 */
+Bool employee_matches(const Employee *emp, SearchType type, const void *keyword) {
+    switch (type) {
+        case SEARCH_BY_ID:
+            return (emp->id == *(const int *)keyword) ? TRUE : FALSE;
+        case SEARCH_BY_NAME:
+            return (strstr(emp->name, (const char *)keyword) != NULL) ? TRUE : FALSE;
+        case SEARCH_BY_DEPARTMENT:
+            return (strcmp(emp->department, (const char *)keyword) == 0) ? TRUE : FALSE;
+    }
+    return FALSE;
+}
+
+/* 计算分块数: 记录数低于阈值时不拆分,否则按并行度的若干倍切分以平衡负载 */
+static size_t scan_chunk_count(const EmployeeView *view, ThreadPool *pool) {
+    if (pool == NULL || view->size < PARALLEL_SCAN_THRESHOLD) {
+        return 1;
+    }
+    size_t chunks = (size_t)thread_pool_concurrency(pool) * PARALLEL_SCAN_OVERSUBSCRIBE;
+    size_t max_chunks = view->size / PARALLEL_SCAN_MIN_CHUNK;
+    size_t span_count = employee_view_span_count(view);
+    if (max_chunks > span_count) {
+        max_chunks = span_count;
+    }
+    if (chunks > max_chunks) {
+        chunks = max_chunks;
+    }
+    return (chunks > 0) ? chunks : 1;
+}
+
+/* 分块查询上下文: 每个分块负责一段连续的记录段,写入独立的局部结果缓冲区 */
+typedef struct {
+    const EmployeeView *view;
+    size_t span_count;
+    size_t chunk_count;
+    SearchType type;
+    const void *keyword;
+    Vector **partials;     /* 每个分块的局部结果 */
+    volatile long failed;  /* 任一分块内存不足时置1 */
+} SearchScan;
+
+static ErrorCode search_scan_spans(const EmployeeView *view, size_t first, size_t last,
+                                   SearchType type, const void *keyword, Vector *out) {
+    for (size_t s = first; s < last; s++) {
+        Employee *const *records = NULL;
+        size_t count = employee_view_span(view, s, &records);
+        for (size_t i = 0; i < count; i++) {
+            if (employee_matches(records[i], type, keyword)) {
+                ErrorCode err = vector_push_back(out, records[i]);
+                if (err != SUCCESS) {
+                    return err;
+                }
+            }
+        }
+    }
+    return SUCCESS;
+}
+
+static void search_scan_chunk(void *ctx, size_t chunk) {
+    SearchScan *scan = (SearchScan *)ctx;
+    size_t first = scan->span_count * chunk / scan->chunk_count;
+    size_t last = scan->span_count * (chunk + 1) / scan->chunk_count;
+    if (search_scan_spans(scan->view, first, last, scan->type, scan->keyword,
+                          scan->partials[chunk]) != SUCCESS) {
+        atomic_long_store(&scan->failed, 1);
+    }
+}
+
+/* 用索引回答按工号/部门的查询,索引不适用时返回FALSE */
+static Bool search_index(const EmployeeView *view, const EmployeeIndex *index,
+                         SearchType type, const void *keyword, Vector *results) {
+    if (index == NULL || index->version != view->version || index->record_count != view->size) {
+        return FALSE;
+    }
+    
+    if (type == SEARCH_BY_ID) {
+        unsigned int positions[16];
+        size_t count = employee_index_find_id(index, *(const int *)keyword, positions, 16);
+        if (count > 16) {
+            return FALSE;  /* 重复工号过多,交给全表扫描 */
+        }
+        if (vector_reserve(results, count) != SUCCESS) {
+            return FALSE;
+        }
+        for (size_t i = 0; i < count; i++) {
+            vector_push_back(results, (void *)employee_view_get(view, positions[i]));
+        }
+        return TRUE;
+    }
+    
+    if (type == SEARCH_BY_DEPARTMENT) {
+        size_t count = 0;
+        const unsigned int *positions = employee_index_find_department(
+            index, (const char *)keyword, &count);
+        if (vector_reserve(results, count) != SUCCESS) {
+            return FALSE;
+        }
+        for (size_t i = 0; i < count; i++) {
+            vector_push_back(results, (void *)employee_view_get(view, positions[i]));
+        }
+        return TRUE;
+    }
+    
+    return FALSE;
+}
+
+/* 用姓名索引回答子串查询: 候选位置升序,逐条确认后结果顺序与全表扫描一致 */
+static Bool search_name_index(const EmployeeView *view, const NameIndex *index,
+                              const char *keyword, Vector *results) {
+    if (index == NULL || index->version != view->version || index->record_count != view->size) {
+        return FALSE;
+    }
+    
+    const unsigned int *positions = NULL;
+    size_t count = 0;
+    if (!name_index_candidates(index, keyword, &positions, &count)) {
+        return FALSE;
+    }
+    /* 按候选数预留容量,确认过程中的追加不会失败 */
+    if (vector_reserve(results, count) != SUCCESS) {
+        return FALSE;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const Employee *emp = employee_view_get(view, positions[i]);
+        if (strstr(emp->name, keyword) != NULL) {
+            vector_push_back(results, (void *)emp);
+        }
+    }
+    return TRUE;
+}
+
+/* 在视图上执行查询,大表按块并行扫描后按顺序合并 */
+static Vector *search_view(const EmployeeView *view, const EmployeeIndex *index,
+                           const NameIndex *name_index, SearchType type, const void *keyword) {
     Vector *results = vector_create();
     if (results == NULL) {
         return NULL;
     }
     
-    size_t size = vector_size(manager->employees);
-    for (size_t i = 0; i < size; i++) {
-        Employee *emp = (Employee *)manager->employees->data[i];
-        Bool match = FALSE;
-        
-        switch (type) {
-            case SEARCH_BY_ID:
-                if (emp->id == *(int *)keyword) {
-                    match = TRUE;
-                }
-                break;
-            case SEARCH_BY_NAME:
-                if (strstr(emp->name, (const char *)keyword) != NULL) {
-                    match = TRUE;
-                }
-                break;
-            case SEARCH_BY_DEPARTMENT:
-                if (strcmp(emp->department, (const char *)keyword) == 0) {
-                    match = TRUE;
-                }
-                break;
+    if (type == SEARCH_BY_NAME) {
+        if (search_name_index(view, name_index, (const char *)keyword, results)) {
+            return results;
         }
-        
-        if (match) {
-            vector_push_back(results, emp);
+    } else if (search_index(view, index, type, keyword, results)) {
+        return results;
+    }
+    
+    ThreadPool *pool = (view->size >= PARALLEL_SCAN_THRESHOLD) ? thread_pool_default() : NULL;
+    size_t chunk_count = scan_chunk_count(view, pool);
+    size_t span_count = employee_view_span_count(view);
+    
+    if (chunk_count == 1) {
+        /* 内存不足时不返回不完整的结果,调用方也就不会把它放进缓存 */
+        if (search_scan_spans(view, 0, span_count, type, keyword, results) != SUCCESS) {
+            vector_free(results);
+            return NULL;
         }
+        return results;
+    }
+    
+    SearchScan scan;
+    scan.view = view;
+    scan.span_count = span_count;
+    scan.chunk_count = chunk_count;
+    scan.type = type;
+    scan.keyword = keyword;
+    scan.failed = 0;
+    scan.partials = (Vector **)calloc(chunk_count, sizeof(Vector *));
+    if (scan.partials == NULL) {
+        vector_free(results);
+        return NULL;
+    }
+    
+    Bool ok = TRUE;
+    for (size_t c = 0; c < chunk_count && ok; c++) {
+        scan.partials[c] = vector_create();
+        ok = (scan.partials[c] != NULL) ? TRUE : FALSE;
+    }
+    
+    if (ok && thread_pool_run(pool, chunk_count, search_scan_chunk, &scan) == SUCCESS &&
+        atomic_long_load(&scan.failed) == 0) {
+        /* 按分块顺序拼接,保持与串行扫描一致的结果顺序 */
+        size_t total = 0;
+        for (size_t c = 0; c < chunk_count; c++) {
+            total += scan.partials[c]->size;
+        }
+        ok = (vector_reserve(results, total) == SUCCESS) ? TRUE : FALSE;
+        for (size_t c = 0; c < chunk_count && ok; c++) {
+            Vector *local = scan.partials[c];
+            if (local->size > 0) {
+                memcpy(results->data + results->size, local->data, local->size * sizeof(void *));
+                results->size += local->size;
+            }
+        }
+    } else {
+        ok = FALSE;
+    }
+    
+    for (size_t c = 0; c < chunk_count; c++) {
+        vector_free(scan.partials[c]);
     }
+    free(scan.partials);
     
+    if (!ok) {
+        vector_free(results);
+        return NULL;
+    }
+    return results;
+}
+
+Vector *employee_manager_search(EmployeeManager *manager, SearchType type,
+                                const void *keyword) {
+    if (manager == NULL || keyword == NULL) {
+        return NULL;
+    }
+    
+    EmployeeView view;
+    employee_manager_view_begin(manager, &view);
+    
+    /* 缓存项与视图版本一致时,其中的指针就是当前视图中的记录 */
+    size_t key_len = (type == SEARCH_BY_ID) ? sizeof(int) : strlen((const char *)keyword);
+    Vector *results = vector_create();
+    if (results != NULL &&
+        query_cache_get_results(manager->cache, (int)type, keyword, key_len, view.version, results)) {
+        employee_manager_view_end(manager, &view);
+        return results;
+    }
+    vector_free(results);
+    
+    const EmployeeIndex *index = (const EmployeeIndex *)atomic_ptr_load(&manager->index);
+    const NameIndex *name_index = (const NameIndex *)atomic_ptr_load(&manager->name_index);
+    results = search_view(&view, index, name_index, type, keyword);
+    if (results != NULL) {
+        query_cache_put_results(manager->cache, (int)type, keyword, key_len, view.version, results);
+    }
+    employee_manager_view_end(manager, &view);
     return results;
 }
 
@@ -237,35 +1234,42 @@ static int compare_by_attend_days(const void *a, const void *b) {
     return (e2->attend_days > e1->attend_days) - (e2->attend_days < e1->attend_days);
 }
 
-void employee_manager_sort(EmployeeManager *manager, SortType type) {
-    if (manager == NULL || manager->employees == NULL) {
-        return;
-    }
-    
-    Comparator compare = NULL;
+Comparator employee_comparator(SortType type) {
     switch (type) {
         case SORT_BY_ID:
-            compare = compare_by_id;
-            break;
+            return compare_by_id;
         case SORT_BY_NAME:
-            compare = compare_by_name;
-            break;
+            return compare_by_name;
         case SORT_BY_DEPARTMENT:
-            compare = compare_by_department;
-            break;
+            return compare_by_department;
         case SORT_BY_ATTEND_DATE:
-            compare = compare_by_attend_date;
-            break;
+            return compare_by_attend_date;
         case SORT_BY_ATTEND_DAYS:
-            compare = compare_by_attend_days;
-            break;
+            return compare_by_attend_days;
+    }
+    return NULL;
+}
+
+void employee_manager_sort(EmployeeManager *manager, SortType type) {
+    if (manager == NULL || manager->employees == NULL) {
+        return;
     }
     
+    Comparator compare = employee_comparator(type);
     if (compare != NULL) {
+        manager_lock(manager);
         quick_sort(manager->employees, compare);
+        manager_check_id_order(manager);
+        manager->generation++;
+        manager_mark_dirty_from(manager, 0);
+        if (manager->concurrent) {
+            manager_republish_all(manager);
+        }
+        manager_unlock(manager);
     }
 }
 
+
 Vector *employee_manager_get_all(EmployeeManager *manager) {
     if (manager == NULL) {
         return NULL;
@@ -273,25 +1277,108 @@ Vector *employee_manager_get_all(EmployeeManager *manager) {
     return manager->employees;
 }
 
-int employee_manager_monthly_attendance(EmployeeManager *manager,
-                                        const char *year_month) {
-    if (manager == NULL || year_month == NULL) {
-        return 0;
+/* 分块出勤统计上下文: 每个分块写入独立的部分和 */
+typedef struct {
+    const EmployeeView *view;
+    size_t span_count;
+    size_t chunk_count;
+    const char *prefix;
+    size_t prefix_len;
+    long long *partials;
+} AttendanceScan;
+
+static long long attendance_scan_spans(const EmployeeView *view, size_t first, size_t last,
+                                       const char *prefix, size_t prefix_len) {
+    long long total = 0;
+    for (size_t s = first; s < last; s++) {
+        Employee *const *records = NULL;
+        size_t count = employee_view_span(view, s, &records);
+        for (size_t i = 0; i < count; i++) {
+            if (strncmp(records[i]->attend_date, prefix, prefix_len) == 0) {
+                total += records[i]->attend_days;
+            }
+        }
+    }
+    return total;
+}
+
+static void attendance_scan_chunk(void *ctx, size_t chunk) {
+    AttendanceScan *scan = (AttendanceScan *)ctx;
+    size_t first = scan->span_count * chunk / scan->chunk_count;
+    size_t last = scan->span_count * (chunk + 1) / scan->chunk_count;
+    scan->partials[chunk] = attendance_scan_spans(scan->view, first, last,
+                                                  scan->prefix, scan->prefix_len);
+}
+
+/* 统计出勤日期以prefix开头的职工出勤天数之和 */
+static int attendance_sum_by_prefix(EmployeeManager *manager, const char *prefix) {
+    EmployeeView view;
+    employee_manager_view_begin(manager, &view);
+    
+    size_t len = strlen(prefix);
+    long long summed = 0;
+    if (query_cache_get_number(manager->cache, CACHE_QUERY_ATTENDANCE, prefix, len,
+                               view.version, &summed)) {
+        employee_manager_view_end(manager, &view);
+        return (int)summed;
     }
     
-    int total_days = 0;
-    size_t len = strlen(year_month);
+    /* 汇总表与视图版本一致时直接累加月度汇总 */
+    const DateAggregate *aggregate = (const DateAggregate *)atomic_ptr_load(&manager->date_index);
+    if (aggregate != NULL && aggregate->version == view.version &&
+        aggregate->record_count == view.size && date_aggregate_sum(aggregate, prefix, &summed)) {
+        query_cache_put_number(manager->cache, CACHE_QUERY_ATTENDANCE, prefix, len,
+                               view.version, summed);
+        employee_manager_view_end(manager, &view);
+        return (int)summed;
+    }
     
-    size_t size = vector_size(manager->employees);
-    for (size_t i = 0; i < size; i++) {
-        Employee *emp = (Employee *)manager->employees->data[i];
-        /* 检查日期是否以year_month开头 (如"2024-01") */
-        if (strncmp(emp->attend_date, year_month, len) == 0) {
-            total_days += emp->attend_days;
+    size_t span_count = employee_view_span_count(&view);
+    ThreadPool *pool = (view.size >= PARALLEL_SCAN_THRESHOLD) ? thread_pool_default() : NULL;
+    size_t chunk_count = scan_chunk_count(&view, pool);
+    
+    long long *partials = NULL;
+    if (chunk_count > 1) {
+        partials = (long long *)calloc(chunk_count, sizeof(long long));
+    }
+    
+    long long total = 0;
+    Bool scanned = FALSE;
+    if (partials != NULL) {
+        AttendanceScan scan;
+        scan.view = &view;
+        scan.span_count = span_count;
+        scan.chunk_count = chunk_count;
+        scan.prefix = prefix;
+        scan.prefix_len = len;
+        scan.partials = partials;
+        if (thread_pool_run(pool, chunk_count, attendance_scan_chunk, &scan) == SUCCESS) {
+            for (size_t c = 0; c < chunk_count; c++) {
+                total += partials[c];
+            }
+            scanned = TRUE;
         }
+        free(partials);
+    }
+    /* 单线程扫描;并行提交失败时也退回这里,不返回只含部分分块的合计 */
+    if (!scanned) {
+        total = attendance_scan_spans(&view, 0, span_count, prefix, len);
+    }
+    
+    query_cache_put_number(manager->cache, CACHE_QUERY_ATTENDANCE, prefix, len,
+                           view.version, total);
+    employee_manager_view_end(manager, &view);
+    return (int)total;
+}
+
+int employee_manager_monthly_attendance(EmployeeManager *manager,
+                                        const char *year_month) {
+    if (manager == NULL || year_month == NULL) {
+        return 0;
     }
     
-    return total_days;
+    /* 检查日期是否以year_month开头 (如"2024-01") */
+    return attendance_sum_by_prefix(manager, year_month);
 }
 
 int employee_manager_yearly_attendance(EmployeeManager *manager,
@@ -300,17 +1387,6 @@ int employee_manager_yearly_attendance(EmployeeManager *manager,
         return 0;
     }
     
-    int total_days = 0;
-    size_t len = strlen(year);
-    
-    size_t size = vector_size(manager->employees);
-    for (size_t i = 0; i < size; i++) {
-        Employee *emp = (Employee *)manager->employees->data[i];
-        /* 检查日期是否以year开头 (如"2024") */
-        if (strncmp(emp->attend_date, year, len) == 0) {
-            total_days += emp->attend_days;
-        }
-    }
-    
-    return total_days;
+    /* 检查日期是否以year开头 (如"2024") */
+    return attendance_sum_by_prefix(manager, year);
 }
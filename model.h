@@ -4,6 +4,8 @@
 #include "common.h"
 #include "vector.h"
 #include "sort.h"
+#include "thread.h"
+#include "epoch.h"
 
 /* 职工结构体 */
 PACK_PUSH
@@ -16,12 +18,85 @@ typedef struct {
 } Employee;
 PACK_POP
 
+/* 每个记录块容纳的职工指针数 */
+#define EMPLOYEE_BLOCK_SIZE 1024
+
+/* 记录块: 发布后只读,修改时整块复制(写时复制) */
+typedef struct {
+    size_t count;                              /* 块内记录数 */
+    Employee *records[EMPLOYEE_BLOCK_SIZE];    /* 职工指针 */
+} EmployeeBlock;
+
+/* 表版本: 并发模式下发布给读者的不可变视图,未修改的块在版本间共享 */
+typedef struct {
+    unsigned long version;   /* 发布时管理器的修改代数 */
+    int next_id;             /* 发布时的下一个可用工号 */
+    size_t size;             /* 记录总数 */
+    size_t block_count;      /* 块数 */
+    EmployeeBlock **blocks;  /* 块指针数组 */
+    size_t *block_starts;    /* 每块首条记录的全局下标 */
+} EmployeeTable;
+
+/* 索引(见index.h) */
+struct EmployeeIndex;
+struct NameIndex;
+struct DateAggregate;
+
+/* 查询结果缓存(见query_cache.h) */
+struct QueryCache;
+
+/* 附加到管理器的索引种类,按后台构建的顺序排列 */
+typedef enum {
+    INDEX_KIND_PRIMARY = 0,  /* 工号哈希 + 部门倒排(EmployeeIndex) */
+    INDEX_KIND_NAME,         /* 姓名字节组倒排(NameIndex) */
+    INDEX_KIND_DATE,         /* 出勤日期月度汇总(DateAggregate) */
+    INDEX_KIND_COUNT
+} IndexKind;
+
+/* 全部索引种类的位掩码 */
+#define INDEX_KINDS_ALL ((1u << INDEX_KIND_COUNT) - 1u)
+
+/* 变更跟踪粒度(条),与存储层v2记录块的大小一致 */
+#define DIRTY_BLOCK_RECORDS 4096
+
 /* 职工管理器 */
 typedef struct {
-    Vector *employees;  /* 存储Employee指针的动态数组 */
-    int next_id;        /* 下一个可用的工号 */
+    Vector *employees;          /* 存储Employee指针的动态数组(写者视图) */
+    int next_id;                /* 下一个可用的工号 */
+    unsigned long generation;   /* 修改代数: 每次增删改、排序、批量写入后加1 */
+    Bool concurrent;            /* 是否已启用并发模式 */
+    Bool ids_ascending;         /* 写者数组是否按工号严格递增(此时可按工号二分查找) */
+    Mutex *write_lock;          /* 并发模式: 写者互斥锁 */
+    EpochDomain *epoch;         /* 并发模式: 读者纪元与延迟回收 */
+    void *volatile published;   /* 并发模式: 当前发布的EmployeeTable */
+    void *volatile index;       /* 附加的EmployeeIndex,版本与视图不符时不使用 */
+    void *volatile name_index;  /* 附加的NameIndex,同上 */
+    void *volatile date_index;  /* 附加的DateAggregate,同上 */
+    struct QueryCache *cache;   /* 查询与出勤统计结果缓存,按修改代数失效 */
+    unsigned char *dirty_blocks;    /* 变更跟踪: 自同步以来修改过的块(每块DIRTY_BLOCK_RECORDS条) */
+    size_t dirty_capacity;          /* dirty_blocks的长度 */
+    size_t dirty_from;              /* 此块及之后全部视为已修改(删除、排序后位置整体移动) */
+    size_t synced_size;             /* 同步时的记录数 */
+    unsigned long long sync_stamp;  /* 同步文件的保存标记,0表示没有同步基线 */
 } EmployeeManager;
 
+/* 只读视图: 非并发模式引用职工数组,并发模式引用某个已发布的表版本 */
+typedef struct {
+    Employee **records;          /* 非并发模式: 连续的职工指针数组 */
+    const EmployeeTable *table;  /* 并发模式: 分块表版本 */
+    size_t size;                 /* 记录总数 */
+    int next_id;                 /* 下一个可用工号 */
+    unsigned long version;       /* 视图对应的修改代数 */
+    int token;                   /* 并发模式: 读临界区令牌 */
+} EmployeeView;
+
+/* 快照: 某一时刻的不可变表版本,创建为O(1),持有期间写者可继续修改 */
+typedef struct {
+    EmployeeManager *manager;  /* 所属管理器 */
+    EmployeeView view;         /* 持有读临界区的只读视图 */
+    unsigned long version;     /* 快照对应的修改代数 */
+} EmployeeSnapshot;
+
 /* 查询条件 */
 typedef enum {
     SEARCH_BY_ID,
@@ -38,6 +113,15 @@ typedef enum {
     SORT_BY_ATTEND_DAYS
 } SortType;
 
+/* 职工字段校验结果 */
+typedef enum {
+    EMPLOYEE_FIELDS_OK = 0,
+    EMPLOYEE_BAD_NAME,        /* 姓名为空或过长 */
+    EMPLOYEE_BAD_DEPARTMENT,  /* 部门为空或过长 */
+    EMPLOYEE_BAD_DATE,        /* 出勤日期过长 */
+    EMPLOYEE_BAD_DAYS         /* 出勤天数不在0~MAX_ATTEND_DAYS */
+} EmployeeFieldError;
+
 /* ========== EmployeeManager 方法 ========== */
 
 /* 创建管理器 */
@@ -46,7 +130,7 @@ EmployeeManager *employee_manager_create(void);
 /* 释放管理器 */
 void employee_manager_free(EmployeeManager *manager);
 
-/* 添加职工 */
+/* 添加职工(字段不合法时返回ERROR_INVALID_PARAMETER,见employee_check_fields) */
 ErrorCode employee_manager_add(EmployeeManager *manager, const char *name, 
                                const char *department, const char *attend_date, 
                                int attend_days);
@@ -57,19 +141,28 @@ ErrorCode employee_manager_remove_at(EmployeeManager *manager, size_t index);
 /* 根据工号删除职工 */
 ErrorCode employee_manager_remove_by_id(EmployeeManager *manager, int id);
 
-/* 修改职工信息 */
+/* 修改职工信息(字段校验同添加) */
 ErrorCode employee_manager_update(EmployeeManager *manager, int id,
                                   const char *name, const char *department,
                                   const char *attend_date, int attend_days);
 
-/* 查询职工 */
+/* 查询职工: 数据未修改时重复的查询直接返回缓存的结果 */
 Vector *employee_manager_search(EmployeeManager *manager, SearchType type, 
                                 const void *keyword);
 
+/* 判断职工是否满足查询条件 */
+Bool employee_matches(const Employee *emp, SearchType type, const void *keyword);
+
 /* 排序职工 */
 void employee_manager_sort(EmployeeManager *manager, SortType type);
 
-/* 获取所有职工 */
+/* 排序方式对应的比较器(参数为指向Employee指针的指针) */
+Comparator employee_comparator(SortType type);
+
+/*
+ * 获取所有职工: 返回写者自己的数组,不做复制。
+ * 并发模式下只有写者线程可以调用,且结果在该线程下一次修改前有效;其他线程请用快照。
+ */
 Vector *employee_manager_get_all(EmployeeManager *manager);
 
 /* 统计月度出勤 */
@@ -80,12 +173,105 @@ int employee_manager_monthly_attendance(EmployeeManager *manager,
 int employee_manager_yearly_attendance(EmployeeManager *manager, 
                                        const char *year);
 
+/* ========== 并发模式 ========== */
+
+/*
+ * 启用并发模式: 此后读者通过纪元保护的只读表版本访问数据,永不阻塞;
+ * 写者之间用互斥锁串行化,修改时只复制受影响的记录块并原子发布新版本,
+ * 被替换的块与记录在所有旧读者离开后回收。
+ * 并发模式下查询结果中的指针只在调用方持有读锁期间有效。
+ * 须在其他线程访问管理器之前由写者线程调用且只调用一次,重复调用会触发断言。
+ */
+ErrorCode employee_manager_enable_concurrency(EmployeeManager *manager);
+
+/* 读锁: 进入读临界区(非阻塞),返回的令牌需交给read_unlock */
+int employee_manager_read_lock(EmployeeManager *manager);
+void employee_manager_read_unlock(EmployeeManager *manager, int token);
+
+/* 批量写入: 直接修改employees数组前后调用,结束时重新发布整张表 */
+void employee_manager_begin_write(EmployeeManager *manager);
+void employee_manager_end_write(EmployeeManager *manager);
+
+/* 打开只读视图(并发模式下进入读临界区),使用完毕须调用view_end */
+ErrorCode employee_manager_view_begin(EmployeeManager *manager, EmployeeView *view);
+void employee_manager_view_end(EmployeeManager *manager, EmployeeView *view);
+
+/* 视图按块遍历: 返回第index段的记录数,并通过records输出该段首地址 */
+size_t employee_view_span_count(const EmployeeView *view);
+size_t employee_view_span(const EmployeeView *view, size_t index, Employee *const **records);
+
+/* 按全局下标读取视图中的记录 */
+const Employee *employee_view_get(const EmployeeView *view, size_t index);
+
+/*
+ * 附加索引(接管所有权,可为NULL以移除): 查询按工号/部门时,
+ * 若索引版本与视图版本一致则直接查索引,否则退回全表扫描
+ */
+ErrorCode employee_manager_attach_index(EmployeeManager *manager, struct EmployeeIndex *index);
+
+/* 附加姓名索引(按姓名查询且关键字不短于3字节时使用)与出勤汇总(月度/年度统计时使用) */
+ErrorCode employee_manager_attach_name_index(EmployeeManager *manager, struct NameIndex *index);
+ErrorCode employee_manager_attach_date_aggregate(EmployeeManager *manager,
+                                                 struct DateAggregate *aggregate);
+
+/* 某种索引是否已附加且与当前版本一致(即查询会走索引而非全表扫描) */
+Bool employee_manager_index_ready(EmployeeManager *manager, IndexKind kind);
+
+/* ========== 变更跟踪 ========== */
+
+/* 自同步以来的变更: 由employee_manager_changes复制,用完须employee_changes_free */
+typedef struct {
+    unsigned long long stamp;  /* 同步文件的保存标记,0表示没有同步基线 */
+    unsigned long version;     /* 复制时的修改代数 */
+    size_t synced_size;        /* 同步时的记录数 */
+    size_t dirty_from;         /* 此块及之后全部视为已修改 */
+    unsigned char *blocks;     /* 各块是否修改 */
+    size_t block_count;        /* blocks的长度 */
+} EmployeeChanges;
+
+/*
+ * 标记已与文件同步: stamp为文件的保存标记(0清除基线),version为写出或读入的视图版本;
+ * 其间又有修改(版本不符)时清除基线,下次保存退回完整写出
+ */
+void employee_manager_mark_synced(EmployeeManager *manager, unsigned long version,
+                                  unsigned long long stamp);
+
+/* 复制当前的变更信息 */
+ErrorCode employee_manager_changes(EmployeeManager *manager, EmployeeChanges *changes);
+void employee_changes_free(EmployeeChanges *changes);
+
+/* 第block块自同步以来是否修改过 */
+Bool employee_changes_dirty(const EmployeeChanges *changes, size_t block);
+
+/* ========== MVCC快照 ========== */
+
+/*
+ * 创建快照: 引用当前发布的表版本,不复制数据;只能在并发模式下使用,
+ * 未启用时返回NULL。快照可交给其他线程长时间使用,
+ * 期间被替换的块会暂缓回收,释放快照后统一回收。
+ */
+EmployeeSnapshot *employee_manager_snapshot(EmployeeManager *manager);
+
+/* 释放快照(可在任意线程调用) */
+void employee_snapshot_release(EmployeeSnapshot *snapshot);
+
+/* 快照中的记录数与按下标访问 */
+size_t employee_snapshot_size(const EmployeeSnapshot *snapshot);
+const Employee *employee_snapshot_get(const EmployeeSnapshot *snapshot, size_t index);
+
 /* ========== Employee 工具函数 ========== */
 
 /* 创建职工 */
 Employee *employee_create(int id, const char *name, const char *department,
                          const char *attend_date, int attend_days);
 
+/*
+ * 校验职工字段(添加、修改与CSV导入共用): 姓名、部门非空且不超长,出勤天数在0~MAX_ATTEND_DAYS;
+ * 出勤日期只限制长度,可为空或非标准写法(统计按前缀匹配,分区归入年份0)
+ */
+EmployeeFieldError employee_check_fields(const char *name, const char *department,
+                                         const char *attend_date, int attend_days);
+
 /* 释放职工 */
 void employee_free(Employee *emp);
 
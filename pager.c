@@ -0,0 +1,205 @@
+#include "pager.h"
+#include "thread.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* 空链接/空帧标记 */
+#define NO_FRAME ((size_t)-1)
+
+typedef struct {
+    size_t page;        /* 缓存的页号 */
+    size_t size;        /* 有效字节数 */
+    size_t pins;        /* 钉住计数 */
+    size_t next;        /* 同一哈希桶中的下一帧 */
+    Bool valid;         /* 是否缓存了页 */
+    Bool referenced;    /* CLOCK引用位 */
+    unsigned char *data;
+} Frame;
+
+struct BufferPool {
+    Mutex *lock;
+    Frame *frames;
+    size_t frame_count;
+    size_t page_size;
+    size_t *buckets;    /* 页号 -> 帧的哈希桶(链表头) */
+    size_t bucket_count;  /* 2的幂 */
+    size_t hand;        /* CLOCK指针 */
+    PageLoader loader;
+    void *ctx;
+    BufferPoolStats stats;
+};
+
+static size_t page_bucket(const BufferPool *pool, size_t page) {
+    unsigned long long x = (unsigned long long)page;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    return (size_t)x & (pool->bucket_count - 1);
+}
+
+static size_t find_frame(const BufferPool *pool, size_t page) {
+    for (size_t f = pool->buckets[page_bucket(pool, page)]; f != NO_FRAME; f = pool->frames[f].next) {
+        if (pool->frames[f].page == page) {
+            return f;
+        }
+    }
+    return NO_FRAME;
+}
+
+static void unlink_frame(BufferPool *pool, size_t frame) {
+    size_t *link = &pool->buckets[page_bucket(pool, pool->frames[frame].page)];
+    while (*link != frame) {
+        link = &pool->frames[*link].next;
+    }
+    *link = pool->frames[frame].next;
+    pool->frames[frame].valid = FALSE;
+}
+
+/* CLOCK: 跳过钉住的帧,引用位为1的帧清零后给第二次机会;两圈都找不到时返回NO_FRAME */
+static size_t choose_victim(BufferPool *pool) {
+    for (size_t step = 0; step < pool->frame_count * 2; step++) {
+        size_t f = pool->hand;
+        pool->hand = (pool->hand + 1) % pool->frame_count;
+        Frame *frame = &pool->frames[f];
+        if (frame->pins > 0) {
+            continue;
+        }
+        if (frame->valid && frame->referenced) {
+            frame->referenced = FALSE;
+            continue;
+        }
+        return f;
+    }
+    return NO_FRAME;
+}
+
+BufferPool *buffer_pool_create(size_t frame_count, size_t page_size,
+                               PageLoader loader, void *ctx) {
+    if (frame_count == 0 || page_size == 0 || loader == NULL) {
+        return NULL;
+    }
+
+    BufferPool *pool = (BufferPool *)calloc(1, sizeof(BufferPool));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->frame_count = frame_count;
+    pool->page_size = page_size;
+    pool->loader = loader;
+    pool->ctx = ctx;
+    pool->bucket_count = 16;
+    while (pool->bucket_count < frame_count * 2) {
+        pool->bucket_count *= 2;
+    }
+
+    pool->lock = mutex_create();
+    pool->frames = (Frame *)calloc(frame_count, sizeof(Frame));
+    pool->buckets = (size_t *)malloc(pool->bucket_count * sizeof(size_t));
+    if (pool->lock == NULL || pool->frames == NULL || pool->buckets == NULL) {
+        buffer_pool_free(pool);
+        return NULL;
+    }
+    for (size_t b = 0; b < pool->bucket_count; b++) {
+        pool->buckets[b] = NO_FRAME;
+    }
+    for (size_t f = 0; f < frame_count; f++) {
+        pool->frames[f].next = NO_FRAME;
+        pool->frames[f].data = (unsigned char *)malloc(page_size);
+        if (pool->frames[f].data == NULL) {
+            buffer_pool_free(pool);
+            return NULL;
+        }
+    }
+    return pool;
+}
+
+void buffer_pool_free(BufferPool *pool) {
+    if (pool == NULL) {
+        return;
+    }
+    if (pool->frames != NULL) {
+        for (size_t f = 0; f < pool->frame_count; f++) {
+            free(pool->frames[f].data);
+        }
+    }
+    free(pool->frames);
+    free(pool->buckets);
+    mutex_free(pool->lock);
+    free(pool);
+}
+
+ErrorCode buffer_pool_pin(BufferPool *pool, size_t page, PageHandle *handle) {
+    if (pool == NULL || handle == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    mutex_lock(pool->lock);
+    size_t f = find_frame(pool, page);
+    if (f != NO_FRAME) {
+        pool->stats.hits++;
+    } else {
+        f = choose_victim(pool);
+        if (f == NO_FRAME) {
+            mutex_unlock(pool->lock);
+            return ERROR_OUT_OF_MEMORY;
+        }
+        Frame *frame = &pool->frames[f];
+        if (frame->valid) {
+            unlink_frame(pool, f);
+            pool->stats.evictions++;
+        }
+
+        /* 加载在锁内进行: 同一页不会被并发重复加载 */
+        size_t size = 0;
+        ErrorCode err = pool->loader(pool->ctx, page, frame->data, &size);
+        if (err != SUCCESS) {
+            mutex_unlock(pool->lock);
+            return err;
+        }
+        size_t bucket = page_bucket(pool, page);
+        frame->page = page;
+        frame->size = (size < pool->page_size) ? size : pool->page_size;
+        frame->valid = TRUE;
+        frame->next = pool->buckets[bucket];
+        pool->buckets[bucket] = f;
+        pool->stats.misses++;
+    }
+
+    Frame *frame = &pool->frames[f];
+    frame->pins++;
+    frame->referenced = TRUE;
+    handle->page = page;
+    handle->data = frame->data;
+    handle->size = frame->size;
+    handle->frame = f;
+    mutex_unlock(pool->lock);
+    return SUCCESS;
+}
+
+void buffer_pool_unpin(BufferPool *pool, PageHandle *handle) {
+    if (pool == NULL || handle == NULL || handle->data == NULL) {
+        return;
+    }
+
+    mutex_lock(pool->lock);
+    Frame *frame = &pool->frames[handle->frame];
+    if (frame->pins > 0) {
+        frame->pins--;
+    }
+    mutex_unlock(pool->lock);
+    handle->data = NULL;
+    handle->size = 0;
+}
+
+void buffer_pool_stats(BufferPool *pool, BufferPoolStats *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    if (pool == NULL) {
+        memset(stats, 0, sizeof(BufferPoolStats));
+        return;
+    }
+    mutex_lock(pool->lock);
+    *stats = pool->stats;
+    mutex_unlock(pool->lock);
+}
@@ -0,0 +1,47 @@
+#ifndef PAGER_H
+#define PAGER_H
+
+#include "common.h"
+
+/*
+ * 缓冲池: 固定数量的页帧缓存磁盘上的定长页,按CLOCK算法淘汰。
+ * 页被钉住(pin)期间内容保持有效且不会被淘汰,用完须unpin;
+ * 缓存未命中时调用加载函数把页读入空闲或被淘汰的帧。
+ * 所有操作由内部互斥锁串行化,可在多个线程中同时钉住不同的页。
+ */
+
+/* 页加载函数: 把第page页读入buffer(容量为页大小),通过size返回有效字节数 */
+typedef ErrorCode (*PageLoader)(void *ctx, size_t page, void *buffer, size_t *size);
+
+typedef struct BufferPool BufferPool;
+
+/* 已钉住的页 */
+typedef struct {
+    size_t page;        /* 页号 */
+    const void *data;   /* 页内容,unpin前有效 */
+    size_t size;        /* 有效字节数 */
+    size_t frame;       /* 所在帧(内部使用) */
+} PageHandle;
+
+/* 命中统计 */
+typedef struct {
+    unsigned long long hits;       /* 命中次数 */
+    unsigned long long misses;     /* 未命中(加载)次数 */
+    unsigned long long evictions;  /* 淘汰次数 */
+} BufferPoolStats;
+
+/* 创建缓冲池: frame_count个帧,每帧page_size字节 */
+BufferPool *buffer_pool_create(size_t frame_count, size_t page_size,
+                               PageLoader loader, void *ctx);
+void buffer_pool_free(BufferPool *pool);
+
+/* 钉住第page页;所有帧都被钉住时返回ERROR_OUT_OF_MEMORY */
+ErrorCode buffer_pool_pin(BufferPool *pool, size_t page, PageHandle *handle);
+
+/* 解除钉住 */
+void buffer_pool_unpin(BufferPool *pool, PageHandle *handle);
+
+/* 读取命中统计(pool为NULL时全部为0) */
+void buffer_pool_stats(BufferPool *pool, BufferPoolStats *stats);
+
+#endif /* PAGER_H */
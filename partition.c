@@ -0,0 +1,498 @@
+#include "partition.h"
+#include "storage.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static Bool is_digit(char c) {
+    return (c >= '0' && c <= '9') ? TRUE : FALSE;
+}
+
+/* 分区年份: 日期前四位均为数字时取其值,否则为0 */
+static int date_year(const char *date) {
+    for (int i = 0; i < 4; i++) {
+        if (!is_digit(date[i])) {
+            return 0;
+        }
+    }
+    return (date[0] - '0') * 1000 + (date[1] - '0') * 100 + (date[2] - '0') * 10 + (date[3] - '0');
+}
+
+/* 月份: 日期形如YYYY-MM时取1~12,否则为0 */
+static int date_month(const char *date) {
+    if (date_year(date) == 0 || date[4] != '-' || !is_digit(date[5]) || !is_digit(date[6])) {
+        return 0;
+    }
+    int month = (date[5] - '0') * 10 + (date[6] - '0');
+    return (month >= 1 && month <= 12) ? month : 0;
+}
+
+/* 解析统计前缀"YYYY"或"YYYY-MM",month为0表示整年 */
+static Bool parse_prefix(const char *prefix, int *year, int *month) {
+    size_t length = strlen(prefix);
+    if (length == 4) {
+        *year = date_year(prefix);
+        *month = 0;
+        return (*year != 0) ? TRUE : FALSE;
+    }
+    if (length == 7) {
+        *year = date_year(prefix);
+        *month = date_month(prefix);
+        return (*year != 0 && *month != 0) ? TRUE : FALSE;
+    }
+    return FALSE;
+}
+
+/* "<base><suffix>",由调用方释放 */
+static char *make_path(const char *base, const char *suffix) {
+    size_t length = strlen(base) + strlen(suffix) + 1;
+    char *path = (char *)malloc(length);
+    if (path != NULL) {
+        snprintf(path, length, "%s%s", base, suffix);
+    }
+    return path;
+}
+
+static char *partition_path(const char *base, int year) {
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%04d.db", year);
+    return make_path(base, suffix);
+}
+
+/* 按年份查找分区下标,不存在返回-1 */
+static long find_part(const PartitionStore *store, int year) {
+    size_t lo = 0;
+    size_t hi = store->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (store->parts[mid].year == year) {
+            return (long)mid;
+        }
+        if (store->parts[mid].year < year) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return -1;
+}
+
+PartitionStore *partition_store_open(const char *base, ErrorCode *err) {
+    ErrorCode result = SUCCESS;
+    PartitionStore *store = NULL;
+    if (base == NULL) {
+        result = ERROR_NULL_POINTER;
+    } else if ((store = (PartitionStore *)calloc(1, sizeof(PartitionStore))) == NULL) {
+        result = ERROR_OUT_OF_MEMORY;
+    } else {
+        store->base = make_path(base, "");
+        store->manager = employee_manager_create();
+        if (store->base == NULL || store->manager == NULL) {
+            result = ERROR_OUT_OF_MEMORY;
+        }
+    }
+
+    /* 清单不存在时为空存储 */
+    char *manifest = (result == SUCCESS) ? make_path(base, ".manifest") : NULL;
+    if (result == SUCCESS && manifest == NULL) {
+        result = ERROR_OUT_OF_MEMORY;
+    }
+    if (result == SUCCESS) {
+        int next_id = 0;
+        result = storage_load_manifest(manifest, &store->parts, &store->count, &next_id);
+        if (result == ERROR_FILE_NOT_FOUND) {
+            result = SUCCESS;
+        } else if (result == SUCCESS && next_id > store->manager->next_id) {
+            store->manager->next_id = next_id;
+        }
+    }
+    free(manifest);
+    if (result == SUCCESS) {
+        store->loaded = (Bool *)calloc(store->count > 0 ? store->count : 1, sizeof(Bool));
+        if (store->loaded == NULL) {
+            result = ERROR_OUT_OF_MEMORY;
+        }
+    }
+    for (size_t i = 1; result == SUCCESS && i < store->count; i++) {
+        if (store->parts[i - 1].year >= store->parts[i].year) {
+            result = ERROR_DATA_CORRUPTION;
+        }
+    }
+
+    if (result != SUCCESS) {
+        partition_store_free(store);
+        store = NULL;
+    }
+    if (err != NULL) {
+        *err = result;
+    }
+    return store;
+}
+
+void partition_store_free(PartitionStore *store) {
+    if (store != NULL) {
+        employee_manager_free(store->manager);
+        free(store->base);
+        free(store->parts);
+        free(store->loaded);
+        free(store);
+    }
+}
+
+/* 加载第index个分区;分区文件的next_id不会使管理器的next_id后退 */
+static ErrorCode load_part(PartitionStore *store, size_t index) {
+    if (store->loaded[index]) {
+        return SUCCESS;
+    }
+    char *path = partition_path(store->base, store->parts[index].year);
+    if (path == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    int next_id = store->manager->next_id;
+    ErrorCode err = storage_load_employees(path, store->manager);
+    free(path);
+    if (store->manager->next_id < next_id) {
+        store->manager->next_id = next_id;
+    }
+    if (err == SUCCESS) {
+        store->loaded[index] = TRUE;
+    }
+    return err;
+}
+
+ErrorCode partition_store_load_year(PartitionStore *store, int year) {
+    if (store == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    long index = find_part(store, year);
+    return (index < 0) ? SUCCESS : load_part(store, (size_t)index);
+}
+
+ErrorCode partition_store_load_for_id(PartitionStore *store, int id) {
+    if (store == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    for (size_t i = 0; i < store->count; i++) {
+        if (id >= store->parts[i].min_id && id <= store->parts[i].max_id) {
+            ErrorCode err = load_part(store, i);
+            if (err != SUCCESS) {
+                return err;
+            }
+        }
+    }
+    return SUCCESS;
+}
+
+ErrorCode partition_store_load_all(PartitionStore *store) {
+    if (store == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    for (size_t i = 0; i < store->count; i++) {
+        ErrorCode err = load_part(store, i);
+        if (err != SUCCESS) {
+            return err;
+        }
+    }
+    return SUCCESS;
+}
+
+Bool partition_store_is_loaded(const PartitionStore *store, int year) {
+    if (store == NULL) {
+        return FALSE;
+    }
+    long index = find_part(store, year);
+    return (index >= 0 && store->loaded[index]) ? TRUE : FALSE;
+}
+
+Vector *partition_store_search(PartitionStore *store, SearchType type, const void *keyword) {
+    if (store == NULL || keyword == NULL) {
+        return NULL;
+    }
+    ErrorCode err = (type == SEARCH_BY_ID) ? partition_store_load_for_id(store, *(const int *)keyword)
+                                           : partition_store_load_all(store);
+    if (err != SUCCESS) {
+        return NULL;
+    }
+    return employee_manager_search(store->manager, type, keyword);
+}
+
+/* 已加载部分的统计加上未加载分区的清单汇总 */
+static int store_attendance(PartitionStore *store, const char *prefix) {
+    int year = 0;
+    int month = 0;
+    if (!parse_prefix(prefix, &year, &month)) {
+        /* 清单无法回答的前缀: 全部加载后在内存中统计 */
+        if (partition_store_load_all(store) != SUCCESS) {
+            return 0;
+        }
+    }
+
+    long long total = employee_manager_yearly_attendance(store->manager, prefix);
+    long index = (year != 0) ? find_part(store, year) : -1;
+    if (index >= 0 && !store->loaded[index]) {
+        const PartitionSummary *part = &store->parts[index];
+        total += (month != 0) ? part->month_days[month - 1] : part->total_days;
+    }
+    return (int)total;
+}
+
+int partition_store_yearly_attendance(PartitionStore *store, const char *year) {
+    if (store == NULL || year == NULL) {
+        return 0;
+    }
+    return store_attendance(store, year);
+}
+
+int partition_store_monthly_attendance(PartitionStore *store, const char *year_month) {
+    if (store == NULL || year_month == NULL) {
+        return 0;
+    }
+    return store_attendance(store, year_month);
+}
+
+/* 内存中出现的年份及各年的记录(按年份升序) */
+typedef struct {
+    int year;
+    size_t count;
+    Employee **records;
+} YearGroup;
+
+typedef struct {
+    YearGroup *groups;
+    size_t count;
+    size_t capacity;
+} YearGroups;
+
+static void year_groups_free(YearGroups *years) {
+    for (size_t i = 0; i < years->count; i++) {
+        free(years->groups[i].records);
+    }
+    free(years->groups);
+    years->groups = NULL;
+    years->count = 0;
+    years->capacity = 0;
+}
+
+/* 找到或插入年份(保持升序),返回下标,内存不足返回-1 */
+static long year_groups_find(YearGroups *years, int year) {
+    size_t pos = 0;
+    while (pos < years->count && years->groups[pos].year < year) {
+        pos++;
+    }
+    if (pos < years->count && years->groups[pos].year == year) {
+        return (long)pos;
+    }
+    if (years->count == years->capacity) {
+        size_t capacity = (years->capacity == 0) ? 16 : years->capacity * 2;
+        YearGroup *groups = (YearGroup *)realloc(years->groups, capacity * sizeof(YearGroup));
+        if (groups == NULL) {
+            return -1;
+        }
+        years->groups = groups;
+        years->capacity = capacity;
+    }
+    memmove(&years->groups[pos + 1], &years->groups[pos], (years->count - pos) * sizeof(YearGroup));
+    years->groups[pos].year = year;
+    years->groups[pos].count = 0;
+    years->groups[pos].records = NULL;
+    years->count++;
+    return (long)pos;
+}
+
+/* 统计视图中的年份;collect为TRUE时再把记录按年份分组 */
+static ErrorCode group_by_year(const EmployeeView *view, YearGroups *years, Bool collect) {
+    size_t span_count = employee_view_span_count(view);
+    for (int pass = 0; pass < (collect ? 2 : 1); pass++) {
+        for (size_t g = 0; g < years->count; g++) {
+            if (pass == 1) {
+                years->groups[g].records = (Employee **)malloc(
+                    (years->groups[g].count > 0 ? years->groups[g].count : 1) * sizeof(Employee *));
+                if (years->groups[g].records == NULL) {
+                    return ERROR_OUT_OF_MEMORY;
+                }
+            }
+            years->groups[g].count = 0;
+        }
+        /* 第一遍计数,第二遍填入;相邻记录多为同一年,先比较上一次命中的年份 */
+        long last = -1;
+        for (size_t s = 0; s < span_count; s++) {
+            Employee *const *records = NULL;
+            size_t count = employee_view_span(view, s, &records);
+            for (size_t i = 0; i < count; i++) {
+                int year = date_year(records[i]->attend_date);
+                if (last < 0 || years->groups[last].year != year) {
+                    last = year_groups_find(years, year);
+                    if (last < 0) {
+                        return ERROR_OUT_OF_MEMORY;
+                    }
+                }
+                YearGroup *group = &years->groups[last];
+                if (pass == 1) {
+                    group->records[group->count] = records[i];
+                }
+                group->count++;
+            }
+        }
+    }
+    return SUCCESS;
+}
+
+/* 计算一组记录的摘要 */
+static void summarize(const YearGroup *group, PartitionSummary *part) {
+    memset(part, 0, sizeof(PartitionSummary));
+    part->year = group->year;
+    part->record_count = group->count;
+    for (size_t i = 0; i < group->count; i++) {
+        const Employee *emp = group->records[i];
+        if (i == 0 || emp->id < part->min_id) {
+            part->min_id = emp->id;
+        }
+        if (i == 0 || emp->id > part->max_id) {
+            part->max_id = emp->id;
+        }
+        part->total_days += emp->attend_days;
+        int month = date_month(emp->attend_date);
+        if (month != 0) {
+            part->month_days[month - 1] += emp->attend_days;
+        }
+    }
+}
+
+ErrorCode partition_store_save(PartitionStore *store) {
+    if (store == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    /* 第一步: 记录要写入的年份若有未加载的分区,先加载,否则重写时会丢失其中的记录 */
+    YearGroups years = {NULL, 0, 0};
+    EmployeeView view;
+    employee_manager_view_begin(store->manager, &view);
+    ErrorCode err = group_by_year(&view, &years, FALSE);
+    employee_manager_view_end(store->manager, &view);
+    for (size_t g = 0; err == SUCCESS && g < years.count; g++) {
+        err = partition_store_load_year(store, years.groups[g].year);
+    }
+    year_groups_free(&years);
+    if (err != SUCCESS) {
+        return err;
+    }
+
+    /* 第二步: 按年份写出分区文件(storage_save_view先写临时文件再改名,每个分区文件总是完整的) */
+    size_t capacity = store->count;
+    employee_manager_view_begin(store->manager, &view);
+    err = group_by_year(&view, &years, TRUE);
+    capacity += years.count;
+    PartitionSummary *parts = (PartitionSummary *)malloc((capacity > 0 ? capacity : 1) *
+                                                         sizeof(PartitionSummary));
+    Bool *loaded = (Bool *)malloc((capacity > 0 ? capacity : 1) * sizeof(Bool));
+    if (err == SUCCESS && (parts == NULL || loaded == NULL)) {
+        err = ERROR_OUT_OF_MEMORY;
+    }
+    size_t count = 0;
+    for (size_t g = 0; err == SUCCESS && g < years.count; g++) {
+        const YearGroup *group = &years.groups[g];
+        EmployeeView subset;
+        memset(&subset, 0, sizeof(EmployeeView));
+        subset.records = group->records;
+        subset.size = group->count;
+        subset.next_id = view.next_id;
+        subset.version = view.version;
+
+        char *path = partition_path(store->base, group->year);
+        err = (path != NULL) ? storage_save_view(path, &subset) : ERROR_OUT_OF_MEMORY;
+        free(path);
+        if (err == SUCCESS) {
+            summarize(group, &parts[count]);
+            loaded[count] = TRUE;
+            count++;
+        }
+    }
+    int next_id = view.next_id;
+    employee_manager_view_end(store->manager, &view);
+
+    /* 未加载的分区原样保留;已加载但记录已全部移走的分区在清单提交后才删除文件 */
+    size_t *obsolete = (size_t *)malloc((store->count > 0 ? store->count : 1) * sizeof(size_t));
+    size_t obsolete_count = 0;
+    if (err == SUCCESS && obsolete == NULL) {
+        err = ERROR_OUT_OF_MEMORY;
+    }
+    for (size_t i = 0; err == SUCCESS && i < store->count; i++) {
+        Bool written = FALSE;
+        for (size_t g = 0; g < years.count; g++) {
+            if (years.groups[g].year == store->parts[i].year) {
+                written = TRUE;
+                break;
+            }
+        }
+        if (written) {
+            continue;
+        }
+        if (store->loaded[i]) {
+            obsolete[obsolete_count++] = i;
+            continue;
+        }
+        /* 保持按年份升序 */
+        size_t pos = count;
+        while (pos > 0 && parts[pos - 1].year > store->parts[i].year) {
+            pos--;
+        }
+        memmove(&parts[pos + 1], &parts[pos], (count - pos) * sizeof(PartitionSummary));
+        memmove(&loaded[pos + 1], &loaded[pos], (count - pos) * sizeof(Bool));
+        parts[pos] = store->parts[i];
+        loaded[pos] = FALSE;
+        count++;
+    }
+    year_groups_free(&years);
+
+    /*
+     * 分区文件写完后提交清单(同样是原子改名)。在此之前失败时没有删除任何文件,
+     * 旧清单描述的分区文件都还在;清单提交后才删除不再列出的分区文件
+     */
+    char *manifest = (err == SUCCESS) ? make_path(store->base, ".manifest") : NULL;
+    if (err == SUCCESS) {
+        err = (manifest != NULL) ? storage_save_manifest(manifest, parts, count, next_id)
+                                 : ERROR_OUT_OF_MEMORY;
+    }
+    free(manifest);
+    if (err != SUCCESS) {
+        free(obsolete);
+        free(parts);
+        free(loaded);
+        return err;
+    }
+    for (size_t k = 0; k < obsolete_count; k++) {
+        char *path = partition_path(store->base, store->parts[obsolete[k]].year);
+        if (path != NULL) {
+            remove(path);
+            free(path);
+        }
+    }
+    free(obsolete);
+
+    free(store->parts);
+    free(store->loaded);
+    store->parts = parts;
+    store->loaded = loaded;
+    store->count = count;
+    return SUCCESS;
+}
+
+ErrorCode partition_save_manager(const char *base, EmployeeManager *manager) {
+    if (base == NULL || manager == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    /* 以管理器的全部记录为已加载内容,不继承旧清单 */
+    PartitionStore store;
+    memset(&store, 0, sizeof(PartitionStore));
+    store.base = make_path(base, "");
+    if (store.base == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    store.manager = manager;
+    ErrorCode err = partition_store_save(&store);
+    free(store.base);
+    free(store.parts);
+    free(store.loaded);
+    return err;
+}
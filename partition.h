@@ -0,0 +1,68 @@
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include "common.h"
+#include "model.h"
+
+/*
+ * 按年份分区的数据存储
+ * 记录按出勤日期的年份写入各自的分区文件"<base>.<year>.db"(v2格式),
+ * 清单文件"<base>.manifest"记录每个分区的记录数、工号范围和出勤天数汇总。
+ * 打开时只读清单;查询首次需要某个分区时才把它加载进store->manager。
+ * 年度/月度出勤统计对未加载的分区直接使用清单中的汇总。
+ * 日期前四位不是数字的记录归入年份0的分区。
+ */
+
+/* 分区摘要: 清单中每个分区一项 */
+PACK_PUSH
+typedef struct {
+    int year;                          /* 分区年份 */
+    int min_id;                        /* 最小工号 */
+    int max_id;                        /* 最大工号 */
+    unsigned long long record_count;   /* 记录数 */
+    long long total_days;              /* 出勤天数合计 */
+    long long month_days[12];          /* 日期形如YYYY-MM的记录按月的出勤天数合计 */
+} PartitionSummary;
+PACK_POP
+
+typedef struct {
+    char *base;                 /* 文件名前缀 */
+    EmployeeManager *manager;   /* 已加载分区与新增记录 */
+    PartitionSummary *parts;    /* 清单中的分区(按年份升序) */
+    Bool *loaded;               /* 各分区是否已加载 */
+    size_t count;               /* 分区数 */
+} PartitionStore;
+
+/* 打开分区存储: 清单不存在时得到空存储,err可为NULL */
+PartitionStore *partition_store_open(const char *base, ErrorCode *err);
+void partition_store_free(PartitionStore *store);
+
+/* 按需加载: 指定年份 / 工号范围可能包含id的分区 / 全部分区 */
+ErrorCode partition_store_load_year(PartitionStore *store, int year);
+ErrorCode partition_store_load_for_id(PartitionStore *store, int id);
+ErrorCode partition_store_load_all(PartitionStore *store);
+
+/* 分区是否已加载(清单中没有该年份时返回FALSE) */
+Bool partition_store_is_loaded(const PartitionStore *store, int year);
+
+/* 查询: 按工号只加载可能包含该工号的分区,其他条件加载全部分区 */
+Vector *partition_store_search(PartitionStore *store, SearchType type, const void *keyword);
+
+/*
+ * 出勤统计: 已加载部分在内存中统计,未加载分区取清单汇总;
+ * 前缀不是"YYYY"或"YYYY-MM"时先加载全部分区
+ */
+int partition_store_yearly_attendance(PartitionStore *store, const char *year);
+int partition_store_monthly_attendance(PartitionStore *store, const char *year_month);
+
+/*
+ * 保存: 把已加载的记录按年份重写对应分区并更新清单,
+ * 未加载的分区保持不变;写之前先加载记录要写入的、尚未加载的分区。
+ * 各分区文件与清单都是原子改名写入,清空的分区文件在清单提交后才删除
+ */
+ErrorCode partition_store_save(PartitionStore *store);
+
+/* 把管理器中的全部记录写成分区文件与清单(用于从单文件迁移) */
+ErrorCode partition_save_manager(const char *base, EmployeeManager *manager);
+
+#endif /* PARTITION_H */
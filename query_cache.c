@@ -0,0 +1,337 @@
+#include "query_cache.h"
+#include "thread.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * 缓存项: 同时挂在哈希桶链和LRU双向链表上。
+ * 引用计数中缓存自身持有1个,命中的读者在锁内加1、锁外复制完再减1,
+ * 因此读者复制结果时不占用缓存锁,项被淘汰后由最后一个读者释放。
+ */
+typedef struct CacheEntry {
+    int type;                          /* 查询类型 */
+    size_t key_len;                    /* 关键字字节数 */
+    unsigned char key[QUERY_CACHE_KEY_MAX];
+    size_t hash;                       /* 键的哈希值 */
+    unsigned long version;             /* 计算时的修改代数 */
+    void **items;                      /* 指针结果(整数结果时为NULL) */
+    size_t item_count;
+    long long number;                  /* 整数结果 */
+    volatile long refs;                /* 引用计数 */
+    struct CacheEntry *next_in_bucket;
+    struct CacheEntry *prev;           /* LRU: 更近使用的一侧 */
+    struct CacheEntry *next;           /* LRU: 更久未用的一侧 */
+} CacheEntry;
+
+struct QueryCache {
+    Mutex *lock;                  /* 保护以下字段(命中统计除外) */
+    CacheEntry **buckets;         /* 哈希桶 */
+    size_t bucket_count;          /* 桶数(2的幂) */
+    CacheEntry *head;             /* 最近使用 */
+    CacheEntry *tail;             /* 最久未用 */
+    size_t entries;               /* 当前项数 */
+    size_t pointers;              /* 当前缓存的指针总数 */
+    size_t max_entries;
+    size_t max_pointers;
+    unsigned long version;        /* 当前项所属的修改代数 */
+    volatile long hits;           /* 原子计数,锁竞争时也要计入未命中 */
+    volatile long misses;
+};
+
+/* FNV-1a */
+static size_t key_hash(int type, const void *key, size_t key_len) {
+    size_t hash = (size_t)2166136261u ^ (size_t)(unsigned int)type;
+    const unsigned char *bytes = (const unsigned char *)key;
+    for (size_t i = 0; i < key_len; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static void lru_unlink(QueryCache *cache, CacheEntry *entry) {
+    if (entry->prev != NULL) {
+        entry->prev->next = entry->next;
+    } else {
+        cache->head = entry->next;
+    }
+    if (entry->next != NULL) {
+        entry->next->prev = entry->prev;
+    } else {
+        cache->tail = entry->prev;
+    }
+    entry->prev = NULL;
+    entry->next = NULL;
+}
+
+static void lru_push_front(QueryCache *cache, CacheEntry *entry) {
+    entry->prev = NULL;
+    entry->next = cache->head;
+    if (cache->head != NULL) {
+        cache->head->prev = entry;
+    } else {
+        cache->tail = entry;
+    }
+    cache->head = entry;
+}
+
+static void entry_release(CacheEntry *entry) {
+    if (atomic_long_add(&entry->refs, -1) == 0) {
+        free(entry->items);
+        free(entry);
+    }
+}
+
+/* 从桶链和LRU链表中摘除,并放弃缓存持有的引用 */
+static void entry_remove(QueryCache *cache, CacheEntry *entry) {
+    CacheEntry **link = &cache->buckets[entry->hash & (cache->bucket_count - 1)];
+    while (*link != entry) {
+        link = &(*link)->next_in_bucket;
+    }
+    *link = entry->next_in_bucket;
+    lru_unlink(cache, entry);
+    cache->entries--;
+    cache->pointers -= entry->item_count;
+    entry_release(entry);
+}
+
+static void clear_locked(QueryCache *cache) {
+    while (cache->tail != NULL) {
+        entry_remove(cache, cache->tail);
+    }
+}
+
+/*
+ * 使缓存与version对齐: 更新的代数到来时清空旧项;
+ * 返回FALSE表示调用方的视图比缓存旧,既不查也不存
+ */
+static Bool sync_version(QueryCache *cache, unsigned long version) {
+    if (version > cache->version) {
+        clear_locked(cache);
+        cache->version = version;
+    }
+    return (version == cache->version) ? TRUE : FALSE;
+}
+
+static CacheEntry *find_locked(QueryCache *cache, int type, const void *key, size_t key_len,
+                               size_t hash) {
+    CacheEntry *entry = cache->buckets[hash & (cache->bucket_count - 1)];
+    for (; entry != NULL; entry = entry->next_in_bucket) {
+        if (entry->hash == hash && entry->type == type && entry->key_len == key_len &&
+            memcmp(entry->key, key, key_len) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/* 查找并移到LRU头部,计入命中统计 */
+static CacheEntry *lookup_locked(QueryCache *cache, int type, const void *key, size_t key_len,
+                                 unsigned long version) {
+    CacheEntry *entry = NULL;
+    if (sync_version(cache, version)) {
+        entry = find_locked(cache, type, key, key_len, key_hash(type, key, key_len));
+    }
+    if (entry == NULL) {
+        atomic_long_add(&cache->misses, 1);
+        return NULL;
+    }
+    atomic_long_add(&cache->hits, 1);
+    lru_unlink(cache, entry);
+    lru_push_front(cache, entry);
+    return entry;
+}
+
+/* 插入新项(接管items),先淘汰旧项腾出空间;失败时释放items */
+static void insert_locked(QueryCache *cache, int type, const void *key, size_t key_len,
+                          unsigned long version, void **items, size_t item_count, long long number) {
+    if (!sync_version(cache, version) || item_count > cache->max_pointers) {
+        free(items);
+        return;
+    }
+
+    size_t hash = key_hash(type, key, key_len);
+    CacheEntry *existing = find_locked(cache, type, key, key_len, hash);
+    if (existing != NULL) {
+        entry_remove(cache, existing);
+    }
+    while (cache->tail != NULL &&
+           (cache->entries >= cache->max_entries || cache->pointers + item_count > cache->max_pointers)) {
+        entry_remove(cache, cache->tail);
+    }
+
+    CacheEntry *entry = (CacheEntry *)calloc(1, sizeof(CacheEntry));
+    if (entry == NULL) {
+        free(items);
+        return;
+    }
+    entry->type = type;
+    entry->key_len = key_len;
+    memcpy(entry->key, key, key_len);
+    entry->hash = hash;
+    entry->version = version;
+    entry->items = items;
+    entry->item_count = item_count;
+    entry->number = number;
+    entry->refs = 1;
+
+    CacheEntry **bucket = &cache->buckets[hash & (cache->bucket_count - 1)];
+    entry->next_in_bucket = *bucket;
+    *bucket = entry;
+    lru_push_front(cache, entry);
+    cache->entries++;
+    cache->pointers += item_count;
+}
+
+QueryCache *query_cache_create(size_t max_entries, size_t max_pointers) {
+    if (max_entries == 0) {
+        return NULL;
+    }
+
+    QueryCache *cache = (QueryCache *)calloc(1, sizeof(QueryCache));
+    if (cache == NULL) {
+        return NULL;
+    }
+    cache->max_entries = max_entries;
+    cache->max_pointers = max_pointers;
+    cache->bucket_count = 16;
+    while (cache->bucket_count < max_entries * 2) {
+        cache->bucket_count *= 2;
+    }
+    cache->buckets = (CacheEntry **)calloc(cache->bucket_count, sizeof(CacheEntry *));
+    cache->lock = mutex_create();
+    if (cache->buckets == NULL || cache->lock == NULL) {
+        free(cache->buckets);
+        mutex_free(cache->lock);
+        free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+void query_cache_free(QueryCache *cache) {
+    if (cache != NULL) {
+        clear_locked(cache);
+        free(cache->buckets);
+        mutex_free(cache->lock);
+        free(cache);
+    }
+}
+
+Bool query_cache_get_results(QueryCache *cache, int type, const void *key, size_t key_len,
+                             unsigned long version, Vector *out) {
+    if (cache == NULL || key == NULL || key_len > QUERY_CACHE_KEY_MAX || out == NULL) {
+        return FALSE;
+    }
+
+    /* 读路径不等锁: 有人正在修改缓存时直接按未命中处理,由调用方自行计算 */
+    if (!mutex_trylock(cache->lock)) {
+        atomic_long_add(&cache->misses, 1);
+        return FALSE;
+    }
+    CacheEntry *entry = lookup_locked(cache, type, key, key_len, version);
+    if (entry != NULL && entry->items == NULL) {
+        entry = NULL;
+    }
+    if (entry != NULL) {
+        atomic_long_add(&entry->refs, 1);
+    }
+    mutex_unlock(cache->lock);
+    if (entry == NULL) {
+        return FALSE;
+    }
+
+    /* 项的内容插入后不再改变,持有引用即可在锁外复制 */
+    Bool hit = FALSE;
+    if (vector_reserve(out, out->size + entry->item_count) == SUCCESS) {
+        if (entry->item_count > 0) {
+            memcpy(out->data + out->size, entry->items, entry->item_count * sizeof(void *));
+            out->size += entry->item_count;
+        }
+        hit = TRUE;
+    }
+    entry_release(entry);
+    return hit;
+}
+
+void query_cache_put_results(QueryCache *cache, int type, const void *key, size_t key_len,
+                             unsigned long version, const Vector *results) {
+    if (cache == NULL || key == NULL || key_len > QUERY_CACHE_KEY_MAX || results == NULL ||
+        results->size > cache->max_pointers) {
+        return;
+    }
+
+    /* 空结果也要缓存,用1个元素的分配区分于整数结果 */
+    void **items = (void **)malloc((results->size > 0 ? results->size : 1) * sizeof(void *));
+    if (items == NULL) {
+        return;
+    }
+    if (results->size > 0) {
+        memcpy(items, results->data, results->size * sizeof(void *));
+    }
+
+    /* 存入是尽力而为的: 锁被占用时放弃本次缓存,不让查询线程排队 */
+    if (!mutex_trylock(cache->lock)) {
+        free(items);
+        return;
+    }
+    insert_locked(cache, type, key, key_len, version, items, results->size, 0);
+    mutex_unlock(cache->lock);
+}
+
+Bool query_cache_get_number(QueryCache *cache, int type, const void *key, size_t key_len,
+                            unsigned long version, long long *value) {
+    if (cache == NULL || key == NULL || key_len > QUERY_CACHE_KEY_MAX || value == NULL) {
+        return FALSE;
+    }
+
+    Bool hit = FALSE;
+    if (!mutex_trylock(cache->lock)) {
+        atomic_long_add(&cache->misses, 1);
+        return FALSE;
+    }
+    CacheEntry *entry = lookup_locked(cache, type, key, key_len, version);
+    if (entry != NULL && entry->items == NULL) {
+        *value = entry->number;
+        hit = TRUE;
+    }
+    mutex_unlock(cache->lock);
+    return hit;
+}
+
+void query_cache_put_number(QueryCache *cache, int type, const void *key, size_t key_len,
+                            unsigned long version, long long value) {
+    if (cache == NULL || key == NULL || key_len > QUERY_CACHE_KEY_MAX) {
+        return;
+    }
+
+    if (!mutex_trylock(cache->lock)) {
+        return;
+    }
+    insert_locked(cache, type, key, key_len, version, NULL, 0, value);
+    mutex_unlock(cache->lock);
+}
+
+void query_cache_clear(QueryCache *cache) {
+    if (cache != NULL) {
+        mutex_lock(cache->lock);
+        clear_locked(cache);
+        mutex_unlock(cache->lock);
+    }
+}
+
+void query_cache_stats(QueryCache *cache, QueryCacheStats *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    if (cache == NULL) {
+        memset(stats, 0, sizeof(QueryCacheStats));
+        return;
+    }
+
+    mutex_lock(cache->lock);
+    stats->hits = (unsigned long long)atomic_long_load(&cache->hits);
+    stats->misses = (unsigned long long)atomic_long_load(&cache->misses);
+    stats->entries = cache->entries;
+    stats->pointers = cache->pointers;
+    mutex_unlock(cache->lock);
+}
@@ -0,0 +1,58 @@
+#ifndef QUERY_CACHE_H
+#define QUERY_CACHE_H
+
+#include "common.h"
+#include "vector.h"
+
+/*
+ * 查询结果缓存: 以(查询类型, 关键字字节)为键的有界LRU缓存
+ * 每项记录计算时的修改代数;查询时代数不符即视为未命中。代数前进后首次访问
+ * 会清空全部旧项,因此数据未变时重复查询直接返回缓存,任何修改后自动失效。
+ * 结果为指针数组(如查询到的职工)或一个整数(如出勤统计)。
+ * 容量按项数和缓存的指针总数双重限制,超出时淘汰最久未用的项。内部加锁,可多线程使用;
+ * 查找和存入都只尝试加锁,锁被占用时按未命中/不缓存处理,查询线程不会在缓存上排队。
+ * 命中的指针结果在锁外复制。
+ */
+
+/* 关键字最大字节数,更长的关键字不缓存 */
+#define QUERY_CACHE_KEY_MAX 64
+
+/* 默认容量 */
+#define QUERY_CACHE_DEFAULT_ENTRIES 64
+#define QUERY_CACHE_DEFAULT_POINTERS (1u << 20)
+
+typedef struct QueryCache QueryCache;
+
+/* 命中统计 */
+typedef struct {
+    unsigned long long hits;    /* 命中次数 */
+    unsigned long long misses;  /* 未命中次数 */
+    size_t entries;             /* 当前项数 */
+    size_t pointers;            /* 当前缓存的指针总数 */
+} QueryCacheStats;
+
+/* 创建/释放缓存: 最多max_entries项、共max_pointers个结果指针 */
+QueryCache *query_cache_create(size_t max_entries, size_t max_pointers);
+void query_cache_free(QueryCache *cache);
+
+/* 查找指针结果: 命中时把缓存的结果追加到out并返回TRUE(锁被占用时返回FALSE) */
+Bool query_cache_get_results(QueryCache *cache, int type, const void *key, size_t key_len,
+                             unsigned long version, Vector *out);
+
+/* 存入指针结果(复制),超出容量或锁被占用时不缓存 */
+void query_cache_put_results(QueryCache *cache, int type, const void *key, size_t key_len,
+                             unsigned long version, const Vector *results);
+
+/* 查找/存入整数结果 */
+Bool query_cache_get_number(QueryCache *cache, int type, const void *key, size_t key_len,
+                            unsigned long version, long long *value);
+void query_cache_put_number(QueryCache *cache, int type, const void *key, size_t key_len,
+                            unsigned long version, long long value);
+
+/* 清空全部项 */
+void query_cache_clear(QueryCache *cache);
+
+/* 读取统计(cache为NULL时全部为0) */
+void query_cache_stats(QueryCache *cache, QueryCacheStats *stats);
+
+#endif /* QUERY_CACHE_H */
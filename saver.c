@@ -0,0 +1,175 @@
+#include "saver.h"
+#include "storage.h"
+#include "thread.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct BackgroundSaver {
+    Thread *thread;               /* 专用写线程 */
+    Mutex *lock;                  /* 保护以下字段 */
+    CondVar *cond;                /* 有新请求/请求完成/停止时广播 */
+    EmployeeSnapshot *pending;    /* 排队中的快照(只保留最新一个) */
+    char *pending_file;           /* 排队请求的目标文件 */
+    Bool running;                 /* 写线程正在保存 */
+    Bool stopping;                /* 要求写线程退出 */
+    Bool has_result;              /* 是否有未被poll取走的结果 */
+    SaveResult last;              /* 最近一次完成的结果 */
+};
+
+/* 写线程: 逐个取出排队的快照写出 */
+static void saver_thread_main(void *arg) {
+    BackgroundSaver *saver = (BackgroundSaver *)arg;
+
+    mutex_lock(saver->lock);
+    for (;;) {
+        while (saver->pending == NULL && !saver->stopping) {
+            cond_wait(saver->cond, saver->lock);
+        }
+        if (saver->pending == NULL) {
+            break;
+        }
+
+        EmployeeSnapshot *snapshot = saver->pending;
+        char *filename = saver->pending_file;
+        saver->pending = NULL;
+        saver->pending_file = NULL;
+        saver->running = TRUE;
+        mutex_unlock(saver->lock);
+
+        SaveResult result;
+        result.error = storage_save_snapshot(filename, snapshot);
+        result.count = employee_snapshot_size(snapshot);
+        result.version = snapshot->version;
+        employee_snapshot_release(snapshot);
+        free(filename);
+
+        mutex_lock(saver->lock);
+        saver->running = FALSE;
+        saver->last = result;
+        saver->has_result = TRUE;
+        cond_broadcast(saver->cond);
+    }
+    mutex_unlock(saver->lock);
+}
+
+BackgroundSaver *background_saver_create(void) {
+    BackgroundSaver *saver = (BackgroundSaver *)calloc(1, sizeof(BackgroundSaver));
+    if (saver == NULL) {
+        return NULL;
+    }
+
+    saver->last.error = SUCCESS;
+    saver->lock = mutex_create();
+    saver->cond = cond_create();
+    if (saver->lock == NULL || saver->cond == NULL) {
+        mutex_free(saver->lock);
+        cond_free(saver->cond);
+        free(saver);
+        return NULL;
+    }
+
+    saver->thread = thread_create(saver_thread_main, saver);
+    if (saver->thread == NULL) {
+        mutex_free(saver->lock);
+        cond_free(saver->cond);
+        free(saver);
+        return NULL;
+    }
+    return saver;
+}
+
+void background_saver_free(BackgroundSaver *saver) {
+    if (saver == NULL) {
+        return;
+    }
+
+    /* 写线程会先处理完排队的请求再退出 */
+    mutex_lock(saver->lock);
+    saver->stopping = TRUE;
+    cond_broadcast(saver->cond);
+    mutex_unlock(saver->lock);
+
+    thread_join(saver->thread);
+    mutex_free(saver->lock);
+    cond_free(saver->cond);
+    free(saver);
+}
+
+ErrorCode background_saver_submit(BackgroundSaver *saver, EmployeeManager *manager,
+                                  const char *filename) {
+    if (saver == NULL || manager == NULL || filename == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    if (!manager->concurrent) {
+        return ERROR_INVALID_PARAMETER;
+    }
+
+    char *name = (char *)malloc(strlen(filename) + 1);
+    if (name == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    strcpy(name, filename);
+
+    EmployeeSnapshot *snapshot = employee_manager_snapshot(manager);
+    if (snapshot == NULL) {
+        free(name);
+        return ERROR_OUT_OF_MEMORY;
+    }
+
+    mutex_lock(saver->lock);
+    EmployeeSnapshot *replaced = saver->pending;
+    char *replaced_file = saver->pending_file;
+    saver->pending = snapshot;
+    saver->pending_file = name;
+    cond_broadcast(saver->cond);
+    mutex_unlock(saver->lock);
+
+    /* 被取代的旧请求尚未开始,直接丢弃 */
+    if (replaced != NULL) {
+        employee_snapshot_release(replaced);
+        free(replaced_file);
+    }
+    return SUCCESS;
+}
+
+Bool background_saver_poll(BackgroundSaver *saver, SaveResult *result) {
+    if (saver == NULL) {
+        return FALSE;
+    }
+
+    mutex_lock(saver->lock);
+    Bool has_result = saver->has_result;
+    if (has_result) {
+        if (result != NULL) {
+            *result = saver->last;
+        }
+        saver->has_result = FALSE;
+    }
+    mutex_unlock(saver->lock);
+    return has_result;
+}
+
+Bool background_saver_busy(BackgroundSaver *saver) {
+    if (saver == NULL) {
+        return FALSE;
+    }
+
+    mutex_lock(saver->lock);
+    Bool busy = (saver->pending != NULL || saver->running) ? TRUE : FALSE;
+    mutex_unlock(saver->lock);
+    return busy;
+}
+
+ErrorCode background_saver_wait(BackgroundSaver *saver) {
+    if (saver == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    mutex_lock(saver->lock);
+    while (saver->pending != NULL || saver->running) {
+        cond_wait(saver->cond, saver->lock);
+    }
+    ErrorCode err = saver->last.error;
+    mutex_unlock(saver->lock);
+    return err;
+}
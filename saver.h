@@ -0,0 +1,41 @@
+#ifndef SAVER_H
+#define SAVER_H
+
+#include "common.h"
+#include "model.h"
+
+/*
+ * 后台保存器
+ * 专用写线程从快照写出数据文件(临时文件+fsync+改名),提交后调用方立即返回。
+ * 尚未开始的请求会被更新的请求取代,只保留最新快照;
+ * 完成结果通过poll非阻塞地取回,wait阻塞直到全部请求完成。
+ * 保存器必须先于其引用的管理器释放。
+ */
+
+typedef struct BackgroundSaver BackgroundSaver;
+
+/* 一次保存的结果 */
+typedef struct {
+    ErrorCode error;        /* 保存结果 */
+    size_t count;           /* 写出的记录数 */
+    unsigned long version;  /* 写出的快照对应的修改代数 */
+} SaveResult;
+
+/* 创建/释放保存器,释放时等待进行中的保存完成 */
+BackgroundSaver *background_saver_create(void);
+void background_saver_free(BackgroundSaver *saver);
+
+/* 为管理器当前状态创建快照并提交给写线程(管理器须已启用并发模式) */
+ErrorCode background_saver_submit(BackgroundSaver *saver, EmployeeManager *manager,
+                                  const char *filename);
+
+/* 取回最近一次完成的结果,没有新结果时返回FALSE */
+Bool background_saver_poll(BackgroundSaver *saver, SaveResult *result);
+
+/* 是否有排队或进行中的保存 */
+Bool background_saver_busy(BackgroundSaver *saver);
+
+/* 阻塞直到所有已提交的保存完成,返回最后一次保存的结果 */
+ErrorCode background_saver_wait(BackgroundSaver *saver);
+
+#endif /* SAVER_H */
@@ -1,4 +1,5 @@
 #include "sort.h"
+#include <stdlib.h>
 
 /* 交换两个元素 */
 static void swap(void **a, void **b) {
@@ -41,3 +42,121 @@ void quick_sort(Vector *v, Comparator compare) {
     
     quick_sort_recursive(v->data, 0, (int)v->size - 1, compare);
 }
+
+/* ========== 败者树 ========== */
+
+/*
+ * 结点按堆布局编号: 叶子k+j对应第j路,内部结点1..k-1保存该处比赛的败者,
+ * nodes[0]保存总胜者
+ */
+struct LoserTree {
+    size_t k;
+    size_t *nodes;
+    void **items;     /* 每路的当前元素 */
+    size_t *winners;  /* 建树时的暂存空间 */
+    Comparator compare;
+};
+
+/* 第a路是否胜过第b路: 耗尽的路总是失败,相等时路号小者胜 */
+static int loser_tree_beats(const LoserTree *tree, size_t a, size_t b) {
+    if (tree->items[a] == NULL) {
+        return 0;
+    }
+    if (tree->items[b] == NULL) {
+        return 1;
+    }
+    int cmp = tree->compare(&tree->items[a], &tree->items[b]);
+    return (cmp < 0 || (cmp == 0 && a < b)) ? 1 : 0;
+}
+
+LoserTree *loser_tree_create(size_t k, Comparator compare) {
+    if (k == 0 || compare == NULL) {
+        return NULL;
+    }
+
+    LoserTree *tree = (LoserTree *)malloc(sizeof(LoserTree));
+    if (tree == NULL) {
+        return NULL;
+    }
+    tree->k = k;
+    tree->compare = compare;
+    tree->nodes = (size_t *)malloc(k * sizeof(size_t));
+    tree->items = (void **)calloc(k, sizeof(void *));
+    tree->winners = (size_t *)malloc(2 * k * sizeof(size_t));
+    if (tree->nodes == NULL || tree->items == NULL || tree->winners == NULL) {
+        loser_tree_free(tree);
+        return NULL;
+    }
+    return tree;
+}
+
+void loser_tree_free(LoserTree *tree) {
+    if (tree == NULL) {
+        return;
+    }
+    free(tree->nodes);
+    free(tree->items);
+    free(tree->winners);
+    free(tree);
+}
+
+void loser_tree_build(LoserTree *tree, void *const *heads) {
+    if (tree == NULL || heads == NULL) {
+        return;
+    }
+
+    size_t k = tree->k;
+    for (size_t j = 0; j < k; j++) {
+        tree->items[j] = heads[j];
+    }
+    if (k == 1) {
+        tree->nodes[0] = 0;
+        return;
+    }
+
+    /* 自底向上比赛: winners[i]为结点i子树的胜者 */
+    size_t *winners = tree->winners;
+    for (size_t j = 0; j < k; j++) {
+        winners[k + j] = j;
+    }
+    for (size_t i = k - 1; i >= 1; i--) {
+        size_t left = winners[2 * i];
+        size_t right = winners[2 * i + 1];
+        if (loser_tree_beats(tree, left, right)) {
+            winners[i] = left;
+            tree->nodes[i] = right;
+        } else {
+            winners[i] = right;
+            tree->nodes[i] = left;
+        }
+    }
+    tree->nodes[0] = winners[1];
+}
+
+size_t loser_tree_top(const LoserTree *tree) {
+    if (tree == NULL || tree->items[tree->nodes[0]] == NULL) {
+        return LOSER_TREE_EMPTY;
+    }
+    return tree->nodes[0];
+}
+
+void *loser_tree_top_item(const LoserTree *tree) {
+    return (tree != NULL) ? tree->items[tree->nodes[0]] : NULL;
+}
+
+void loser_tree_replace(LoserTree *tree, void *next) {
+    if (tree == NULL) {
+        return;
+    }
+
+    size_t winner = tree->nodes[0];
+    tree->items[winner] = next;
+    for (size_t node = (tree->k + winner) / 2; node >= 1; node /= 2) {
+        if (loser_tree_beats(tree, tree->nodes[node], winner)) {
+            size_t loser = winner;
+            winner = tree->nodes[node];
+            tree->nodes[node] = loser;
+        }
+    }
+    tree->nodes[0] = winner;
+}
@@ -9,4 +9,30 @@ typedef int (*Comparator)(const void *a, const void *b);
 /* 快速排序 */
 void quick_sort(Vector *v, Comparator compare);
 
+/*
+ * 败者树: k路归并时每取出一个元素只需沿一条路径比较log2(k)次。
+ * 每路的当前元素以指针表示,NULL表示该路已耗尽;
+ * compare与quick_sort相同,参数为指向元素指针的指针。
+ * 元素相等时路号小的优先,归并按路号排列的有序段时结果稳定
+ */
+typedef struct LoserTree LoserTree;
+
+/* 全部耗尽时loser_tree_top的返回值 */
+#define LOSER_TREE_EMPTY ((size_t)-1)
+
+LoserTree *loser_tree_create(size_t k, Comparator compare);
+void loser_tree_free(LoserTree *tree);
+
+/* 设置各路的首元素并建树 */
+void loser_tree_build(LoserTree *tree, void *const *heads);
+
+/* 当前最小元素所在的路 */
+size_t loser_tree_top(const LoserTree *tree);
+
+/* 当前最小元素 */
+void *loser_tree_top_item(const LoserTree *tree);
+
+/* 用胜者所在路的下一个元素(NULL表示耗尽)替换并重赛 */
+void loser_tree_replace(LoserTree *tree, void *next);
+
 #endif /* SORT_H */
@@ -1,138 +1,367 @@
+/* 启用64位文件偏移(须在所有系统头文件之前定义) */
+#if !defined(_WIN32) && !defined(_FILE_OFFSET_BITS)
+    #define _FILE_OFFSET_BITS 64
+#endif
+
+/* Linux下的O_DIRECT需要_GNU_SOURCE */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE
+#endif
+
 #include "storage.h"
+#include "storage_io.h"
+#include "csv.h"
+#include "io_backend.h"
+#include "thread.h"
+#include "thread_pool.h"
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
-/* 计算简单的校验和 */
-static unsigned int calculate_checksum(const void *data, size_t size) {
-    unsigned int sum = 0;
-    const unsigned char *bytes = (const unsigned char *)data;
+#if defined(_WIN32)
+    #include <windows.h>
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+/* 将只读视图中的职工数据写入v2文件,附带索引段 */
+static ErrorCode save_view(const char *filename, const EmployeeView *view,
+                           unsigned long long stamp) {
+    V2Writer out;
+    ErrorCode err = v2_writer_open(&out, filename);
+    if (err != SUCCESS) {
+        return err;
+    }
+    out.stamp = stamp;
+    chunk_writer_enable_direct(&out.writer, (unsigned long long)view->size * sizeof(Employee));
     
-    for (size_t i = 0; i < size; i++) {
-        sum += bytes[i];
-        sum = (sum << 1) | (sum >> 31);  /* 循环左移增加扩散性 */
+    size_t span_count = employee_view_span_count(view);
+    for (size_t s = 0; s < span_count && out.ok; s++) {
+        Employee *const *records = NULL;
+        size_t count = employee_view_span(view, s, &records);
+        for (size_t i = 0; i < count; i++) {
+            v2_writer_put(&out, records[i]);
+        }
+    }
+    
+    /* 索引段为可选: 构建失败(如内存不足)时只写记录 */
+    EmployeeIndex *index = out.ok ? employee_index_build(view) : NULL;
+    if (index != NULL) {
+        out.ok = (write_section(&out.writer, &out.dir, SECTION_ID_INDEX, index->id_slots,
+                                index->id_slot_count * sizeof(IndexIdSlot), index->id_slot_count) &&
+                  write_section(&out.writer, &out.dir, SECTION_DEPT_INDEX, index->depts,
+                                index->dept_count * sizeof(IndexDeptEntry), index->dept_count) &&
+                  write_section(&out.writer, &out.dir, SECTION_DEPT_POSTINGS, index->postings,
+                                index->record_count * sizeof(unsigned int), index->record_count))
+                     ? TRUE : FALSE;
+        employee_index_free(index);
     }
     
-    return sum;
+    return v2_writer_commit(&out, view->next_id);
 }
 
-/* 保存职工数据到文件 */
-ErrorCode storage_save_employees(const char *filename, EmployeeManager *manager) {
-    if (filename == NULL || manager == NULL) {
-        return ERROR_NULL_POINTER;
+/* 增量保存按记录块定位变更跟踪的块 */
+#if DIRTY_BLOCK_RECORDS != FILE_BLOCK_RECORDS
+    #error "DIRTY_BLOCK_RECORDS must equal FILE_BLOCK_RECORDS"
+#endif
+
+/* 增量保存追加的数据超过有效记录的一半时,完整写出并不更慢,改为完整保存 */
+#define INCREMENTAL_MAX_APPEND_RATIO 2
+
+static ErrorCode read_v2_header(ChunkReader *reader, const FileHeader *prefix, long long total,
+                                FileHeaderV2 *header, size_t *slot);
+static ErrorCode read_v2_directory(ChunkReader *reader, const FileHeader *prefix, long long total,
+                                  FileHeaderV2 *header, size_t *slot, SectionEntry **dir);
+
+/* 读取v2文件的文件头与记录块目录(按文件顺序),slot返回文件头所在的槽,成功时*blocks由调用方释放 */
+static ErrorCode read_record_directory(const char *filename, FileHeaderV2 *header, size_t *slot,
+                                       SectionEntry **blocks, size_t *block_count,
+                                       long long *total) {
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) {
+        return ERROR_FILE_NOT_FOUND;
+    }
+    *total = file_size(fp);
+    ChunkReader reader;
+    if (chunk_reader_init(&reader, fp, FILE_V2_DATA_OFFSET) != SUCCESS) {
+        fclose(fp);
+        return ERROR_OUT_OF_MEMORY;
     }
     
-    FILE *fp = fopen(filename, "wb");
-    if (fp == NULL) {
-        return ERROR_FILE_WRITE_FAILED;
+    FileHeader prefix;
+    SectionEntry *dir = NULL;
+    ErrorCode err;
+    if (!chunk_reader_get(&reader, &prefix, sizeof(FileHeader))) {
+        err = ERROR_FILE_READ_FAILED;
+    } else if (prefix.magic != MAGIC_NUMBER || prefix.version != FILE_VERSION) {
+        err = ERROR_INVALID_FILE;
+    } else {
+        err = read_v2_directory(&reader, &prefix, *total, header, slot, &dir);
+    }
+    chunk_reader_free(&reader);
+    fclose(fp);
+    if (err != SUCCESS) {
+        return err;
     }
     
-    /* 准备文件头 */
-    FileHeader header;
-    header.magic = MAGIC_NUMBER;
-    header.version = FILE_VERSION;
-    header.count = (unsigned int)manager->employees->size;
-    header.checksum = 0;  /* 暂时设置为0 */
+    size_t count = 0;
+    for (size_t i = 0; i < (size_t)header->directory_count; i++) {
+        if (dir[i].type == SECTION_RECORDS) {
+            dir[count++] = dir[i];
+        }
+    }
+    *blocks = dir;
+    *block_count = count;
+    return SUCCESS;
+}
+
+/*
+ * 增量保存: 文件仍是上次同步的那份(保存标记与记录数一致)时,只把修改过的记录块
+ * 和新的段目录追加到文件尾部,落盘后再把新文件头写入另一个槽。当前槽在整个过程中
+ * 不被改写,任何时刻崩溃(包括新槽写了一半)都能按当前槽加载完整的旧版本。
+ * 未修改的块沿用原位置,过时的索引段不再登记,下次完整保存时重建。
+ * 没有任何修改时不写文件,*stamp改为文件原有的标记。
+ * 文件不符、旧版单槽文件或应当完整保存时返回ERROR_INVALID_FILE且不做任何写入
+ */
+static ErrorCode save_incremental(const char *filename, const EmployeeView *view,
+                                  const EmployeeChanges *changes, unsigned long long *stamp) {
+    FileHeaderV2 header;
+    SectionEntry *old = NULL;
+    size_t old_count = 0;
+    size_t slot = 0;
+    long long total = 0;
+    if (read_record_directory(filename, &header, &slot, &old, &old_count, &total) != SUCCESS) {
+        return ERROR_INVALID_FILE;
+    }
+    Bool matches = (header.header_size == FILE_V2_DATA_OFFSET &&
+                    header.save_stamp == changes->stamp &&
+                    header.record_count == changes->synced_size &&
+                    header.block_records == FILE_BLOCK_RECORDS) ? TRUE : FALSE;
+    /* 块号与记录位置的对应要求除末块外都是满块 */
+    for (size_t b = 0; b + 1 < old_count && matches; b++) {
+        matches = (old[b].count == FILE_BLOCK_RECORDS) ? TRUE : FALSE;
+    }
     
-    /* 写入文件头 */
-    if (fwrite(&header, sizeof(FileHeader), 1, fp) != 1) {
-        fclose(fp);
-        return ERROR_FILE_WRITE_FAILED;
+    size_t block_count = (view->size + FILE_BLOCK_RECORDS - 1) / FILE_BLOCK_RECORDS;
+    SectionEntry *dir = matches ? (SectionEntry *)malloc((block_count + 1) * sizeof(SectionEntry)) : NULL;
+    if (dir == NULL) {
+        free(old);
+        return ERROR_INVALID_FILE;
     }
     
-    /* 写入所有职工数据并计算校验和 */
-    unsigned int checksum = 0;
-    for (size_t i = 0; i < manager->employees->size; i++) {
-        Employee *emp = (Employee *)manager->employees->data[i];
-        if (fwrite(emp, sizeof(Employee), 1, fp) != 1) {
-            fclose(fp);
-            return ERROR_FILE_WRITE_FAILED;
+    /* 沿用未修改的块,统计需要追加的字节数 */
+    unsigned long long appended = 0;
+    for (size_t b = 0; b < block_count; b++) {
+        size_t first = b * FILE_BLOCK_RECORDS;
+        size_t count = (view->size - first < FILE_BLOCK_RECORDS) ? view->size - first : FILE_BLOCK_RECORDS;
+        if (b < old_count && old[b].count == count && !employee_changes_dirty(changes, b)) {
+            dir[b] = old[b];
+        } else {
+            memset(&dir[b], 0, sizeof(SectionEntry));
+            dir[b].type = SECTION_RECORDS;
+            dir[b].count = count;
+            dir[b].size = (unsigned long long)count * sizeof(Employee);
+            appended += dir[b].size;
         }
-        checksum += calculate_checksum(emp, sizeof(Employee));
     }
+    free(old);
     
-    /* 更新文件头中的校验和 */
-    header.checksum = checksum;
-    fseek(fp, 0, SEEK_SET);
-    if (fwrite(&header, sizeof(FileHeader), 1, fp) != 1) {
-        fclose(fp);
-        return ERROR_FILE_WRITE_FAILED;
+    if (appended == 0 && block_count == old_count && header.next_id == view->next_id) {
+        free(dir);
+        *stamp = header.save_stamp;
+        return SUCCESS;
+    }
+    unsigned long long live = (unsigned long long)view->size * sizeof(Employee);
+    if (appended * INCREMENTAL_MAX_APPEND_RATIO > live ||
+        (unsigned long long)total + appended > INCREMENTAL_MAX_APPEND_RATIO * live + STORAGE_CHUNK_SIZE) {
+        free(dir);
+        return ERROR_INVALID_FILE;
     }
     
-    /* 保存next_id */
-    fseek(fp, 0, SEEK_END);
-    if (fwrite(&manager->next_id, sizeof(int), 1, fp) != 1) {
-        fclose(fp);
+    FILE *fp = fopen(filename, "r+b");
+    if (fp == NULL) {
+        free(dir);
         return ERROR_FILE_WRITE_FAILED;
     }
+    ChunkWriter writer;
+    ErrorCode err = chunk_writer_init(&writer, fp);
+    if (err != SUCCESS) {
+        free(dir);
+        fclose(fp);
+        return err;
+    }
     
-    fclose(fp);
-    return SUCCESS;
+    /* 从文件尾部写起: 修改过的块,然后是段目录 */
+    writer.offset = (unsigned long long)total;
+    writer.flushed = (unsigned long long)total;
+    for (size_t b = 0; b < block_count; b++) {
+        if (dir[b].offset != 0) {
+            continue;
+        }
+        dir[b].offset = writer.offset;
+        size_t first = b * FILE_BLOCK_RECORDS;
+        for (size_t i = 0; i < dir[b].count; i++) {
+            const Employee *emp = employee_view_get(view, first + i);
+            chunk_writer_put(&writer, emp, sizeof(Employee));
+            dir[b].checksum = checksum_update(dir[b].checksum, emp, sizeof(Employee));
+        }
+    }
+    header.record_count = view->size;
+    header.directory_offset = writer.offset;
+    header.directory_count = block_count;
+    header.directory_checksum = calculate_checksum(dir, block_count * sizeof(SectionEntry));
+    header.next_id = view->next_id;
+    header.save_stamp = *stamp;
+    header.sequence++;
+    header.header_checksum = calculate_checksum(&header, offsetof(FileHeaderV2, header_checksum));
+    chunk_writer_put(&writer, dir, block_count * sizeof(SectionEntry));
+    free(dir);
+    
+    /* 新数据落盘后才写入另一个槽 */
+    unsigned long long header_offset = (unsigned long long)((slot + 1) % FILE_HEADER_SLOTS) *
+                                       sizeof(FileHeaderV2);
+    Bool ok = chunk_writer_finish(&writer);
+    ok = ok && sync_file(fp);
+    ok = ok && file_seek(fp, header_offset) && fwrite(&header, sizeof(FileHeaderV2), 1, fp) == 1;
+    ok = ok && sync_file(fp);
+    if (fclose(fp) != 0) {
+        ok = FALSE;
+    }
+    return ok ? SUCCESS : ERROR_FILE_WRITE_FAILED;
 }
 
-/* 从文件加载职工数据 */
-ErrorCode storage_load_employees(const char *filename, EmployeeManager *manager) {
+/* 保存职工数据到文件: 文件仍是上次同步的那份时增量保存,否则完整写出 */
+ErrorCode storage_save_employees(const char *filename, EmployeeManager *manager) {
     if (filename == NULL || manager == NULL) {
         return ERROR_NULL_POINTER;
     }
     
+    EmployeeChanges changes;
+    Bool tracked = (employee_manager_changes(manager, &changes) == SUCCESS) ? TRUE : FALSE;
+    
+    /* 打开只读视图,并发模式下保存期间的修改不会影响本次写出的内容 */
+    EmployeeView view;
+    employee_manager_view_begin(manager, &view);
+    unsigned long long stamp = next_save_stamp();
+    ErrorCode err = ERROR_INVALID_FILE;
+    if (tracked && changes.stamp != 0 && changes.version == view.version) {
+        err = save_incremental(filename, &view, &changes, &stamp);
+    }
+    if (err == ERROR_INVALID_FILE) {
+        err = save_view(filename, &view, stamp);
+    }
+    if (err == SUCCESS) {
+        employee_manager_mark_synced(manager, view.version, stamp);
+    }
+    employee_manager_view_end(manager, &view);
+    if (tracked) {
+        employee_changes_free(&changes);
+    }
+    return err;
+}
+
+/* 保存快照到文件 */
+ErrorCode storage_save_snapshot(const char *filename, const EmployeeSnapshot *snapshot) {
+    if (filename == NULL || snapshot == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    unsigned long long stamp = next_save_stamp();
+    ErrorCode err = save_view(filename, &snapshot->view, stamp);
+    if (err == SUCCESS) {
+        /* 快照之后又有修改时版本不符,基线被清除 */
+        employee_manager_mark_synced(snapshot->manager, snapshot->version, stamp);
+    }
+    return err;
+}
+
+/* 读取v2文件的当前文件头 */
+ErrorCode storage_read_header(const char *filename, FileHeaderV2 *header) {
+    if (filename == NULL || header == NULL) {
+        return ERROR_NULL_POINTER;
+    }
     FILE *fp = fopen(filename, "rb");
     if (fp == NULL) {
         return ERROR_FILE_NOT_FOUND;
     }
-    
-    /* 读取文件头 */
-    FileHeader header;
-    if (fread(&header, sizeof(FileHeader), 1, fp) != 1) {
+    long long total = file_size(fp);
+    ChunkReader reader;
+    if (chunk_reader_init(&reader, fp, FILE_V2_DATA_OFFSET) != SUCCESS) {
         fclose(fp);
-        return ERROR_FILE_READ_FAILED;
+        return ERROR_OUT_OF_MEMORY;
     }
     
-    /* 验证魔数 */
-    if (header.magic != MAGIC_NUMBER) {
-        fclose(fp);
-        return ERROR_INVALID_FILE;
+    FileHeader prefix;
+    ErrorCode err;
+    if (!chunk_reader_get(&reader, &prefix, sizeof(FileHeader))) {
+        err = ERROR_FILE_READ_FAILED;
+    } else if (prefix.magic != MAGIC_NUMBER || prefix.version != FILE_VERSION) {
+        err = ERROR_INVALID_FILE;
+    } else {
+        err = read_v2_header(&reader, &prefix, total, header, NULL);
     }
-    
-    /* 验证版本 */
-    if (header.version != FILE_VERSION) {
-        fclose(fp);
-        return ERROR_INVALID_FILE;
+    chunk_reader_free(&reader);
+    fclose(fp);
+    return err;
+}
+
+/* 保存任意只读视图 */
+ErrorCode storage_save_view(const char *filename, const EmployeeView *view) {
+    if (filename == NULL || view == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    return save_view(filename, view, next_save_stamp());
+}
+
+/* 加载v1文件: 定长记录 + 总校验和 + 尾部next_id */
+static ErrorCode load_v1(ChunkReader *reader, const FileHeader *header, long long total,
+                         EmployeeManager *manager) {
+    /* 文件长度不足以容纳声明的记录数时直接报错,避免按错误的count预留内存 */
+    if (total >= 0 &&
+        (unsigned long long)header->count * sizeof(Employee) >
+        (unsigned long long)total - sizeof(FileHeader)) {
+        return ERROR_FILE_READ_FAILED;
     }
     
-    /* 读取所有职工数据并计算校验和 */
+    /* 读取所有职工数据并计算校验和(批量写入期间持有写锁) */
+    employee_manager_begin_write(manager);
+    ErrorCode result = vector_reserve(manager->employees,
+                                      manager->employees->size + header->count);
     unsigned int checksum = 0;
-    for (unsigned int i = 0; i < header.count; i++) {
+    for (unsigned int i = 0; result == SUCCESS && i < header->count; i++) {
         Employee *emp = (Employee *)malloc(sizeof(Employee));
         if (emp == NULL) {
-            fclose(fp);
-            return ERROR_OUT_OF_MEMORY;
+            result = ERROR_OUT_OF_MEMORY;
+            break;
         }
         
-        if (fread(emp, sizeof(Employee), 1, fp) != 1) {
+        if (!chunk_reader_get(reader, emp, sizeof(Employee))) {
             free(emp);
-            fclose(fp);
-            return ERROR_FILE_READ_FAILED;
+            result = ERROR_FILE_READ_FAILED;
+            break;
         }
         
         checksum += calculate_checksum(emp, sizeof(Employee));
         
-        ErrorCode err = vector_push_back(manager->employees, emp);
-        if (err != SUCCESS) {
-            free(emp);
-            fclose(fp);
-            return err;
-        }
+        /* 已预留容量,追加不会失败 */
+        vector_push_back(manager->employees, emp);
     }
     
     /* 验证校验和 */
-    if (checksum != header.checksum) {
-        fclose(fp);
-        return ERROR_DATA_CORRUPTION;
+    if (result == SUCCESS && checksum != header->checksum) {
+        result = ERROR_DATA_CORRUPTION;
+    }
+    
+    if (result != SUCCESS) {
+        employee_manager_end_write(manager);
+        return result;
     }
     
     /* 读取next_id */
-    if (fread(&manager->next_id, sizeof(int), 1, fp) != 1) {
+    if (!chunk_reader_get(reader, &manager->next_id, sizeof(int))) {
         /* 如果没有next_id,使用默认值 */
         manager->next_id = 1001;
         if (manager->employees->size > 0) {
@@ -148,110 +377,1194 @@ ErrorCode storage_load_employees(const char *filename, EmployeeManager *manager)
         }
     }
     
-    fclose(fp);
+    employee_manager_end_write(manager);
     return SUCCESS;
 }
 
-/* 导出为CSV格式 */
-ErrorCode storage_export_csv(const char *filename, EmployeeManager *manager) {
-    if (filename == NULL || manager == NULL) {
-        return ERROR_NULL_POINTER;
+/* 读入一个完整的段并校验,成功时data指向malloc分配的内容 */
+static ErrorCode read_section(ChunkReader *reader, const SectionEntry *entry, void **data) {
+    *data = malloc((size_t)entry->size + 1);
+    if (*data == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    if (!chunk_reader_seek(reader, entry->offset) ||
+        !chunk_reader_get(reader, *data, (size_t)entry->size)) {
+        free(*data);
+        *data = NULL;
+        return ERROR_FILE_READ_FAILED;
+    }
+    if (calculate_checksum(*data, (size_t)entry->size) != entry->checksum) {
+        free(*data);
+        *data = NULL;
+        return ERROR_DATA_CORRUPTION;
+    }
+    return SUCCESS;
+}
+
+/* 读入三个索引段并组装索引 */
+static ErrorCode read_index_sections(ChunkReader *reader, const SectionEntry *id_section,
+                                     const SectionEntry *dept_section,
+                                     const SectionEntry *postings_section,
+                                     unsigned long long record_count, EmployeeIndex **index) {
+    void *slots = NULL;
+    void *depts = NULL;
+    void *postings = NULL;
+    ErrorCode result = read_section(reader, id_section, &slots);
+    if (result == SUCCESS) {
+        result = read_section(reader, dept_section, &depts);
+    }
+    if (result == SUCCESS) {
+        result = read_section(reader, postings_section, &postings);
+    }
+    if (result != SUCCESS || postings_section->count != record_count) {
+        free(slots);
+        free(depts);
+        free(postings);
+        return (result != SUCCESS) ? result : ERROR_DATA_CORRUPTION;
     }
     
-    FILE *fp = fopen(filename, "w");
-    if (fp == NULL) {
-        return ERROR_FILE_WRITE_FAILED;
+    *index = employee_index_from_sections((size_t)record_count,
+                                          (IndexIdSlot *)slots, (size_t)id_section->count,
+                                          (IndexDeptEntry *)depts, (size_t)dept_section->count,
+                                          (unsigned int *)postings);
+    return (*index != NULL) ? SUCCESS : ERROR_DATA_CORRUPTION;
+}
+
+/* 检查段目录项的大小与元素数是否一致 */
+static Bool section_size_valid(const SectionEntry *entry, size_t element_size) {
+    return (entry->count <= entry->size && entry->size == entry->count * element_size) ? TRUE : FALSE;
+}
+
+/* 文件头槽的校验和与版本是否有效 */
+static Bool header_slot_valid(const FileHeaderV2 *header) {
+    return (header->magic == MAGIC_NUMBER && header->version == FILE_VERSION &&
+            header->header_checksum == calculate_checksum(header, offsetof(FileHeaderV2, header_checksum)))
+           ? TRUE : FALSE;
+}
+
+/*
+ * 读取v2文件头区并选出当前文件头: 槽0有效且为旧版单槽文件时只有槽0;
+ * 否则在有效的槽中取序号最大的(槽0损坏时仍可使用槽1)。slot可为NULL
+ */
+static ErrorCode read_v2_header(ChunkReader *reader, const FileHeader *prefix, long long total,
+                                FileHeaderV2 *header, size_t *slot) {
+    FileHeaderV2 slots[FILE_HEADER_SLOTS];
+    memcpy(&slots[0], prefix, sizeof(FileHeader));
+    if (!chunk_reader_get(reader, (unsigned char *)&slots[0] + sizeof(FileHeader),
+                          sizeof(FileHeaderV2) - sizeof(FileHeader))) {
+        return ERROR_FILE_READ_FAILED;
+    }
+    Bool valid[FILE_HEADER_SLOTS];
+    valid[0] = header_slot_valid(&slots[0]);
+    Bool single = (valid[0] && slots[0].header_size == sizeof(FileHeaderV2)) ? TRUE : FALSE;
+    for (size_t i = 1; i < FILE_HEADER_SLOTS; i++) {
+        valid[i] = (!single && total >= (long long)FILE_V2_DATA_OFFSET &&
+                    chunk_reader_get(reader, &slots[i], sizeof(FileHeaderV2)) &&
+                    header_slot_valid(&slots[i]) && slots[i].header_size == FILE_V2_DATA_OFFSET)
+                   ? TRUE : FALSE;
     }
     
-    /* 写入CSV头 */
-    fprintf(fp, "工号,姓名,部门,出勤日期,出勤天数\n");
+    size_t best = FILE_HEADER_SLOTS;
+    for (size_t i = 0; i < FILE_HEADER_SLOTS; i++) {
+        if (valid[i] && (best == FILE_HEADER_SLOTS || (int)(slots[i].sequence - slots[best].sequence) > 0)) {
+            best = i;
+        }
+    }
+    if (best == FILE_HEADER_SLOTS) {
+        return ERROR_DATA_CORRUPTION;
+    }
+    *header = slots[best];
+    if (slot != NULL) {
+        *slot = best;
+    }
+    if ((header->header_size != sizeof(FileHeaderV2) && header->header_size != FILE_V2_DATA_OFFSET) ||
+        header->block_records == 0 || total < 0) {
+        return ERROR_INVALID_FILE;
+    }
+    return SUCCESS;
+}
+
+/*
+ * 读取v2文件头区的其余部分与段目录并校验:
+ * 文件头与目录校验和、各段范围与大小、记录块总数与文件头一致。
+ * 成功时*dir由调用方释放,slot(可为NULL)返回文件头所在的槽
+ */
+static ErrorCode read_v2_directory(ChunkReader *reader, const FileHeader *prefix, long long total,
+                                  FileHeaderV2 *header, size_t *slot, SectionEntry **dir) {
+    ErrorCode err = read_v2_header(reader, prefix, total, header, slot);
+    if (err != SUCCESS) {
+        return err;
+    }
     
-    /* 写入所有职工数据 */
-    for (size_t i = 0; i < manager->employees->size; i++) {
-        Employee *emp = (Employee *)manager->employees->data[i];
-        fprintf(fp, "%d,%s,%s,%s,%d\n",
-                emp->id, emp->name, emp->department,
-                emp->attend_date, emp->attend_days);
+    unsigned long long file_bytes = (unsigned long long)total;
+    if (header->directory_offset < header->header_size || header->directory_offset > file_bytes ||
+        header->directory_count > (file_bytes - header->directory_offset) / sizeof(SectionEntry)) {
+        return ERROR_FILE_READ_FAILED;
     }
     
-    fclose(fp);
+    /* 读取并校验段目录 */
+    size_t dir_count = (size_t)header->directory_count;
+    SectionEntry *entries = (SectionEntry *)malloc((dir_count + 1) * sizeof(SectionEntry));
+    if (entries == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    if (!chunk_reader_seek(reader, header->directory_offset) ||
+        !chunk_reader_get(reader, entries, dir_count * sizeof(SectionEntry))) {
+        free(entries);
+        return ERROR_FILE_READ_FAILED;
+    }
+    if (calculate_checksum(entries, dir_count * sizeof(SectionEntry)) != header->directory_checksum) {
+        free(entries);
+        return ERROR_DATA_CORRUPTION;
+    }
+    
+    /* 校验各段范围;未知类型的段忽略,便于以后扩展 */
+    unsigned long long record_count = 0;
+    Bool valid = TRUE;
+    for (size_t i = 0; i < dir_count && valid; i++) {
+        const SectionEntry *entry = &entries[i];
+        if (entry->offset < header->header_size || entry->offset > header->directory_offset ||
+            entry->size > header->directory_offset - entry->offset) {
+            valid = FALSE;
+            break;
+        }
+        switch (entry->type) {
+            case SECTION_RECORDS:
+                valid = (section_size_valid(entry, sizeof(Employee)) &&
+                         entry->count <= header->block_records) ? TRUE : FALSE;
+                record_count += entry->count;
+                break;
+            case SECTION_ID_INDEX:
+                valid = section_size_valid(entry, sizeof(IndexIdSlot));
+                break;
+            case SECTION_DEPT_INDEX:
+                valid = section_size_valid(entry, sizeof(IndexDeptEntry));
+                break;
+            case SECTION_DEPT_POSTINGS:
+                valid = section_size_valid(entry, sizeof(unsigned int));
+                break;
+            default:
+                break;
+        }
+    }
+    if (!valid || record_count != header->record_count) {
+        free(entries);
+        return ERROR_DATA_CORRUPTION;
+    }
+    
+    *dir = entries;
     return SUCCESS;
 }
 
-/* 简单的字符串哈希函数(用于密码加密) */
-static unsigned int simple_hash(const char *str) {
-    unsigned int hash = 5381;
-    int c;
+/* 按文件顺序收集记录块目录项,max_size返回最大块字节数;没有记录块时返回NULL且count为0 */
+static const SectionEntry **collect_record_blocks(const SectionEntry *dir, size_t dir_count,
+                                                  size_t *count, size_t *max_size) {
+    size_t block_count = 0;
+    *max_size = 0;
+    for (size_t i = 0; i < dir_count; i++) {
+        if (dir[i].type == SECTION_RECORDS) {
+            block_count++;
+            if (dir[i].size > *max_size) {
+                *max_size = (size_t)dir[i].size;
+            }
+        }
+    }
+    *count = 0;
+    if (block_count == 0 || *max_size == 0) {
+        return NULL;
+    }
+    
+    const SectionEntry **blocks = (const SectionEntry **)malloc(block_count * sizeof(SectionEntry *));
+    if (blocks == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < dir_count; i++) {
+        if (dir[i].type == SECTION_RECORDS) {
+            blocks[(*count)++] = &dir[i];
+        }
+    }
+    return blocks;
+}
+
+/*
+ * 异步读入全部记录块并追加到管理器: 最多STORAGE_IO_DEPTH块同时在途,
+ * 按文件顺序逐块校验并展开,校验与后续块的读取重叠进行
+ */
+static ErrorCode load_record_blocks(int fd, const SectionEntry *dir, size_t dir_count,
+                                    EmployeeManager *manager) {
+    size_t block_count = 0;
+    size_t max_size = 0;
+    const SectionEntry **blocks = collect_record_blocks(dir, dir_count, &block_count, &max_size);
+    if (blocks == NULL) {
+        return (block_count == 0 && max_size > 0) ? ERROR_OUT_OF_MEMORY : SUCCESS;
+    }
     
-    while ((c = *str++)) {
-        hash = ((hash << 5) + hash) + c;  /* hash * 33 + c */
+    size_t depth = (block_count < STORAGE_IO_DEPTH) ? block_count : STORAGE_IO_DEPTH;
+    ErrorCode result;
+    IoQueue *queue = io_queue_create(io_backend_default(), fd, depth, max_size, &result);
+    if (queue == NULL) {
+        free(blocks);
+        return result;
+    }
+    
+    /* 第b块使用第b % depth个槽 */
+    for (size_t b = 0; b < depth && result == SUCCESS; b++) {
+        result = io_queue_submit(queue, b, IO_OP_READ, blocks[b]->offset, (size_t)blocks[b]->size);
+    }
+    for (size_t b = 0; b < block_count && result == SUCCESS; b++) {
+        size_t slot = b % depth;
+        size_t bytes = 0;
+        result = io_queue_wait(queue, slot, &bytes);
+        if (result == SUCCESS && bytes != blocks[b]->size) {
+            result = ERROR_FILE_READ_FAILED;
+        }
+        const Employee *records = (const Employee *)io_queue_buffer(queue, slot);
+        if (result == SUCCESS && calculate_checksum(records, bytes) != blocks[b]->checksum) {
+            result = ERROR_DATA_CORRUPTION;
+        }
+        for (unsigned long long i = 0; result == SUCCESS && i < blocks[b]->count; i++) {
+            Employee *emp = (Employee *)malloc(sizeof(Employee));
+            if (emp == NULL) {
+                result = ERROR_OUT_OF_MEMORY;
+                break;
+            }
+            *emp = records[i];
+            vector_push_back(manager->employees, emp);
+        }
+        if (result == SUCCESS && b + depth < block_count) {
+            const SectionEntry *next = blocks[b + depth];
+            result = io_queue_submit(queue, slot, IO_OP_READ, next->offset, (size_t)next->size);
+        }
     }
     
-    return hash;
+    io_queue_free(queue);
+    free(blocks);
+    return result;
 }
 
-/* 保存用户凭证 */
-ErrorCode storage_save_credential(const char *filename, const char *username,
-                                   const char *password) {
-    if (filename == NULL || username == NULL || password == NULL) {
-        return ERROR_NULL_POINTER;
+/* 记录数达到阈值且有多个CPU核心时自动并行加载 */
+#define STORAGE_PARALLEL_LOAD_THRESHOLD 65536
+
+/* 并行加载: 每个线程负责的任务数(便于负载均衡) */
+#define STORAGE_LOAD_TASKS_PER_THREAD 4
+
+/* 并行加载的一个区间: 连续的若干记录块 */
+typedef struct {
+    size_t block_begin;
+    size_t block_end;
+    size_t first;             /* 首条记录相对本次加载的位置 */
+    size_t filled;            /* 已放入数组的记录数,失败时据此释放 */
+    IndexPartial *partial;    /* 部门编码,不建立索引时为NULL */
+    ErrorCode result;
+} LoadRange;
+
+typedef struct {
+    int fd;
+    const SectionEntry **blocks;
+    size_t max_size;
+    Employee **slots;         /* 数组中本次加载的起始位置 */
+    LoadRange *ranges;
+} ParallelLoadJob;
+
+static void load_range_task(void *ctx, size_t task_index) {
+    ParallelLoadJob *job = (ParallelLoadJob *)ctx;
+    LoadRange *range = &job->ranges[task_index];
+    unsigned char *buffer = (unsigned char *)malloc(job->max_size);
+    if (buffer == NULL) {
+        range->result = ERROR_OUT_OF_MEMORY;
+        return;
     }
     
-    FILE *fp = fopen(filename, "wb");
-    if (fp == NULL) {
-        return ERROR_FILE_WRITE_FAILED;
+    for (size_t b = range->block_begin; b < range->block_end && range->result == SUCCESS; b++) {
+        const SectionEntry *entry = job->blocks[b];
+        size_t bytes = 0;
+        range->result = io_read_at(job->fd, buffer, (size_t)entry->size, entry->offset, &bytes);
+        if (range->result == SUCCESS && bytes != entry->size) {
+            range->result = ERROR_FILE_READ_FAILED;
+        }
+        if (range->result == SUCCESS && calculate_checksum(buffer, bytes) != entry->checksum) {
+            range->result = ERROR_DATA_CORRUPTION;
+        }
+        const Employee *records = (const Employee *)buffer;
+        for (unsigned long long i = 0; range->result == SUCCESS && i < entry->count; i++) {
+            Employee *emp = (Employee *)malloc(sizeof(Employee));
+            if (emp == NULL) {
+                range->result = ERROR_OUT_OF_MEMORY;
+                break;
+            }
+            *emp = records[i];
+            job->slots[range->first + range->filled++] = emp;
+            if (range->partial != NULL && index_partial_add(range->partial, emp->department) != SUCCESS) {
+                /* 只放弃部门编码,加载继续;缺少分区时合并阶段整体放弃索引 */
+                index_partial_free(range->partial);
+                range->partial = NULL;
+            }
+        }
+    }
+    free(buffer);
+}
+
+/*
+ * 多线程读入全部记录块并追加到管理器: 块按区间分成若干任务,各任务把记录写入预分配
+ * 数组中互不重叠的位置;全部成功后一次性更新记录数。index非NULL时合并各任务的
+ * 部门编码建立索引;索引的任何一步失败都只使*index为NULL(由后台索引构建器重建),
+ * 不影响加载结果
+ */
+static ErrorCode load_record_blocks_parallel(int fd, const SectionEntry *dir, size_t dir_count,
+                                             EmployeeManager *manager, ThreadPool *pool,
+                                             EmployeeIndex **index) {
+    size_t block_count = 0;
+    size_t max_size = 0;
+    const SectionEntry **blocks = collect_record_blocks(dir, dir_count, &block_count, &max_size);
+    if (blocks == NULL) {
+        return (block_count == 0 && max_size > 0) ? ERROR_OUT_OF_MEMORY : SUCCESS;
     }
     
-    UserCredential cred;
-    strncpy(cred.username, username, MAX_USERNAME_LEN - 1);
-    cred.username[MAX_USERNAME_LEN - 1] = '\0';
+    size_t task_count = (size_t)thread_pool_concurrency(pool) * STORAGE_LOAD_TASKS_PER_THREAD;
+    if (task_count > block_count) {
+        task_count = block_count;
+    }
+    size_t per_task = (block_count + task_count - 1) / task_count;
+    task_count = (block_count + per_task - 1) / per_task;
+    LoadRange *ranges = (LoadRange *)calloc(task_count, sizeof(LoadRange));
+    if (ranges == NULL) {
+        free(blocks);
+        return ERROR_OUT_OF_MEMORY;
+    }
     
-    /* 简单加密:保存密码的哈希值 */
-    unsigned int hash = simple_hash(password);
-    snprintf(cred.password, MAX_PASSWORD_LEN, "%u", hash);
+    /* 各区间的起始位置由前面各块的记录数累加得到 */
+    ErrorCode result = SUCCESS;
+    Bool indexing = (index != NULL) ? TRUE : FALSE;
+    size_t position = 0;
+    for (size_t t = 0; t < task_count; t++) {
+        LoadRange *range = &ranges[t];
+        range->block_begin = t * per_task;
+        range->block_end = (range->block_begin + per_task < block_count) ? range->block_begin + per_task
+                                                                         : block_count;
+        range->first = position;
+        range->result = SUCCESS;
+        for (size_t b = range->block_begin; b < range->block_end; b++) {
+            position += (size_t)blocks[b]->count;
+        }
+        if (indexing) {
+            range->partial = index_partial_create(range->first, position - range->first);
+            indexing = (range->partial != NULL) ? TRUE : FALSE;
+        }
+    }
+    if (!indexing) {
+        for (size_t t = 0; t < task_count; t++) {
+            index_partial_free(ranges[t].partial);
+            ranges[t].partial = NULL;
+        }
+    }
     
-    if (fwrite(&cred, sizeof(UserCredential), 1, fp) != 1) {
-        fclose(fp);
-        return ERROR_FILE_WRITE_FAILED;
+    ParallelLoadJob job;
+    job.fd = fd;
+    job.blocks = blocks;
+    job.max_size = max_size;
+    job.slots = (Employee **)manager->employees->data + manager->employees->size;
+    job.ranges = ranges;
+    result = thread_pool_run(pool, task_count, load_range_task, &job);
+    for (size_t t = 0; t < task_count && result == SUCCESS; t++) {
+        result = ranges[t].result;
+        if (ranges[t].partial == NULL) {
+            indexing = FALSE;
+        }
     }
     
-    fclose(fp);
-    return SUCCESS;
+    if (result == SUCCESS) {
+        manager->employees->size += position;
+        if (indexing) {
+            IndexPartial **partials = (IndexPartial **)malloc(task_count * sizeof(IndexPartial *));
+            if (partials != NULL) {
+                for (size_t t = 0; t < task_count; t++) {
+                    partials[t] = ranges[t].partial;
+                }
+                *index = employee_index_merge(partials, task_count, job.slots, position, 0);
+                free(partials);
+            }
+        }
+    } else {
+        for (size_t t = 0; t < task_count; t++) {
+            for (size_t i = 0; i < ranges[t].filled; i++) {
+                free(job.slots[ranges[t].first + i]);
+            }
+        }
+    }
+    
+    for (size_t t = 0; t < task_count; t++) {
+        index_partial_free(ranges[t].partial);
+    }
+    free(ranges);
+    free(blocks);
+    return result;
 }
 
-/* 验证用户凭证 */
-Bool storage_verify_credential(const char *filename, const char *username,
-                                const char *password) {
-    if (filename == NULL || username == NULL || password == NULL) {
-        return FALSE;
+/* 加载v2文件: 先校验文件头与段目录,再读入索引段与各记录块 */
+static ErrorCode load_v2(ChunkReader *reader, const FileHeader *prefix, long long total,
+                         EmployeeManager *manager, ThreadPool *pool) {
+    FileHeaderV2 header;
+    SectionEntry *dir = NULL;
+    ErrorCode err = read_v2_directory(reader, prefix, total, &header, NULL, &dir);
+    if (err != SUCCESS) {
+        return err;
+    }
+    
+    size_t dir_count = (size_t)header.directory_count;
+    unsigned long long record_count = header.record_count;
+    const SectionEntry *id_section = NULL;
+    const SectionEntry *dept_section = NULL;
+    const SectionEntry *postings_section = NULL;
+    for (size_t i = 0; i < dir_count; i++) {
+        if (dir[i].type == SECTION_ID_INDEX) {
+            id_section = &dir[i];
+        } else if (dir[i].type == SECTION_DEPT_INDEX) {
+            dept_section = &dir[i];
+        } else if (dir[i].type == SECTION_DEPT_POSTINGS) {
+            postings_section = &dir[i];
+        }
+    }
+    
+    /* 索引位置以文件中的记录顺序为准,只有加载到空管理器时才能直接使用 */
+    EmployeeIndex *index = NULL;
+    if (manager->employees->size == 0 &&
+        id_section != NULL && dept_section != NULL && postings_section != NULL) {
+        err = read_index_sections(reader, id_section, dept_section, postings_section,
+                                  record_count, &index);
+        if (err != SUCCESS) {
+            free(dir);
+            return err;
+        }
+    }
+    
+    /* 未指定线程池时,记录数较多且有多个CPU核心才并行 */
+    if (pool == NULL && record_count >= STORAGE_PARALLEL_LOAD_THRESHOLD) {
+        ThreadPool *shared = thread_pool_default();
+        if (shared != NULL && thread_pool_concurrency(shared) > 1) {
+            pool = shared;
+        }
+    }
+    
+    /* 逐块读入记录并校验;并行加载时顺带为没有索引段的文件建立索引 */
+    Bool synced = (manager->employees->size == 0) ? TRUE : FALSE;
+    employee_manager_begin_write(manager);
+    ErrorCode result = vector_reserve(manager->employees,
+                                      manager->employees->size + (size_t)record_count);
+    if (result == SUCCESS && pool != NULL) {
+        result = load_record_blocks_parallel(fileno(reader->fp), dir, dir_count, manager, pool,
+                                             (synced && index == NULL) ? &index : NULL);
+    } else if (result == SUCCESS) {
+        result = load_record_blocks(fileno(reader->fp), dir, dir_count, manager);
     }
+    if (result == SUCCESS) {
+        manager->next_id = header.next_id;
+    }
+    employee_manager_end_write(manager);
+    free(dir);
     
+    if (result == SUCCESS && index != NULL) {
+        index->version = manager->generation;
+        employee_manager_attach_index(manager, index);
+    } else {
+        employee_index_free(index);
+    }
+    /* 加载到空管理器时内存与文件一致,可作为增量保存的基线 */
+    if (result == SUCCESS && synced) {
+        employee_manager_mark_synced(manager, manager->generation, header.save_stamp);
+    }
+    return result;
+}
+
+/* 从文件加载职工数据,pool为NULL时由记录数决定是否并行 */
+static ErrorCode load_file(const char *filename, EmployeeManager *manager, ThreadPool *pool) {
     FILE *fp = fopen(filename, "rb");
     if (fp == NULL) {
-        return FALSE;
+        return ERROR_FILE_NOT_FOUND;
     }
     
-    UserCredential cred;
-    if (fread(&cred, sizeof(UserCredential), 1, fp) != 1) {
+    long long total = file_size(fp);
+    ChunkReader reader;
+    if (chunk_reader_init(&reader, fp, (total > 0) ? (size_t)total : 0) != SUCCESS) {
         fclose(fp);
-        return FALSE;
+        return ERROR_OUT_OF_MEMORY;
     }
     
-    fclose(fp);
+    /* 读取文件头(v1与v2共有的前16字节) */
+    FileHeader header;
+    ErrorCode result;
+    if (!chunk_reader_get(&reader, &header, sizeof(FileHeader))) {
+        result = ERROR_FILE_READ_FAILED;
+    } else if (header.magic != MAGIC_NUMBER) {
+        result = ERROR_INVALID_FILE;
+    } else if (header.version == FILE_VERSION_V1) {
+        result = load_v1(&reader, &header, total, manager);
+    } else if (header.version == FILE_VERSION) {
+        result = load_v2(&reader, &header, total, manager, pool);
+    } else {
+        result = ERROR_INVALID_FILE;
+    }
     
-    /* 验证用户名 */
-    if (strcmp(cred.username, username) != 0) {
-        return FALSE;
+    chunk_reader_free(&reader);
+    fclose(fp);
+    return result;
+}
+
+/* 从文件加载职工数据 */
+ErrorCode storage_load_employees(const char *filename, EmployeeManager *manager) {
+    if (filename == NULL || manager == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    return load_file(filename, manager, NULL);
+}
+
+/* 多线程加载 */
+ErrorCode storage_load_employees_parallel(const char *filename, EmployeeManager *manager,
+                                          ThreadPool *pool) {
+    if (filename == NULL || manager == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    if (pool == NULL) {
+        pool = thread_pool_default();
+        if (pool == NULL) {
+            return ERROR_OUT_OF_MEMORY;
+        }
+    }
+    return load_file(filename, manager, pool);
+}
+
+/* CSV导出参数: 输出缓冲区满CSV_WRITE_BUFFER字节写出一次;
+ * 记录数达到阈值时按CSV_PARALLEL_CHUNK条一块并行格式化,每轮最多一批块,按顺序拼接写出 */
+#define CSV_PARALLEL_THRESHOLD 65536
+#define CSV_PARALLEL_CHUNK 16384
+
+/* 并行格式化上下文: 第task块负责[first + task * CSV_PARALLEL_CHUNK, ...)的记录 */
+typedef struct {
+    const EmployeeView *view;
+    size_t first;
+    CsvBuffer *buffers;
+    volatile long failed;
+} CsvFormatJob;
+
+static void csv_format_chunk(void *ctx, size_t task_index) {
+    CsvFormatJob *job = (CsvFormatJob *)ctx;
+    CsvBuffer *buffer = &job->buffers[task_index];
+    size_t begin = job->first + task_index * CSV_PARALLEL_CHUNK;
+    size_t end = begin + CSV_PARALLEL_CHUNK;
+    if (end > job->view->size) {
+        end = job->view->size;
+    }
+
+    buffer->size = 0;
+    for (size_t i = begin; i < end; i++) {
+        if (csv_append_employee(buffer, employee_view_get(job->view, i)) != SUCCESS) {
+            atomic_long_store(&job->failed, 1);
+            return;
+        }
+    }
+}
+
+/* 多线程格式化: 每轮格式化若干块,再按块顺序写出,保证输出与串行一致 */
+static ErrorCode write_csv_parallel(FILE *fp, const EmployeeView *view, ThreadPool *pool) {
+    size_t batch = (size_t)thread_pool_concurrency(pool) * 2;
+    CsvBuffer *buffers = (CsvBuffer *)calloc(batch, sizeof(CsvBuffer));
+    if (buffers == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+
+    ErrorCode err = SUCCESS;
+    for (size_t i = 0; err == SUCCESS && i < batch; i++) {
+        err = csv_buffer_init(&buffers[i], CSV_PARALLEL_CHUNK * 64);
+    }
+
+    CsvFormatJob job;
+    job.view = view;
+    job.buffers = buffers;
+    job.failed = 0;
+    for (size_t first = 0; err == SUCCESS && first < view->size;
+         first += batch * CSV_PARALLEL_CHUNK) {
+        size_t remaining = view->size - first;
+        size_t tasks = (remaining + CSV_PARALLEL_CHUNK - 1) / CSV_PARALLEL_CHUNK;
+        if (tasks > batch) {
+            tasks = batch;
+        }
+
+        job.first = first;
+        err = thread_pool_run(pool, tasks, csv_format_chunk, &job);
+        if (err == SUCCESS && atomic_long_load(&job.failed)) {
+            err = ERROR_OUT_OF_MEMORY;
+        }
+        for (size_t t = 0; err == SUCCESS && t < tasks; t++) {
+            if (fwrite(buffers[t].data, 1, buffers[t].size, fp) != buffers[t].size) {
+                err = ERROR_FILE_WRITE_FAILED;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < batch; i++) {
+        csv_buffer_free(&buffers[i]);
+    }
+    free(buffers);
+    return err;
+}
+
+/* 单线程格式化: 复用一个大缓冲区,满了再写出 */
+static ErrorCode write_csv_serial(FILE *fp, const EmployeeView *view) {
+    CsvBuffer buffer;
+    ErrorCode err = csv_buffer_init(&buffer, CSV_WRITE_BUFFER + CSV_MAX_ROW_LEN);
+    if (err != SUCCESS) {
+        return err;
+    }
+
+    size_t span_count = employee_view_span_count(view);
+    for (size_t s = 0; err == SUCCESS && s < span_count; s++) {
+        Employee *const *records = NULL;
+        size_t count = employee_view_span(view, s, &records);
+        for (size_t i = 0; err == SUCCESS && i < count; i++) {
+            err = csv_append_employee(&buffer, records[i]);
+            if (err == SUCCESS && buffer.size >= CSV_WRITE_BUFFER) {
+                if (fwrite(buffer.data, 1, buffer.size, fp) != buffer.size) {
+                    err = ERROR_FILE_WRITE_FAILED;
+                }
+                buffer.size = 0;
+            }
+        }
+    }
+    if (err == SUCCESS && buffer.size > 0 &&
+        fwrite(buffer.data, 1, buffer.size, fp) != buffer.size) {
+        err = ERROR_FILE_WRITE_FAILED;
+    }
+
+    csv_buffer_free(&buffer);
+    return err;
+}
+
+/* 将只读视图导出为CSV */
+static ErrorCode export_view_csv(const char *filename, const EmployeeView *view) {
+    AtomicFile file;
+    ErrorCode err = atomic_file_open(&file, filename, "w");
+    if (err != SUCCESS) {
+        return err;
     }
+    FILE *fp = file.fp;
+    
+    /* 写入CSV头 */
+    fputs(CSV_HEADER, fp);
     
-    /* 验证密码 */
-    unsigned int hash = simple_hash(password);
-    char hash_str[MAX_PASSWORD_LEN];
-    snprintf(hash_str, MAX_PASSWORD_LEN, "%u", hash);
+    /* 写入所有职工数据 */
+    ThreadPool *pool = (view->size >= CSV_PARALLEL_THRESHOLD) ? thread_pool_default() : NULL;
+    if (pool != NULL) {
+        err = write_csv_parallel(fp, view, pool);
+    } else {
+        err = write_csv_serial(fp, view);
+    }
     
-    if (strcmp(cred.password, hash_str) != 0) {
-        return FALSE;
+    if (err == SUCCESS && ferror(fp)) {
+        err = ERROR_FILE_WRITE_FAILED;
+    }
+    if (err != SUCCESS) {
+        atomic_file_abort(&file);
+        return err;
+    }
+    return atomic_file_commit(&file);
+}
+
+/* 导出为CSV格式 */
+ErrorCode storage_export_csv(const char *filename, EmployeeManager *manager) {
+    if (filename == NULL || manager == NULL) {
+        return ERROR_NULL_POINTER;
     }
     
+    EmployeeView view;
+    employee_manager_view_begin(manager, &view);
+    ErrorCode err = export_view_csv(filename, &view);
+    employee_manager_view_end(manager, &view);
+    return err;
+}
+
+/* 将快照导出为CSV格式 */
+ErrorCode storage_export_csv_snapshot(const char *filename, const EmployeeSnapshot *snapshot) {
+    if (filename == NULL || snapshot == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    return export_view_csv(filename, &snapshot->view);
+}
+
+/* ========== 分页访问 ========== */
+
+/* 默认缓冲池页数: 每页一个记录块(约1 MiB),合计约64 MiB */
+#define PAGED_DEFAULT_POOL_PAGES 64
+
+/* 单页记录数上限,防止损坏的文件头导致巨大的页帧分配 */
+#define PAGED_MAX_BLOCK_RECORDS (1u << 20)
+
+struct PagedStore {
+    FILE *fp;                        /* 只由页加载函数访问(缓冲池锁内) */
+    BufferPool *pool;
+    SectionEntry *blocks;            /* 记录块目录项,按文件顺序 */
+    unsigned long long *block_starts;  /* 每块首条记录的全局下标,末项为记录总数 */
+    size_t block_count;
+    unsigned long long record_count;
+    int next_id;
+};
+
+/* 页加载函数: 整块读入并校验 */
+static ErrorCode paged_load_block(void *ctx, size_t page, void *buffer, size_t *size) {
+    PagedStore *store = (PagedStore *)ctx;
+    if (page >= store->block_count) {
+        return ERROR_INDEX_OUT_OF_BOUNDS;
+    }
+    const SectionEntry *entry = &store->blocks[page];
+    size_t bytes = (size_t)entry->size;
+    if (!file_seek(store->fp, entry->offset) || fread(buffer, 1, bytes, store->fp) != bytes) {
+        return ERROR_FILE_READ_FAILED;
+    }
+    if (calculate_checksum(buffer, bytes) != entry->checksum) {
+        return ERROR_DATA_CORRUPTION;
+    }
+    *size = bytes;
+    return SUCCESS;
+}
+
+/* 读入文件头与段目录,保留记录块目录项 */
+static ErrorCode paged_read_directory(PagedStore *store, size_t *block_records) {
+    long long total = file_size(store->fp);
+    ChunkReader reader;
+    if (chunk_reader_init(&reader, store->fp, FILE_V2_DATA_OFFSET) != SUCCESS) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+
+    FileHeader prefix;
+    FileHeaderV2 header;
+    SectionEntry *dir = NULL;
+    ErrorCode err;
+    if (!chunk_reader_get(&reader, &prefix, sizeof(FileHeader))) {
+        err = ERROR_FILE_READ_FAILED;
+    } else if (prefix.magic != MAGIC_NUMBER || prefix.version != FILE_VERSION) {
+        err = ERROR_INVALID_FILE;
+    } else {
+        err = read_v2_directory(&reader, &prefix, total, &header, NULL, &dir);
+    }
+    chunk_reader_free(&reader);
+    if (err != SUCCESS) {
+        return err;
+    }
+    if (header.block_records > PAGED_MAX_BLOCK_RECORDS) {
+        free(dir);
+        return ERROR_INVALID_FILE;
+    }
+
+    /* 就地压缩为只含记录块的目录 */
+    size_t dir_count = (size_t)header.directory_count;
+    size_t count = 0;
+    for (size_t i = 0; i < dir_count; i++) {
+        if (dir[i].type == SECTION_RECORDS) {
+            dir[count++] = dir[i];
+        }
+    }
+    store->block_starts = (unsigned long long *)malloc((count + 1) * sizeof(unsigned long long));
+    if (store->block_starts == NULL) {
+        free(dir);
+        return ERROR_OUT_OF_MEMORY;
+    }
+    unsigned long long start = 0;
+    for (size_t b = 0; b < count; b++) {
+        store->block_starts[b] = start;
+        start += dir[b].count;
+    }
+    store->block_starts[count] = start;
+
+    store->blocks = dir;
+    store->block_count = count;
+    store->record_count = header.record_count;
+    store->next_id = header.next_id;
+    *block_records = header.block_records;
+    return SUCCESS;
+}
+
+PagedStore *storage_paged_open(const char *filename, size_t pool_pages, ErrorCode *err) {
+    ErrorCode result = SUCCESS;
+    PagedStore *store = NULL;
+    if (filename == NULL) {
+        result = ERROR_NULL_POINTER;
+    } else if ((store = (PagedStore *)calloc(1, sizeof(PagedStore))) == NULL) {
+        result = ERROR_OUT_OF_MEMORY;
+    } else if ((store->fp = fopen(filename, "rb")) == NULL) {
+        result = ERROR_FILE_NOT_FOUND;
+    } else {
+        size_t block_records = 0;
+        result = paged_read_directory(store, &block_records);
+        if (result == SUCCESS) {
+            store->pool = buffer_pool_create((pool_pages > 0) ? pool_pages : PAGED_DEFAULT_POOL_PAGES,
+                                             block_records * sizeof(Employee),
+                                             paged_load_block, store);
+            if (store->pool == NULL) {
+                result = ERROR_OUT_OF_MEMORY;
+            }
+        }
+    }
+
+    if (result != SUCCESS) {
+        storage_paged_close(store);
+        store = NULL;
+    }
+    if (err != NULL) {
+        *err = result;
+    }
+    return store;
+}
+
+void storage_paged_close(PagedStore *store) {
+    if (store == NULL) {
+        return;
+    }
+    buffer_pool_free(store->pool);
+    if (store->fp != NULL) {
+        fclose(store->fp);
+    }
+    free(store->blocks);
+    free(store->block_starts);
+    free(store);
+}
+
+size_t storage_paged_record_count(const PagedStore *store) {
+    return (store != NULL) ? (size_t)store->record_count : 0;
+}
+
+size_t storage_paged_page_count(const PagedStore *store) {
+    return (store != NULL) ? store->block_count : 0;
+}
+
+int storage_paged_next_id(const PagedStore *store) {
+    return (store != NULL) ? store->next_id : 0;
+}
+
+ErrorCode storage_paged_pin(PagedStore *store, size_t page, PageHandle *handle) {
+    if (store == NULL || handle == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    if (page >= store->block_count) {
+        return ERROR_INDEX_OUT_OF_BOUNDS;
+    }
+    return buffer_pool_pin(store->pool, page, handle);
+}
+
+void storage_paged_unpin(PagedStore *store, PageHandle *handle) {
+    if (store != NULL) {
+        buffer_pool_unpin(store->pool, handle);
+    }
+}
+
+size_t storage_paged_page_records(const PageHandle *handle, const Employee **records) {
+    if (handle == NULL || handle->data == NULL || records == NULL) {
+        return 0;
+    }
+    *records = (const Employee *)handle->data;
+    return handle->size / sizeof(Employee);
+}
+
+ErrorCode storage_paged_get(PagedStore *store, size_t index, Employee *out) {
+    if (store == NULL || out == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    if (index >= store->record_count) {
+        return ERROR_INDEX_OUT_OF_BOUNDS;
+    }
+
+    /* 二分查找index所在的块 */
+    size_t lo = 0;
+    size_t hi = store->block_count;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (store->block_starts[mid] <= index) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    PageHandle handle;
+    ErrorCode err = buffer_pool_pin(store->pool, lo, &handle);
+    if (err != SUCCESS) {
+        return err;
+    }
+    const Employee *records = NULL;
+    storage_paged_page_records(&handle, &records);
+    *out = records[index - (size_t)store->block_starts[lo]];
+    buffer_pool_unpin(store->pool, &handle);
+    return SUCCESS;
+}
+
+ErrorCode storage_paged_scan(PagedStore *store, PagedVisitor visitor, void *ctx) {
+    if (store == NULL || visitor == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    Bool more = TRUE;
+    for (size_t page = 0; page < store->block_count && more; page++) {
+        PageHandle handle;
+        ErrorCode err = buffer_pool_pin(store->pool, page, &handle);
+        if (err != SUCCESS) {
+            return err;
+        }
+        const Employee *records = NULL;
+        size_t count = storage_paged_page_records(&handle, &records);
+        for (size_t i = 0; i < count && more; i++) {
+            more = visitor(ctx, &records[i]);
+        }
+        buffer_pool_unpin(store->pool, &handle);
+    }
+    return SUCCESS;
+}
+
+/* 查询上下文 */
+typedef struct {
+    SearchType type;
+    const void *keyword;
+    PagedVisitor visitor;
+    void *ctx;
+    size_t matches;
+} PagedSearch;
+
+static Bool paged_search_visit(void *ctx, const Employee *emp) {
+    PagedSearch *search = (PagedSearch *)ctx;
+    if (!employee_matches(emp, search->type, search->keyword)) {
+        return TRUE;
+    }
+    search->matches++;
+    /* 按工号查询也扫描全部页: 导入或合并得到的文件可能含重复工号,与employee_manager_search一致 */
+    return (search->visitor != NULL) ? search->visitor(search->ctx, emp) : TRUE;
+}
+
+ErrorCode storage_paged_search(PagedStore *store, SearchType type, const void *keyword,
+                               PagedVisitor visitor, void *ctx, size_t *matches) {
+    if (store == NULL || keyword == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    PagedSearch search;
+    search.type = type;
+    search.keyword = keyword;
+    search.visitor = visitor;
+    search.ctx = ctx;
+    search.matches = 0;
+    ErrorCode err = storage_paged_scan(store, paged_search_visit, &search);
+    if (matches != NULL) {
+        *matches = search.matches;
+    }
+    return err;
+}
+
+/* 出勤统计上下文 */
+typedef struct {
+    const char *prefix;
+    size_t prefix_len;
+    long long total;
+} PagedAttendance;
+
+static Bool paged_attendance_visit(void *ctx, const Employee *emp) {
+    PagedAttendance *sum = (PagedAttendance *)ctx;
+    if (strncmp(emp->attend_date, sum->prefix, sum->prefix_len) == 0) {
+        sum->total += emp->attend_days;
+    }
     return TRUE;
 }
+
+ErrorCode storage_paged_attendance(PagedStore *store, const char *prefix, long long *total) {
+    if (store == NULL || prefix == NULL || total == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    PagedAttendance sum;
+    sum.prefix = prefix;
+    sum.prefix_len = strlen(prefix);
+    sum.total = 0;
+    ErrorCode err = storage_paged_scan(store, paged_attendance_visit, &sum);
+    *total = sum.total;
+    return err;
+}
+
+ErrorCode storage_paged_export_csv(PagedStore *store, const char *filename) {
+    if (store == NULL || filename == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    CsvStream out;
+    ErrorCode err = csv_stream_open(&out, filename);
+    if (err != SUCCESS) {
+        return err;
+    }
+    err = storage_paged_scan(store, csv_stream_put, &out);
+    return csv_stream_commit(&out, err);
+}
+
+void storage_paged_stats(PagedStore *store, BufferPoolStats *stats) {
+    buffer_pool_stats((store != NULL) ? store->pool : NULL, stats);
+}
+
+/* 保存出勤位图 */
+ErrorCode storage_save_attendance(const char *filename, const AttendanceBook *book) {
+    if (filename == NULL || book == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    AtomicFile file;
+    ErrorCode err = atomic_file_open(&file, filename, "wb");
+    if (err != SUCCESS) {
+        return err;
+    }
+    FILE *fp = file.fp;
+
+    FileHeader header;
+    header.magic = ATTENDANCE_MAGIC;
+    header.version = ATTENDANCE_VERSION;
+    header.count = (unsigned int)book->count;
+    header.checksum = 0;
+    for (size_t i = 0; i < book->count; i++) {
+        header.checksum += calculate_checksum(&book->entries[i], sizeof(AttendanceYear));
+    }
+
+    if (fwrite(&header, sizeof(FileHeader), 1, fp) != 1 ||
+        (book->count > 0 &&
+         fwrite(book->entries, sizeof(AttendanceYear), book->count, fp) != book->count)) {
+        atomic_file_abort(&file);
+        return ERROR_FILE_WRITE_FAILED;
+    }
+
+    return atomic_file_commit(&file);
+}
+
+/* 加载出勤位图,与book中已有记录按位或合并 */
+ErrorCode storage_load_attendance(const char *filename, AttendanceBook *book) {
+    if (filename == NULL || book == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) {
+        return ERROR_FILE_NOT_FOUND;
+    }
+
+    FileHeader header;
+    if (fread(&header, sizeof(FileHeader), 1, fp) != 1) {
+        fclose(fp);
+        return ERROR_FILE_READ_FAILED;
+    }
+
+    if (header.magic != ATTENDANCE_MAGIC || header.version != ATTENDANCE_VERSION) {
+        fclose(fp);
+        return ERROR_INVALID_FILE;
+    }
+
+    ErrorCode result = SUCCESS;
+    unsigned int checksum = 0;
+    for (unsigned int i = 0; i < header.count; i++) {
+        AttendanceYear entry;
+        if (fread(&entry, sizeof(AttendanceYear), 1, fp) != 1) {
+            result = ERROR_FILE_READ_FAILED;
+            break;
+        }
+
+        checksum += calculate_checksum(&entry, sizeof(AttendanceYear));
+
+        result = attendance_book_merge(book, &entry);
+        if (result != SUCCESS) {
+            break;
+        }
+    }
+
+    if (result == SUCCESS && checksum != header.checksum) {
+        result = ERROR_DATA_CORRUPTION;
+    }
+
+    fclose(fp);
+    return result;
+}
+
+/* 保存分区清单 */
+ErrorCode storage_save_manifest(const char *filename, const PartitionSummary *parts,
+                                size_t count, int next_id) {
+    if (filename == NULL || (parts == NULL && count > 0)) {
+        return ERROR_NULL_POINTER;
+    }
+
+    AtomicFile file;
+    ErrorCode err = atomic_file_open(&file, filename, "wb");
+    if (err != SUCCESS) {
+        return err;
+    }
+    FILE *fp = file.fp;
+
+    FileHeader header;
+    header.magic = MANIFEST_MAGIC;
+    header.version = MANIFEST_VERSION;
+    header.count = (unsigned int)count;
+    header.checksum = checksum_update(calculate_checksum(&next_id, sizeof(int)),
+                                      parts, count * sizeof(PartitionSummary));
+
+    if (fwrite(&header, sizeof(FileHeader), 1, fp) != 1 ||
+        fwrite(&next_id, sizeof(int), 1, fp) != 1 ||
+        (count > 0 && fwrite(parts, sizeof(PartitionSummary), count, fp) != count)) {
+        atomic_file_abort(&file);
+        return ERROR_FILE_WRITE_FAILED;
+    }
+
+    return atomic_file_commit(&file);
+}
+
+/* 加载分区清单,parts由调用方释放 */
+ErrorCode storage_load_manifest(const char *filename, PartitionSummary **parts,
+                                size_t *count, int *next_id) {
+    if (filename == NULL || parts == NULL || count == NULL || next_id == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    *parts = NULL;
+    *count = 0;
+
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) {
+        return ERROR_FILE_NOT_FOUND;
+    }
+
+    FileHeader header;
+    int id = 0;
+    if (fread(&header, sizeof(FileHeader), 1, fp) != 1) {
+        fclose(fp);
+        return ERROR_FILE_READ_FAILED;
+    }
+    if (header.magic != MANIFEST_MAGIC || header.version != MANIFEST_VERSION) {
+        fclose(fp);
+        return ERROR_INVALID_FILE;
+    }
+    long long total = file_size(fp);
+    if (total < 0 || (unsigned long long)total != sizeof(FileHeader) + sizeof(int) +
+                                                  (unsigned long long)header.count * sizeof(PartitionSummary)) {
+        fclose(fp);
+        return ERROR_FILE_READ_FAILED;
+    }
+
+    PartitionSummary *entries = (PartitionSummary *)malloc(
+        (header.count > 0 ? header.count : 1) * sizeof(PartitionSummary));
+    if (entries == NULL) {
+        fclose(fp);
+        return ERROR_OUT_OF_MEMORY;
+    }
+    ErrorCode result = SUCCESS;
+    if (fread(&id, sizeof(int), 1, fp) != 1 ||
+        fread(entries, sizeof(PartitionSummary), header.count, fp) != header.count) {
+        result = ERROR_FILE_READ_FAILED;
+    } else if (checksum_update(calculate_checksum(&id, sizeof(int)), entries,
+                               header.count * sizeof(PartitionSummary)) != header.checksum) {
+        result = ERROR_DATA_CORRUPTION;
+    }
+    fclose(fp);
+
+    if (result != SUCCESS) {
+        free(entries);
+        return result;
+    }
+    *parts = entries;
+    *count = header.count;
+    *next_id = id;
+    return SUCCESS;
+}
+
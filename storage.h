@@ -3,6 +3,11 @@
 
 #include "common.h"
 #include "model.h"
+#include "attendance.h"
+#include "index.h"
+#include "partition.h"
+#include "pager.h"
+#include "thread_pool.h"
 
 /* 文件头结构 */
 PACK_PUSH
@@ -14,33 +19,136 @@ typedef struct {
 } FileHeader;
 PACK_POP
 
-/* 用户凭证结构 */
+/* 每个记录块的记录数(v2格式) */
+#define FILE_BLOCK_RECORDS 4096
+
+/*
+ * v2文件头: 前两个字段与FileHeader相同,据此区分版本。
+ * 文件开头是FILE_HEADER_SLOTS个文件头槽,增量保存把新文件头写入当前槽以外的槽并把序号加1,
+ * 加载时取序号最大的有效槽;改写文件头中途崩溃时另一个槽仍指向完整的旧版本
+ */
+PACK_PUSH
+typedef struct {
+    unsigned int magic;                   /* 魔数: 0x454D5053 (ASCII: EMPS) */
+    unsigned int version;                 /* 版本号: 2 */
+    unsigned int header_size;             /* 文件头区字节数(旧版单槽文件为一个槽的大小) */
+    unsigned int block_records;           /* 每个记录块的最大记录数 */
+    unsigned long long record_count;      /* 记录总数 */
+    unsigned long long directory_offset;  /* 尾部段目录的偏移 */
+    unsigned long long directory_count;   /* 段目录项数 */
+    int next_id;                          /* 下一个可用工号 */
+    unsigned int directory_checksum;      /* 段目录校验和 */
+    unsigned long long save_stamp;        /* 保存标记: 每次保存不同,增量保存据此确认文件未被替换 */
+    unsigned int sequence;                /* 文件头序号: 完整保存为0,每次增量保存加1 */
+    unsigned int header_checksum;         /* 以上字段的校验和 */
+} FileHeaderV2;
+PACK_POP
+
+/* 文件头槽数与第一个记录块的偏移 */
+#define FILE_HEADER_SLOTS 2
+#define FILE_V2_DATA_OFFSET (FILE_HEADER_SLOTS * sizeof(FileHeaderV2))
+
+/* v2段类型 */
+typedef enum {
+    SECTION_RECORDS = 1,        /* 记录块: count条Employee */
+    SECTION_ID_INDEX = 2,       /* 工号哈希槽: count个IndexIdSlot */
+    SECTION_DEPT_INDEX = 3,     /* 部门倒排项: count个IndexDeptEntry */
+    SECTION_DEPT_POSTINGS = 4   /* 部门倒排位置: count个unsigned int */
+} SectionType;
+
+/* v2段目录项 */
 PACK_PUSH
 typedef struct {
-    char username[MAX_USERNAME_LEN];
-    char password[MAX_PASSWORD_LEN];
-} UserCredential;
+    unsigned int type;           /* 段类型(SectionType) */
+    unsigned int checksum;       /* 段内容校验和 */
+    unsigned long long offset;   /* 段在文件中的偏移 */
+    unsigned long long size;     /* 段字节数 */
+    unsigned long long count;    /* 段内元素数 */
+} SectionEntry;
 PACK_POP
 
 /* ========== 数据存储函数 ========== */
 
-/* 保存职工数据到文件 */
+/* 保存职工数据到文件(v2格式,含工号哈希与部门倒排索引段) */
 ErrorCode storage_save_employees(const char *filename, EmployeeManager *manager);
 
-/* 从文件加载职工数据 */
+/*
+ * 从文件加载职工数据: 支持v1定长格式与v2分块格式,v1文件在下次保存时升级为v2。
+ * v2文件中的索引段直接读入并附加到管理器(仅当加载前管理器为空)
+ */
 ErrorCode storage_load_employees(const char *filename, EmployeeManager *manager);
 
+/*
+ * 多线程加载v2文件: 记录块按区间分给线程池,各线程独立读入、校验并把记录放入预分配
+ * 数组的对应位置,同时为部门编码;文件不带索引段且加载前管理器为空时合并各线程的
+ * 部门字典建立索引。pool为NULL时使用共享线程池,v1文件按单线程加载。
+ * storage_load_employees在记录数较多且有多个CPU核心时自动采用此方式
+ */
+ErrorCode storage_load_employees_parallel(const char *filename, EmployeeManager *manager,
+                                          ThreadPool *pool);
+
 /* 导出为CSV格式 */
 ErrorCode storage_export_csv(const char *filename, EmployeeManager *manager);
 
-/* ========== 认证存储函数 ========== */
+/* 读取v2文件的当前文件头(序号最大的有效槽) */
+ErrorCode storage_read_header(const char *filename, FileHeaderV2 *header);
+
+/* 保存任意只读视图(v2格式),用于写出记录子集 */
+ErrorCode storage_save_view(const char *filename, const EmployeeView *view);
+
+/* 保存/加载分区清单(与职工数据共用文件头格式,魔数为PMST),其后为next_id与各分区摘要 */
+ErrorCode storage_save_manifest(const char *filename, const PartitionSummary *parts,
+                                size_t count, int next_id);
+ErrorCode storage_load_manifest(const char *filename, PartitionSummary **parts,
+                                size_t *count, int *next_id);
+
+/* 基于快照保存/导出: 可在后台线程运行,期间写者继续修改不影响输出 */
+ErrorCode storage_save_snapshot(const char *filename, const EmployeeSnapshot *snapshot);
+ErrorCode storage_export_csv_snapshot(const char *filename, const EmployeeSnapshot *snapshot);
+
+/*
+ * 分页只读访问v2文件: 每个记录块是一页,打开时只读文件头与段目录,
+ * 记录块按需经缓冲池读入,内存占用与文件大小无关。
+ * 查询、统计与导出逐页流式处理;v1文件须先保存一次升级为v2
+ */
+typedef struct PagedStore PagedStore;
+
+/* 打开v2文件,缓冲池容纳pool_pages页(0取默认值),err可为NULL */
+PagedStore *storage_paged_open(const char *filename, size_t pool_pages, ErrorCode *err);
+void storage_paged_close(PagedStore *store);
+
+/* 记录总数、页数、文件中的下一个可用工号 */
+size_t storage_paged_record_count(const PagedStore *store);
+size_t storage_paged_page_count(const PagedStore *store);
+int storage_paged_next_id(const PagedStore *store);
+
+/* 钉住/解除钉住一页;钉住期间通过storage_paged_page_records访问页内记录 */
+ErrorCode storage_paged_pin(PagedStore *store, size_t page, PageHandle *handle);
+void storage_paged_unpin(PagedStore *store, PageHandle *handle);
+size_t storage_paged_page_records(const PageHandle *handle, const Employee **records);
+
+/* 按文件中的记录顺序读取第index条记录 */
+ErrorCode storage_paged_get(PagedStore *store, size_t index, Employee *out);
+
+/* 逐条访问记录,visitor返回FALSE时提前结束 */
+typedef Bool (*PagedVisitor)(void *ctx, const Employee *emp);
+ErrorCode storage_paged_scan(PagedStore *store, PagedVisitor visitor, void *ctx);
+
+/* 查询: 对每条匹配的记录调用visitor(可为NULL),matches返回匹配数(可为NULL);工号重复时报告全部匹配 */
+ErrorCode storage_paged_search(PagedStore *store, SearchType type, const void *keyword,
+                               PagedVisitor visitor, void *ctx, size_t *matches);
+
+/* 出勤日期以prefix开头的记录的出勤天数之和("YYYY"为年度,"YYYY-MM"为月度) */
+ErrorCode storage_paged_attendance(PagedStore *store, const char *prefix, long long *total);
+
+/* 逐页导出为CSV,格式与storage_export_csv相同 */
+ErrorCode storage_paged_export_csv(PagedStore *store, const char *filename);
 
-/* 保存用户凭证 */
-ErrorCode storage_save_credential(const char *filename, const char *username, 
-                                   const char *password);
+/* 缓冲池命中统计(store为NULL时全部为0) */
+void storage_paged_stats(PagedStore *store, BufferPoolStats *stats);
 
-/* 验证用户凭证 */
-Bool storage_verify_credential(const char *filename, const char *username, 
-                                const char *password);
+/* 保存/加载出勤位图(与职工数据共用文件头格式,魔数为ATTD) */
+ErrorCode storage_save_attendance(const char *filename, const AttendanceBook *book);
+ErrorCode storage_load_attendance(const char *filename, AttendanceBook *book);
 
 #endif /* STORAGE_H */
@@ -0,0 +1,534 @@
+/* 启用64位文件偏移(须在所有系统头文件之前定义) */
+#if !defined(_WIN32) && !defined(_FILE_OFFSET_BITS)
+    #define _FILE_OFFSET_BITS 64
+#endif
+
+/* Linux下的O_DIRECT需要_GNU_SOURCE */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE
+#endif
+
+#include "storage_io.h"
+#include "thread.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_WIN32)
+    #include <windows.h>
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+/* 在已有校验和上继续累加一段数据(可分段计算同一块的校验和) */
+unsigned int checksum_update(unsigned int sum, const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    
+    for (size_t i = 0; i < size; i++) {
+        sum += bytes[i];
+        sum = (sum << 1) | (sum >> 31);  /* 循环左移增加扩散性 */
+    }
+    
+    return sum;
+}
+
+/* 计算简单的校验和 */
+unsigned int calculate_checksum(const void *data, size_t size) {
+    return checksum_update(0, data, size);
+}
+
+unsigned long long fnv64_update(unsigned long long hash, const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/* 64位文件偏移定位 */
+Bool file_seek(FILE *fp, unsigned long long offset) {
+#if defined(_WIN32)
+    return (_fseeki64(fp, (__int64)offset, SEEK_SET) == 0) ? TRUE : FALSE;
+#else
+    return (fseeko(fp, (off_t)offset, SEEK_SET) == 0) ? TRUE : FALSE;
+#endif
+}
+
+/* 文件总字节数,失败返回-1 */
+long long file_size(FILE *fp) {
+#if defined(_WIN32)
+    __int64 current = _ftelli64(fp);
+    if (current < 0 || _fseeki64(fp, 0, SEEK_END) != 0) {
+        return -1;
+    }
+    long long size = (long long)_ftelli64(fp);
+    _fseeki64(fp, current, SEEK_SET);
+#else
+    off_t current = ftello(fp);
+    if (current < 0 || fseeko(fp, 0, SEEK_END) != 0) {
+        return -1;
+    }
+    long long size = (long long)ftello(fp);
+    fseeko(fp, current, SEEK_SET);
+#endif
+    return size;
+}
+
+
+ErrorCode atomic_file_open(AtomicFile *file, const char *filename, const char *mode) {
+    size_t length = strlen(filename);
+    file->filename = filename;
+    file->temp_path = (char *)malloc(length + 5);
+    if (file->temp_path == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    memcpy(file->temp_path, filename, length);
+    memcpy(file->temp_path + length, ".tmp", 5);
+
+    file->fp = fopen(file->temp_path, mode);
+    if (file->fp == NULL) {
+        free(file->temp_path);
+        return ERROR_FILE_WRITE_FAILED;
+    }
+    return SUCCESS;
+}
+
+/* 放弃写入: 关闭并删除临时文件 */
+void atomic_file_abort(AtomicFile *file) {
+    fclose(file->fp);
+    remove(file->temp_path);
+    free(file->temp_path);
+}
+
+/* 刷新并同步到磁盘 */
+Bool sync_file(FILE *fp) {
+    if (fflush(fp) != 0) {
+        return FALSE;
+    }
+#if defined(_WIN32)
+    return (_commit(_fileno(fp)) == 0) ? TRUE : FALSE;
+#else
+    return (fsync(fileno(fp)) == 0) ? TRUE : FALSE;
+#endif
+}
+
+#if !defined(_WIN32)
+/* 同步目标所在目录,使改名本身也落盘(尽力而为) */
+static void sync_parent_dir(const char *filename) {
+    const char *slash = strrchr(filename, '/');
+    char *dir = NULL;
+    if (slash == NULL) {
+        dir = (char *)malloc(2);
+        if (dir != NULL) {
+            strcpy(dir, ".");
+        }
+    } else {
+        size_t length = (slash == filename) ? 1 : (size_t)(slash - filename);
+        dir = (char *)malloc(length + 1);
+        if (dir != NULL) {
+            memcpy(dir, filename, length);
+            dir[length] = '\0';
+        }
+    }
+    if (dir == NULL) {
+        return;
+    }
+
+    int fd = open(dir, O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+    free(dir);
+}
+#endif
+
+/* 提交写入: fsync临时文件后原子改名覆盖目标 */
+ErrorCode atomic_file_commit(AtomicFile *file) {
+    if (!sync_file(file->fp)) {
+        atomic_file_abort(file);
+        return ERROR_FILE_WRITE_FAILED;
+    }
+    if (fclose(file->fp) != 0) {
+        remove(file->temp_path);
+        free(file->temp_path);
+        return ERROR_FILE_WRITE_FAILED;
+    }
+
+#if defined(_WIN32)
+    Bool renamed = MoveFileExA(file->temp_path, file->filename,
+                               MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) ? TRUE : FALSE;
+#else
+    Bool renamed = (rename(file->temp_path, file->filename) == 0) ? TRUE : FALSE;
+    if (renamed) {
+        sync_parent_dir(file->filename);
+    }
+#endif
+
+    if (!renamed) {
+        remove(file->temp_path);
+    }
+    free(file->temp_path);
+    return renamed ? SUCCESS : ERROR_FILE_WRITE_FAILED;
+}
+
+
+ErrorCode chunk_writer_init(ChunkWriter *writer, FILE *fp) {
+    ErrorCode err;
+    writer->fp = fp;
+    writer->slot = 0;
+    writer->used = 0;
+    writer->offset = 0;
+    writer->flushed = 0;
+    writer->direct = FALSE;
+    writer->failed = FALSE;
+    writer->queue = io_queue_create(io_backend_default(), fileno(fp), STORAGE_IO_DEPTH,
+                                    STORAGE_CHUNK_SIZE, &err);
+    if (writer->queue == NULL) {
+        return err;
+    }
+    writer->buffer = (unsigned char *)io_queue_buffer(writer->queue, 0);
+    setvbuf(fp, NULL, _IONBF, 0);
+    return SUCCESS;
+}
+
+/* 预计写出大量数据时启用O_DIRECT(文件系统不支持时保持缓冲写) */
+void chunk_writer_enable_direct(ChunkWriter *writer, unsigned long long expected) {
+#if defined(O_DIRECT)
+    if (expected < STORAGE_DIRECT_THRESHOLD || writer->flushed > 0) {
+        return;
+    }
+    int fd = fileno(writer->fp);
+    int flags = fcntl(fd, F_GETFL);
+    if (flags >= 0 && fcntl(fd, F_SETFL, flags | O_DIRECT) == 0) {
+        writer->direct = TRUE;
+    }
+#else
+    (void)writer;
+    (void)expected;
+#endif
+}
+
+static void chunk_writer_disable_direct(ChunkWriter *writer) {
+#if defined(O_DIRECT)
+    int fd = fileno(writer->fp);
+    int flags = fcntl(fd, F_GETFL);
+    if (flags >= 0) {
+        fcntl(fd, F_SETFL, flags & ~O_DIRECT);
+    }
+#endif
+    writer->direct = FALSE;
+}
+
+/* 等待槽上的写入完成,失败时记录 */
+static void chunk_writer_reclaim(ChunkWriter *writer, size_t slot) {
+    if (io_queue_busy(writer->queue, slot) &&
+        io_queue_wait(writer->queue, slot, NULL) != SUCCESS) {
+        writer->failed = TRUE;
+    }
+}
+
+/* 提交当前块并切换到下一个空闲槽 */
+static void chunk_writer_flush(ChunkWriter *writer) {
+    if (writer->used == 0) {
+        return;
+    }
+    /* O_DIRECT要求长度对齐: 不足一整块的尾部改回缓冲写 */
+    if (writer->direct && writer->used % IO_BUFFER_ALIGN != 0) {
+        if (io_queue_drain(writer->queue) != SUCCESS) {
+            writer->failed = TRUE;
+        }
+        chunk_writer_disable_direct(writer);
+    }
+    if (!writer->failed &&
+        io_queue_submit(writer->queue, writer->slot, IO_OP_WRITE, writer->flushed, writer->used) != SUCCESS) {
+        writer->failed = TRUE;
+    }
+    writer->flushed += writer->used;
+    writer->used = 0;
+
+    writer->slot = (writer->slot + 1) % STORAGE_IO_DEPTH;
+    chunk_writer_reclaim(writer, writer->slot);
+    writer->buffer = (unsigned char *)io_queue_buffer(writer->queue, writer->slot);
+}
+
+void chunk_writer_put(ChunkWriter *writer, const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    writer->offset += size;
+    while (size > 0) {
+        size_t room = STORAGE_CHUNK_SIZE - writer->used;
+        size_t n = (size < room) ? size : room;
+        memcpy(writer->buffer + writer->used, bytes, n);
+        writer->used += n;
+        bytes += n;
+        size -= n;
+        if (writer->used == STORAGE_CHUNK_SIZE) {
+            chunk_writer_flush(writer);
+        }
+    }
+}
+
+/* 写出剩余数据、等待全部完成并释放队列,返回是否全部写出成功 */
+Bool chunk_writer_finish(ChunkWriter *writer) {
+    chunk_writer_flush(writer);
+    if (io_queue_drain(writer->queue) != SUCCESS) {
+        writer->failed = TRUE;
+    }
+    if (writer->direct) {
+        chunk_writer_disable_direct(writer);
+    }
+    io_queue_free(writer->queue);
+    writer->queue = NULL;
+    writer->buffer = NULL;
+    return writer->failed ? FALSE : TRUE;
+}
+
+
+ErrorCode chunk_reader_init(ChunkReader *reader, FILE *fp, size_t expected) {
+    reader->fp = fp;
+    reader->pos = 0;
+    reader->end = 0;
+    reader->offset = 0;
+    reader->capacity = (expected > 0 && expected < STORAGE_CHUNK_SIZE) ? expected : STORAGE_CHUNK_SIZE;
+    reader->buffer = (unsigned char *)malloc(reader->capacity);
+    if (reader->buffer == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    setvbuf(fp, NULL, _IONBF, 0);
+    return SUCCESS;
+}
+
+/* 读取size字节,数据不足时返回FALSE */
+Bool chunk_reader_get(ChunkReader *reader, void *data, size_t size) {
+    unsigned char *bytes = (unsigned char *)data;
+    reader->offset += size;
+    while (size > 0) {
+        if (reader->pos == reader->end) {
+            reader->end = fread(reader->buffer, 1, reader->capacity, reader->fp);
+            reader->pos = 0;
+            if (reader->end == 0) {
+                return FALSE;
+            }
+        }
+        size_t avail = reader->end - reader->pos;
+        size_t n = (size < avail) ? size : avail;
+        memcpy(bytes, reader->buffer + reader->pos, n);
+        reader->pos += n;
+        bytes += n;
+        size -= n;
+    }
+    return TRUE;
+}
+
+/* 跳转到指定偏移,已位于该处时不产生系统调用 */
+Bool chunk_reader_seek(ChunkReader *reader, unsigned long long offset) {
+    if (offset == reader->offset) {
+        return TRUE;
+    }
+    reader->pos = 0;
+    reader->end = 0;
+    reader->offset = offset;
+    return file_seek(reader->fp, offset);
+}
+
+void chunk_reader_free(ChunkReader *reader) {
+    free(reader->buffer);
+    reader->buffer = NULL;
+}
+
+
+/* 追加一个段目录项,返回其下标,失败返回(size_t)-1 */
+size_t directory_add(SectionDirectory *dir, unsigned int type, unsigned long long offset) {
+    if (dir->count == dir->capacity) {
+        size_t new_capacity = (dir->capacity == 0) ? 64 : dir->capacity * 2;
+        SectionEntry *entries = (SectionEntry *)realloc(dir->entries,
+                                                        new_capacity * sizeof(SectionEntry));
+        if (entries == NULL) {
+            return (size_t)-1;
+        }
+        dir->entries = entries;
+        dir->capacity = new_capacity;
+    }
+
+    SectionEntry *entry = &dir->entries[dir->count];
+    memset(entry, 0, sizeof(SectionEntry));
+    entry->type = type;
+    entry->offset = offset;
+    return dir->count++;
+}
+
+/* 整体写出一个段并登记到目录 */
+Bool write_section(ChunkWriter *writer, SectionDirectory *dir, unsigned int type,
+                   const void *data, size_t size, unsigned long long count) {
+    size_t slot = directory_add(dir, type, writer->offset);
+    if (slot == (size_t)-1) {
+        return FALSE;
+    }
+    dir->entries[slot].size = size;
+    dir->entries[slot].count = count;
+    dir->entries[slot].checksum = calculate_checksum(data, size);
+    chunk_writer_put(writer, data, size);
+    return TRUE;
+}
+
+
+ErrorCode v2_writer_open(V2Writer *out, const char *filename) {
+    ErrorCode err = atomic_file_open(&out->file, filename, "wb");
+    if (err != SUCCESS) {
+        return err;
+    }
+    err = chunk_writer_init(&out->writer, out->file.fp);
+    if (err != SUCCESS) {
+        atomic_file_abort(&out->file);
+        return err;
+    }
+    
+    out->dir.entries = NULL;
+    out->dir.count = 0;
+    out->dir.capacity = 0;
+    out->block = (size_t)-1;
+    out->record_count = 0;
+    out->stamp = 0;
+    out->ok = TRUE;
+    
+    /* 文件头区占位,提交时回填槽0;槽1保持全0(无效),首次增量保存时写入 */
+    FileHeaderV2 slots[FILE_HEADER_SLOTS];
+    memset(slots, 0, sizeof(slots));
+    chunk_writer_put(&out->writer, slots, sizeof(slots));
+    return SUCCESS;
+}
+
+/* 追加一条记录: 按固定记录数分块,逐块累计校验和 */
+void v2_writer_put(V2Writer *out, const Employee *emp) {
+    if (!out->ok) {
+        return;
+    }
+    if (out->block == (size_t)-1 || out->dir.entries[out->block].count == FILE_BLOCK_RECORDS) {
+        out->block = directory_add(&out->dir, SECTION_RECORDS, out->writer.offset);
+        if (out->block == (size_t)-1) {
+            out->ok = FALSE;
+            return;
+        }
+    }
+    SectionEntry *entry = &out->dir.entries[out->block];
+    chunk_writer_put(&out->writer, emp, sizeof(Employee));
+    entry->checksum = checksum_update(entry->checksum, emp, sizeof(Employee));
+    entry->size += sizeof(Employee);
+    entry->count++;
+    out->record_count++;
+}
+
+void v2_writer_abort(V2Writer *out) {
+    chunk_writer_finish(&out->writer);
+    free(out->dir.entries);
+    atomic_file_abort(&out->file);
+}
+
+/* 写出段目录、回填文件头并提交;失败时放弃临时文件 */
+ErrorCode v2_writer_commit(V2Writer *out, int next_id) {
+    FileHeaderV2 header;
+    memset(&header, 0, sizeof(FileHeaderV2));
+    header.magic = MAGIC_NUMBER;
+    header.version = FILE_VERSION;
+    header.header_size = FILE_V2_DATA_OFFSET;
+    header.block_records = FILE_BLOCK_RECORDS;
+    header.record_count = out->record_count;
+    header.directory_offset = out->writer.offset;
+    header.directory_count = out->dir.count;
+    header.next_id = next_id;
+    header.save_stamp = out->stamp;
+    header.directory_checksum = calculate_checksum(out->dir.entries,
+                                                   out->dir.count * sizeof(SectionEntry));
+    header.header_checksum = calculate_checksum(&header, offsetof(FileHeaderV2, header_checksum));
+    if (out->ok && out->dir.count > 0) {
+        chunk_writer_put(&out->writer, out->dir.entries, out->dir.count * sizeof(SectionEntry));
+    }
+    free(out->dir.entries);
+    out->dir.entries = NULL;
+    
+    Bool ok = out->ok;
+    if (!chunk_writer_finish(&out->writer) || !ok) {
+        atomic_file_abort(&out->file);
+        return ok ? ERROR_FILE_WRITE_FAILED : ERROR_OUT_OF_MEMORY;
+    }
+    
+    /* 回填文件头 */
+    if (!file_seek(out->file.fp, 0) ||
+        fwrite(&header, sizeof(FileHeaderV2), 1, out->file.fp) != 1) {
+        atomic_file_abort(&out->file);
+        return ERROR_FILE_WRITE_FAILED;
+    }
+    
+    return atomic_file_commit(&out->file);
+}
+
+/* 生成保存标记: 时间、时钟与进程内计数混合,不为0 */
+unsigned long long next_save_stamp(void) {
+    static volatile long counter = 0;
+    unsigned long long x = ((unsigned long long)time(NULL) << 32) ^
+                           ((unsigned long long)clock() << 12) ^
+                           (unsigned long long)atomic_long_add(&counter, 1);
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    return (x == 0) ? 1 : x;
+}
+
+/* ========== CSV流式写出 ========== */
+
+/* 打开目标文件并写入CSV头 */
+ErrorCode csv_stream_open(CsvStream *out, const char *filename) {
+    ErrorCode err = atomic_file_open(&out->file, filename, "w");
+    if (err != SUCCESS) {
+        return err;
+    }
+    out->err = csv_buffer_init(&out->buffer, CSV_WRITE_BUFFER + CSV_MAX_ROW_LEN);
+    if (out->err != SUCCESS) {
+        atomic_file_abort(&out->file);
+        return out->err;
+    }
+    fputs(CSV_HEADER, out->file.fp);
+    return SUCCESS;
+}
+
+/* 追加一条记录(PagedVisitor),出错后返回FALSE */
+Bool csv_stream_put(void *ctx, const Employee *emp) {
+    CsvStream *out = (CsvStream *)ctx;
+    if (out->err != SUCCESS) {
+        return FALSE;
+    }
+    out->err = csv_append_employee(&out->buffer, emp);
+    if (out->err == SUCCESS && out->buffer.size >= CSV_WRITE_BUFFER) {
+        if (fwrite(out->buffer.data, 1, out->buffer.size, out->file.fp) != out->buffer.size) {
+            out->err = ERROR_FILE_WRITE_FAILED;
+        }
+        out->buffer.size = 0;
+    }
+    return (out->err == SUCCESS) ? TRUE : FALSE;
+}
+
+/* 写出剩余数据并提交;err为调用方的错误,非SUCCESS时放弃临时文件 */
+ErrorCode csv_stream_commit(CsvStream *out, ErrorCode err) {
+    if (err == SUCCESS) {
+        err = out->err;
+    }
+    FILE *fp = out->file.fp;
+    if (err == SUCCESS && out->buffer.size > 0 &&
+        fwrite(out->buffer.data, 1, out->buffer.size, fp) != out->buffer.size) {
+        err = ERROR_FILE_WRITE_FAILED;
+    }
+    csv_buffer_free(&out->buffer);
+
+    if (err == SUCCESS && ferror(fp)) {
+        err = ERROR_FILE_WRITE_FAILED;
+    }
+    if (err != SUCCESS) {
+        atomic_file_abort(&out->file);
+        return err;
+    }
+    return atomic_file_commit(&out->file);
+}
@@ -0,0 +1,167 @@
+#ifndef STORAGE_IO_H
+#define STORAGE_IO_H
+
+#include "common.h"
+#include "storage.h"
+#include "csv.h"
+#include "io_backend.h"
+#include <stdio.h>
+
+/*
+ * 存储层内部共用的文件读写设施: 校验和、64位偏移、原子写文件、分块读写、
+ * v2流式写出与CSV流式写出。供storage.c以及从中拆出的同步、合并、外部排序、
+ * 列式、紧凑格式、凭证等模块使用,不是对外接口。
+ */
+
+/* 在已有校验和上继续累加一段数据(可分段计算同一块的校验和) */
+unsigned int checksum_update(unsigned int sum, const void *data, size_t size);
+
+/* 计算简单的校验和 */
+unsigned int calculate_checksum(const void *data, size_t size);
+
+/* FNV-1a 64位哈希(可分段计算,初值为FNV64_INIT) */
+#define FNV64_INIT 0xcbf29ce484222325ULL
+unsigned long long fnv64_update(unsigned long long hash, const void *data, size_t size);
+
+/* 64位文件偏移定位 */
+Bool file_seek(FILE *fp, unsigned long long offset);
+
+/* 文件总字节数,失败返回-1 */
+long long file_size(FILE *fp);
+
+/* 刷新并同步到磁盘 */
+Bool sync_file(FILE *fp);
+
+/* 原子写文件: 先写入"<目标>.tmp",落盘后再改名覆盖目标,中途失败不破坏原文件 */
+typedef struct {
+    FILE *fp;              /* 临时文件 */
+    char *temp_path;       /* 临时文件路径 */
+    const char *filename;  /* 目标文件路径 */
+} AtomicFile;
+
+ErrorCode atomic_file_open(AtomicFile *file, const char *filename, const char *mode);
+
+/* 放弃写入: 关闭并删除临时文件 */
+void atomic_file_abort(AtomicFile *file);
+
+/* 提交写入: fsync临时文件后原子改名覆盖目标 */
+ErrorCode atomic_file_commit(AtomicFile *file);
+
+/* 批量I/O的分块大小: 整块读写,绕过stdio缓冲,每块一次系统调用 */
+#define STORAGE_CHUNK_SIZE (4u << 20)
+
+/* 异步I/O队列深度: 同时在途的块数 */
+#define STORAGE_IO_DEPTH 4
+
+/* 预计写出超过此字节数时尝试O_DIRECT,绕过页缓存 */
+#define STORAGE_DIRECT_THRESHOLD (64ull << 20)
+
+/*
+ * 分块写出器: 记录先序列化进当前块,满一块即异步提交并切换到下一个槽,
+ * 序列化与最多STORAGE_IO_DEPTH块的写入重叠进行。写入使用显式偏移,从文件开头写起
+ */
+typedef struct {
+    FILE *fp;
+    IoQueue *queue;
+    size_t slot;                 /* 当前填充的槽 */
+    unsigned char *buffer;       /* 当前槽的缓冲区 */
+    size_t used;
+    unsigned long long offset;   /* 已写入的总字节数(即下一字节的文件偏移) */
+    unsigned long long flushed;  /* 当前块在文件中的起始偏移 */
+    Bool direct;                 /* 已启用O_DIRECT */
+    Bool failed;
+} ChunkWriter;
+
+ErrorCode chunk_writer_init(ChunkWriter *writer, FILE *fp);
+
+/* 预计写出大量数据时启用O_DIRECT(文件系统不支持时保持缓冲写) */
+void chunk_writer_enable_direct(ChunkWriter *writer, unsigned long long expected);
+
+void chunk_writer_put(ChunkWriter *writer, const void *data, size_t size);
+
+/* 写出剩余数据、等待全部完成并释放队列,返回是否全部写出成功 */
+Bool chunk_writer_finish(ChunkWriter *writer);
+
+/* 分块读取器: 整块读入缓冲区,再按记录拷出 */
+typedef struct {
+    FILE *fp;
+    unsigned char *buffer;
+    size_t capacity;
+    size_t pos;
+    size_t end;
+    unsigned long long offset;  /* 下一个待读字节的文件偏移 */
+} ChunkReader;
+
+/* 缓冲区取expected字节(0或超过STORAGE_CHUNK_SIZE时取STORAGE_CHUNK_SIZE) */
+ErrorCode chunk_reader_init(ChunkReader *reader, FILE *fp, size_t expected);
+
+/* 读取size字节,数据不足时返回FALSE */
+Bool chunk_reader_get(ChunkReader *reader, void *data, size_t size);
+
+/* 跳转到指定偏移,已位于该处时不产生系统调用 */
+Bool chunk_reader_seek(ChunkReader *reader, unsigned long long offset);
+
+void chunk_reader_free(ChunkReader *reader);
+
+/* v2段目录(写出时累积) */
+typedef struct {
+    SectionEntry *entries;
+    size_t count;
+    size_t capacity;
+} SectionDirectory;
+
+/* 追加一个段目录项,返回其下标,失败返回(size_t)-1 */
+size_t directory_add(SectionDirectory *dir, unsigned int type, unsigned long long offset);
+
+/* 整体写出一个段并登记到目录 */
+Bool write_section(ChunkWriter *writer, SectionDirectory *dir, unsigned int type,
+                   const void *data, size_t size, unsigned long long count);
+
+/*
+ * v2流式写出器: 逐条追加记录,结束时写出段目录并回填文件头
+ * 文件头 | 记录块... | 索引段(可选) | 段目录
+ * 记录块与段各自带校验和
+ */
+typedef struct {
+    AtomicFile file;
+    ChunkWriter writer;
+    SectionDirectory dir;
+    size_t block;                    /* 当前记录块的目录项下标 */
+    unsigned long long record_count;
+    unsigned long long stamp;        /* 写入文件头的保存标记 */
+    Bool ok;                         /* 目录项分配是否都成功 */
+} V2Writer;
+
+ErrorCode v2_writer_open(V2Writer *out, const char *filename);
+
+/* 追加一条记录: 按固定记录数分块,逐块累计校验和 */
+void v2_writer_put(V2Writer *out, const Employee *emp);
+
+void v2_writer_abort(V2Writer *out);
+
+/* 写出段目录、回填文件头并提交;失败时放弃临时文件 */
+ErrorCode v2_writer_commit(V2Writer *out, int next_id);
+
+/* 生成保存标记: 时间、时钟与进程内计数混合,不为0 */
+unsigned long long next_save_stamp(void);
+
+/* CSV输出缓冲区满此字节数写出一次 */
+#define CSV_WRITE_BUFFER (1024 * 1024)
+
+/* CSV流式写出: 逐条追加记录,缓冲区满CSV_WRITE_BUFFER字节写出一次 */
+typedef struct {
+    AtomicFile file;
+    CsvBuffer buffer;
+    ErrorCode err;
+} CsvStream;
+
+/* 打开目标文件并写入CSV头 */
+ErrorCode csv_stream_open(CsvStream *out, const char *filename);
+
+/* 追加一条记录(PagedVisitor),出错后返回FALSE */
+Bool csv_stream_put(void *ctx, const Employee *emp);
+
+/* 写出剩余数据并提交;err为调用方的错误,非SUCCESS时放弃临时文件 */
+ErrorCode csv_stream_commit(CsvStream *out, ErrorCode err);
+
+#endif /* STORAGE_IO_H */
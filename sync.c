@@ -0,0 +1,560 @@
+/* 启用64位文件偏移(须在所有系统头文件之前定义) */
+#if !defined(_WIN32) && !defined(_FILE_OFFSET_BITS)
+    #define _FILE_OFFSET_BITS 64
+#endif
+
+#include "sync.h"
+#include "storage_io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+/* 源文件扫描窗口与区间复制缓冲区的字节数 */
+#define SYNC_WINDOW_SIZE (4u << 20)
+#define SYNC_COPY_SIZE (1u << 20)
+
+/* 字面段(从源文件传输)的备份偏移标记 */
+#define SYNC_LITERAL ((unsigned long long)-1)
+#define SYNC_NO_BLOCK ((size_t)-1)
+
+/* rsync滚动校验和: a为字节和,b为按位置加权的和,各取低16位 */
+typedef struct {
+    unsigned int a;
+    unsigned int b;
+} RollingSum;
+
+static void rolling_init(RollingSum *sum, const unsigned char *data, size_t size) {
+    sum->a = 0;
+    sum->b = 0;
+    for (size_t i = 0; i < size; i++) {
+        sum->a += data[i];
+        sum->b += (unsigned int)(size - i) * data[i];
+    }
+    sum->a &= 0xFFFFu;
+    sum->b &= 0xFFFFu;
+}
+
+/* 窗口右移一字节: 移出out,移入in */
+static void rolling_roll(RollingSum *sum, unsigned char out, unsigned char in, size_t size) {
+    sum->a = (sum->a - out + in) & 0xFFFFu;
+    sum->b = (sum->b - (unsigned int)size * out + sum->a) & 0xFFFFu;
+}
+
+static unsigned int rolling_value(const RollingSum *sum) {
+    return sum->a | (sum->b << 16);
+}
+
+/* 备份的块签名 */
+typedef struct {
+    unsigned int weak;          /* 滚动校验和 */
+    unsigned long long strong;  /* 强哈希 */
+    unsigned long long offset;  /* 块在备份中的偏移 */
+    size_t next;                /* 同一哈希桶中的下一块 */
+} SyncBlock;
+
+typedef struct {
+    SyncBlock *blocks;
+    size_t count;
+    size_t *buckets;            /* 滚动校验和 -> 块链表头 */
+    size_t bucket_count;        /* 2的幂 */
+    unsigned long long tail_offset;  /* 不足一块的尾部: 只与源文件的尾部比较 */
+    size_t tail_length;
+    unsigned long long tail_strong;
+} SyncSignature;
+
+static size_t sync_bucket(const SyncSignature *sig, unsigned int weak) {
+    return (size_t)((weak * 2654435761u) ^ (weak >> 16)) & (sig->bucket_count - 1);
+}
+
+static void sync_signature_free(SyncSignature *sig) {
+    free(sig->blocks);
+    free(sig->buckets);
+    sig->blocks = NULL;
+    sig->buckets = NULL;
+    sig->count = 0;
+}
+
+/* 计算备份中每个完整块的签名,以及不足一块的尾部的强哈希 */
+static ErrorCode sync_build_signature(FILE *fp, SyncSignature *sig) {
+    long long total = file_size(fp);
+    if (total < 0) {
+        return ERROR_FILE_READ_FAILED;
+    }
+    size_t capacity = (size_t)((unsigned long long)total / SYNC_BLOCK_SIZE);
+    sig->bucket_count = 16;
+    while (sig->bucket_count < capacity * 2) {
+        sig->bucket_count *= 2;
+    }
+    sig->blocks = (SyncBlock *)malloc((capacity + 1) * sizeof(SyncBlock));
+    sig->buckets = (size_t *)malloc(sig->bucket_count * sizeof(size_t));
+    unsigned char *buffer = (unsigned char *)malloc(SYNC_WINDOW_SIZE);
+    if (sig->blocks == NULL || sig->buckets == NULL || buffer == NULL) {
+        free(buffer);
+        sync_signature_free(sig);
+        return ERROR_OUT_OF_MEMORY;
+    }
+    for (size_t i = 0; i < sig->bucket_count; i++) {
+        sig->buckets[i] = SYNC_NO_BLOCK;
+    }
+    
+    /* 窗口大小是块大小的整数倍,逐窗口读入后按块计算 */
+    unsigned long long offset = 0;
+    for (;;) {
+        size_t n = fread(buffer, 1, SYNC_WINDOW_SIZE, fp);
+        size_t pos = 0;
+        for (; pos + SYNC_BLOCK_SIZE <= n && sig->count < capacity; pos += SYNC_BLOCK_SIZE) {
+            SyncBlock *block = &sig->blocks[sig->count];
+            RollingSum sum;
+            rolling_init(&sum, buffer + pos, SYNC_BLOCK_SIZE);
+            block->weak = rolling_value(&sum);
+            block->strong = fnv64_update(FNV64_INIT, buffer + pos, SYNC_BLOCK_SIZE);
+            block->offset = offset + pos;
+            size_t bucket = sync_bucket(sig, block->weak);
+            block->next = sig->buckets[bucket];
+            sig->buckets[bucket] = sig->count++;
+        }
+        if (n < SYNC_WINDOW_SIZE) {
+            sig->tail_offset = offset + pos;
+            sig->tail_length = n - pos;
+            sig->tail_strong = fnv64_update(FNV64_INIT, buffer + pos, n - pos);
+            break;
+        }
+        offset += n;
+    }
+    free(buffer);
+    if (ferror(fp)) {
+        sync_signature_free(sig);
+        return ERROR_FILE_READ_FAILED;
+    }
+    return SUCCESS;
+}
+
+/* 查找与data处一整块相同的备份块,优先选择偏移与position相同的块 */
+static const SyncBlock *sync_find(const SyncSignature *sig, unsigned int weak,
+                                  const unsigned char *data, unsigned long long position) {
+    const SyncBlock *found = NULL;
+    Bool hashed = FALSE;
+    unsigned long long strong = 0;
+    for (size_t i = sig->buckets[sync_bucket(sig, weak)]; i != SYNC_NO_BLOCK; i = sig->blocks[i].next) {
+        const SyncBlock *block = &sig->blocks[i];
+        if (block->weak != weak) {
+            continue;
+        }
+        /* 滚动校验和相同时才计算强哈希 */
+        if (!hashed) {
+            strong = fnv64_update(FNV64_INIT, data, SYNC_BLOCK_SIZE);
+            hashed = TRUE;
+        }
+        if (block->strong == strong) {
+            if (block->offset == position) {
+                return block;
+            }
+            if (found == NULL) {
+                found = block;
+            }
+        }
+    }
+    return found;
+}
+
+/* 差异: 按源文件顺序排列的匹配段与字面段 */
+typedef struct {
+    unsigned long long source_offset;
+    unsigned long long replica_offset;  /* 匹配段在备份中的偏移,字面段为SYNC_LITERAL */
+    unsigned long long length;
+} SyncOp;
+
+typedef struct {
+    SyncOp *ops;
+    size_t count;
+    size_t capacity;
+} SyncDelta;
+
+/* 追加一段,与前一段首尾相接时合并 */
+static Bool sync_delta_add(SyncDelta *delta, unsigned long long source_offset,
+                           unsigned long long replica_offset, unsigned long long length) {
+    if (delta->count > 0) {
+        SyncOp *last = &delta->ops[delta->count - 1];
+        Bool literal = (replica_offset == SYNC_LITERAL) ? TRUE : FALSE;
+        if (last->source_offset + last->length == source_offset &&
+            (literal ? last->replica_offset == SYNC_LITERAL
+                     : (last->replica_offset != SYNC_LITERAL &&
+                        last->replica_offset + last->length == replica_offset))) {
+            last->length += length;
+            return TRUE;
+        }
+    }
+    if (delta->count == delta->capacity) {
+        size_t capacity = (delta->capacity == 0) ? 64 : delta->capacity * 2;
+        SyncOp *ops = (SyncOp *)realloc(delta->ops, capacity * sizeof(SyncOp));
+        if (ops == NULL) {
+            return FALSE;
+        }
+        delta->ops = ops;
+        delta->capacity = capacity;
+    }
+    SyncOp *op = &delta->ops[delta->count++];
+    op->source_offset = source_offset;
+    op->replica_offset = replica_offset;
+    op->length = length;
+    return TRUE;
+}
+
+/*
+ * 扫描源文件生成差异: 窗口内有一整块时查找匹配,命中则跳过整块,否则记一个字面字节
+ * 并把滚动校验和右移一字节。同时计算整个源文件的哈希与字节数
+ */
+static ErrorCode sync_scan_source(FILE *fp, const SyncSignature *sig, SyncDelta *delta,
+                                  unsigned long long *digest, unsigned long long *size) {
+    unsigned char *buffer = (unsigned char *)malloc(SYNC_WINDOW_SIZE);
+    if (buffer == NULL) {
+        return ERROR_OUT_OF_MEMORY;
+    }
+    
+    unsigned long long base = 0;   /* buffer[0]在源文件中的偏移 */
+    unsigned long long hash = FNV64_INIT;
+    size_t pos = 0;
+    size_t end = 0;
+    Bool eof = FALSE;
+    Bool rolling = FALSE;
+    RollingSum sum;
+    ErrorCode err = SUCCESS;
+    for (;;) {
+        /* 窗口不足一块时把剩余部分移到开头并继续读入 */
+        if (end - pos < SYNC_BLOCK_SIZE && !eof) {
+            memmove(buffer, buffer + pos, end - pos);
+            base += pos;
+            end -= pos;
+            pos = 0;
+            size_t n = fread(buffer + end, 1, SYNC_WINDOW_SIZE - end, fp);
+            if (ferror(fp)) {
+                err = ERROR_FILE_READ_FAILED;
+                break;
+            }
+            hash = fnv64_update(hash, buffer + end, n);
+            eof = (n < SYNC_WINDOW_SIZE - end) ? TRUE : FALSE;
+            end += n;
+        }
+        
+        if (end - pos < SYNC_BLOCK_SIZE || sig->count == 0) {
+            /* 源文件的尾部与备份的尾部相同时也算匹配 */
+            Bool tail = (eof && end - pos < SYNC_BLOCK_SIZE && sig->tail_length > 0 &&
+                         end - pos == sig->tail_length &&
+                         fnv64_update(FNV64_INIT, buffer + pos, end - pos) == sig->tail_strong)
+                            ? TRUE : FALSE;
+            if (end > pos && !sync_delta_add(delta, base + pos, tail ? sig->tail_offset : SYNC_LITERAL,
+                                             end - pos)) {
+                err = ERROR_OUT_OF_MEMORY;
+                break;
+            }
+            pos = end;
+            rolling = FALSE;
+            if (eof) {
+                break;
+            }
+            continue;
+        }
+        
+        if (!rolling) {
+            rolling_init(&sum, buffer + pos, SYNC_BLOCK_SIZE);
+            rolling = TRUE;
+        }
+        const SyncBlock *match = sync_find(sig, rolling_value(&sum), buffer + pos, base + pos);
+        Bool ok;
+        if (match != NULL) {
+            ok = sync_delta_add(delta, base + pos, match->offset, SYNC_BLOCK_SIZE);
+            pos += SYNC_BLOCK_SIZE;
+            rolling = FALSE;
+        } else {
+            ok = sync_delta_add(delta, base + pos, SYNC_LITERAL, 1);
+            unsigned char out = buffer[pos++];
+            if (end - pos >= SYNC_BLOCK_SIZE) {
+                rolling_roll(&sum, out, buffer[pos + SYNC_BLOCK_SIZE - 1], SYNC_BLOCK_SIZE);
+            } else {
+                rolling = FALSE;  /* 读入后续数据后重新计算 */
+            }
+        }
+        if (!ok) {
+            err = ERROR_OUT_OF_MEMORY;
+            break;
+        }
+    }
+    
+    free(buffer);
+    *digest = hash;
+    *size = base + end;
+    return err;
+}
+
+/* 计算整个文件的哈希 */
+static ErrorCode sync_file_digest(const char *filename, unsigned long long *digest) {
+    FILE *fp = fopen(filename, "rb");
+    unsigned char *buffer = (unsigned char *)malloc(SYNC_COPY_SIZE);
+    if (fp == NULL || buffer == NULL) {
+        if (fp != NULL) {
+            fclose(fp);
+        }
+        free(buffer);
+        return (fp == NULL) ? ERROR_FILE_NOT_FOUND : ERROR_OUT_OF_MEMORY;
+    }
+    unsigned long long hash = FNV64_INIT;
+    size_t n;
+    while ((n = fread(buffer, 1, SYNC_COPY_SIZE, fp)) > 0) {
+        hash = fnv64_update(hash, buffer, n);
+    }
+    ErrorCode err = ferror(fp) ? ERROR_FILE_READ_FAILED : SUCCESS;
+    fclose(fp);
+    free(buffer);
+    *digest = hash;
+    return err;
+}
+
+static Bool file_truncate(FILE *fp, unsigned long long size) {
+#if defined(_WIN32)
+    return (_chsize_s(_fileno(fp), (__int64)size) == 0) ? TRUE : FALSE;
+#else
+    return (ftruncate(fileno(fp), (off_t)size) == 0) ? TRUE : FALSE;
+#endif
+}
+
+/* 需要写入备份的段: 字面段与移动了位置的匹配段 */
+static Bool sync_op_writes(const SyncOp *op) {
+    return (op->replica_offset != op->source_offset) ? TRUE : FALSE;
+}
+
+/*
+ * 能否就地更新: 移动位置的匹配段要从备份中读取,其来源区间不能被任何写入覆盖
+ * (差异按源文件偏移有序且互不重叠,用二分查找检查)
+ */
+static Bool sync_in_place_safe(const SyncDelta *delta) {
+    size_t *writes = (size_t *)malloc((delta->count + 1) * sizeof(size_t));
+    if (writes == NULL) {
+        return FALSE;
+    }
+    size_t write_count = 0;
+    for (size_t i = 0; i < delta->count; i++) {
+        if (sync_op_writes(&delta->ops[i])) {
+            writes[write_count++] = i;
+        }
+    }
+    
+    Bool safe = TRUE;
+    for (size_t i = 0; i < delta->count && safe; i++) {
+        const SyncOp *op = &delta->ops[i];
+        if (op->replica_offset == SYNC_LITERAL || !sync_op_writes(op)) {
+            continue;
+        }
+        /* 找第一个结束位置超过来源起点的写入段,检查是否与来源区间相交 */
+        size_t lo = 0;
+        size_t hi = write_count;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            const SyncOp *w = &delta->ops[writes[mid]];
+            if (w->source_offset + w->length <= op->replica_offset) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo < write_count && delta->ops[writes[lo]].source_offset < op->replica_offset + op->length) {
+            safe = FALSE;
+        }
+    }
+    free(writes);
+    return safe;
+}
+
+/*
+ * 就地更新: 字面段从源文件、移动的匹配段从备份自身复制到源文件中的偏移,
+ * 原位置的匹配段不动,最后截断到源文件长度
+ */
+static ErrorCode sync_apply_in_place(FILE *src, const char *replica, const SyncDelta *delta,
+                                     unsigned long long size, SyncStats *stats) {
+    FILE *dst = fopen(replica, "r+b");
+    unsigned char *buffer = (unsigned char *)malloc(SYNC_COPY_SIZE);
+    if (dst == NULL || buffer == NULL) {
+        if (dst != NULL) {
+            fclose(dst);
+        }
+        free(buffer);
+        return (dst == NULL) ? ERROR_FILE_WRITE_FAILED : ERROR_OUT_OF_MEMORY;
+    }
+    
+    ErrorCode err = SUCCESS;
+    for (size_t i = 0; i < delta->count && err == SUCCESS; i++) {
+        const SyncOp *op = &delta->ops[i];
+        Bool literal = (op->replica_offset == SYNC_LITERAL) ? TRUE : FALSE;
+        FILE *from = literal ? src : dst;
+        unsigned long long offset = literal ? op->source_offset : op->replica_offset;
+        for (unsigned long long done = 0; sync_op_writes(op) && done < op->length && err == SUCCESS; ) {
+            size_t n = (op->length - done < SYNC_COPY_SIZE) ? (size_t)(op->length - done) : SYNC_COPY_SIZE;
+            size_t bytes = 0;
+            err = io_read_at(fileno(from), buffer, n, offset + done, &bytes);
+            if (err == SUCCESS && bytes != n) {
+                err = ERROR_FILE_READ_FAILED;
+            }
+            if (err == SUCCESS) {
+                err = io_write_at(fileno(dst), buffer, n, op->source_offset + done);
+            }
+            done += n;
+            stats->written_bytes += n;
+        }
+    }
+    if (err == SUCCESS && (!file_truncate(dst, size) || !sync_file(dst))) {
+        err = ERROR_FILE_WRITE_FAILED;
+    }
+    if (fclose(dst) != 0 && err == SUCCESS) {
+        err = ERROR_FILE_WRITE_FAILED;
+    }
+    free(buffer);
+    return err;
+}
+
+/*
+ * 重组备份: 按差异依次从旧备份(匹配段)或源文件(字面段)复制到"<备份>.tmp",
+ * 写出内容的哈希与源文件一致才改名替换,否则返回ERROR_DATA_CORRUPTION。
+ * *old在提交前关闭(可为NULL,此时差异只能含字面段)
+ */
+static ErrorCode sync_apply_rebuild(FILE *src, FILE **old, const char *replica, const SyncDelta *delta,
+                                    unsigned long long digest, SyncStats *stats) {
+    AtomicFile file;
+    ErrorCode err = atomic_file_open(&file, replica, "wb");
+    if (err != SUCCESS) {
+        return err;
+    }
+    unsigned char *buffer = (unsigned char *)malloc(SYNC_COPY_SIZE);
+    if (buffer == NULL) {
+        atomic_file_abort(&file);
+        return ERROR_OUT_OF_MEMORY;
+    }
+    
+    unsigned long long hash = FNV64_INIT;
+    for (size_t i = 0; i < delta->count && err == SUCCESS; i++) {
+        const SyncOp *op = &delta->ops[i];
+        Bool literal = (op->replica_offset == SYNC_LITERAL) ? TRUE : FALSE;
+        FILE *from = literal ? src : *old;
+        unsigned long long offset = literal ? op->source_offset : op->replica_offset;
+        if (from == NULL) {
+            err = ERROR_INVALID_PARAMETER;
+            break;
+        }
+        for (unsigned long long done = 0; done < op->length && err == SUCCESS; ) {
+            size_t n = (op->length - done < SYNC_COPY_SIZE) ? (size_t)(op->length - done) : SYNC_COPY_SIZE;
+            size_t bytes = 0;
+            err = io_read_at(fileno(from), buffer, n, offset + done, &bytes);
+            if (err == SUCCESS && bytes != n) {
+                err = ERROR_FILE_READ_FAILED;
+            }
+            if (err == SUCCESS && fwrite(buffer, 1, n, file.fp) != n) {
+                err = ERROR_FILE_WRITE_FAILED;
+            }
+            hash = fnv64_update(hash, buffer, n);
+            done += n;
+            stats->written_bytes += n;
+        }
+    }
+    free(buffer);
+    if (*old != NULL) {
+        fclose(*old);
+        *old = NULL;
+    }
+    
+    if (err == SUCCESS && hash != digest) {
+        err = ERROR_DATA_CORRUPTION;
+    }
+    if (err != SUCCESS) {
+        atomic_file_abort(&file);
+        return err;
+    }
+    return atomic_file_commit(&file);
+}
+
+ErrorCode storage_sync_file(const char *source, const char *replica, SyncStats *stats) {
+    SyncStats local;
+    if (stats == NULL) {
+        stats = &local;
+    }
+    memset(stats, 0, sizeof(SyncStats));
+    if (source == NULL || replica == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    
+    FILE *src = fopen(source, "rb");
+    if (src == NULL) {
+        return ERROR_FILE_NOT_FOUND;
+    }
+    FILE *old = fopen(replica, "rb");
+    SyncSignature sig;
+    memset(&sig, 0, sizeof(SyncSignature));
+    SyncDelta delta;
+    memset(&delta, 0, sizeof(SyncDelta));
+    
+    /* 备份的块签名,再在源文件上滚动匹配 */
+    ErrorCode err = (old != NULL) ? sync_build_signature(old, &sig) : SUCCESS;
+    unsigned long long digest = 0;
+    unsigned long long size = 0;
+    if (err == SUCCESS) {
+        err = sync_scan_source(src, &sig, &delta, &digest, &size);
+    }
+    sync_signature_free(&sig);
+    
+    stats->source_bytes = size;
+    for (size_t i = 0; i < delta.count; i++) {
+        if (delta.ops[i].replica_offset == SYNC_LITERAL) {
+            stats->literal_bytes += delta.ops[i].length;
+        } else {
+            stats->matched_bytes += delta.ops[i].length;
+        }
+    }
+    Bool in_place = (err == SUCCESS && old != NULL && sync_in_place_safe(&delta)) ? TRUE : FALSE;
+    
+    Bool verified = FALSE;
+    if (err == SUCCESS && in_place) {
+        fclose(old);
+        old = NULL;
+        stats->in_place = TRUE;
+        err = sync_apply_in_place(src, replica, &delta, size, stats);
+        unsigned long long result = 0;
+        if (err == SUCCESS && (err = sync_file_digest(replica, &result)) == SUCCESS) {
+            verified = (result == digest) ? TRUE : FALSE;
+        }
+    } else if (err == SUCCESS && old != NULL) {
+        err = sync_apply_rebuild(src, &old, replica, &delta, digest, stats);
+        verified = (err == SUCCESS) ? TRUE : FALSE;
+        if (err == ERROR_DATA_CORRUPTION) {
+            err = SUCCESS;
+        }
+    }
+    
+    /* 备份不存在或结果校验不符(强哈希碰撞等): 完整复制 */
+    if (err == SUCCESS && !verified) {
+        SyncOp all;
+        all.source_offset = 0;
+        all.replica_offset = SYNC_LITERAL;
+        all.length = size;
+        SyncDelta copy;
+        copy.ops = &all;
+        copy.count = (size > 0) ? 1 : 0;
+        copy.capacity = 1;
+        if (old != NULL) {
+            fclose(old);
+            old = NULL;
+        }
+        stats->in_place = FALSE;
+        stats->full_copy = TRUE;
+        err = sync_apply_rebuild(src, &old, replica, &copy, digest, stats);
+    }
+    
+    if (old != NULL) {
+        fclose(old);
+    }
+    fclose(src);
+    free(delta.ops);
+    return err;
+}
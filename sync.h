@@ -0,0 +1,27 @@
+#ifndef SYNC_H
+#define SYNC_H
+
+#include "common.h"
+
+/* 增量同步的块大小(字节) */
+#define SYNC_BLOCK_SIZE 4096
+
+/* 增量同步统计 */
+typedef struct {
+    unsigned long long source_bytes;   /* 源文件字节数 */
+    unsigned long long matched_bytes;  /* 与备份中已有块相同、无需传输的字节数 */
+    unsigned long long literal_bytes;  /* 需要从源文件传输的字节数 */
+    unsigned long long written_bytes;  /* 实际写入备份的字节数 */
+    Bool in_place;                     /* 就地更新,只改写了差异部分 */
+    Bool full_copy;                    /* 备份不存在或校验不符,完整复制 */
+} SyncStats;
+
+/*
+ * rsync式增量同步: 按SYNC_BLOCK_SIZE字节分块计算备份的滚动校验和与强哈希,在源文件上
+ * 逐字节滚动查找相同的块,只传输不匹配的部分。移动位置的块的来源不会被覆盖时就地改写
+ * 备份的差异区间,否则经"<备份>.tmp"重组后改名替换;结果与源文件的整体哈希比对,不符时完整复制。
+ * 备份不存在时直接复制;stats可为NULL,不为NULL时在任何返回路径上都已填写(失败时为已完成部分)
+ */
+ErrorCode storage_sync_file(const char *source, const char *replica, SyncStats *stats);
+
+#endif /* SYNC_H */
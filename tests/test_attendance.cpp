@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+extern "C" {
+    #include "../attendance.h"
+    #include "../storage.h"
+}
+
+class AttendanceTest : public ::testing::Test {
+protected:
+    AttendanceBook *book;
+
+    void SetUp() override {
+        book = attendance_book_create();
+        ASSERT_NE(book, nullptr);
+    }
+
+    void TearDown() override {
+        attendance_book_free(book);
+    }
+};
+
+// 测试日期解析
+TEST(AttendanceDateTest, ParseDate) {
+    int y, m, d;
+    EXPECT_TRUE(attendance_parse_date("2024-02-29", &y, &m, &d));
+    EXPECT_EQ(y, 2024);
+    EXPECT_EQ(m, 2);
+    EXPECT_EQ(d, 29);
+
+    EXPECT_FALSE(attendance_parse_date("2023-02-29", &y, &m, &d));
+    EXPECT_FALSE(attendance_parse_date("2024-13-01", &y, &m, &d));
+    EXPECT_FALSE(attendance_parse_date("2024-1-01", &y, &m, &d));
+    EXPECT_FALSE(attendance_parse_date("2024-01-01x", &y, &m, &d));
+    EXPECT_FALSE(attendance_parse_date(nullptr, &y, &m, &d));
+}
+
+// 测试年内天数计算
+TEST(AttendanceDateTest, DayOfYear) {
+    EXPECT_EQ(attendance_day_of_year(2024, 1, 1), 0);
+    EXPECT_EQ(attendance_day_of_year(2024, 3, 1), 60);
+    EXPECT_EQ(attendance_day_of_year(2023, 3, 1), 59);
+    EXPECT_EQ(attendance_day_of_year(2024, 12, 31), 365);
+}
+
+// 测试标记与查询
+TEST_F(AttendanceTest, MarkAndQuery) {
+    EXPECT_EQ(attendance_mark(book, 1001, "2024-03-15"), SUCCESS);
+    EXPECT_TRUE(attendance_is_present(book, 1001, "2024-03-15"));
+    EXPECT_FALSE(attendance_is_present(book, 1001, "2024-03-16"));
+    EXPECT_FALSE(attendance_is_present(book, 1002, "2024-03-15"));
+
+    EXPECT_EQ(attendance_clear(book, 1001, "2024-03-15"), SUCCESS);
+    EXPECT_FALSE(attendance_is_present(book, 1001, "2024-03-15"));
+
+    EXPECT_EQ(attendance_mark(book, 1001, "2024-02-30"), ERROR_INVALID_PARAMETER);
+    EXPECT_EQ(attendance_mark(nullptr, 1001, "2024-03-15"), ERROR_NULL_POINTER);
+}
+
+// 测试月/年统计
+TEST_F(AttendanceTest, MonthAndYearTotals) {
+    char date[16];
+    for (int d = 1; d <= 29; d++) {
+        snprintf(date, sizeof(date), "2024-02-%02d", d);
+        ASSERT_EQ(attendance_mark(book, 1001, date), SUCCESS);
+    }
+    attendance_mark(book, 1001, "2024-12-31");
+    attendance_mark(book, 1002, "2024-02-10");
+
+    EXPECT_EQ(attendance_month_days(book, 1001, 2024, 2), 29);
+    EXPECT_EQ(attendance_month_days(book, 1001, 2024, 3), 0);
+    EXPECT_EQ(attendance_month_days(book, 1001, 2024, 12), 1);
+    EXPECT_EQ(attendance_year_days(book, 1001, 2024), 30);
+    EXPECT_EQ(attendance_year_days(book, 1001, 2023), 0);
+
+    EXPECT_EQ(attendance_total_month(book, 2024, 2), 30);
+    EXPECT_EQ(attendance_total_year(book, 2024), 31);
+}
+
+// 测试最长连续出勤(跨64位字边界)
+TEST_F(AttendanceTest, LongestStreak) {
+    char date[16];
+    for (int d = 1; d <= 31; d++) {
+        snprintf(date, sizeof(date), "2023-03-%02d", d);
+        attendance_mark(book, 1001, date);
+    }
+    attendance_mark(book, 1001, "2023-01-02");
+    attendance_mark(book, 1001, "2023-01-03");
+
+    EXPECT_EQ(attendance_longest_streak(book, 1001, 2023), 31);
+    EXPECT_EQ(attendance_longest_streak(book, 1002, 2023), 0);
+}
+
+// 测试共同出勤与某日出勤名单
+TEST_F(AttendanceTest, CommonDaysAndPresentOn) {
+    attendance_mark(book, 1001, "2024-05-01");
+    attendance_mark(book, 1001, "2024-05-02");
+    attendance_mark(book, 1002, "2024-05-02");
+    attendance_mark(book, 1002, "2024-05-03");
+    attendance_mark(book, 1003, "2024-05-02");
+
+    int ids[] = {1001, 1002, 1003};
+    EXPECT_EQ(attendance_common_days(book, ids, 2, 2024), 1);
+    EXPECT_EQ(attendance_common_days(book, ids, 3, 2024), 1);
+
+    size_t count = 0;
+    int *present = attendance_present_on(book, "2024-05-02", &count);
+    ASSERT_NE(present, nullptr);
+    EXPECT_EQ(count, 3u);
+    free(present);
+
+    present = attendance_present_on(book, "2024-05-03", &count);
+    ASSERT_NE(present, nullptr);
+    ASSERT_EQ(count, 1u);
+    EXPECT_EQ(present[0], 1002);
+    free(present);
+}
+
+// 测试大量记录时哈希索引扩容
+TEST_F(AttendanceTest, ManyEmployees) {
+    for (int id = 1; id <= 5000; id++) {
+        ASSERT_EQ(attendance_mark(book, id, "2024-07-01"), SUCCESS);
+    }
+    EXPECT_EQ(book->count, 5000u);
+    EXPECT_EQ(attendance_total_year(book, 2024), 5000);
+    EXPECT_TRUE(attendance_is_present(book, 4321, "2024-07-01"));
+}
+
+// 测试保存与加载
+TEST_F(AttendanceTest, SaveAndLoad) {
+    const char *filename = "test_attendance.dat";
+    attendance_mark(book, 1001, "2024-01-01");
+    attendance_mark(book, 1001, "2024-12-31");
+    attendance_mark(book, 1002, "2023-06-15");
+
+    ASSERT_EQ(storage_save_attendance(filename, book), SUCCESS);
+
+    AttendanceBook *loaded = attendance_book_create();
+    ASSERT_EQ(storage_load_attendance(filename, loaded), SUCCESS);
+    EXPECT_EQ(loaded->count, 2u);
+    EXPECT_TRUE(attendance_is_present(loaded, 1001, "2024-12-31"));
+    EXPECT_TRUE(attendance_is_present(loaded, 1002, "2023-06-15"));
+    EXPECT_EQ(attendance_year_days(loaded, 1001, 2024), 2);
+    attendance_book_free(loaded);
+
+    remove(filename);
+}
@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+extern "C" {
+    #include "../cli.h"
+    #include "../storage.h"
+    #include "../compact_file.h"
+}
+
+static const char *TEST_CLI_DB = "test_cli.db";
+static const char *TEST_CLI_CSV = "test_cli.csv";
+static const char *TEST_CLI_OUT = "test_cli_out.csv";
+static const char *TEST_CLI_REPLICA = "test_cli_replica.db";
+static const char *TEST_CLI_SCRIPT = "test_cli_script.txt";
+
+class CliTest : public ::testing::Test {
+protected:
+    std::string out_text;
+    std::string err_text;
+
+    void SetUp() override {
+        remove_files();
+    }
+
+    void TearDown() override {
+        remove_files();
+    }
+
+    void remove_files() {
+        std::remove(TEST_CLI_DB);
+        std::remove(TEST_CLI_CSV);
+        std::remove(TEST_CLI_OUT);
+        std::remove(TEST_CLI_REPLICA);
+        std::remove(TEST_CLI_SCRIPT);
+    }
+
+    static std::string read_stream(FILE *fp) {
+        std::string text;
+        std::rewind(fp);
+        char buffer[4096];
+        size_t n;
+        while ((n = std::fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+            text.append(buffer, n);
+        }
+        std::fclose(fp);
+        return text;
+    }
+
+    // 执行子命令,输出保存在out_text/err_text
+    int run(std::vector<std::string> args) {
+        std::vector<char *> argv;
+        for (auto &arg : args) {
+            argv.push_back(&arg[0]);
+        }
+        FILE *out = std::tmpfile();
+        FILE *err = std::tmpfile();
+        int code = cli_run((int)argv.size(), argv.data(), out, err);
+        out_text = read_stream(out);
+        err_text = read_stream(err);
+        return code;
+    }
+
+    void write_csv(const char *text) {
+        FILE *fp = std::fopen(TEST_CLI_CSV, "w");
+        ASSERT_NE(fp, nullptr);
+        std::fputs(text, fp);
+        std::fclose(fp);
+    }
+};
+
+// 测试错误码与退出码的对应
+TEST_F(CliTest, ExitCodes) {
+    EXPECT_EQ(cli_exit_code(SUCCESS), 0);
+    EXPECT_EQ(cli_exit_code(ERROR_FILE_NOT_FOUND), 5);
+    EXPECT_EQ(cli_exit_code(ERROR_NOT_FOUND), 11);
+    EXPECT_STREQ(cli_error_name(ERROR_DATA_CORRUPTION), "data_corruption");
+    EXPECT_TRUE(cli_is_command("query"));
+    EXPECT_FALSE(cli_is_command("menu"));
+    EXPECT_FALSE(cli_is_command(nullptr));
+}
+
+// 测试导入、查询、统计的输出格式
+TEST_F(CliTest, ImportQueryStats) {
+    write_csv("工号,姓名,部门,出勤日期,出勤天数\n"
+              "1001,张三,研发部,2024-01-15,22\n"
+              "1002,李四,市场部,2024-01-16,20\n"
+              "bad,王五,财务部,2024-01-17,21\n"
+              "1003,赵六,研发部,2024-02-01,19\n");
+    ASSERT_EQ(run({"import", "--db", TEST_CLI_DB, TEST_CLI_CSV}), 0);
+    EXPECT_EQ(out_text, "imported=3\nrejected=1\nrejected.4=invalid employee ID\nrecords=3\n");
+    EXPECT_EQ(err_text, "");
+
+    ASSERT_EQ(run({"query", "--db", TEST_CLI_DB, "--dept", "研发部"}), 0);
+    EXPECT_EQ(out_text, "工号,姓名,部门,出勤日期,出勤天数\n"
+                        "1001,张三,研发部,2024-01-15,22\n"
+                        "1003,赵六,研发部,2024-02-01,19\n");
+
+    ASSERT_EQ(run({"query", "--db", TEST_CLI_DB, "--id", "1002"}), 0);
+    EXPECT_NE(out_text.find("1002,李四,市场部"), std::string::npos);
+
+    EXPECT_EQ(run({"query", "--db", TEST_CLI_DB, "--name", "钱七"}), 11);
+    EXPECT_EQ(err_text.rfind("error=not_found code=-11 command=query", 0), 0u);
+
+    ASSERT_EQ(run({"stats", "--db", TEST_CLI_DB, "2024-01", "2024"}), 0);
+    EXPECT_EQ(out_text, "records=3\nnext_id=1004\ndays.2024-01=42\ndays.2024=61\n");
+}
+
+// 测试用法错误与文件错误的退出码
+TEST_F(CliTest, Errors) {
+    EXPECT_EQ(run({"stats", "--db", TEST_CLI_DB}), 5);
+    EXPECT_EQ(err_text.rfind("error=file_not_found code=-5 command=stats", 0), 0u);
+
+    EXPECT_EQ(run({"bogus"}), CLI_EXIT_USAGE);
+    EXPECT_EQ(run({"query", "--db", TEST_CLI_DB}), CLI_EXIT_USAGE);
+    EXPECT_EQ(run({"query", "--db", TEST_CLI_DB, "--id", "12x"}), CLI_EXIT_USAGE);
+    EXPECT_EQ(run({"query", "--db", TEST_CLI_DB, "--id", "1", "--name", "a"}), CLI_EXIT_USAGE);
+    EXPECT_EQ(run({"compact", "--db", TEST_CLI_DB, "--out", "x"}), CLI_EXIT_USAGE);
+    EXPECT_EQ(run({"compact", "--db"}), CLI_EXIT_USAGE);
+    EXPECT_EQ(run({"import", "--db", TEST_CLI_DB}), CLI_EXIT_USAGE);
+    EXPECT_EQ(run({"sort", "--db", TEST_CLI_DB, "--by", "salary"}), CLI_EXIT_USAGE);
+    EXPECT_NE(err_text.find("Usage:"), std::string::npos);
+    EXPECT_EQ(out_text, "");
+}
+
+// 测试排序、压缩、导出与同步
+TEST_F(CliTest, SortCompactExportSync) {
+    EmployeeManager *mgr = employee_manager_create();
+    employee_manager_add(mgr, "张三", "研发部", "2024-01-15", 10);
+    employee_manager_add(mgr, "李四", "市场部", "2024-01-16", 30);
+    employee_manager_add(mgr, "王五", "财务部", "2024-01-17", 20);
+    ASSERT_EQ(storage_save_employees(TEST_CLI_DB, mgr), SUCCESS);
+    employee_manager_free(mgr);
+
+    // 写出到新文件时原库不变
+    ASSERT_EQ(run({"sort", "--db", TEST_CLI_DB, "--by", "days", "--out", TEST_CLI_OUT, "--format", "csv"}), 0);
+    EXPECT_EQ(out_text, std::string("output=") + TEST_CLI_OUT + "\n");
+    FILE *fp = std::fopen(TEST_CLI_OUT, "r");
+    ASSERT_NE(fp, nullptr);
+    std::string sorted = read_stream(fp);
+    EXPECT_LT(sorted.find("李四"), sorted.find("王五"));
+    EXPECT_LT(sorted.find("王五"), sorted.find("张三"));
+
+    // 原地排序
+    ASSERT_EQ(run({"sort", "--db", TEST_CLI_DB, "--by", "days"}), 0);
+    EXPECT_EQ(out_text, "records=3\n");
+    mgr = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(TEST_CLI_DB, mgr), SUCCESS);
+    EXPECT_STREQ(((Employee *)mgr->employees->data[0])->name, "李四");
+    employee_manager_free(mgr);
+
+    ASSERT_EQ(run({"compact", "--db", TEST_CLI_DB}), 0);
+    EXPECT_EQ(out_text, "records=3\n");
+
+    ASSERT_EQ(run({"export", "--db", TEST_CLI_DB, TEST_CLI_OUT}), 0);
+    EXPECT_EQ(out_text, "exported=3\n");
+
+    // 紧凑归档可由storage_load_compact读回
+    ASSERT_EQ(run({"export", "--db", TEST_CLI_DB, "--format", "compact", TEST_CLI_OUT}), 0);
+    EXPECT_EQ(out_text, "exported=3\n");
+    mgr = employee_manager_create();
+    ASSERT_EQ(storage_load_compact(TEST_CLI_OUT, mgr), SUCCESS);
+    EXPECT_EQ(mgr->employees->size, 3u);
+    employee_manager_free(mgr);
+    EXPECT_EQ(run({"export", "--db", TEST_CLI_DB, "--format", "xml", TEST_CLI_OUT}), CLI_EXIT_USAGE);
+
+    ASSERT_EQ(run({"sync", "--db", TEST_CLI_DB, TEST_CLI_REPLICA}), 0);
+    EXPECT_NE(out_text.find("mode=full_copy\n"), std::string::npos);
+    ASSERT_EQ(run({"sync", "--db", TEST_CLI_DB, TEST_CLI_REPLICA}), 0);
+    EXPECT_NE(out_text.find("literal_bytes=0\n"), std::string::npos);
+}
+
+// 测试批处理脚本: 菜单操作按脚本执行,失败的操作计入退出码
+TEST_F(CliTest, BatchScript) {
+    FILE *fp = std::fopen(TEST_CLI_SCRIPT, "w");
+    ASSERT_NE(fp, nullptr);
+    std::fputs("1\t张三\t研发部\t2024-01-15\t22\n"
+               "1\t李四\t市场部\t2024-01-16\t20\n"
+               "9\n", fp);
+    std::fclose(fp);
+    ASSERT_EQ(run({"batch", "--db", TEST_CLI_DB, TEST_CLI_SCRIPT}), 0);
+    EXPECT_EQ(out_text, "info: Employee added successfully!\n"
+                        "info: Employee added successfully!\n"
+                        "info: Data saved successfully!\n");
+    EXPECT_EQ(err_text, "");
+
+    ASSERT_EQ(run({"query", "--db", TEST_CLI_DB, "--dept", "市场部"}), 0);
+    EXPECT_NE(out_text.find("1002,李四,市场部"), std::string::npos);
+
+    // 删除不存在的工号,脚本结束时未保存即退出
+    fp = std::fopen(TEST_CLI_SCRIPT, "w");
+    ASSERT_NE(fp, nullptr);
+    std::fputs("2\t9999\n2\t1001\n", fp);
+    std::fclose(fp);
+    EXPECT_EQ(run({"batch", "--db", TEST_CLI_DB, TEST_CLI_SCRIPT}), 4);
+    EXPECT_EQ(out_text, "error: Employee ID not found!\n"
+                        "info: Employee removed successfully!\n"
+                        "info: Exit without saving\n");
+    EXPECT_EQ(err_text.rfind("error=invalid_parameter code=-4 command=batch", 0), 0u);
+    ASSERT_EQ(run({"stats", "--db", TEST_CLI_DB}), 0);
+    EXPECT_NE(out_text.find("records=2\n"), std::string::npos);
+
+    EXPECT_EQ(run({"batch", "--db", TEST_CLI_DB, "no_such_script.txt"}), 5);
+    EXPECT_EQ(run({"batch", "--db", TEST_CLI_DB, "a", "b"}), CLI_EXIT_USAGE);
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+extern "C" {
+    #include "../columnar.h"
+    #include "../storage.h"
+    #include "../model.h"
+}
+
+const char *TEST_COLUMNAR_FILE = "test_columnar.col";
+
+class ColumnarTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::remove(TEST_COLUMNAR_FILE);
+    }
+    
+    void TearDown() override {
+        std::remove(TEST_COLUMNAR_FILE);
+    }
+};
+
+// 测试列式导出后完整加载,跨多个行组
+TEST_F(ColumnarTest, ColumnarRoundTrip) {
+    EmployeeManager *mgr = employee_manager_create();
+    const char *depts[] = {"研发部", "市场部", "人事部", "财务部"};
+    const int rows = COLUMNAR_GROUP_ROWS * 2 + 100;
+    for (int i = 0; i < rows; i++) {
+        char date[MAX_DATE_LEN];
+        snprintf(date, sizeof(date), "2024-%02d-%02d", i % 12 + 1, i % 28 + 1);
+        employee_manager_add(mgr, (i % 3) ? "张三" : "Smith, John", depts[i % 4], date, i % 31);
+    }
+    employee_manager_add(mgr, "空日期", "研发部", "", 0);
+    ASSERT_EQ(storage_export_columnar(TEST_COLUMNAR_FILE, mgr), SUCCESS);
+    
+    EmployeeManager *loaded = employee_manager_create();
+    ASSERT_EQ(storage_load_columnar(TEST_COLUMNAR_FILE, loaded), SUCCESS);
+    ASSERT_EQ(loaded->employees->size, mgr->employees->size);
+    EXPECT_EQ(loaded->next_id, mgr->next_id);
+    for (size_t i = 0; i < mgr->employees->size; i++) {
+        const Employee *a = (const Employee *)mgr->employees->data[i];
+        const Employee *b = (const Employee *)loaded->employees->data[i];
+        ASSERT_EQ(a->id, b->id);
+        ASSERT_STREQ(a->name, b->name);
+        ASSERT_STREQ(a->department, b->department);
+        ASSERT_STREQ(a->attend_date, b->attend_date);
+        ASSERT_EQ(a->attend_days, b->attend_days);
+    }
+    
+    employee_manager_free(mgr);
+    employee_manager_free(loaded);
+}
+
+// 测试按行组统计跳过无关行组,只读取需要的列
+TEST_F(ColumnarTest, ColumnarStatsSkipGroups) {
+    EmployeeManager *mgr = employee_manager_create();
+    const int rows = COLUMNAR_GROUP_ROWS * 3;
+    for (int i = 0; i < rows; i++) {
+        employee_manager_add(mgr, "员工", (i % 2) ? "研发部" : "市场部", "2024-01-15", 1);
+    }
+    ASSERT_EQ(storage_export_columnar(TEST_COLUMNAR_FILE, mgr), SUCCESS);
+    
+    ErrorCode err = SUCCESS;
+    ColumnarReader *reader = storage_columnar_open(TEST_COLUMNAR_FILE, &err);
+    ASSERT_NE(reader, nullptr);
+    EXPECT_EQ(storage_columnar_row_count(reader), (size_t)rows);
+    ASSERT_EQ(storage_columnar_group_count(reader), 3u);
+    
+    // 统计出工号落在第二组的区间,其余两组不读
+    int target_min = 1001 + COLUMNAR_GROUP_ROWS + 10;
+    int target_max = target_min + 99;
+    std::vector<int> days(COLUMNAR_GROUP_ROWS);
+    std::vector<int> ids(COLUMNAR_GROUP_ROWS);
+    size_t groups_read = 0;
+    long total = 0;
+    for (size_t g = 0; g < storage_columnar_group_count(reader); g++) {
+        int min = 0, max = 0;
+        ASSERT_EQ(storage_columnar_stats(reader, g, COLUMN_ID, &min, &max), SUCCESS);
+        if (max < target_min || min > target_max) {
+            continue;
+        }
+        groups_read++;
+        ASSERT_EQ(storage_columnar_read_ints(reader, g, COLUMN_ID, ids.data()), SUCCESS);
+        ASSERT_EQ(storage_columnar_read_ints(reader, g, COLUMN_ATTEND_DAYS, days.data()), SUCCESS);
+        for (size_t i = 0; i < storage_columnar_group_rows(reader, g); i++) {
+            if (ids[i] >= target_min && ids[i] <= target_max) {
+                total += days[i];
+            }
+        }
+    }
+    EXPECT_EQ(groups_read, 1u);
+    EXPECT_EQ(total, 100);
+    
+    // 字典列输出编码,可查回部门名;字符串列不能按整数读取
+    ASSERT_EQ(storage_columnar_read_ints(reader, 0, COLUMN_DEPARTMENT, ids.data()), SUCCESS);
+    EXPECT_STREQ(storage_columnar_department(reader, ids[0]), "市场部");
+    EXPECT_STREQ(storage_columnar_department(reader, ids[1]), "研发部");
+    EXPECT_EQ(storage_columnar_department(reader, 2), nullptr);
+    EXPECT_EQ(storage_columnar_read_ints(reader, 0, COLUMN_NAME, ids.data()), ERROR_INVALID_PARAMETER);
+    
+    storage_columnar_close(reader);
+    employee_manager_free(mgr);
+}
+
+// 测试列块被篡改时报告数据损坏
+TEST_F(ColumnarTest, ColumnarChecksumError) {
+    EmployeeManager *mgr = employee_manager_create();
+    employee_manager_add(mgr, "张三", "研发部", "2024-01-15", 22);
+    employee_manager_add(mgr, "李四", "市场部", "2024-01-16", 23);
+    ASSERT_EQ(storage_export_columnar(TEST_COLUMNAR_FILE, mgr), SUCCESS);
+    
+    // 篡改第一个行组的工号列
+    FILE *fp = fopen(TEST_COLUMNAR_FILE, "r+b");
+    ASSERT_NE(fp, nullptr);
+    fseek(fp, (long)(sizeof(ColumnarHeader) + COLUMN_COUNT * sizeof(ColumnSchema)), SEEK_SET);
+    fputc(0x7F, fp);
+    fclose(fp);
+    
+    EmployeeManager *loaded = employee_manager_create();
+    EXPECT_EQ(storage_load_columnar(TEST_COLUMNAR_FILE, loaded), ERROR_DATA_CORRUPTION);
+    EXPECT_EQ(loaded->employees->size, 0u);
+    
+    // 其他格式的文件不能按列式打开
+    ASSERT_EQ(storage_save_employees(TEST_COLUMNAR_FILE, mgr), SUCCESS);
+    ErrorCode err = SUCCESS;
+    EXPECT_EQ(storage_columnar_open(TEST_COLUMNAR_FILE, &err), nullptr);
+    EXPECT_EQ(err, ERROR_INVALID_FILE);
+    
+    employee_manager_free(mgr);
+    employee_manager_free(loaded);
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <cstring>
+extern "C" {
+    #include "../compact.h"
+}
+
+class CompactTest : public ::testing::Test {
+protected:
+    CompactTable *table;
+
+    void SetUp() override {
+        table = compact_table_create();
+        ASSERT_NE(table, nullptr);
+    }
+
+    void TearDown() override {
+        compact_table_free(table);
+    }
+};
+
+// 测试追加与访问函数还原
+TEST_F(CompactTest, AppendAndGet) {
+    Employee *emp = employee_create(1001, "张三", "研发部", "2024-01-15", 22);
+    ASSERT_NE(emp, nullptr);
+    EXPECT_EQ(compact_table_append(table, emp), SUCCESS);
+
+    EXPECT_STREQ(compact_table_name(table, 0), "张三");
+    EXPECT_STREQ(compact_table_department(table, 0), "研发部");
+    EXPECT_EQ(table->rows[0].attend_date, 20240115);
+
+    char date[MAX_DATE_LEN];
+    compact_table_date(table, 0, date);
+    EXPECT_STREQ(date, "2024-01-15");
+
+    Employee out;
+    EXPECT_EQ(compact_table_get(table, 0, &out), SUCCESS);
+    EXPECT_EQ(memcmp(&out, emp, sizeof(Employee)), 0);
+    EXPECT_EQ(compact_table_get(table, 1, &out), ERROR_INDEX_OUT_OF_BOUNDS);
+
+    employee_free(emp);
+}
+
+// 测试部门字典去重
+TEST_F(CompactTest, DepartmentDictionary) {
+    const char *depts[] = {"研发部", "市场部", "研发部", "人事部", "市场部"};
+    for (int i = 0; i < 5; i++) {
+        Employee *emp = employee_create(1001 + i, "员工", depts[i], "2024-01-01", 1);
+        ASSERT_EQ(compact_table_append(table, emp), SUCCESS);
+        employee_free(emp);
+    }
+
+    EXPECT_EQ(table->dept_count, 3u);
+    EXPECT_EQ(table->rows[0].dept_code, table->rows[2].dept_code);
+    EXPECT_EQ(table->rows[1].dept_code, table->rows[4].dept_code);
+    EXPECT_STREQ(compact_table_department(table, 3), "人事部");
+
+    unsigned short code = 0;
+    EXPECT_EQ(compact_table_intern_department(table, "市场部", &code), SUCCESS);
+    EXPECT_EQ(code, table->rows[1].dept_code);
+}
+
+// 测试非标准日期原样保留
+TEST_F(CompactTest, NonStandardDate) {
+    Employee *a = employee_create(1001, "甲", "部门", "2024-01", 1);
+    Employee *b = employee_create(1002, "乙", "部门", "", 1);
+    ASSERT_EQ(compact_table_append(table, a), SUCCESS);
+    ASSERT_EQ(compact_table_append(table, b), SUCCESS);
+
+    char date[MAX_DATE_LEN];
+    compact_table_date(table, 0, date);
+    EXPECT_STREQ(date, "2024-01");
+    EXPECT_LT(table->rows[0].attend_date, 0);
+    compact_table_date(table, 1, date);
+    EXPECT_STREQ(date, "");
+
+    employee_free(a);
+    employee_free(b);
+}
+
+// 测试内存占用明显小于定长记录
+TEST_F(CompactTest, MemoryUsage) {
+    const char *depts[] = {"研发部", "市场部", "人事部", "财务部"};
+    for (int i = 0; i < 10000; i++) {
+        Employee *emp = employee_create(1001 + i, "王小明", depts[i % 4], "2024-03-01", 20);
+        ASSERT_EQ(compact_table_append(table, emp), SUCCESS);
+        employee_free(emp);
+    }
+
+    EXPECT_EQ(table->count, 10000u);
+    EXPECT_LT(compact_table_memory_usage(table) * 4, 10000 * sizeof(Employee));
+}
+
+// 测试接管损坏的缓冲区时报告数据损坏
+TEST_F(CompactTest, AttachRejectsBadReferences) {
+    CompactEmployee *rows = (CompactEmployee *)malloc(sizeof(CompactEmployee));
+    CompactString *depts = (CompactString *)malloc(sizeof(CompactString));
+    char *arena = (char *)malloc(4);
+    memcpy(arena, "ab\0", 4);
+    depts[0].offset = 0;
+    depts[0].length = 2;
+    rows[0].id = 1;
+    rows[0].name_offset = 100;  // 越界
+    rows[0].name_length = 2;
+    rows[0].dept_code = 0;
+    rows[0].attend_date = 0;
+    rows[0].attend_days = 0;
+
+    EXPECT_EQ(compact_table_attach(table, rows, 1, arena, 4, depts, 1), ERROR_DATA_CORRUPTION);
+    EXPECT_EQ(table->count, 0u);
+}
+
+// 测试NULL参数
+TEST_F(CompactTest, NullParams) {
+    EXPECT_EQ(compact_table_append(nullptr, nullptr), ERROR_NULL_POINTER);
+    EXPECT_EQ(compact_table_append(table, nullptr), ERROR_NULL_POINTER);
+    EXPECT_EQ(compact_table_name(table, 0), nullptr);
+    compact_table_free(nullptr);  // 不应该崩溃
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+extern "C" {
+    #include "../compact_file.h"
+    #include "../storage.h"
+    #include "../model.h"
+}
+
+const char *TEST_COMPACT_DB = "test_compact.db";
+
+class CompactFileTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::remove(TEST_COMPACT_DB);
+    }
+    
+    void TearDown() override {
+        std::remove(TEST_COMPACT_DB);
+    }
+};
+
+// 测试紧凑格式保存与加载
+TEST_F(CompactFileTest, SaveAndLoadCompact) {
+    const char *compact_file = "test_employees.cdb";
+    EmployeeManager *mgr = employee_manager_create();
+    ASSERT_NE(mgr, nullptr);
+    
+    const char *depts[] = {"研发部", "市场部", "人事部"};
+    char name[32];
+    for (int i = 0; i < 1000; i++) {
+        snprintf(name, sizeof(name), "员工%d", i);
+        employee_manager_add(mgr, name, depts[i % 3], (i % 7 == 0) ? "2024-02" : "2024-02-29", i % 31);
+    }
+    
+    EXPECT_EQ(storage_save_compact(compact_file, mgr), SUCCESS);
+    EXPECT_EQ(storage_save_employees(TEST_COMPACT_DB, mgr), SUCCESS);
+    
+    // 紧凑文件体积应远小于定长格式
+    FILE *fp = fopen(compact_file, "rb");
+    ASSERT_NE(fp, nullptr);
+    fseek(fp, 0, SEEK_END);
+    long compact_size = ftell(fp);
+    fclose(fp);
+    fp = fopen(TEST_COMPACT_DB, "rb");
+    ASSERT_NE(fp, nullptr);
+    fseek(fp, 0, SEEK_END);
+    long fixed_size = ftell(fp);
+    fclose(fp);
+    EXPECT_LT(compact_size * 4, fixed_size);
+    
+    EmployeeManager *mgr2 = employee_manager_create();
+    ASSERT_NE(mgr2, nullptr);
+    EXPECT_EQ(storage_load_compact(compact_file, mgr2), SUCCESS);
+    ASSERT_EQ(mgr2->employees->size, mgr->employees->size);
+    EXPECT_EQ(mgr2->next_id, mgr->next_id);
+    for (size_t i = 0; i < mgr->employees->size; i++) {
+        EXPECT_EQ(memcmp(mgr->employees->data[i], mgr2->employees->data[i], sizeof(Employee)), 0);
+    }
+    
+    // 普通格式加载紧凑文件应失败
+    EmployeeManager *mgr3 = employee_manager_create();
+    EXPECT_EQ(storage_load_employees(compact_file, mgr3), ERROR_INVALID_FILE);
+    EXPECT_EQ(storage_load_compact(TEST_COMPACT_DB, mgr3), ERROR_INVALID_FILE);
+    
+    employee_manager_free(mgr);
+    employee_manager_free(mgr2);
+    employee_manager_free(mgr3);
+    std::remove(compact_file);
+}
+
+// 测试紧凑文件被篡改时报告数据损坏
+TEST_F(CompactFileTest, LoadCompactChecksumError) {
+    const char *compact_file = "test_employees.cdb";
+    EmployeeManager *mgr = employee_manager_create();
+    employee_manager_add(mgr, "张三", "研发部", "2024-01-15", 22);
+    ASSERT_EQ(storage_save_compact(compact_file, mgr), SUCCESS);
+    
+    FILE *fp = fopen(compact_file, "r+b");
+    ASSERT_NE(fp, nullptr);
+    fseek(fp, -2, SEEK_END);
+    fputc('X', fp);
+    fclose(fp);
+    
+    EmployeeManager *mgr2 = employee_manager_create();
+    EXPECT_EQ(storage_load_compact(compact_file, mgr2), ERROR_DATA_CORRUPTION);
+    EXPECT_EQ(mgr2->employees->size, 0u);
+    
+    employee_manager_free(mgr);
+    employee_manager_free(mgr2);
+    std::remove(compact_file);
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <cstdio>
+#include <string>
 extern "C" {
     #include "../controller.h"
 }
@@ -89,6 +90,10 @@ TEST_F(ControllerTest, SaveAndExit) {
     Controller *ctrl = controller_create(TEST_CTRL_DB, TEST_CTRL_AUTH);
     ASSERT_NE(ctrl, nullptr);
     
+    // 保存基于快照,须等加载完成、管理器切换到并发模式之后
+    EXPECT_EQ(controller_wait_load(ctrl), ERROR_FILE_NOT_FOUND);
+    EXPECT_EQ(ctrl->manager->concurrent, TRUE);
+    
     // 添加一些数据
     employee_manager_add(ctrl->manager, "张三", "研发部", "2024-01-15", 22);
     
@@ -138,3 +143,121 @@ TEST_F(ControllerTest, BasicOperationFlow) {
 }
 
 
+
+// 测试后台加载: 创建控制器时开始加载,wait_load换入加载好的管理器
+TEST_F(ControllerTest, BackgroundLoad) {
+    EmployeeManager *mgr = employee_manager_create();
+    employee_manager_add(mgr, "张三", "研发部", "2024-01-15", 22);
+    employee_manager_add(mgr, "李四", "市场部", "2024-01-16", 23);
+    employee_manager_add(mgr, "王五", "财务部", "2024-01-17", 24);
+    ASSERT_EQ(storage_save_employees(TEST_CTRL_DB, mgr), SUCCESS);
+    employee_manager_free(mgr);
+    
+    Controller *ctrl = controller_create(TEST_CTRL_DB, TEST_CTRL_AUTH);
+    ASSERT_NE(ctrl, nullptr);
+    EXPECT_EQ(controller_wait_load(ctrl), SUCCESS);
+    ASSERT_EQ(ctrl->manager->employees->size, 3u);
+    EXPECT_EQ(ctrl->manager->next_id, 1004);
+    EXPECT_STREQ(((Employee *)ctrl->manager->employees->data[1])->name, "李四");
+    
+    // 重复调用返回同一结果,不再替换管理器
+    EmployeeManager *loaded = ctrl->manager;
+    EXPECT_EQ(controller_wait_load(ctrl), SUCCESS);
+    EXPECT_EQ(ctrl->manager, loaded);
+    controller_free(ctrl);
+    
+    // 文件不存在: 保留原来的空管理器
+    std::remove(TEST_CTRL_DB);
+    ctrl = controller_create(TEST_CTRL_DB, TEST_CTRL_AUTH);
+    ASSERT_NE(ctrl, nullptr);
+    EXPECT_EQ(controller_wait_load(ctrl), ERROR_FILE_NOT_FOUND);
+    ASSERT_NE(ctrl->manager, nullptr);
+    EXPECT_EQ(ctrl->manager->employees->size, 0u);
+    EXPECT_EQ(employee_manager_add(ctrl->manager, "赵六", "人事部", "2024-01-18", 20), SUCCESS);
+    controller_free(ctrl);
+    
+    EXPECT_EQ(controller_wait_load(nullptr), ERROR_NULL_POINTER);
+}
+
+// 测试索引刷新: 首次立即提交,连续编辑期间推迟,数据稳定后只提交一次
+TEST_F(ControllerTest, RefreshIndexesDebounced) {
+    Controller *ctrl = controller_create(TEST_CTRL_DB, TEST_CTRL_AUTH);
+    ASSERT_NE(ctrl, nullptr);
+    controller_wait_load(ctrl);
+    employee_manager_add(ctrl->manager, "张三", "研发部", "2024-01-15", 22);
+    
+    controller_refresh_indexes(ctrl);
+    ASSERT_EQ(background_indexer_wait(ctrl->indexer), SUCCESS);
+    for (int kind = 0; kind < INDEX_KIND_COUNT; kind++) {
+        EXPECT_TRUE(employee_manager_index_ready(ctrl->manager, (IndexKind)kind));
+    }
+    
+    // 代数刚变化: 推迟提交
+    employee_manager_add(ctrl->manager, "李四", "市场部", "2024-01-16", 20);
+    controller_refresh_indexes(ctrl);
+    EXPECT_FALSE(background_indexer_busy(ctrl->indexer));
+    EXPECT_FALSE(employee_manager_index_ready(ctrl->manager, INDEX_KIND_PRIMARY));
+    
+    // 两次刷新之间没有新的修改: 提交重建
+    controller_refresh_indexes(ctrl);
+    ASSERT_EQ(background_indexer_wait(ctrl->indexer), SUCCESS);
+    for (int kind = 0; kind < INDEX_KIND_COUNT; kind++) {
+        EXPECT_TRUE(employee_manager_index_ready(ctrl->manager, (IndexKind)kind));
+    }
+    EXPECT_EQ(ctrl->indexed_generation, ctrl->manager->generation);
+    
+    // 索引已是最新: 不再提交
+    controller_refresh_indexes(ctrl);
+    EXPECT_FALSE(background_indexer_busy(ctrl->indexer));
+    
+    controller_refresh_indexes(nullptr);  // 不应该崩溃
+    controller_free(ctrl);
+}
+
+// 测试批处理视图驱动主循环: 脚本执行增删改查后保存退出
+TEST_F(ControllerTest, BatchScript) {
+    Controller *ctrl = controller_create(TEST_CTRL_DB, TEST_CTRL_AUTH);
+    ASSERT_NE(ctrl, nullptr);
+    controller_wait_load(ctrl);
+    
+    FILE *in = std::tmpfile();
+    FILE *out = std::tmpfile();
+    std::fputs("# 添加两名职工\n"
+               "1\t张三\t研发部\t2024-01-15\t22\n"
+               "1\t李四\t市场部\t2024-01-16\t20\n"
+               "3\t1002\t李四\t财务部\t2024-01-16\t21\n"
+               "2\t9999\n"
+               "4\t1\t1001\n"
+               "9\n", in);
+    std::rewind(in);
+    AppView *view = view_create_batch(in, out);
+    ASSERT_NE(view, nullptr);
+    controller_set_view(ctrl, view);
+    controller_run(ctrl);
+    EXPECT_FALSE(ctrl->is_running);
+    EXPECT_EQ(view_batch_errors(ctrl->view), 1u);
+    controller_free(ctrl);
+    
+    std::string text;
+    std::rewind(out);
+    char buffer[1024];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), out)) > 0) {
+        text.append(buffer, n);
+    }
+    EXPECT_EQ(text, "info: Employee added successfully!\n"
+                    "info: Employee added successfully!\n"
+                    "info: Employee updated successfully!\n"
+                    "error: Employee ID not found!\n"
+                    "1001,张三,研发部,2024-01-15,22\n"
+                    "info: Data saved successfully!\n");
+    std::fclose(in);
+    std::fclose(out);
+    
+    // 保存的数据可以重新加载
+    EmployeeManager *mgr = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(TEST_CTRL_DB, mgr), SUCCESS);
+    ASSERT_EQ(mgr->employees->size, 2u);
+    EXPECT_STREQ(((Employee *)mgr->employees->data[1])->department, "财务部");
+    employee_manager_free(mgr);
+}
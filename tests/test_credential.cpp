@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "test_helpers.h"
+extern "C" {
+    #include "../credential.h"
+}
+
+const char *TEST_CREDENTIAL_FILE = "test_credential.auth";
+
+class CredentialTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::remove(TEST_CREDENTIAL_FILE);
+    }
+    
+    void TearDown() override {
+        std::remove(TEST_CREDENTIAL_FILE);
+    }
+};
+
+// 测试storage_save_credential和storage_verify_credential
+TEST_F(CredentialTest, SaveAndVerifyCredential) {
+    const char *username = "admin";
+    const char *password = "password123";
+    
+    ErrorCode err = storage_save_credential(TEST_CREDENTIAL_FILE, username, password);
+    EXPECT_EQ(err, SUCCESS);
+    
+    // 验证正确的凭证
+    Bool result = storage_verify_credential(TEST_CREDENTIAL_FILE, username, password);
+    EXPECT_EQ(result, TRUE);
+    
+    // 验证错误的密码
+    result = storage_verify_credential(TEST_CREDENTIAL_FILE, username, "wrongpassword");
+    EXPECT_EQ(result, FALSE);
+    
+    // 验证错误的用户名
+    result = storage_verify_credential(TEST_CREDENTIAL_FILE, "wronguser", password);
+    EXPECT_EQ(result, FALSE);
+}
+
+// 测试storage_save_credential NULL参数
+TEST_F(CredentialTest, SaveCredentialNullParams) {
+    EXPECT_EQ(storage_save_credential(nullptr, "admin", "password"), ERROR_NULL_POINTER);
+    EXPECT_EQ(storage_save_credential(TEST_CREDENTIAL_FILE, nullptr, "password"), ERROR_NULL_POINTER);
+    EXPECT_EQ(storage_save_credential(TEST_CREDENTIAL_FILE, "admin", nullptr), ERROR_NULL_POINTER);
+}
+
+// 测试storage_verify_credential NULL参数
+TEST_F(CredentialTest, VerifyCredentialNullParams) {
+    EXPECT_EQ(storage_verify_credential(nullptr, "admin", "password"), FALSE);
+    EXPECT_EQ(storage_verify_credential(TEST_CREDENTIAL_FILE, nullptr, "password"), FALSE);
+    EXPECT_EQ(storage_verify_credential(TEST_CREDENTIAL_FILE, "admin", nullptr), FALSE);
+}
+
+// 测试storage_verify_credential 文件不存在
+TEST_F(CredentialTest, VerifyCredentialFileNotFound) {
+    Bool result = storage_verify_credential("nonexistent.auth", "admin", "password");
+    EXPECT_EQ(result, FALSE);
+}
+
+// 在凭证文件中查找账号所在的槽,返回槽在文件中的偏移(找不到时为-1)
+static long find_credential_slot(const char *filename, const char *username, CredentialSlot *out) {
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) {
+        return -1;
+    }
+    CredentialFileHeader header;
+    long offset = -1;
+    if (fread(&header, sizeof(header), 1, fp) == 1) {
+        CredentialSlot slot;
+        for (unsigned int i = 0; i < header.capacity && fread(&slot, sizeof(slot), 1, fp) == 1; i++) {
+            if (slot.state == CREDENTIAL_SLOT_USED && strcmp(slot.username, username) == 0) {
+                offset = (long)(sizeof(header) + i * sizeof(slot));
+                *out = slot;
+                break;
+            }
+        }
+    }
+    fclose(fp);
+    return offset;
+}
+
+// 测试槽位置属于文件格式: 探测起点为用户名的FNV-1a 64位哈希取低位
+TEST_F(CredentialTest, CredentialSlotLayoutIsStable) {
+    ErrorCode err = SUCCESS;
+    CredentialStore *store = storage_credentials_open(TEST_CREDENTIAL_FILE, &err);
+    ASSERT_NE(store, nullptr);
+    ASSERT_EQ(storage_credentials_add(store, "admin", "admin123"), SUCCESS);
+    storage_credentials_close(store);
+    
+    // FNV-1a 64("admin") = 0xe5cde7fdda328454,新文件64个槽,落在第20槽
+    CredentialSlot slot;
+    EXPECT_EQ(find_credential_slot(TEST_CREDENTIAL_FILE, "admin", &slot),
+              (long)(sizeof(CredentialFileHeader) + 20 * sizeof(CredentialSlot)));
+}
+
+// 测试多用户凭证库: 扩容、重新打开后验证、删除与复用、原位改写
+TEST_F(CredentialTest, CredentialStoreManyUsers) {
+    ErrorCode err;
+    CredentialStore *store = storage_credentials_open(TEST_CREDENTIAL_FILE, &err);
+    ASSERT_NE(store, nullptr);
+    EXPECT_EQ(storage_credentials_count(store), 0u);
+    ASSERT_EQ(storage_credentials_set_cost(store, CREDENTIAL_MIN_ITERATIONS), SUCCESS);
+    
+    const int users = 150;
+    char name[32];
+    char password[32];
+    for (int i = 0; i < users; i++) {
+        snprintf(name, sizeof(name), "operator%03d", i);
+        snprintf(password, sizeof(password), "pw-%d", i * 7);
+        ASSERT_EQ(storage_credentials_add(store, name, password), SUCCESS) << name;
+    }
+    EXPECT_EQ(storage_credentials_count(store), (size_t)users);
+    EXPECT_EQ(storage_credentials_add(store, "operator007", "again"), ERROR_INVALID_PARAMETER);
+    EXPECT_EQ(storage_credentials_add(store, "", "x"), ERROR_INVALID_PARAMETER);
+    storage_credentials_close(store);
+    
+    // 重新打开: 一次读入后在内存中验证
+    store = storage_credentials_open(TEST_CREDENTIAL_FILE, &err);
+    ASSERT_NE(store, nullptr);
+    EXPECT_EQ(storage_credentials_count(store), (size_t)users);
+    EXPECT_EQ(storage_credentials_cost(store), (unsigned int)CREDENTIAL_MIN_ITERATIONS);
+    for (int i = 0; i < users; i += 13) {
+        snprintf(name, sizeof(name), "operator%03d", i);
+        snprintf(password, sizeof(password), "pw-%d", i * 7);
+        EXPECT_TRUE(storage_credentials_verify(store, name, password)) << name;
+        EXPECT_FALSE(storage_credentials_verify(store, name, "pw-wrong"));
+    }
+    EXPECT_FALSE(storage_credentials_verify(store, "nobody", "pw-0"));
+    
+    // 删除与改口令只改写一个槽,文件大小不变
+    long long size_before = (long long)read_whole_file(TEST_CREDENTIAL_FILE).size();
+    EXPECT_EQ(storage_credentials_remove(store, "operator010"), SUCCESS);
+    EXPECT_EQ(storage_credentials_remove(store, "operator010"), ERROR_NOT_FOUND);
+    EXPECT_EQ(storage_credentials_set_password(store, "operator020", "changed"), SUCCESS);
+    EXPECT_EQ(storage_credentials_set_password(store, "nobody", "changed"), ERROR_NOT_FOUND);
+    EXPECT_EQ(storage_credentials_add(store, "operator010", "back"), SUCCESS);
+    EXPECT_EQ((long long)read_whole_file(TEST_CREDENTIAL_FILE).size(), size_before);
+    storage_credentials_close(store);
+    
+    store = storage_credentials_open(TEST_CREDENTIAL_FILE, &err);
+    ASSERT_NE(store, nullptr);
+    EXPECT_EQ(storage_credentials_count(store), (size_t)users);
+    EXPECT_TRUE(storage_credentials_verify(store, "operator010", "back"));
+    EXPECT_FALSE(storage_credentials_verify(store, "operator010", "pw-70"));
+    EXPECT_TRUE(storage_credentials_verify(store, "operator020", "changed"));
+    EXPECT_TRUE(storage_credentials_contains(store, "operator149"));
+    EXPECT_FALSE(storage_credentials_contains(store, "operator150"));
+    EXPECT_EQ(storage_credentials_set_cost(store, CREDENTIAL_MIN_ITERATIONS - 1), ERROR_INVALID_PARAMETER);
+    storage_credentials_close(store);
+    
+    // 损坏的槽按删除处理,其余账号(包括探测链上更靠后的)不受影响
+    CredentialSlot slot;
+    long offset = find_credential_slot(TEST_CREDENTIAL_FILE, "operator030", &slot);
+    ASSERT_GE(offset, 0);
+    FILE *fp = fopen(TEST_CREDENTIAL_FILE, "r+b");
+    ASSERT_NE(fp, nullptr);
+    fseek(fp, offset + (long)offsetof(CredentialSlot, hash), SEEK_SET);
+    fputc(slot.hash[0] ^ 0xFF, fp);
+    fclose(fp);
+    store = storage_credentials_open(TEST_CREDENTIAL_FILE, &err);
+    ASSERT_NE(store, nullptr);
+    EXPECT_EQ(storage_credentials_count(store), (size_t)users - 1);
+    EXPECT_FALSE(storage_credentials_verify(store, "operator030", "pw-210"));
+    for (int i = 0; i < users; i += 7) {
+        if (i == 30 || i == 10 || i == 20) {
+            continue;
+        }
+        snprintf(name, sizeof(name), "operator%03d", i);
+        EXPECT_TRUE(storage_credentials_contains(store, name)) << name;
+    }
+    storage_credentials_close(store);
+    
+    EXPECT_EQ(storage_credentials_open(nullptr, &err), nullptr);
+    EXPECT_EQ(err, ERROR_NULL_POINTER);
+    write_whole_file(TEST_CREDENTIAL_FILE, std::string(300, 'x'));
+    EXPECT_EQ(storage_credentials_open(TEST_CREDENTIAL_FILE, &err), nullptr);
+    EXPECT_EQ(err, ERROR_INVALID_FILE);
+}
+
+// 测试旧版单账号文件的迁移: 打开时转换格式,首次登录成功后升级为PBKDF2哈希
+TEST_F(CredentialTest, CredentialStoreMigratesLegacyFile) {
+    UserCredential legacy;
+    memset(&legacy, 0, sizeof(legacy));
+    strcpy(legacy.username, "admin");
+    unsigned int hash = 5381;
+    for (const char *p = "password123"; *p != '\0'; p++) {
+        hash = hash * 33 + (unsigned char)*p;
+    }
+    snprintf(legacy.password, sizeof(legacy.password), "%u", hash);
+    write_whole_file(TEST_CREDENTIAL_FILE, std::string((const char *)&legacy, sizeof(legacy)));
+    
+    ErrorCode err;
+    CredentialStore *store = storage_credentials_open(TEST_CREDENTIAL_FILE, &err);
+    ASSERT_NE(store, nullptr);
+    ASSERT_EQ(storage_credentials_set_cost(store, CREDENTIAL_MIN_ITERATIONS), SUCCESS);
+    EXPECT_EQ(storage_credentials_count(store), 1u);
+    CredentialSlot slot;
+    ASSERT_GE(find_credential_slot(TEST_CREDENTIAL_FILE, "admin", &slot), 0);
+    EXPECT_EQ(slot.iterations, 0u);
+    
+    EXPECT_FALSE(storage_credentials_verify(store, "admin", "password"));
+    EXPECT_TRUE(storage_credentials_verify(store, "admin", "password123"));
+    ASSERT_GE(find_credential_slot(TEST_CREDENTIAL_FILE, "admin", &slot), 0);
+    EXPECT_EQ(slot.iterations, (unsigned int)CREDENTIAL_MIN_ITERATIONS);
+    storage_credentials_close(store);
+    
+    // 提高代价后,下次登录成功时按新代价重新哈希
+    store = storage_credentials_open(TEST_CREDENTIAL_FILE, &err);
+    ASSERT_NE(store, nullptr);
+    ASSERT_EQ(storage_credentials_set_cost(store, CREDENTIAL_MIN_ITERATIONS * 2), SUCCESS);
+    EXPECT_TRUE(storage_credentials_verify(store, "admin", "password123"));
+    ASSERT_GE(find_credential_slot(TEST_CREDENTIAL_FILE, "admin", &slot), 0);
+    EXPECT_EQ(slot.iterations, (unsigned int)CREDENTIAL_MIN_ITERATIONS * 2);
+    EXPECT_TRUE(storage_credentials_verify(store, "admin", "password123"));
+    storage_credentials_close(store);
+    EXPECT_TRUE(storage_verify_credential(TEST_CREDENTIAL_FILE, "admin", "password123"));
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+extern "C" {
+    #include "../crypto.h"
+}
+
+static std::string to_hex(const unsigned char *data, size_t size) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    for (size_t i = 0; i < size; i++) {
+        hex.push_back(digits[data[i] >> 4]);
+        hex.push_back(digits[data[i] & 15]);
+    }
+    return hex;
+}
+
+// 测试SHA-256标准向量(FIPS 180-2)
+TEST(CryptoTest, Sha256Vectors) {
+    unsigned char digest[SHA256_DIGEST_LEN];
+    sha256("", 0, digest);
+    EXPECT_EQ(to_hex(digest, sizeof(digest)),
+              "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    sha256("abc", 3, digest);
+    EXPECT_EQ(to_hex(digest, sizeof(digest)),
+              "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    const char *two_blocks = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    sha256(two_blocks, strlen(two_blocks), digest);
+    EXPECT_EQ(to_hex(digest, sizeof(digest)),
+              "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    
+    // 分段输入与一次输入结果相同
+    std::string million(1000000, 'a');
+    Sha256 ctx;
+    sha256_init(&ctx);
+    for (size_t i = 0; i < million.size(); i += 999) {
+        sha256_update(&ctx, million.data() + i, std::min<size_t>(999, million.size() - i));
+    }
+    sha256_final(&ctx, digest);
+    EXPECT_EQ(to_hex(digest, sizeof(digest)),
+              "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+// 测试HMAC-SHA256(RFC 4231)
+TEST(CryptoTest, HmacSha256Vectors) {
+    unsigned char mac[SHA256_DIGEST_LEN];
+    unsigned char key[20];
+    memset(key, 0x0b, sizeof(key));
+    hmac_sha256(key, sizeof(key), "Hi There", 8, mac);
+    EXPECT_EQ(to_hex(mac, sizeof(mac)),
+              "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7");
+    const char *data = "what do ya want for nothing?";
+    hmac_sha256("Jefe", 4, data, strlen(data), mac);
+    EXPECT_EQ(to_hex(mac, sizeof(mac)),
+              "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+    
+    // 长于块大小的密钥先哈希
+    unsigned char long_key[131];
+    memset(long_key, 0xaa, sizeof(long_key));
+    const char *text = "Test Using Larger Than Block-Size Key - Hash Key First";
+    hmac_sha256(long_key, sizeof(long_key), text, strlen(text), mac);
+    EXPECT_EQ(to_hex(mac, sizeof(mac)),
+              "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54");
+}
+
+// 测试PBKDF2-HMAC-SHA256(RFC 7914等公开向量)
+TEST(CryptoTest, Pbkdf2Vectors) {
+    unsigned char out[40];
+    pbkdf2_sha256("password", 8, "salt", 4, 1, out, 32);
+    EXPECT_EQ(to_hex(out, 32), "120fb6cffcf8b32c43e7225256c4f837a86548c92ccc35480805987cb70be17b");
+    pbkdf2_sha256("password", 8, "salt", 4, 2, out, 32);
+    EXPECT_EQ(to_hex(out, 32), "ae4d0c95af6b46d32d0adff928f06dd02a303f8ef3c251dfd6e2d85a95474c43");
+    pbkdf2_sha256("password", 8, "salt", 4, 4096, out, 32);
+    EXPECT_EQ(to_hex(out, 32), "c5e478d59288c841aa530db6845c4c8d962893a001ce4e11a4963873aa98134a");
+    
+    // 输出跨越两个块
+    const char *password = "passwordPASSWORDpassword";
+    const char *salt = "saltSALTsaltSALTsaltSALTsaltSALTsalt";
+    pbkdf2_sha256(password, strlen(password), salt, strlen(salt), 4096, out, 40);
+    EXPECT_EQ(to_hex(out, 40),
+              "348c89dbcbd32b2f32d814b8116e84cf2b17347ebc1800181c4e2a1fb8dd53e1c635518c7dac47e9");
+}
+
+// 测试随机数与等时比较
+TEST(CryptoTest, RandomAndEqual) {
+    unsigned char a[16];
+    unsigned char b[16];
+    ASSERT_EQ(crypto_random_bytes(a, sizeof(a)), SUCCESS);
+    ASSERT_EQ(crypto_random_bytes(b, sizeof(b)), SUCCESS);
+    EXPECT_FALSE(crypto_equal(a, b, sizeof(a)));
+    memcpy(b, a, sizeof(a));
+    EXPECT_TRUE(crypto_equal(a, b, sizeof(a)));
+    b[15] ^= 1;
+    EXPECT_FALSE(crypto_equal(a, b, sizeof(a)));
+    EXPECT_EQ(crypto_random_bytes(nullptr, 4), ERROR_NULL_POINTER);
+}
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <string>
+extern "C" {
+    #include "../csv.h"
+}
+
+static Employee make_employee(int id, const char *name, const char *dept,
+                              const char *date, int days) {
+    Employee emp;
+    memset(&emp, 0, sizeof(emp));
+    emp.id = id;
+    strcpy(emp.name, name);
+    strcpy(emp.department, dept);
+    strcpy(emp.attend_date, date);
+    emp.attend_days = days;
+    return emp;
+}
+
+// 测试整数格式化与printf一致
+TEST(CsvTest, FormatInt) {
+    const int values[] = {0, 7, 10, 99, 100, 1001, 65535, -1, -42, INT_MAX, INT_MIN};
+    for (int value : values) {
+        char out[16];
+        char expected[16];
+        size_t length = csv_format_int(out, value);
+        int n = snprintf(expected, sizeof(expected), "%d", value);
+        EXPECT_EQ(std::string(out, length), std::string(expected, (size_t)n));
+    }
+}
+
+// 测试普通记录的输出与fprintf逐字节一致
+TEST(CsvTest, RowMatchesPrintf) {
+    Employee emp = make_employee(1001, "张三", "研发部", "2024-01-15", 22);
+    CsvBuffer buffer;
+    ASSERT_EQ(csv_buffer_init(&buffer, 0), SUCCESS);
+    ASSERT_EQ(csv_append_employee(&buffer, &emp), SUCCESS);
+
+    char expected[256];
+    int n = snprintf(expected, sizeof(expected), "%d,%s,%s,%s,%d\n",
+                     emp.id, emp.name, emp.department, emp.attend_date, emp.attend_days);
+    EXPECT_EQ(std::string(buffer.data, buffer.size), std::string(expected, (size_t)n));
+    csv_buffer_free(&buffer);
+}
+
+// 测试含逗号、双引号、换行的字段按RFC 4180加引号
+TEST(CsvTest, QuotesSpecialFields) {
+    Employee emp = make_employee(7, "Smith, John", "R\"D\"", "a\nb", 3);
+    CsvBuffer buffer;
+    ASSERT_EQ(csv_buffer_init(&buffer, 0), SUCCESS);
+    ASSERT_EQ(csv_append_employee(&buffer, &emp), SUCCESS);
+    EXPECT_EQ(std::string(buffer.data, buffer.size),
+              std::string("7,\"Smith, John\",\"R\"\"D\"\"\",\"a\nb\",3\n"));
+    csv_buffer_free(&buffer);
+}
+
+// 测试全部为双引号的最长字段不会越过单行上限
+TEST(CsvTest, WorstCaseRowFits) {
+    Employee emp;
+    memset(&emp, '"', sizeof(emp));
+    emp.id = INT_MIN;
+    emp.attend_days = INT_MIN;
+
+    CsvBuffer buffer;
+    ASSERT_EQ(csv_buffer_init(&buffer, 0), SUCCESS);
+    ASSERT_EQ(csv_append_employee(&buffer, &emp), SUCCESS);
+    EXPECT_LE(buffer.size, (size_t)CSV_MAX_ROW_LEN);
+    EXPECT_EQ(buffer.data[buffer.size - 1], '\n');
+    csv_buffer_free(&buffer);
+}
+
+// 测试分隔符扫描在16字节边界内外都能找到第一个特殊字符
+TEST(CsvTest, ScanSpecial) {
+    std::string text(100, 'a');
+    for (size_t pos : {0u, 5u, 15u, 16u, 17u, 31u, 64u, 99u}) {
+        for (char c : {',', '"', '\n', '\r'}) {
+            std::string s = text;
+            s[pos] = c;
+            EXPECT_EQ(csv_scan_special(s.data(), s.data() + s.size()), s.data() + pos);
+        }
+    }
+    EXPECT_EQ(csv_scan_special(text.data(), text.data() + text.size()), text.data() + text.size());
+}
+
+// 测试引号字段(含逗号、双写引号、换行)与CRLF行尾
+TEST(CsvTest, NextRecordQuoted) {
+    std::string input = "7,\"Smith, John\",\"R\"\"D\",\"a\nb\",3\r\n8,x,y,z,1";
+    const char *cursor = input.data();
+    const char *end = cursor + input.size();
+    CsvField fields[CSV_COLUMN_COUNT];
+    size_t count = 0;
+    size_t lines = 0;
+
+    ASSERT_EQ(csv_next_record(&cursor, end, TRUE, fields, CSV_COLUMN_COUNT, &count, &lines),
+              CSV_RECORD_OK);
+    ASSERT_EQ(count, 5u);
+    EXPECT_EQ(lines, 2u);
+    char out[64];
+    ASSERT_TRUE(csv_field_copy(&fields[1], out, sizeof(out)));
+    EXPECT_STREQ(out, "Smith, John");
+    ASSERT_TRUE(csv_field_copy(&fields[2], out, sizeof(out)));
+    EXPECT_STREQ(out, "R\"D");
+    ASSERT_TRUE(csv_field_copy(&fields[3], out, sizeof(out)));
+    EXPECT_STREQ(out, "a\nb");
+
+    ASSERT_EQ(csv_next_record(&cursor, end, TRUE, fields, CSV_COLUMN_COUNT, &count, &lines),
+              CSV_RECORD_OK);
+    EXPECT_EQ(count, 5u);
+    int value = 0;
+    ASSERT_TRUE(csv_field_to_int(&fields[0], &value));
+    EXPECT_EQ(value, 8);
+    EXPECT_EQ(csv_next_record(&cursor, end, TRUE, fields, CSV_COLUMN_COUNT, &count, &lines),
+              CSV_RECORD_END);
+}
+
+// 测试缓冲区末尾不完整的记录与出错后跳到下一行
+TEST(CsvTest, NextRecordIncompleteAndErrors) {
+    std::string input = "1,\"abc";
+    const char *cursor = input.data();
+    CsvField fields[CSV_COLUMN_COUNT];
+    size_t count = 0;
+    size_t lines = 0;
+    EXPECT_EQ(csv_next_record(&cursor, input.data() + input.size(), FALSE, fields,
+                              CSV_COLUMN_COUNT, &count, &lines), CSV_RECORD_INCOMPLETE);
+    EXPECT_EQ(cursor, input.data());
+    EXPECT_EQ(csv_next_record(&cursor, input.data() + input.size(), TRUE, fields,
+                              CSV_COLUMN_COUNT, &count, &lines), CSV_RECORD_BAD_QUOTE);
+
+    std::string bad = "1,ab\"c,d\n1,2,3,4,5,6\n2,a,b,c,d\n";
+    cursor = bad.data();
+    const char *end = bad.data() + bad.size();
+    lines = 0;
+    EXPECT_EQ(csv_next_record(&cursor, end, TRUE, fields, CSV_COLUMN_COUNT, &count, &lines),
+              CSV_RECORD_BAD_QUOTE);
+    EXPECT_EQ(lines, 1u);
+    EXPECT_EQ(csv_next_record(&cursor, end, TRUE, fields, CSV_COLUMN_COUNT, &count, &lines),
+              CSV_RECORD_TOO_MANY_FIELDS);
+    EXPECT_EQ(lines, 2u);
+    EXPECT_EQ(csv_next_record(&cursor, end, TRUE, fields, CSV_COLUMN_COUNT, &count, &lines),
+              CSV_RECORD_OK);
+    EXPECT_EQ(lines, 3u);
+}
+
+// 测试整数字段解析
+TEST(CsvTest, FieldToInt) {
+    const char *cases[] = {"0", "42", "-7", "2147483647", "-2147483648"};
+    const int expected[] = {0, 42, -7, INT_MAX, INT_MIN};
+    for (size_t i = 0; i < 5; i++) {
+        CsvField field = {cases[i], strlen(cases[i]), FALSE};
+        int value = 1;
+        ASSERT_TRUE(csv_field_to_int(&field, &value));
+        EXPECT_EQ(value, expected[i]);
+    }
+    const char *bad[] = {"", "-", "12a", " 1", "2147483648", "-2147483649"};
+    for (const char *text : bad) {
+        CsvField field = {text, strlen(text), FALSE};
+        int value = 0;
+        EXPECT_FALSE(csv_field_to_int(&field, &value));
+    }
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+extern "C" {
+    #include "../csv_import.h"
+    #include "../storage.h"
+    #include "../model.h"
+}
+
+const char *TEST_IMPORT_CSV = "test_csv_import.csv";
+
+class CsvImportTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::remove(TEST_IMPORT_CSV);
+    }
+    
+    void TearDown() override {
+        std::remove(TEST_IMPORT_CSV);
+    }
+};
+
+// 测试导出的CSV可以原样导入(文件超过一个读缓冲区,覆盖跨块的记录)
+TEST_F(CsvImportTest, ImportExportedCsv) {
+    EmployeeManager *mgr = employee_manager_create();
+    const char *depts[] = {"研发部", "市场部", "人事部"};
+    for (int i = 0; i < 150000; i++) {
+        employee_manager_add(mgr, (i % 2) ? "张三" : "Li", depts[i % 3], "2024-01-15", i % 31);
+    }
+    ASSERT_EQ(storage_export_csv(TEST_IMPORT_CSV, mgr), SUCCESS);
+    
+    EmployeeManager *loaded = employee_manager_create();
+    CsvImportReport report;
+    ASSERT_EQ(storage_import_csv(TEST_IMPORT_CSV, loaded, &report), SUCCESS);
+    EXPECT_EQ(report.imported, 150000u);
+    EXPECT_EQ(report.rejected, 0u);
+    ASSERT_EQ(loaded->employees->size, mgr->employees->size);
+    for (size_t i = 0; i < mgr->employees->size; i++) {
+        const Employee *a = (const Employee *)mgr->employees->data[i];
+        const Employee *b = (const Employee *)loaded->employees->data[i];
+        ASSERT_EQ(a->id, b->id);
+        ASSERT_STREQ(a->name, b->name);
+        ASSERT_STREQ(a->department, b->department);
+        ASSERT_STREQ(a->attend_date, b->attend_date);
+        ASSERT_EQ(a->attend_days, b->attend_days);
+    }
+    EXPECT_EQ(loaded->next_id, mgr->next_id);
+    
+    employee_manager_free(mgr);
+    employee_manager_free(loaded);
+}
+
+// 测试逐行校验: 非法行跳过并报告行号,合法行全部导入
+TEST_F(CsvImportTest, ImportCsvReportsLineErrors) {
+    FILE *fp = fopen(TEST_IMPORT_CSV, "wb");
+    ASSERT_NE(fp, nullptr);
+    fputs("\xEF\xBB\xBF工号,姓名,部门,出勤日期,出勤天数\r\n"
+          "2001,\"Smith, John\",研发部,2024-02-29,20\r\n"   /* 2: 合法 */
+          ",李四,市场部,2024-03-01,5\r\n"                   /* 3: 合法,自动分配工号 */
+          "2001,王五,市场部,2024-03-01,5\r\n"               /* 4: 工号重复 */
+          "abc,王五,市场部,2024-03-01,5\r\n"                /* 5: 工号非法 */
+          "2002,,市场部,2024-03-01,5\r\n"                   /* 6: 姓名为空 */
+          "2003,赵六,市场部,2023-02-29T08:00:00Z,5\r\n"     /* 7: 日期过长 */
+          "2004,赵六,市场部,2024-03-01,400\r\n"             /* 8: 天数越界 */
+          "2005,赵六,市场部\r\n"                            /* 9: 列数不对 */
+          "2006,\"赵\"六,市场部,2024-03-01,5\r\n"          /* 10: 引号不匹配 */
+          "\r\n"                                            /* 11: 空行忽略 */
+          "2007,\"多\n行\",市场部,2024-03-01,5\r\n"       /* 12-13: 合法 */
+          "1001,钱七,市场部,2024-03-01,5",                  /* 14: 与已有工号重复 */
+          fp);
+    fclose(fp);
+    
+    EmployeeManager *mgr = employee_manager_create();
+    employee_manager_add(mgr, "已有", "研发部", "2024-01-01", 1);
+    CsvImportReport report;
+    ASSERT_EQ(storage_import_csv(TEST_IMPORT_CSV, mgr, &report), SUCCESS);
+    EXPECT_EQ(report.imported, 3u);
+    EXPECT_EQ(report.rejected, 8u);
+    ASSERT_EQ(report.error_count, 8u);
+    const size_t lines[] = {4, 5, 6, 7, 8, 9, 10, 14};
+    const CsvLineError errors[] = {CSV_LINE_DUPLICATE_ID, CSV_LINE_BAD_ID, CSV_LINE_BAD_NAME,
+                                   CSV_LINE_BAD_DATE, CSV_LINE_BAD_DAYS, CSV_LINE_FIELD_COUNT,
+                                   CSV_LINE_BAD_QUOTE, CSV_LINE_DUPLICATE_ID};
+    for (size_t i = 0; i < 8; i++) {
+        EXPECT_EQ(report.errors[i].line, lines[i]);
+        EXPECT_EQ(report.errors[i].error, errors[i]);
+    }
+    
+    ASSERT_EQ(mgr->employees->size, 4u);
+    const Employee *smith = (const Employee *)mgr->employees->data[1];
+    EXPECT_EQ(smith->id, 2001);
+    EXPECT_STREQ(smith->name, "Smith, John");
+    const Employee *auto_id = (const Employee *)mgr->employees->data[2];
+    EXPECT_EQ(auto_id->id, 2008);  /* 从最大导入工号之后分配 */
+    EXPECT_STREQ(((const Employee *)mgr->employees->data[3])->name, "多\n行");
+    EXPECT_EQ(mgr->next_id, 2009);
+    
+    EXPECT_EQ(storage_import_csv("nonexistent.csv", mgr, &report), ERROR_FILE_NOT_FOUND);
+    EXPECT_EQ(storage_import_csv(nullptr, mgr, &report), ERROR_NULL_POINTER);
+    employee_manager_free(mgr);
+}
+
+// 测试导入与添加共用同一校验: 控制台录入的非标准日期、空日期导出后可原样导入
+TEST_F(CsvImportTest, ImportAcceptsRecordsAddedAtConsole) {
+    EmployeeManager *mgr = employee_manager_create();
+    ASSERT_EQ(employee_manager_add(mgr, "张三", "研发部", "2024-02", 0), SUCCESS);
+    ASSERT_EQ(employee_manager_add(mgr, "李四", "市场部", "", 366), SUCCESS);
+    ASSERT_EQ(employee_manager_add(mgr, "王五", "市场部", "2024-01-01", 367), ERROR_INVALID_PARAMETER);
+    ASSERT_EQ(employee_manager_add(mgr, "", "市场部", "2024-01-01", 1), ERROR_INVALID_PARAMETER);
+    ASSERT_EQ(storage_export_csv(TEST_IMPORT_CSV, mgr), SUCCESS);
+    
+    EmployeeManager *loaded = employee_manager_create();
+    CsvImportReport report;
+    ASSERT_EQ(storage_import_csv(TEST_IMPORT_CSV, loaded, &report), SUCCESS);
+    EXPECT_EQ(report.imported, 2u);
+    EXPECT_EQ(report.rejected, 0u);
+    ASSERT_EQ(loaded->employees->size, 2u);
+    EXPECT_STREQ(((const Employee *)loaded->employees->data[0])->attend_date, "2024-02");
+    
+    employee_manager_free(mgr);
+    employee_manager_free(loaded);
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+extern "C" {
+    #include "../epoch.h"
+}
+
+// 回收计数回调
+static int freed_count = 0;
+static void count_free(void *ptr) {
+    (void)ptr;
+    freed_count++;
+}
+
+// 测试创建和释放
+TEST(EpochTest, CreateAndFree) {
+    EpochDomain *domain = epoch_domain_create();
+    ASSERT_NE(domain, nullptr);
+    EXPECT_EQ(epoch_pending_count(domain), 0u);
+    epoch_domain_free(domain);
+    epoch_domain_free(nullptr);  // 不应该崩溃
+}
+
+// 测试无读者时立即回收
+TEST(EpochTest, ReclaimWithoutReaders) {
+    EpochDomain *domain = epoch_domain_create();
+    ASSERT_NE(domain, nullptr);
+    
+    int a = 0;
+    freed_count = 0;
+    EXPECT_EQ(epoch_retire(domain, &a, count_free), SUCCESS);
+    EXPECT_EQ(epoch_pending_count(domain), 1u);
+    epoch_reclaim(domain);
+    EXPECT_EQ(freed_count, 1);
+    EXPECT_EQ(epoch_pending_count(domain), 0u);
+    
+    epoch_domain_free(domain);
+}
+
+// 测试读者存在时延迟回收
+TEST(EpochTest, ReaderDelaysReclaim) {
+    EpochDomain *domain = epoch_domain_create();
+    ASSERT_NE(domain, nullptr);
+    
+    int a = 0, b = 0;
+    freed_count = 0;
+    int token = epoch_enter(domain);
+    
+    epoch_retire(domain, &a, count_free);
+    epoch_reclaim(domain);
+    EXPECT_EQ(freed_count, 0);  // 读者可能仍在访问
+    
+    // 新读者进入新纪元,不影响旧对象的回收
+    int token2 = epoch_enter(domain);
+    epoch_retire(domain, &b, count_free);
+    epoch_reclaim(domain);
+    EXPECT_EQ(freed_count, 0);
+    
+    epoch_exit(domain, token);
+    epoch_reclaim(domain);
+    EXPECT_EQ(freed_count, 1);
+    
+    epoch_exit(domain, token2);
+    epoch_synchronize(domain);
+    EXPECT_EQ(freed_count, 2);
+    
+    epoch_domain_free(domain);
+}
+
+// 测试释放时回收所有待回收对象
+TEST(EpochTest, FreeReleasesPending) {
+    EpochDomain *domain = epoch_domain_create();
+    ASSERT_NE(domain, nullptr);
+    
+    int a = 0;
+    freed_count = 0;
+    int token = epoch_enter(domain);
+    epoch_retire(domain, &a, count_free);
+    epoch_reclaim(domain);
+    epoch_exit(domain, token);
+    
+    epoch_domain_free(domain);
+    EXPECT_EQ(freed_count, 1);
+}
+
+// 测试NULL参数
+TEST(EpochTest, NullParams) {
+    int a = 0;
+    EXPECT_EQ(epoch_retire(nullptr, &a, count_free), ERROR_NULL_POINTER);
+    epoch_reclaim(nullptr);  // 不应该崩溃
+    epoch_synchronize(nullptr);  // 不应该崩溃
+    EXPECT_EQ(epoch_pending_count(nullptr), 0u);
+}
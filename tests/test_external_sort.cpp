@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include "test_helpers.h"
+extern "C" {
+    #include "../external_sort.h"
+    #include "../storage.h"
+    #include "../model.h"
+}
+
+const char *TEST_SORT_DB = "test_external_sort.db";
+const char *TEST_SORT_CSV = "test_external_sort.csv";
+
+class ExternalSortTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::remove(TEST_SORT_DB);
+        std::remove(TEST_SORT_CSV);
+    }
+    
+    void TearDown() override {
+        std::remove(TEST_SORT_DB);
+        std::remove(TEST_SORT_CSV);
+    }
+};
+
+// 检查外部排序没有遗留临时段文件
+static bool sort_runs_left(const char *output) {
+    for (int run = 0; run < 64; run++) {
+        std::string path = std::string(output) + ".run" + std::to_string(run);
+        FILE *fp = fopen(path.c_str(), "rb");
+        if (fp != NULL) {
+            fclose(fp);
+            return true;
+        }
+    }
+    return false;
+}
+
+// 测试外部排序: 最小预算下多趟归并,CSV输出与内存排序后导出一致
+TEST_F(ExternalSortTest, ExternalSortCsvMatchesInMemory) {
+    EmployeeManager *mgr = employee_manager_create();
+    const int rows = FILE_BLOCK_RECORDS * 3 + 17;
+    for (int i = 0; i < rows; i++) {
+        char name[MAX_NAME_LEN];
+        snprintf(name, sizeof(name), "员工%05d", (i * 7919) % rows);  // 打乱且唯一
+        employee_manager_add(mgr, name, (i % 2) ? "研发部" : "市场部", "2024-01-15", i % 31);
+    }
+    ASSERT_EQ(storage_save_employees(TEST_SORT_DB, mgr), SUCCESS);
+    
+    const char *sorted_csv = "test_sorted.csv";
+    ASSERT_EQ(storage_external_sort(TEST_SORT_DB, sorted_csv, SORT_BY_NAME, SORT_OUTPUT_CSV,
+                                    EXTERNAL_SORT_MIN_BUDGET), SUCCESS);
+    EXPECT_FALSE(sort_runs_left(sorted_csv));
+    
+    employee_manager_sort(mgr, SORT_BY_NAME);
+    ASSERT_EQ(storage_export_csv(TEST_SORT_CSV, mgr), SUCCESS);
+    EXPECT_TRUE(read_whole_file(TEST_SORT_CSV) == read_whole_file(sorted_csv));
+    
+    // 预算足够时在内存中完成,结果相同
+    ASSERT_EQ(storage_external_sort(TEST_SORT_DB, sorted_csv, SORT_BY_NAME, SORT_OUTPUT_CSV, 0), SUCCESS);
+    EXPECT_TRUE(read_whole_file(TEST_SORT_CSV) == read_whole_file(sorted_csv));
+    
+    std::remove(sorted_csv);
+    employee_manager_free(mgr);
+}
+
+// 测试外部排序输出v2文件: 记录有序、数量与next_id保持不变
+TEST_F(ExternalSortTest, ExternalSortToDb) {
+    EmployeeManager *mgr = employee_manager_create();
+    const char *depts[] = {"研发部", "市场部", "人事部", "财务部"};
+    const int rows = FILE_BLOCK_RECORDS * 2 + 5;
+    long long id_sum = 0;
+    for (int i = 0; i < rows; i++) {
+        employee_manager_add(mgr, "员工", depts[(i * 5) % 4], "2024-01-15", (i * 13) % 31);
+        id_sum += 1001 + i;
+    }
+    ASSERT_EQ(storage_save_employees(TEST_SORT_DB, mgr), SUCCESS);
+    
+    const char *sorted_db = "test_sorted.db";
+    ASSERT_EQ(storage_external_sort(TEST_SORT_DB, sorted_db, SORT_BY_ATTEND_DAYS, SORT_OUTPUT_DB,
+                                    EXTERNAL_SORT_MIN_BUDGET), SUCCESS);
+    EXPECT_FALSE(sort_runs_left(sorted_db));
+    
+    EmployeeManager *loaded = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(sorted_db, loaded), SUCCESS);
+    ASSERT_EQ(loaded->employees->size, (size_t)rows);
+    EXPECT_EQ(loaded->next_id, mgr->next_id);
+    long long loaded_sum = 0;
+    for (size_t i = 0; i < loaded->employees->size; i++) {
+        Employee *emp = (Employee *)loaded->employees->data[i];
+        loaded_sum += emp->id;
+        if (i > 0) {
+            EXPECT_GE(((Employee *)loaded->employees->data[i - 1])->attend_days, emp->attend_days);
+        }
+    }
+    EXPECT_EQ(loaded_sum, id_sum);
+    
+    // 错误参数
+    EXPECT_EQ(storage_external_sort(nullptr, sorted_db, SORT_BY_ID, SORT_OUTPUT_DB, 0), ERROR_NULL_POINTER);
+    EXPECT_EQ(storage_external_sort("no_such_file.db", sorted_db, SORT_BY_ID, SORT_OUTPUT_DB, 0),
+              ERROR_FILE_NOT_FOUND);
+    EXPECT_EQ(storage_external_sort(TEST_SORT_DB, sorted_db, SORT_BY_ID, (SortOutputFormat)9, 0),
+              ERROR_INVALID_PARAMETER);
+    
+    std::remove(sorted_db);
+    employee_manager_free(mgr);
+    employee_manager_free(loaded);
+}
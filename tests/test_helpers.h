@@ -0,0 +1,31 @@
+#ifndef TEST_HELPERS_H
+#define TEST_HELPERS_H
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+
+// 读取整个文件内容,文件不存在时返回空串
+inline std::string read_whole_file(const char *filename) {
+    std::string content;
+    FILE *fp = fopen(filename, "rb");
+    if (fp != NULL) {
+        char buffer[65536];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+            content.append(buffer, n);
+        }
+        fclose(fp);
+    }
+    return content;
+}
+
+// 用data覆盖整个文件
+inline void write_whole_file(const char *filename, const std::string &data) {
+    FILE *fp = fopen(filename, "wb");
+    ASSERT_NE(fp, nullptr);
+    ASSERT_EQ(fwrite(data.data(), 1, data.size(), fp), data.size());
+    fclose(fp);
+}
+
+#endif /* TEST_HELPERS_H */
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <cstring>
+extern "C" {
+    #include "../index.h"
+}
+
+class IndexTest : public ::testing::Test {
+protected:
+    EmployeeManager *mgr;
+
+    void SetUp() override {
+        mgr = employee_manager_create();
+        ASSERT_NE(mgr, nullptr);
+        const char *depts[] = {"研发部", "市场部", "人事部"};
+        for (int i = 0; i < 3000; i++) {
+            employee_manager_add(mgr, "员工", depts[i % 3], "2024-01-15", i % 31);
+        }
+    }
+
+    void TearDown() override {
+        employee_manager_free(mgr);
+    }
+
+    EmployeeIndex *build() {
+        EmployeeView view;
+        employee_manager_view_begin(mgr, &view);
+        EmployeeIndex *index = employee_index_build(&view);
+        employee_manager_view_end(mgr, &view);
+        return index;
+    }
+};
+
+// 测试按工号查找
+TEST_F(IndexTest, FindById) {
+    EmployeeIndex *index = build();
+    ASSERT_NE(index, nullptr);
+    EXPECT_EQ(index->record_count, 3000u);
+    EXPECT_EQ(index->version, mgr->generation);
+
+    unsigned int position = 0;
+    EXPECT_EQ(employee_index_find_id(index, 1001, &position, 1), 1u);
+    EXPECT_EQ(position, 0u);
+    EXPECT_EQ(employee_index_find_id(index, 3500, &position, 1), 1u);
+    EXPECT_EQ(position, 2499u);
+    EXPECT_EQ(employee_index_find_id(index, 99999, &position, 1), 0u);
+
+    employee_index_free(index);
+}
+
+// 测试部门倒排按位置升序
+TEST_F(IndexTest, FindByDepartment) {
+    EmployeeIndex *index = build();
+    ASSERT_NE(index, nullptr);
+    EXPECT_EQ(index->dept_count, 3u);
+
+    size_t count = 0;
+    const unsigned int *positions = employee_index_find_department(index, "市场部", &count);
+    ASSERT_NE(positions, nullptr);
+    ASSERT_EQ(count, 1000u);
+    for (size_t i = 0; i < count; i++) {
+        EXPECT_EQ(positions[i], 3 * i + 1);
+    }
+
+    EXPECT_EQ(employee_index_find_department(index, "财务部", &count), nullptr);
+    EXPECT_EQ(count, 0u);
+
+    employee_index_free(index);
+}
+
+// 测试附加索引后的查询结果与全表扫描一致,修改后自动退回扫描
+TEST_F(IndexTest, SearchUsesIndexUntilModified) {
+    Vector *scan = employee_manager_search(mgr, SEARCH_BY_DEPARTMENT, "人事部");
+    ASSERT_NE(scan, nullptr);
+
+    EXPECT_EQ(employee_manager_attach_index(mgr, build()), SUCCESS);
+    Vector *indexed = employee_manager_search(mgr, SEARCH_BY_DEPARTMENT, "人事部");
+    ASSERT_NE(indexed, nullptr);
+    ASSERT_EQ(indexed->size, scan->size);
+    for (size_t i = 0; i < scan->size; i++) {
+        EXPECT_EQ(indexed->data[i], scan->data[i]);
+    }
+
+    int id = 2000;
+    Vector *by_id = employee_manager_search(mgr, SEARCH_BY_ID, &id);
+    ASSERT_EQ(by_id->size, 1u);
+    EXPECT_EQ(((Employee *)by_id->data[0])->id, 2000);
+
+    // 删除后索引版本过期,查询仍须正确
+    EXPECT_EQ(employee_manager_remove_by_id(mgr, 2000), SUCCESS);
+    Vector *after = employee_manager_search(mgr, SEARCH_BY_ID, &id);
+    EXPECT_EQ(after->size, 0u);
+
+    vector_free(scan);
+    vector_free(indexed);
+    vector_free(by_id);
+    vector_free(after);
+}
+
+// 测试由损坏的段数组组装索引时失败
+TEST_F(IndexTest, FromSectionsRejectsBadPositions) {
+    IndexIdSlot *slots = (IndexIdSlot *)malloc(4 * sizeof(IndexIdSlot));
+    for (int i = 0; i < 4; i++) {
+        slots[i].id = 0;
+        slots[i].position = INDEX_EMPTY_POSITION;
+    }
+    slots[1].id = 1001;
+    slots[1].position = 7;  // 越界
+    IndexDeptEntry *depts = (IndexDeptEntry *)calloc(1, sizeof(IndexDeptEntry));
+    strcpy(depts[0].name, "研发部");
+    depts[0].count = 1;
+    unsigned int *postings = (unsigned int *)malloc(sizeof(unsigned int));
+    postings[0] = 0;
+
+    EXPECT_EQ(employee_index_from_sections(1, slots, 4, depts, 1, postings), nullptr);
+}
+
+// 测试分区合并的结果与整体构建一致
+TEST_F(IndexTest, MergePartialsMatchesBuild) {
+    // 不同分区首次出现部门的顺序不同,且有只出现在某个分区的部门
+    employee_manager_update(mgr, 1001 + 2500, "员工", "财务部", "2024-01-15", 1);
+    EmployeeIndex *expected = build();
+    ASSERT_NE(expected, nullptr);
+
+    Employee **records = (Employee **)mgr->employees->data;
+    size_t bounds[] = {0, 1, 1200, 1200, 3000};  // 含一个空分区
+    IndexPartial *partials[4];
+    for (size_t p = 0; p < 4; p++) {
+        partials[p] = index_partial_create(bounds[p], bounds[p + 1] - bounds[p]);
+        ASSERT_NE(partials[p], nullptr);
+        for (size_t i = bounds[p]; i < bounds[p + 1]; i++) {
+            ASSERT_EQ(index_partial_add(partials[p], records[i]->department), SUCCESS);
+        }
+    }
+    EXPECT_EQ(index_partial_add(partials[0], "研发部"), ERROR_INDEX_OUT_OF_BOUNDS);
+
+    EmployeeIndex *merged = employee_index_merge(partials, 4, records, 3000, mgr->generation);
+    ASSERT_NE(merged, nullptr);
+    EXPECT_EQ(merged->version, mgr->generation);
+    ASSERT_EQ(merged->dept_count, expected->dept_count);
+    for (size_t d = 0; d < expected->dept_count; d++) {
+        EXPECT_STREQ(merged->depts[d].name, expected->depts[d].name);
+        EXPECT_EQ(merged->depts[d].first, expected->depts[d].first);
+        EXPECT_EQ(merged->depts[d].count, expected->depts[d].count);
+    }
+    EXPECT_EQ(memcmp(merged->postings, expected->postings, 3000 * sizeof(unsigned int)), 0);
+    unsigned int position = 0;
+    EXPECT_EQ(employee_index_find_id(merged, 1001 + 2999, &position, 1), 1u);
+    EXPECT_EQ(position, 2999u);
+
+    // 分区不连续或未覆盖全部记录时拒绝
+    EXPECT_EQ(employee_index_merge(partials + 1, 3, records, 3000, 0), nullptr);
+    EXPECT_EQ(employee_index_merge(partials, 3, records, 3000, 0), nullptr);
+
+    for (size_t p = 0; p < 4; p++) {
+        index_partial_free(partials[p]);
+    }
+    employee_index_free(merged);
+    employee_index_free(expected);
+}
+
+// 测试姓名索引的候选位置覆盖所有子串匹配且按位置升序
+TEST(NameIndexTest, CandidatesCoverMatches) {
+    EmployeeManager *mgr = employee_manager_create();
+    const char *names[] = {"张三丰", "张三", "李四", "欧阳张三", "三张"};
+    for (int i = 0; i < 500; i++) {
+        employee_manager_add(mgr, names[i % 5], "研发部", "2024-01-15", 1);
+    }
+
+    EmployeeView view;
+    employee_manager_view_begin(mgr, &view);
+    NameIndex *index = name_index_build(&view);
+    employee_manager_view_end(mgr, &view);
+    ASSERT_NE(index, nullptr);
+    EXPECT_EQ(index->record_count, 500u);
+
+    const unsigned int *positions = nullptr;
+    size_t count = 0;
+    ASSERT_TRUE(name_index_candidates(index, "张三", &positions, &count));
+    size_t matched = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) {
+            EXPECT_LT(positions[i - 1], positions[i]);
+        }
+        const Employee *emp = (const Employee *)mgr->employees->data[positions[i]];
+        if (strstr(emp->name, "张三") != nullptr) {
+            matched++;
+        }
+    }
+    EXPECT_EQ(matched, 300u);
+
+    ASSERT_TRUE(name_index_candidates(index, "王五", &positions, &count));
+    EXPECT_EQ(count, 0u);
+    ASSERT_TRUE(name_index_candidates(index, "丰", &positions, &count));  // 一个汉字即3字节
+    EXPECT_EQ(count, 100u);
+    EXPECT_FALSE(name_index_candidates(index, "ab", &positions, &count));
+    EXPECT_FALSE(name_index_candidates(index, "", &positions, &count));
+
+    name_index_free(index);
+    name_index_free(nullptr);  // 不应该崩溃
+    employee_manager_free(mgr);
+}
+
+// 测试出勤汇总与逐条比较前缀的结果一致
+TEST(DateAggregateTest, SumMatchesScan) {
+    EmployeeManager *mgr = employee_manager_create();
+    const char *dates[] = {"2023-12-31", "2024-01-15", "2024-02-01", "2024-1", "2024"};
+    for (int i = 0; i < 1000; i++) {
+        employee_manager_add(mgr, "张三", "研发部", dates[i % 5], i % 31);
+    }
+    int monthly = employee_manager_monthly_attendance(mgr, "2024-01");
+    int yearly = employee_manager_yearly_attendance(mgr, "2024");
+    int prefix = employee_manager_yearly_attendance(mgr, "2024-1");
+
+    EmployeeView view;
+    employee_manager_view_begin(mgr, &view);
+    DateAggregate *aggregate = date_aggregate_build(&view);
+    employee_manager_view_end(mgr, &view);
+    ASSERT_NE(aggregate, nullptr);
+    EXPECT_EQ(aggregate->count, 5u);
+
+    long long total = 0;
+    ASSERT_TRUE(date_aggregate_sum(aggregate, "2024-01", &total));
+    EXPECT_EQ(total, monthly);
+    ASSERT_TRUE(date_aggregate_sum(aggregate, "2024", &total));
+    EXPECT_EQ(total, yearly);
+    ASSERT_TRUE(date_aggregate_sum(aggregate, "2024-1", &total));
+    EXPECT_EQ(total, prefix);
+    EXPECT_FALSE(date_aggregate_sum(aggregate, "2024-01-15", &total));
+
+    date_aggregate_free(aggregate);
+    employee_manager_free(mgr);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <cstring>
+extern "C" {
+    #include "../indexer.h"
+    #include "../index.h"
+}
+
+class IndexerTest : public ::testing::Test {
+protected:
+    EmployeeManager *mgr;
+
+    void SetUp() override {
+        mgr = employee_manager_create();
+        ASSERT_NE(mgr, nullptr);
+        const char *names[] = {"张三丰", "李四", "王五", "欧阳张三"};
+        const char *depts[] = {"研发部", "市场部", "人事部"};
+        const char *dates[] = {"2024-01-15", "2024-02-03", "2023-12-30"};
+        for (int i = 0; i < 5000; i++) {
+            employee_manager_add(mgr, names[i % 4], depts[i % 3], dates[i % 3], i % 31);
+        }
+        ASSERT_EQ(employee_manager_enable_concurrency(mgr), SUCCESS);
+    }
+
+    void TearDown() override {
+        employee_manager_free(mgr);
+    }
+
+    size_t count(SearchType type, const void *keyword) {
+        Vector *results = employee_manager_search(mgr, type, keyword);
+        size_t size = (results != nullptr) ? results->size : 0;
+        vector_free(results);
+        return size;
+    }
+};
+
+// 测试创建和释放
+TEST_F(IndexerTest, CreateAndFree) {
+    BackgroundIndexer *indexer = background_indexer_create();
+    ASSERT_NE(indexer, nullptr);
+    EXPECT_FALSE(background_indexer_busy(indexer));
+    EXPECT_EQ(background_indexer_wait(indexer), SUCCESS);
+    EXPECT_EQ(background_indexer_submit(indexer, nullptr, INDEX_KINDS_ALL), ERROR_NULL_POINTER);
+
+    // 未启用并发模式的管理器不能取快照
+    EmployeeManager *plain = employee_manager_create();
+    EXPECT_EQ(background_indexer_submit(indexer, plain, INDEX_KINDS_ALL), ERROR_INVALID_PARAMETER);
+    employee_manager_free(plain);
+    background_indexer_free(indexer);
+    background_indexer_free(nullptr);  // 不应该崩溃
+}
+
+// 测试构建前后查询结果一致,构建完成后各种索引就绪
+TEST_F(IndexerTest, BuildsAllKinds) {
+    int id = 3000;
+    size_t by_id = count(SEARCH_BY_ID, &id);
+    size_t by_dept = count(SEARCH_BY_DEPARTMENT, "市场部");
+    size_t by_name = count(SEARCH_BY_NAME, "张三");
+    int monthly = employee_manager_monthly_attendance(mgr, "2024-01");
+    int yearly = employee_manager_yearly_attendance(mgr, "2024");
+    for (int kind = 0; kind < INDEX_KIND_COUNT; kind++) {
+        EXPECT_FALSE(employee_manager_index_ready(mgr, (IndexKind)kind));
+    }
+
+    BackgroundIndexer *indexer = background_indexer_create();
+    ASSERT_NE(indexer, nullptr);
+    ASSERT_EQ(background_indexer_submit(indexer, mgr, INDEX_KINDS_ALL), SUCCESS);
+    EXPECT_EQ(background_indexer_wait(indexer), SUCCESS);
+    EXPECT_FALSE(background_indexer_busy(indexer));
+    for (int kind = 0; kind < INDEX_KIND_COUNT; kind++) {
+        EXPECT_TRUE(employee_manager_index_ready(mgr, (IndexKind)kind));
+    }
+
+    EXPECT_EQ(count(SEARCH_BY_ID, &id), by_id);
+    EXPECT_EQ(count(SEARCH_BY_DEPARTMENT, "市场部"), by_dept);
+    EXPECT_EQ(count(SEARCH_BY_NAME, "张三"), by_name);
+    EXPECT_EQ(count(SEARCH_BY_NAME, ""), 5000u);  // 不足3字节的关键字走全表扫描
+    EXPECT_EQ(employee_manager_monthly_attendance(mgr, "2024-01"), monthly);
+    EXPECT_EQ(employee_manager_yearly_attendance(mgr, "2024"), yearly);
+
+    // 修改后索引失效,查询退回全表扫描,重新提交后再次就绪
+    ASSERT_EQ(employee_manager_update(mgr, 1001, "张三", "市场部", "2024-01-20", 30), SUCCESS);
+    EXPECT_FALSE(employee_manager_index_ready(mgr, INDEX_KIND_NAME));
+    EXPECT_EQ(count(SEARCH_BY_NAME, "张三丰"), 1249u);
+    EXPECT_EQ(count(SEARCH_BY_DEPARTMENT, "市场部"), by_dept + 1);
+    ASSERT_EQ(background_indexer_submit(indexer, mgr, INDEX_KINDS_ALL), SUCCESS);
+    EXPECT_EQ(background_indexer_wait(indexer), SUCCESS);
+    EXPECT_TRUE(employee_manager_index_ready(mgr, INDEX_KIND_NAME));
+    EXPECT_EQ(count(SEARCH_BY_NAME, "张三丰"), 1249u);
+    EXPECT_EQ(count(SEARCH_BY_DEPARTMENT, "市场部"), by_dept + 1);
+
+    background_indexer_free(indexer);
+}
+
+// 测试只构建请求的种类,已就绪的索引不重建
+TEST_F(IndexerTest, BuildsRequestedKindsOnly) {
+    BackgroundIndexer *indexer = background_indexer_create();
+    ASSERT_NE(indexer, nullptr);
+    ASSERT_EQ(background_indexer_submit(indexer, mgr, 1u << INDEX_KIND_NAME), SUCCESS);
+    EXPECT_EQ(background_indexer_wait(indexer), SUCCESS);
+    EXPECT_FALSE(employee_manager_index_ready(mgr, INDEX_KIND_PRIMARY));
+    EXPECT_TRUE(employee_manager_index_ready(mgr, INDEX_KIND_NAME));
+    EXPECT_FALSE(employee_manager_index_ready(mgr, INDEX_KIND_DATE));
+
+    const void *name_index = mgr->name_index;
+    ASSERT_EQ(background_indexer_submit(indexer, mgr, INDEX_KINDS_ALL), SUCCESS);
+    EXPECT_EQ(background_indexer_wait(indexer), SUCCESS);
+    EXPECT_EQ(mgr->name_index, name_index);
+    for (int kind = 0; kind < INDEX_KIND_COUNT; kind++) {
+        EXPECT_TRUE(employee_manager_index_ready(mgr, (IndexKind)kind));
+    }
+    background_indexer_free(indexer);
+}
+
+// 测试构建期间写者和读者照常工作
+TEST_F(IndexerTest, ConcurrentWrites) {
+    BackgroundIndexer *indexer = background_indexer_create();
+    ASSERT_NE(indexer, nullptr);
+    for (int round = 0; round < 20; round++) {
+        ASSERT_EQ(background_indexer_submit(indexer, mgr, INDEX_KINDS_ALL), SUCCESS);
+        employee_manager_add(mgr, "张三丰", "研发部", "2024-01-15", 1);
+        EXPECT_EQ(count(SEARCH_BY_NAME, "张三丰"), 1250u + round + 1);
+    }
+    // 释放时放弃排队的请求,不应泄漏快照
+    background_indexer_free(indexer);
+}
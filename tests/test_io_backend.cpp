@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#if defined(_WIN32)
+    #include <io.h>
+    #define fileno_for_test _fileno
+#else
+    #include <unistd.h>
+    #define fileno_for_test fileno
+#endif
+extern "C" {
+    #include "../io_backend.h"
+}
+
+static const char *TEST_IO_FILE = "test_io_backend.bin";
+
+// 所有可用的后端
+static std::vector<const IoBackendInterface *> available_backends() {
+    std::vector<const IoBackendInterface *> backends;
+    backends.push_back(io_backend_pread());
+    if (io_backend_uring() != nullptr) {
+        backends.push_back(io_backend_uring());
+    }
+    return backends;
+}
+
+class IoBackendTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::remove(TEST_IO_FILE);
+    }
+    
+    void TearDown() override {
+        std::remove(TEST_IO_FILE);
+    }
+};
+
+// 测试默认后端总是可用
+TEST_F(IoBackendTest, DefaultBackend) {
+    const IoBackendInterface *backend = io_backend_default();
+    ASSERT_NE(backend, nullptr);
+    ASSERT_NE(backend->name, nullptr);
+    if (io_backend_uring() != nullptr) {
+        EXPECT_STREQ(backend->name, "io_uring");
+    } else {
+        EXPECT_STREQ(backend->name, "pread");
+    }
+}
+
+// 测试参数检查与缓冲区对齐
+TEST_F(IoBackendTest, CreateQueue) {
+    FILE *fp = fopen(TEST_IO_FILE, "w+b");
+    ASSERT_NE(fp, nullptr);
+    int fd = fileno_for_test(fp);
+    
+    ErrorCode err = SUCCESS;
+    EXPECT_EQ(io_queue_create(nullptr, fd, 4, 4096, &err), nullptr);
+    EXPECT_EQ(err, ERROR_INVALID_PARAMETER);
+    EXPECT_EQ(io_queue_create(io_backend_pread(), fd, 0, 4096, &err), nullptr);
+    EXPECT_EQ(io_queue_create(io_backend_pread(), -1, 4, 4096, &err), nullptr);
+    
+    for (const IoBackendInterface *backend : available_backends()) {
+        IoQueue *queue = io_queue_create(backend, fd, 3, 100, &err);
+        ASSERT_NE(queue, nullptr) << backend->name;
+        EXPECT_EQ(err, SUCCESS);
+        for (size_t slot = 0; slot < 3; slot++) {
+            void *buffer = io_queue_buffer(queue, slot);
+            ASSERT_NE(buffer, nullptr);
+            EXPECT_EQ((size_t)buffer % IO_BUFFER_ALIGN, 0u);
+            EXPECT_FALSE(io_queue_busy(queue, slot));
+        }
+        EXPECT_EQ(io_queue_buffer(queue, 3), nullptr);
+        // 超过缓冲区大小的请求被拒绝
+        EXPECT_EQ(io_queue_submit(queue, 0, IO_OP_READ, 0, IO_BUFFER_ALIGN + 1), ERROR_INVALID_PARAMETER);
+        EXPECT_EQ(io_queue_wait(queue, 0, nullptr), ERROR_INVALID_PARAMETER);
+        io_queue_free(queue);
+    }
+    io_queue_free(nullptr);  // 不应该崩溃
+    fclose(fp);
+}
+
+// 测试多个写请求同时在途,再乱序读回
+TEST_F(IoBackendTest, WriteThenReadBack) {
+    const size_t block = 64 * 1024;
+    const size_t blocks = 16;
+    
+    for (const IoBackendInterface *backend : available_backends()) {
+        FILE *fp = fopen(TEST_IO_FILE, "w+b");
+        ASSERT_NE(fp, nullptr);
+        int fd = fileno_for_test(fp);
+        IoQueue *queue = io_queue_create(backend, fd, 4, block, nullptr);
+        ASSERT_NE(queue, nullptr) << backend->name;
+        
+        // 每块填充块号,按槽轮流提交
+        for (size_t b = 0; b < blocks; b++) {
+            size_t slot = b % 4;
+            if (io_queue_busy(queue, slot)) {
+                ASSERT_EQ(io_queue_wait(queue, slot, nullptr), SUCCESS);
+            }
+            memset(io_queue_buffer(queue, slot), (int)('A' + b), block);
+            ASSERT_EQ(io_queue_submit(queue, slot, IO_OP_WRITE, b * block, block), SUCCESS);
+        }
+        ASSERT_EQ(io_queue_drain(queue), SUCCESS);
+        
+        // 逆序读回,等待顺序与完成顺序无关
+        for (size_t slot = 0; slot < 4; slot++) {
+            size_t b = blocks - 1 - slot * 3;
+            ASSERT_EQ(io_queue_submit(queue, slot, IO_OP_READ, b * block, block), SUCCESS);
+        }
+        for (size_t slot = 4; slot-- > 0;) {
+            size_t b = blocks - 1 - slot * 3;
+            size_t bytes = 0;
+            ASSERT_EQ(io_queue_wait(queue, slot, &bytes), SUCCESS);
+            ASSERT_EQ(bytes, block);
+            const unsigned char *data = (const unsigned char *)io_queue_buffer(queue, slot);
+            EXPECT_EQ(data[0], 'A' + b);
+            EXPECT_EQ(data[block - 1], 'A' + b);
+        }
+        
+        // 读到文件末尾时返回实际字节数
+        size_t bytes = 0;
+        ASSERT_EQ(io_queue_submit(queue, 0, IO_OP_READ, blocks * block - 100, block), SUCCESS);
+        ASSERT_EQ(io_queue_wait(queue, 0, &bytes), SUCCESS);
+        EXPECT_EQ(bytes, 100u);
+        
+        io_queue_free(queue);
+        fclose(fp);
+        std::remove(TEST_IO_FILE);
+    }
+}
+
+// 测试在只读文件上写入时报告错误
+TEST_F(IoBackendTest, WriteErrorReported) {
+    FILE *fp = fopen(TEST_IO_FILE, "wb");
+    ASSERT_NE(fp, nullptr);
+    fclose(fp);
+    
+    for (const IoBackendInterface *backend : available_backends()) {
+        fp = fopen(TEST_IO_FILE, "rb");
+        ASSERT_NE(fp, nullptr);
+        IoQueue *queue = io_queue_create(backend, fileno_for_test(fp), 2, 4096, nullptr);
+        ASSERT_NE(queue, nullptr) << backend->name;
+        memset(io_queue_buffer(queue, 0), 'x', 4096);
+        ErrorCode err = io_queue_submit(queue, 0, IO_OP_WRITE, 0, 4096);
+        if (err == SUCCESS) {
+            err = io_queue_wait(queue, 0, nullptr);
+        }
+        EXPECT_EQ(err, ERROR_FILE_WRITE_FAILED) << backend->name;
+        io_queue_free(queue);
+        fclose(fp);
+    }
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include "test_helpers.h"
+extern "C" {
+    #include "../merge.h"
+    #include "../storage.h"
+    #include "../model.h"
+}
+
+const char *TEST_MERGE_DB = "test_merge.db";
+
+class MergeTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::remove(TEST_MERGE_DB);
+    }
+    
+    void TearDown() override {
+        std::remove(TEST_MERGE_DB);
+    }
+};
+
+// 按给定工号与顺序写出一个分支库
+struct BranchRow {
+    int id;
+    const char *name;
+    const char *department;
+};
+
+static void save_branch(const char *filename, const BranchRow *rows, size_t count, int next_id) {
+    EmployeeManager *mgr = employee_manager_create();
+    employee_manager_begin_write(mgr);
+    for (size_t i = 0; i < count; i++) {
+        vector_push_back(mgr->employees,
+                         employee_create(rows[i].id, rows[i].name, rows[i].department, "2024-03-01", 20));
+    }
+    mgr->next_id = next_id;
+    employee_manager_end_write(mgr);
+    ASSERT_EQ(storage_save_employees(filename, mgr), SUCCESS);
+    employee_manager_free(mgr);
+}
+
+static bool file_exists(const char *filename) {
+    FILE *fp = fopen(filename, "rb");
+    if (fp != NULL) {
+        fclose(fp);
+        return true;
+    }
+    return false;
+}
+
+// 测试多库合并: 相同记录去重,冲突工号改号并写出对照表,无序输入先排序
+TEST_F(MergeTest, MergeFilesRemapsAndDeduplicates) {
+    const char *branch_a = "test_branch_a.db";
+    const char *branch_b = "test_branch_b.db";
+    const char *branch_c = "test_branch_c.db";
+    const char *merged = "test_merged.db";
+    const char *id_map = "test_merged_ids.csv";
+    const BranchRow rows_a[] = {{1001, "张三", "研发部"}, {1002, "李四", "市场部"}, {1003, "王五", "财务部"}};
+    const BranchRow rows_b[] = {{1001, "张三", "研发部"}, {1003, "赵六", "人事部"}, {1005, "孙七", "研发部"}};
+    const BranchRow rows_c[] = {{1003, "赵六", "人事部"}, {1002, "周八", "市场部"}, {1005, "孙七", "研发部"}};
+    save_branch(branch_a, rows_a, 3, 1004);
+    save_branch(branch_b, rows_b, 3, 1006);
+    save_branch(branch_c, rows_c, 3, 1006);
+    
+    const char *inputs[] = {branch_a, branch_b, branch_c};
+    MergeStats stats = {};
+    ASSERT_EQ(storage_merge_files(inputs, 3, merged, id_map, 0, &stats), SUCCESS);
+    EXPECT_EQ(stats.input_records, 9u);
+    EXPECT_EQ(stats.output_records, 6u);
+    EXPECT_EQ(stats.duplicates, 3u);
+    EXPECT_EQ(stats.remapped, 2u);
+    EXPECT_EQ(stats.sorted_inputs, 1u);
+    
+    // 先到的保留原工号,冲突记录按工号顺序分配新工号并排在末尾
+    EmployeeManager *loaded = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(merged, loaded), SUCCESS);
+    const BranchRow expected[] = {{1001, "张三", "研发部"}, {1002, "李四", "市场部"}, {1003, "王五", "财务部"},
+                                  {1005, "孙七", "研发部"}, {1006, "周八", "市场部"}, {1007, "赵六", "人事部"}};
+    ASSERT_EQ(loaded->employees->size, 6u);
+    EXPECT_EQ(loaded->next_id, 1008);
+    for (size_t i = 0; i < 6; i++) {
+        Employee *emp = (Employee *)loaded->employees->data[i];
+        EXPECT_EQ(emp->id, expected[i].id);
+        EXPECT_STREQ(emp->name, expected[i].name);
+        EXPECT_STREQ(emp->department, expected[i].department);
+    }
+    
+    // 丢弃的重复记录若对应改过号的记录,同样写入对照表
+    EXPECT_EQ(read_whole_file(id_map), std::string("输入序号,原工号,新工号\n2,1002,1006\n1,1003,1007\n2,1003,1007\n"));
+    EXPECT_FALSE(file_exists("test_merged.db.remap"));
+    EXPECT_FALSE(file_exists("test_merged.db.in2"));
+    
+    EXPECT_EQ(storage_merge_files(nullptr, 3, merged, nullptr, 0, nullptr), ERROR_NULL_POINTER);
+    EXPECT_EQ(storage_merge_files(inputs, 0, merged, nullptr, 0, nullptr), ERROR_INVALID_PARAMETER);
+    const char *missing[] = {branch_a, "no_such_file.db"};
+    EXPECT_EQ(storage_merge_files(missing, 2, merged, nullptr, 0, nullptr), ERROR_FILE_NOT_FOUND);
+    
+    employee_manager_free(loaded);
+    std::remove(branch_a);
+    std::remove(branch_b);
+    std::remove(branch_c);
+    std::remove(merged);
+    std::remove(id_map);
+}
+
+// 测试多库合并跨越多个记录块: 输出按工号有序,与单独加载后去重的结果一致
+TEST_F(MergeTest, MergeFilesStreamsLargeInputs) {
+    const char *branch_b = "test_branch_b.db";
+    const char *merged = "test_merged.db";
+    const int rows = FILE_BLOCK_RECORDS * 2 + 7;
+    EmployeeManager *mgr = employee_manager_create();
+    for (int i = 0; i < rows; i++) {
+        employee_manager_add(mgr, "员工", (i % 2 == 0) ? "研发部" : "市场部", "2024-01-15", i % 31);
+    }
+    ASSERT_EQ(storage_save_employees(TEST_MERGE_DB, mgr), SUCCESS);
+    
+    // 第二个库: 后一半记录相同,另追加一批新工号
+    EmployeeManager *other = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(TEST_MERGE_DB, other), SUCCESS);
+    employee_manager_begin_write(other);
+    for (int i = 0; i < rows / 2; i++) {
+        employee_free((Employee *)other->employees->data[i]);
+    }
+    for (int i = rows / 2; i < rows; i++) {
+        other->employees->data[i - rows / 2] = other->employees->data[i];
+    }
+    other->employees->size = rows - rows / 2;
+    employee_manager_end_write(other);
+    for (int i = 0; i < 100; i++) {
+        employee_manager_add(other, "新员工", "人事部", "2024-02-01", 10);
+    }
+    ASSERT_EQ(storage_save_employees(branch_b, other), SUCCESS);
+    
+    const char *inputs[] = {TEST_MERGE_DB, branch_b};
+    MergeStats stats = {};
+    ASSERT_EQ(storage_merge_files(inputs, 2, merged, nullptr, 0, &stats), SUCCESS);
+    EXPECT_EQ(stats.duplicates, (unsigned long long)(rows - rows / 2));
+    EXPECT_EQ(stats.remapped, 0u);
+    EXPECT_EQ(stats.sorted_inputs, 0u);
+    
+    EmployeeManager *loaded = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(merged, loaded), SUCCESS);
+    ASSERT_EQ(loaded->employees->size, (size_t)rows + 100);
+    EXPECT_EQ(loaded->next_id, other->next_id);
+    for (size_t i = 0; i < loaded->employees->size; i++) {
+        Employee *emp = (Employee *)loaded->employees->data[i];
+        const Employee *source = (i < (size_t)rows)
+            ? (Employee *)mgr->employees->data[i]
+            : (Employee *)other->employees->data[i - rows + (rows - rows / 2)];
+        ASSERT_EQ(memcmp(emp, source, sizeof(Employee)), 0) << "record " << i;
+    }
+    
+    employee_manager_free(mgr);
+    employee_manager_free(other);
+    employee_manager_free(loaded);
+    std::remove(branch_b);
+    std::remove(merged);
+}
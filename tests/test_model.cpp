@@ -2,6 +2,7 @@
 #include <cstring>
 extern "C" {
     #include "../model.h"
+    #include "../query_cache.h"
 }
 
 // 测试employee_create
@@ -187,6 +188,74 @@ TEST(EmployeeManagerTest, UpdateEmployeeNotFound) {
     employee_manager_free(mgr);
 }
 
+// 测试记录不按工号有序时仍能按工号修改和删除
+TEST(EmployeeManagerTest, UpdateRemoveAfterSort) {
+    EmployeeManager *mgr = employee_manager_create();
+    employee_manager_add(mgr, "王五", "财务部", "2024-01-17", 10);
+    employee_manager_add(mgr, "张三", "研发部", "2024-01-15", 30);
+    employee_manager_add(mgr, "李四", "市场部", "2024-01-16", 20);
+    EXPECT_EQ(mgr->ids_ascending, TRUE);
+    employee_manager_sort(mgr, SORT_BY_ATTEND_DAYS);
+    EXPECT_EQ(mgr->ids_ascending, FALSE);
+    
+    EXPECT_EQ(employee_manager_update(mgr, 1001, "王五", "人事部", "2024-01-17", 10), SUCCESS);
+    EXPECT_EQ(employee_manager_update(mgr, 1004, "赵六", "人事部", "2024-01-18", 10), ERROR_NOT_FOUND);
+    int id = 1001;
+    Vector *results = employee_manager_search(mgr, SEARCH_BY_ID, &id);
+    ASSERT_NE(results, nullptr);
+    ASSERT_EQ(results->size, 1u);
+    EXPECT_STREQ(((Employee *)results->data[0])->department, "人事部");
+    vector_free(results);
+    
+    EXPECT_EQ(employee_manager_remove_by_id(mgr, 1002), SUCCESS);
+    EXPECT_EQ(employee_manager_remove_by_id(mgr, 1002), ERROR_NOT_FOUND);
+    ASSERT_EQ(mgr->employees->size, 2u);
+    EXPECT_EQ(((Employee *)mgr->employees->data[0])->id, 1003);
+    EXPECT_EQ(((Employee *)mgr->employees->data[1])->id, 1001);
+    
+    // 按工号排回有序后重新启用二分查找
+    employee_manager_sort(mgr, SORT_BY_ID);
+    EXPECT_EQ(mgr->ids_ascending, TRUE);
+    EXPECT_EQ(employee_manager_remove_by_id(mgr, 1003), SUCCESS);
+    ASSERT_EQ(mgr->employees->size, 1u);
+    EXPECT_EQ(((Employee *)mgr->employees->data[0])->id, 1001);
+    employee_manager_free(mgr);
+}
+
+// 测试工号重复时按工号修改和删除作用于第一条匹配的记录
+TEST(EmployeeManagerTest, DuplicateIdsHitFirstRecord) {
+    EmployeeManager *mgr = employee_manager_create();
+    employee_manager_begin_write(mgr);
+    vector_push_back(mgr->employees, employee_create(1001, "甲", "研发部", "2024-01-15", 1));
+    vector_push_back(mgr->employees, employee_create(1000, "乙", "研发部", "2024-01-15", 2));
+    vector_push_back(mgr->employees, employee_create(1001, "丙", "研发部", "2024-01-15", 3));
+    vector_push_back(mgr->employees, employee_create(1002, "丁", "研发部", "2024-01-15", 4));
+    employee_manager_end_write(mgr);
+    EXPECT_EQ(mgr->ids_ascending, FALSE);
+    
+    EXPECT_EQ(employee_manager_update(mgr, 1001, "甲二", "市场部", "2024-01-16", 5), SUCCESS);
+    EXPECT_STREQ(((Employee *)mgr->employees->data[0])->name, "甲二");
+    EXPECT_STREQ(((Employee *)mgr->employees->data[2])->name, "丙");
+    
+    EXPECT_EQ(employee_manager_remove_by_id(mgr, 1001), SUCCESS);
+    ASSERT_EQ(mgr->employees->size, 3u);
+    EXPECT_STREQ(((Employee *)mgr->employees->data[0])->name, "乙");
+    EXPECT_STREQ(((Employee *)mgr->employees->data[1])->name, "丙");
+    
+    // 追加的工号不大于末尾工号时同样退回顺序扫描
+    EmployeeManager *appended = employee_manager_create();
+    employee_manager_add(appended, "甲", "研发部", "2024-01-15", 1);
+    appended->next_id = 1001;
+    employee_manager_add(appended, "乙", "研发部", "2024-01-15", 2);
+    EXPECT_EQ(appended->ids_ascending, FALSE);
+    EXPECT_EQ(employee_manager_remove_by_id(appended, 1001), SUCCESS);
+    ASSERT_EQ(appended->employees->size, 1u);
+    EXPECT_STREQ(((Employee *)appended->employees->data[0])->name, "乙");
+    
+    employee_manager_free(appended);
+    employee_manager_free(mgr);
+}
+
 // 测试employee_manager_update NULL参数
 TEST(EmployeeManagerTest, UpdateEmployeeNullParams) {
     EmployeeManager *mgr = employee_manager_create();
@@ -473,3 +542,304 @@ TEST(EmployeeManagerTest, YearlyAttendanceNull) {
     
     employee_manager_free(mgr);
 }
+
+// 测试大数据量并行查询保持原有顺序
+TEST(EmployeeManagerTest, ParallelSearchPreservesOrder) {
+    EmployeeManager *mgr = employee_manager_create();
+    ASSERT_NE(mgr, nullptr);
+    
+    const int count = 100000;
+    for (int i = 0; i < count; i++) {
+        employee_manager_add(mgr, (i % 3 == 0) ? "张三" : "李四",
+                             (i % 2 == 0) ? "研发部" : "市场部",
+                             (i % 4 == 0) ? "2024-01-15" : "2023-06-01", 1);
+    }
+    
+    const char *dept = "研发部";
+    Vector *results = employee_manager_search(mgr, SEARCH_BY_DEPARTMENT, dept);
+    ASSERT_NE(results, nullptr);
+    EXPECT_EQ(results->size, (size_t)count / 2);
+    for (size_t i = 1; i < results->size; i++) {
+        Employee *prev = (Employee *)results->data[i - 1];
+        Employee *cur = (Employee *)results->data[i];
+        ASSERT_LT(prev->id, cur->id);
+    }
+    vector_free(results);
+    
+    results = employee_manager_search(mgr, SEARCH_BY_NAME, "张");
+    ASSERT_NE(results, nullptr);
+    EXPECT_EQ(results->size, (size_t)(count + 2) / 3);
+    vector_free(results);
+    
+    EXPECT_EQ(employee_manager_monthly_attendance(mgr, "2024-01"), count / 4);
+    EXPECT_EQ(employee_manager_yearly_attendance(mgr, "2023"), count - count / 4);
+    
+    employee_manager_free(mgr);
+}
+
+// 校验视图内容与写者数组一致
+static void expect_view_matches(EmployeeManager *mgr) {
+    EmployeeView view;
+    ASSERT_EQ(employee_manager_view_begin(mgr, &view), SUCCESS);
+    ASSERT_EQ(view.size, mgr->employees->size);
+    for (size_t i = 0; i < view.size; i++) {
+        EXPECT_EQ(employee_view_get(&view, i), (Employee *)mgr->employees->data[i]);
+    }
+    employee_manager_view_end(mgr, &view);
+}
+
+// 测试并发模式下增删改与发布的表版本保持一致
+TEST(EmployeeManagerTest, ConcurrentModeKeepsTableInSync) {
+    EmployeeManager *mgr = employee_manager_create();
+    ASSERT_NE(mgr, nullptr);
+    
+    for (int i = 0; i < 3000; i++) {
+        employee_manager_add(mgr, "张三", "研发部", "2024-01-15", 1);
+    }
+    ASSERT_EQ(employee_manager_enable_concurrency(mgr), SUCCESS);
+    EXPECT_EQ(mgr->concurrent, TRUE);
+    expect_view_matches(mgr);
+    // 并发模式只能启用一次
+    EXPECT_DEBUG_DEATH(employee_manager_enable_concurrency(mgr), "");
+    
+    unsigned long generation = mgr->generation;
+    EXPECT_EQ(employee_manager_add(mgr, "李四", "市场部", "2024-02-01", 2), SUCCESS);
+    EXPECT_GT(mgr->generation, generation);
+    EXPECT_EQ(employee_manager_update(mgr, 2500, "王五", "财务部", "2024-03-01", 3), SUCCESS);
+    EXPECT_EQ(employee_manager_remove_by_id(mgr, 1001), SUCCESS);
+    EXPECT_EQ(employee_manager_remove_at(mgr, 1023), SUCCESS);
+    expect_view_matches(mgr);
+    
+    // 删空一个块
+    for (int i = 0; i < 1100; i++) {
+        ASSERT_EQ(employee_manager_remove_at(mgr, 0), SUCCESS);
+    }
+    expect_view_matches(mgr);
+    
+    employee_manager_sort(mgr, SORT_BY_ATTEND_DAYS);
+    expect_view_matches(mgr);
+    
+    const char *dept = "财务部";
+    Vector *results = employee_manager_search(mgr, SEARCH_BY_DEPARTMENT, dept);
+    ASSERT_NE(results, nullptr);
+    ASSERT_EQ(results->size, 1u);
+    EXPECT_EQ(((Employee *)results->data[0])->id, 2500);
+    vector_free(results);
+    
+    EXPECT_EQ(employee_manager_monthly_attendance(mgr, "2024-02"), 2);
+    
+    employee_manager_free(mgr);
+}
+
+// 读者线程: 反复打开视图并遍历所有记录
+struct ReaderContext {
+    EmployeeManager *mgr;
+    int rounds;
+    volatile long errors;
+};
+
+static void reader_thread(void *arg) {
+    ReaderContext *ctx = (ReaderContext *)arg;
+    for (int r = 0; r < ctx->rounds; r++) {
+        EmployeeView view;
+        employee_manager_view_begin(ctx->mgr, &view);
+        size_t total = 0;
+        size_t spans = employee_view_span_count(&view);
+        for (size_t s = 0; s < spans; s++) {
+            Employee *const *records = NULL;
+            size_t count = employee_view_span(&view, s, &records);
+            for (size_t i = 0; i < count; i++) {
+                if (records[i]->attend_days != 1) {
+                    atomic_long_add(&ctx->errors, 1);
+                }
+            }
+            total += count;
+        }
+        if (total != view.size) {
+            atomic_long_add(&ctx->errors, 1);
+        }
+        employee_manager_view_end(ctx->mgr, &view);
+        
+        employee_manager_monthly_attendance(ctx->mgr, "2024-01");
+    }
+}
+
+// 测试读者与写者并发运行
+TEST(EmployeeManagerTest, ConcurrentReadersAndWriter) {
+    EmployeeManager *mgr = employee_manager_create();
+    ASSERT_NE(mgr, nullptr);
+    for (int i = 0; i < 2000; i++) {
+        employee_manager_add(mgr, "张三", "研发部", "2024-01-15", 1);
+    }
+    ASSERT_EQ(employee_manager_enable_concurrency(mgr), SUCCESS);
+    
+    ReaderContext ctx;
+    ctx.mgr = mgr;
+    ctx.rounds = 200;
+    ctx.errors = 0;
+    Thread *readers[3];
+    for (int i = 0; i < 3; i++) {
+        readers[i] = thread_create(reader_thread, &ctx);
+        ASSERT_NE(readers[i], nullptr);
+    }
+    
+    for (int i = 0; i < 500; i++) {
+        employee_manager_add(mgr, "李四", "市场部", "2024-01-20", 1);
+        employee_manager_update(mgr, 1001 + i, "王五", "财务部", "2024-01-21", 1);
+        employee_manager_remove_at(mgr, (size_t)(i * 3) % mgr->employees->size);
+    }
+    
+    for (int i = 0; i < 3; i++) {
+        thread_join(readers[i]);
+    }
+    EXPECT_EQ(ctx.errors, 0);
+    expect_view_matches(mgr);
+    
+    employee_manager_free(mgr);
+}
+
+// 测试快照在后续修改后保持不变
+TEST(EmployeeManagerTest, SnapshotIsImmutable) {
+    EmployeeManager *mgr = employee_manager_create();
+    ASSERT_NE(mgr, nullptr);
+    
+    employee_manager_add(mgr, "张三", "研发部", "2024-01-15", 22);
+    employee_manager_add(mgr, "李四", "市场部", "2024-01-16", 23);
+    
+    // 快照不会隐式切换模式
+    EXPECT_EQ(employee_manager_snapshot(mgr), nullptr);
+    EXPECT_EQ(mgr->concurrent, FALSE);
+    ASSERT_EQ(employee_manager_enable_concurrency(mgr), SUCCESS);
+    
+    EmployeeSnapshot *snap = employee_manager_snapshot(mgr);
+    ASSERT_NE(snap, nullptr);
+    EXPECT_EQ(snap->version, mgr->generation);
+    
+    employee_manager_update(mgr, 1001, "张三丰", "武当派", "2024-02-01", 28);
+    employee_manager_remove_by_id(mgr, 1002);
+    employee_manager_add(mgr, "王五", "财务部", "2024-01-17", 24);
+    
+    ASSERT_EQ(employee_snapshot_size(snap), 2u);
+    EXPECT_STREQ(employee_snapshot_get(snap, 0)->name, "张三");
+    EXPECT_STREQ(employee_snapshot_get(snap, 1)->name, "李四");
+    EXPECT_EQ(employee_snapshot_get(snap, 2), nullptr);
+    EXPECT_LT(snap->version, mgr->generation);
+    
+    // 新快照看到最新数据
+    EmployeeSnapshot *latest = employee_manager_snapshot(mgr);
+    ASSERT_NE(latest, nullptr);
+    ASSERT_EQ(employee_snapshot_size(latest), 2u);
+    EXPECT_STREQ(employee_snapshot_get(latest, 0)->name, "张三丰");
+    EXPECT_STREQ(employee_snapshot_get(latest, 1)->name, "王五");
+    
+    employee_snapshot_release(snap);
+    employee_snapshot_release(latest);
+    employee_snapshot_release(nullptr);  // 不应该崩溃
+    EXPECT_EQ(employee_manager_snapshot(nullptr), nullptr);
+    
+    employee_manager_free(mgr);
+}
+
+// 测试变更跟踪: 修改、追加、删除分别标记对应的块
+TEST(EmployeeManagerTest, DirtyBlockTracking) {
+    EmployeeManager *mgr = employee_manager_create();
+    for (int i = 0; i < DIRTY_BLOCK_RECORDS * 3; i++) {
+        employee_manager_add(mgr, "员工", "研发部", "2024-01-15", 1);
+    }
+    
+    // 没有同步基线时不跟踪
+    EmployeeChanges changes;
+    ASSERT_EQ(employee_manager_changes(mgr, &changes), SUCCESS);
+    EXPECT_EQ(changes.stamp, 0u);
+    employee_changes_free(&changes);
+    
+    employee_manager_mark_synced(mgr, mgr->generation, 42);
+    ASSERT_EQ(employee_manager_changes(mgr, &changes), SUCCESS);
+    EXPECT_EQ(changes.stamp, 42u);
+    EXPECT_EQ(changes.synced_size, (size_t)DIRTY_BLOCK_RECORDS * 3);
+    for (size_t b = 0; b < 3; b++) {
+        EXPECT_FALSE(employee_changes_dirty(&changes, b));
+    }
+    employee_changes_free(&changes);
+    
+    // 修改第二块中的一条,并追加一条到第四块
+    employee_manager_update(mgr, 1001 + DIRTY_BLOCK_RECORDS + 7, "改名", "研发部", "2024-01-15", 2);
+    employee_manager_add(mgr, "新人", "市场部", "2024-01-16", 3);
+    ASSERT_EQ(employee_manager_changes(mgr, &changes), SUCCESS);
+    EXPECT_EQ(changes.version, mgr->generation);
+    EXPECT_FALSE(employee_changes_dirty(&changes, 0));
+    EXPECT_TRUE(employee_changes_dirty(&changes, 1));
+    EXPECT_FALSE(employee_changes_dirty(&changes, 2));
+    EXPECT_TRUE(employee_changes_dirty(&changes, 3));
+    employee_changes_free(&changes);
+    
+    // 删除使其后所有位置移动
+    employee_manager_remove_at(mgr, DIRTY_BLOCK_RECORDS * 2 + 1);
+    ASSERT_EQ(employee_manager_changes(mgr, &changes), SUCCESS);
+    EXPECT_FALSE(employee_changes_dirty(&changes, 0));
+    EXPECT_TRUE(employee_changes_dirty(&changes, 2));
+    employee_changes_free(&changes);
+    
+    // 同步后清零;以过时的版本同步时放弃基线
+    employee_manager_mark_synced(mgr, mgr->generation, 43);
+    ASSERT_EQ(employee_manager_changes(mgr, &changes), SUCCESS);
+    EXPECT_FALSE(employee_changes_dirty(&changes, 1));
+    EXPECT_FALSE(employee_changes_dirty(&changes, 2));
+    employee_changes_free(&changes);
+    // 批量写入可能改动任意位置
+    employee_manager_begin_write(mgr);
+    employee_manager_end_write(mgr);
+    ASSERT_EQ(employee_manager_changes(mgr, &changes), SUCCESS);
+    EXPECT_TRUE(employee_changes_dirty(&changes, 0));
+    employee_changes_free(&changes);
+    employee_manager_mark_synced(mgr, mgr->generation - 1, 44);
+    ASSERT_EQ(employee_manager_changes(mgr, &changes), SUCCESS);
+    EXPECT_EQ(changes.stamp, 0u);
+    employee_changes_free(&changes);
+    
+    employee_manager_free(mgr);
+}
+
+// 测试重复查询由缓存回答,增删改后失效
+TEST(EmployeeManagerTest, QueryCacheInvalidatedByWrites) {
+    EmployeeManager *mgr = employee_manager_create();
+    for (int i = 0; i < 100; i++) {
+        employee_manager_add(mgr, "张三", (i % 2) ? "研发部" : "市场部", "2024-01-15", 10);
+    }
+
+    QueryCacheStats before = {};
+    query_cache_stats(mgr->cache, &before);
+    for (int round = 0; round < 3; round++) {
+        Vector *results = employee_manager_search(mgr, SEARCH_BY_DEPARTMENT, "研发部");
+        ASSERT_NE(results, nullptr);
+        EXPECT_EQ(results->size, 50u);
+        vector_free(results);
+        EXPECT_EQ(employee_manager_monthly_attendance(mgr, "2024-01"), 1000);
+    }
+    QueryCacheStats after = {};
+    query_cache_stats(mgr->cache, &after);
+    EXPECT_EQ(after.hits - before.hits, 4u);
+
+    // 修改: 部门与出勤统计都应反映新数据
+    ASSERT_EQ(employee_manager_update(mgr, 1001, "张三", "研发部", "2024-01-15", 20), SUCCESS);
+    Vector *results = employee_manager_search(mgr, SEARCH_BY_DEPARTMENT, "研发部");
+    EXPECT_EQ(results->size, 51u);
+    vector_free(results);
+    EXPECT_EQ(employee_manager_monthly_attendance(mgr, "2024-01"), 1010);
+
+    ASSERT_EQ(employee_manager_add(mgr, "李四", "研发部", "2024-01-20", 5), SUCCESS);
+    EXPECT_EQ(employee_manager_monthly_attendance(mgr, "2024-01"), 1015);
+    int id = 1101;
+    results = employee_manager_search(mgr, SEARCH_BY_ID, &id);
+    ASSERT_EQ(results->size, 1u);
+    EXPECT_STREQ(((Employee *)results->data[0])->name, "李四");
+    vector_free(results);
+
+    ASSERT_EQ(employee_manager_remove_by_id(mgr, 1101), SUCCESS);
+    EXPECT_EQ(employee_manager_monthly_attendance(mgr, "2024-01"), 1010);
+    results = employee_manager_search(mgr, SEARCH_BY_ID, &id);
+    EXPECT_EQ(results->size, 0u);
+    vector_free(results);
+
+    employee_manager_free(mgr);
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+extern "C" {
+    #include "../pager.h"
+}
+
+// 测试用页加载器: 页内容为页号,记录加载顺序
+struct FakeDisk {
+    std::vector<size_t> loads;
+    size_t fail_page = (size_t)-1;
+};
+
+static ErrorCode fake_load(void *ctx, size_t page, void *buffer, size_t *size) {
+    FakeDisk *disk = (FakeDisk *)ctx;
+    if (page == disk->fail_page) {
+        return ERROR_FILE_READ_FAILED;
+    }
+    disk->loads.push_back(page);
+    memcpy(buffer, &page, sizeof(page));
+    *size = sizeof(page);
+    return SUCCESS;
+}
+
+static size_t page_value(const PageHandle &handle) {
+    size_t value = 0;
+    memcpy(&value, handle.data, sizeof(value));
+    return value;
+}
+
+// 测试创建参数检查
+TEST(PagerTest, CreateAndFree) {
+    FakeDisk disk;
+    EXPECT_EQ(buffer_pool_create(0, 64, fake_load, &disk), nullptr);
+    EXPECT_EQ(buffer_pool_create(4, 0, fake_load, &disk), nullptr);
+    EXPECT_EQ(buffer_pool_create(4, 64, nullptr, &disk), nullptr);
+
+    BufferPool *pool = buffer_pool_create(4, 64, fake_load, &disk);
+    ASSERT_NE(pool, nullptr);
+    buffer_pool_free(pool);
+    buffer_pool_free(nullptr);  // 不应该崩溃
+}
+
+// 测试命中与未命中统计
+TEST(PagerTest, HitsAndMisses) {
+    FakeDisk disk;
+    BufferPool *pool = buffer_pool_create(4, 64, fake_load, &disk);
+    ASSERT_NE(pool, nullptr);
+
+    PageHandle handle;
+    for (int round = 0; round < 3; round++) {
+        for (size_t page = 0; page < 4; page++) {
+            ASSERT_EQ(buffer_pool_pin(pool, page, &handle), SUCCESS);
+            EXPECT_EQ(page_value(handle), page);
+            EXPECT_EQ(handle.size, sizeof(size_t));
+            buffer_pool_unpin(pool, &handle);
+        }
+    }
+
+    BufferPoolStats stats = {};
+    buffer_pool_stats(pool, &stats);
+    EXPECT_EQ(stats.misses, 4u);
+    EXPECT_EQ(stats.hits, 8u);
+    EXPECT_EQ(stats.evictions, 0u);
+    EXPECT_EQ(disk.loads.size(), 4u);
+    buffer_pool_free(pool);
+}
+
+// 测试CLOCK淘汰: 最近被访问的页获得第二次机会
+TEST(PagerTest, ClockEviction) {
+    FakeDisk disk;
+    BufferPool *pool = buffer_pool_create(3, 64, fake_load, &disk);
+    ASSERT_NE(pool, nullptr);
+
+    PageHandle handle;
+    for (size_t page = 0; page < 3; page++) {
+        ASSERT_EQ(buffer_pool_pin(pool, page, &handle), SUCCESS);
+        buffer_pool_unpin(pool, &handle);
+    }
+
+    // 全部引用位为1: 第一圈清零,第二圈淘汰页0
+    ASSERT_EQ(buffer_pool_pin(pool, 3, &handle), SUCCESS);
+    buffer_pool_unpin(pool, &handle);
+    // 再次访问页1,使其引用位置1;下一次淘汰应跳过页1选中页2
+    ASSERT_EQ(buffer_pool_pin(pool, 1, &handle), SUCCESS);
+    buffer_pool_unpin(pool, &handle);
+    ASSERT_EQ(buffer_pool_pin(pool, 4, &handle), SUCCESS);
+    buffer_pool_unpin(pool, &handle);
+
+    size_t loads_before = disk.loads.size();
+    ASSERT_EQ(buffer_pool_pin(pool, 1, &handle), SUCCESS);  // 仍在缓存中
+    buffer_pool_unpin(pool, &handle);
+    EXPECT_EQ(disk.loads.size(), loads_before);
+    ASSERT_EQ(buffer_pool_pin(pool, 2, &handle), SUCCESS);  // 已被淘汰
+    buffer_pool_unpin(pool, &handle);
+    EXPECT_EQ(disk.loads.size(), loads_before + 1);
+
+    BufferPoolStats stats = {};
+    buffer_pool_stats(pool, &stats);
+    EXPECT_EQ(stats.evictions, 3u);
+    buffer_pool_free(pool);
+}
+
+// 测试钉住的页不会被淘汰,全部钉住时返回错误
+TEST(PagerTest, PinnedPagesStay) {
+    FakeDisk disk;
+    BufferPool *pool = buffer_pool_create(2, 64, fake_load, &disk);
+    ASSERT_NE(pool, nullptr);
+
+    PageHandle a;
+    PageHandle b;
+    PageHandle c;
+    ASSERT_EQ(buffer_pool_pin(pool, 10, &a), SUCCESS);
+    ASSERT_EQ(buffer_pool_pin(pool, 11, &b), SUCCESS);
+    EXPECT_EQ(buffer_pool_pin(pool, 12, &c), ERROR_OUT_OF_MEMORY);
+
+    // 释放b后页12只能替换b,a的内容保持不变
+    buffer_pool_unpin(pool, &b);
+    ASSERT_EQ(buffer_pool_pin(pool, 12, &c), SUCCESS);
+    EXPECT_EQ(page_value(a), 10u);
+    EXPECT_EQ(page_value(c), 12u);
+
+    // 同一页可以重复钉住
+    PageHandle again;
+    ASSERT_EQ(buffer_pool_pin(pool, 10, &again), SUCCESS);
+    EXPECT_EQ(again.data, a.data);
+    buffer_pool_unpin(pool, &again);
+    buffer_pool_unpin(pool, &a);
+    buffer_pool_unpin(pool, &c);
+    buffer_pool_free(pool);
+}
+
+// 测试加载失败时返回错误且不留下无效页
+TEST(PagerTest, LoadFailure) {
+    FakeDisk disk;
+    disk.fail_page = 7;
+    BufferPool *pool = buffer_pool_create(2, 64, fake_load, &disk);
+    ASSERT_NE(pool, nullptr);
+
+    PageHandle handle;
+    EXPECT_EQ(buffer_pool_pin(pool, 7, &handle), ERROR_FILE_READ_FAILED);
+    disk.fail_page = (size_t)-1;
+    ASSERT_EQ(buffer_pool_pin(pool, 7, &handle), SUCCESS);
+    EXPECT_EQ(page_value(handle), 7u);
+    buffer_pool_unpin(pool, &handle);
+
+    EXPECT_EQ(buffer_pool_pin(nullptr, 0, &handle), ERROR_NULL_POINTER);
+    EXPECT_EQ(buffer_pool_pin(pool, 0, nullptr), ERROR_NULL_POINTER);
+    buffer_pool_free(pool);
+}
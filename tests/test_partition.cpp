@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#if defined(_WIN32)
+    #include <direct.h>
+    #define mkdir_for_test(path) _mkdir(path)
+    #define rmdir_for_test(path) _rmdir(path)
+#else
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define mkdir_for_test(path) mkdir(path, 0755)
+    #define rmdir_for_test(path) rmdir(path)
+#endif
+extern "C" {
+    #include "../partition.h"
+    #include "../storage.h"
+}
+
+static const char *TEST_BASE = "test_partitioned";
+
+class PartitionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        cleanup();
+    }
+
+    void TearDown() override {
+        cleanup();
+    }
+
+    void cleanup() {
+        char path[64];
+        snprintf(path, sizeof(path), "%s.manifest", TEST_BASE);
+        std::remove(path);
+        for (int year = 0; year <= 2030; year += (year == 0) ? 2020 : 1) {
+            snprintf(path, sizeof(path), "%s.%04d.db", TEST_BASE, year);
+            std::remove(path);
+        }
+    }
+
+    // 2022~2024三年,每年每月各一条,出勤天数为月份
+    void write_history() {
+        EmployeeManager *mgr = employee_manager_create();
+        for (int year = 2022; year <= 2024; year++) {
+            for (int month = 1; month <= 12; month++) {
+                char date[MAX_DATE_LEN];
+                snprintf(date, sizeof(date), "%04d-%02d-10", year, month);
+                employee_manager_add(mgr, "员工", (month % 2) ? "研发部" : "市场部", date, month);
+            }
+        }
+        employee_manager_add(mgr, "无日期", "研发部", "", 5);
+        ASSERT_EQ(partition_save_manager(TEST_BASE, mgr), SUCCESS);
+        employee_manager_free(mgr);
+    }
+};
+
+// 测试打开时不加载分区,统计直接使用清单汇总
+TEST_F(PartitionTest, StatisticsFromManifest) {
+    write_history();
+
+    ErrorCode err = SUCCESS;
+    PartitionStore *store = partition_store_open(TEST_BASE, &err);
+    ASSERT_NE(store, nullptr);
+    ASSERT_EQ(store->count, 4u);  // 年份0 + 2022~2024
+    EXPECT_EQ(store->manager->employees->size, 0u);
+    EXPECT_EQ(store->manager->next_id, 1001 + 37);
+
+    EXPECT_EQ(partition_store_yearly_attendance(store, "2023"), 78);
+    EXPECT_EQ(partition_store_monthly_attendance(store, "2023-07"), 7);
+    EXPECT_EQ(partition_store_yearly_attendance(store, "2019"), 0);
+    EXPECT_EQ(store->manager->employees->size, 0u);
+
+    // 清单无法回答的前缀会加载全部分区
+    EXPECT_EQ(partition_store_monthly_attendance(store, "2023-1"), 10 + 11 + 12);
+    EXPECT_EQ(store->manager->employees->size, 37u);
+
+    partition_store_free(store);
+}
+
+// 测试查询按需加载分区
+TEST_F(PartitionTest, LazyLoadOnQuery) {
+    write_history();
+    PartitionStore *store = partition_store_open(TEST_BASE, nullptr);
+    ASSERT_NE(store, nullptr);
+
+    // 2023年的第一条记录工号为1001+12
+    int id = 1013;
+    Vector *result = partition_store_search(store, SEARCH_BY_ID, &id);
+    ASSERT_NE(result, nullptr);
+    ASSERT_EQ(result->size, 1u);
+    EXPECT_STREQ(((Employee *)result->data[0])->attend_date, "2023-01-10");
+    vector_free(result);
+    EXPECT_TRUE(partition_store_is_loaded(store, 2023));
+    EXPECT_FALSE(partition_store_is_loaded(store, 2022));
+    EXPECT_FALSE(partition_store_is_loaded(store, 2024));
+    EXPECT_EQ(store->manager->employees->size, 12u);
+
+    // 已加载分区的修改反映在统计中,未加载分区仍用汇总
+    Employee *emp = (Employee *)store->manager->employees->data[0];
+    ASSERT_EQ(employee_manager_update(store->manager, emp->id, emp->name, emp->department,
+                                      emp->attend_date, 100), SUCCESS);
+    EXPECT_EQ(partition_store_yearly_attendance(store, "2023"), 78 - 1 + 100);
+    EXPECT_EQ(partition_store_yearly_attendance(store, "2024"), 78);
+
+    result = partition_store_search(store, SEARCH_BY_DEPARTMENT, "研发部");
+    ASSERT_NE(result, nullptr);
+    EXPECT_EQ(result->size, 19u);
+    vector_free(result);
+    EXPECT_TRUE(partition_store_is_loaded(store, 2022));
+
+    partition_store_free(store);
+}
+
+// 测试保存只重写已加载的分区,跨年修改会先加载目标分区
+TEST_F(PartitionTest, SaveRewritesLoadedPartitions) {
+    write_history();
+    PartitionStore *store = partition_store_open(TEST_BASE, nullptr);
+    ASSERT_NE(store, nullptr);
+    ASSERT_EQ(partition_store_load_year(store, 2023), SUCCESS);
+
+    // 一条2023年的记录改到2024年,另加一条2025年的新记录
+    Employee *emp = (Employee *)store->manager->employees->data[0];
+    ASSERT_EQ(employee_manager_update(store->manager, emp->id, emp->name, emp->department,
+                                      "2024-12-31", 1), SUCCESS);
+    ASSERT_EQ(employee_manager_add(store->manager, "新人", "人事部", "2025-01-02", 3), SUCCESS);
+    EXPECT_EQ(((Employee *)store->manager->employees->data[12])->id, 1001 + 37);
+    ASSERT_EQ(partition_store_save(store), SUCCESS);
+    EXPECT_FALSE(partition_store_is_loaded(store, 2022));
+    EXPECT_TRUE(partition_store_is_loaded(store, 2024));
+    partition_store_free(store);
+
+    store = partition_store_open(TEST_BASE, nullptr);
+    ASSERT_NE(store, nullptr);
+    ASSERT_EQ(store->count, 5u);
+    EXPECT_EQ(partition_store_yearly_attendance(store, "2023"), 78 - 1);
+    EXPECT_EQ(partition_store_yearly_attendance(store, "2024"), 78 + 1);
+    EXPECT_EQ(partition_store_monthly_attendance(store, "2024-12"), 13);
+    EXPECT_EQ(partition_store_yearly_attendance(store, "2025"), 3);
+    EXPECT_EQ(store->manager->next_id, 1001 + 38);
+    ASSERT_EQ(partition_store_load_all(store), SUCCESS);
+    EXPECT_EQ(store->manager->employees->size, 38u);
+    partition_store_free(store);
+}
+
+// 测试分区文件写出后、清单提交前失败: 不删除任何分区文件,旧清单仍可完整加载
+TEST_F(PartitionTest, SaveFailureKeepsOldManifestLoadable) {
+    write_history();
+    PartitionStore *store = partition_store_open(TEST_BASE, nullptr);
+    ASSERT_NE(store, nullptr);
+    ASSERT_EQ(partition_store_load_year(store, 2022), SUCCESS);
+
+    // 2022年的记录全部改到2023年,2022分区将被清空
+    for (size_t i = 0; i < 12; i++) {
+        Employee *emp = (Employee *)store->manager->employees->data[i];
+        ASSERT_EQ(employee_manager_update(store->manager, emp->id, emp->name, emp->department,
+                                          "2023-06-01", 1), SUCCESS);
+    }
+
+    // 清单的临时文件路径被目录占用,写清单失败
+    char blocker[64];
+    snprintf(blocker, sizeof(blocker), "%s.manifest.tmp", TEST_BASE);
+    ASSERT_EQ(mkdir_for_test(blocker), 0);
+    EXPECT_NE(partition_store_save(store), SUCCESS);
+    rmdir_for_test(blocker);
+    partition_store_free(store);
+
+    store = partition_store_open(TEST_BASE, nullptr);
+    ASSERT_NE(store, nullptr);
+    ASSERT_EQ(store->count, 4u);
+    EXPECT_EQ(partition_store_yearly_attendance(store, "2022"), 78);
+    ASSERT_EQ(partition_store_load_year(store, 2022), SUCCESS);
+    EXPECT_EQ(partition_store_load_all(store), SUCCESS);
+    partition_store_free(store);
+}
+
+// 测试清单损坏时打开失败
+TEST_F(PartitionTest, CorruptManifest) {
+    write_history();
+    char path[64];
+    snprintf(path, sizeof(path), "%s.manifest", TEST_BASE);
+    FILE *fp = fopen(path, "r+b");
+    ASSERT_NE(fp, nullptr);
+    fseek(fp, (long)(sizeof(FileHeader) + sizeof(int) + 4), SEEK_SET);
+    fputc(0x55, fp);
+    fclose(fp);
+
+    ErrorCode err = SUCCESS;
+    EXPECT_EQ(partition_store_open(TEST_BASE, &err), nullptr);
+    EXPECT_EQ(err, ERROR_DATA_CORRUPTION);
+}
@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include <cstring>
+extern "C" {
+    #include "../query_cache.h"
+    #include "../thread.h"
+}
+
+static void put_items(QueryCache *cache, int type, const char *key, unsigned long version,
+                      size_t count) {
+    Vector *results = vector_create();
+    for (size_t i = 0; i < count; i++) {
+        vector_push_back(results, (void *)(i + 1));
+    }
+    query_cache_put_results(cache, type, key, strlen(key), version, results);
+    vector_free(results);
+}
+
+static Bool has(QueryCache *cache, int type, const char *key, unsigned long version) {
+    Vector *out = vector_create();
+    Bool hit = query_cache_get_results(cache, type, key, strlen(key), version, out);
+    vector_free(out);
+    return hit;
+}
+
+// 测试命中返回存入的结果,类型和关键字共同构成键
+TEST(QueryCacheTest, HitAndMiss) {
+    QueryCache *cache = query_cache_create(8, 1024);
+    ASSERT_NE(cache, nullptr);
+    EXPECT_FALSE(has(cache, 1, "研发部", 0));
+    put_items(cache, 1, "研发部", 0, 3);
+
+    Vector *out = vector_create();
+    ASSERT_TRUE(query_cache_get_results(cache, 1, "研发部", strlen("研发部"), 0, out));
+    ASSERT_EQ(out->size, 3u);
+    EXPECT_EQ(out->data[2], (void *)3);
+    vector_free(out);
+
+    EXPECT_FALSE(has(cache, 2, "研发部", 0));
+    EXPECT_FALSE(has(cache, 1, "市场部", 0));
+
+    // 空结果同样缓存
+    put_items(cache, 1, "无此部门", 0, 0);
+    EXPECT_TRUE(has(cache, 1, "无此部门", 0));
+
+    long long value = 0;
+    EXPECT_FALSE(query_cache_get_number(cache, 3, "2024-01", 7, 0, &value));
+    query_cache_put_number(cache, 3, "2024-01", 7, 0, 12345);
+    ASSERT_TRUE(query_cache_get_number(cache, 3, "2024-01", 7, 0, &value));
+    EXPECT_EQ(value, 12345);
+
+    QueryCacheStats stats = {};
+    query_cache_stats(cache, &stats);
+    EXPECT_EQ(stats.hits, 3u);
+    EXPECT_EQ(stats.misses, 4u);
+    EXPECT_EQ(stats.entries, 3u);
+    EXPECT_EQ(stats.pointers, 3u);
+
+    query_cache_free(cache);
+    query_cache_free(nullptr);  // 不应该崩溃
+}
+
+// 测试代数前进后旧项全部失效,旧视图既不命中也不写入
+TEST(QueryCacheTest, VersionInvalidates) {
+    QueryCache *cache = query_cache_create(8, 1024);
+    put_items(cache, 1, "a", 5, 2);
+    EXPECT_TRUE(has(cache, 1, "a", 5));
+    EXPECT_FALSE(has(cache, 1, "a", 6));
+
+    QueryCacheStats stats = {};
+    query_cache_stats(cache, &stats);
+    EXPECT_EQ(stats.entries, 0u);
+
+    put_items(cache, 1, "b", 4, 2);
+    EXPECT_FALSE(has(cache, 1, "b", 4));
+    put_items(cache, 1, "b", 6, 2);
+    EXPECT_TRUE(has(cache, 1, "b", 6));
+    query_cache_free(cache);
+}
+
+// 测试按项数和指针总数淘汰最久未用的项
+TEST(QueryCacheTest, EvictsLeastRecentlyUsed) {
+    QueryCache *cache = query_cache_create(3, 10);
+    put_items(cache, 1, "a", 0, 1);
+    put_items(cache, 1, "b", 0, 1);
+    put_items(cache, 1, "c", 0, 1);
+    EXPECT_TRUE(has(cache, 1, "a", 0));  // a变为最近使用
+    put_items(cache, 1, "d", 0, 1);
+    EXPECT_TRUE(has(cache, 1, "a", 0));
+    EXPECT_FALSE(has(cache, 1, "b", 0));
+    EXPECT_TRUE(has(cache, 1, "c", 0));
+    EXPECT_TRUE(has(cache, 1, "d", 0));
+
+    // 指针预算: 大结果挤出旧项,超过预算的结果不缓存
+    put_items(cache, 1, "big", 0, 8);
+    QueryCacheStats stats = {};
+    query_cache_stats(cache, &stats);
+    EXPECT_LE(stats.pointers, 10u);
+    EXPECT_TRUE(has(cache, 1, "big", 0));
+    put_items(cache, 1, "huge", 0, 11);
+    EXPECT_FALSE(has(cache, 1, "huge", 0));
+
+    // 同一键再次存入时替换旧结果
+    put_items(cache, 1, "big", 0, 2);
+    Vector *out = vector_create();
+    ASSERT_TRUE(query_cache_get_results(cache, 1, "big", 3, 0, out));
+    EXPECT_EQ(out->size, 2u);
+    vector_free(out);
+
+    query_cache_clear(cache);
+    query_cache_stats(cache, &stats);
+    EXPECT_EQ(stats.entries, 0u);
+    EXPECT_EQ(stats.pointers, 0u);
+    query_cache_free(cache);
+}
+
+// 测试过长的关键字不缓存
+TEST(QueryCacheTest, LongKeyNotCached) {
+    QueryCache *cache = query_cache_create(4, 16);
+    char key[QUERY_CACHE_KEY_MAX + 2];
+    memset(key, 'x', sizeof(key) - 1);
+    key[sizeof(key) - 1] = '\0';
+    put_items(cache, 1, key, 0, 1);
+    EXPECT_FALSE(has(cache, 1, key, 0));
+    query_cache_free(cache);
+}
+
+// 并发读写: 命中的结果必须完整,淘汰中的项不能被读者看到半截
+struct CacheStressCtx {
+    QueryCache *cache;
+    volatile long stop;
+    volatile long bad;
+    volatile long hits;
+};
+
+static void cache_reader_thread(void *arg) {
+    CacheStressCtx *ctx = (CacheStressCtx *)arg;
+    Vector *out = vector_create();
+    while (atomic_long_load(&ctx->stop) == 0) {
+        vector_clear(out);
+        if (query_cache_get_results(ctx->cache, 1, "研发部", strlen("研发部"), 0, out)) {
+            atomic_long_add(&ctx->hits, 1);
+            if (out->size != 200 || out->data[0] != (void *)1 || out->data[199] != (void *)200) {
+                atomic_long_store(&ctx->bad, 1);
+            }
+        }
+    }
+    vector_free(out);
+}
+
+TEST(QueryCacheTest, ConcurrentReadersSeeWholeEntries) {
+    // 容量只够两项,写者不断存入新项会反复淘汰读者正在复制的项
+    QueryCache *cache = query_cache_create(2, 400);
+    ASSERT_NE(cache, nullptr);
+    CacheStressCtx ctx = {cache, 0, 0, 0};
+
+    Thread *readers[4];
+    for (int i = 0; i < 4; i++) {
+        readers[i] = thread_create(cache_reader_thread, &ctx);
+        ASSERT_NE(readers[i], nullptr);
+    }
+    char key[16];
+    for (int round = 0; round < 2000; round++) {
+        put_items(cache, 1, "研发部", 0, 200);
+        snprintf(key, sizeof(key), "部门%d", round % 3);
+        put_items(cache, 1, key, 0, 200);
+    }
+    atomic_long_store(&ctx.stop, 1);
+    for (int i = 0; i < 4; i++) {
+        thread_join(readers[i]);
+    }
+
+    EXPECT_EQ(ctx.bad, 0);
+    QueryCacheStats stats = {};
+    query_cache_stats(cache, &stats);
+    EXPECT_EQ(stats.hits, (unsigned long long)ctx.hits);
+    query_cache_free(cache);
+}
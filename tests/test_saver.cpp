@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+extern "C" {
+    #include "../saver.h"
+    #include "../storage.h"
+}
+
+static const char *TEST_SAVER_FILE = "test_saver.db";
+
+class SaverTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::remove(TEST_SAVER_FILE);
+    }
+
+    void TearDown() override {
+        std::remove(TEST_SAVER_FILE);
+    }
+};
+
+// 测试创建和释放
+TEST_F(SaverTest, CreateAndFree) {
+    BackgroundSaver *saver = background_saver_create();
+    ASSERT_NE(saver, nullptr);
+    EXPECT_FALSE(background_saver_busy(saver));
+    EXPECT_FALSE(background_saver_poll(saver, nullptr));
+    EXPECT_EQ(background_saver_wait(saver), SUCCESS);
+    background_saver_free(saver);
+    background_saver_free(nullptr);  // 不应该崩溃
+}
+
+// 测试后台保存结果与快照一致,期间修改不影响输出
+TEST_F(SaverTest, SaveInBackground) {
+    EmployeeManager *mgr = employee_manager_create();
+    for (int i = 0; i < 3000; i++) {
+        employee_manager_add(mgr, "张三", "研发部", "2024-01-15", i % 31);
+    }
+    ASSERT_EQ(employee_manager_enable_concurrency(mgr), SUCCESS);
+
+    BackgroundSaver *saver = background_saver_create();
+    ASSERT_NE(saver, nullptr);
+    EXPECT_EQ(background_saver_submit(saver, mgr, TEST_SAVER_FILE), SUCCESS);
+
+    // 提交后继续修改
+    for (int i = 0; i < 100; i++) {
+        employee_manager_add(mgr, "李四", "市场部", "2024-01-16", 1);
+    }
+
+    EXPECT_EQ(background_saver_wait(saver), SUCCESS);
+    EXPECT_FALSE(background_saver_busy(saver));
+
+    SaveResult result;
+    ASSERT_TRUE(background_saver_poll(saver, &result));
+    EXPECT_EQ(result.error, SUCCESS);
+    EXPECT_EQ(result.count, 3000u);
+    EXPECT_FALSE(background_saver_poll(saver, &result));  // 结果只取回一次
+
+    EmployeeManager *loaded = employee_manager_create();
+    EXPECT_EQ(storage_load_employees(TEST_SAVER_FILE, loaded), SUCCESS);
+    EXPECT_EQ(loaded->employees->size, 3000u);
+
+    background_saver_free(saver);
+    employee_manager_free(loaded);
+    employee_manager_free(mgr);
+}
+
+// 测试连续提交时最终文件反映最新状态
+TEST_F(SaverTest, LatestSubmissionWins) {
+    EmployeeManager *mgr = employee_manager_create();
+    ASSERT_EQ(employee_manager_enable_concurrency(mgr), SUCCESS);
+    BackgroundSaver *saver = background_saver_create();
+    ASSERT_NE(saver, nullptr);
+
+    for (int i = 0; i < 20; i++) {
+        employee_manager_add(mgr, "王五", "人事部", "2024-02-01", 5);
+        EXPECT_EQ(background_saver_submit(saver, mgr, TEST_SAVER_FILE), SUCCESS);
+    }
+    EXPECT_EQ(background_saver_wait(saver), SUCCESS);
+
+    EmployeeManager *loaded = employee_manager_create();
+    EXPECT_EQ(storage_load_employees(TEST_SAVER_FILE, loaded), SUCCESS);
+    EXPECT_EQ(loaded->employees->size, 20u);
+
+    background_saver_free(saver);
+    employee_manager_free(loaded);
+    employee_manager_free(mgr);
+}
+
+// 测试写入失败的结果被报告
+TEST_F(SaverTest, ReportsFailure) {
+    EmployeeManager *mgr = employee_manager_create();
+    employee_manager_add(mgr, "张三", "研发部", "2024-01-15", 22);
+    BackgroundSaver *saver = background_saver_create();
+    ASSERT_NE(saver, nullptr);
+
+    // 未启用并发模式的管理器不能取快照
+    EXPECT_EQ(background_saver_submit(saver, mgr, TEST_SAVER_FILE), ERROR_INVALID_PARAMETER);
+    ASSERT_EQ(employee_manager_enable_concurrency(mgr), SUCCESS);
+
+    EXPECT_EQ(background_saver_submit(saver, mgr, "/nonexistent_dir/test.db"), SUCCESS);
+    EXPECT_EQ(background_saver_wait(saver), ERROR_FILE_WRITE_FAILED);
+
+    SaveResult result;
+    ASSERT_TRUE(background_saver_poll(saver, &result));
+    EXPECT_EQ(result.error, ERROR_FILE_WRITE_FAILED);
+
+    EXPECT_EQ(background_saver_submit(nullptr, mgr, TEST_SAVER_FILE), ERROR_NULL_POINTER);
+    EXPECT_EQ(background_saver_submit(saver, nullptr, TEST_SAVER_FILE), ERROR_NULL_POINTER);
+
+    background_saver_free(saver);
+    employee_manager_free(mgr);
+}
@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <vector>
 extern "C" {
     #include "../sort.h"
     #include "../vector.h"
@@ -168,3 +169,67 @@ TEST(SortTest, QuickSortLargeData) {
     delete[] data;
     vector_free(v);
 }
+
+// 用败者树归并若干有序数组,返回归并后的元素指针序列
+static std::vector<int *> merge_with_loser_tree(std::vector<std::vector<int> > &runs) {
+    std::vector<int *> merged;
+    std::vector<size_t> pos(runs.size(), 0);
+    std::vector<void *> heads(runs.size());
+    for (size_t r = 0; r < runs.size(); r++) {
+        heads[r] = runs[r].empty() ? nullptr : &runs[r][0];
+    }
+    
+    LoserTree *tree = loser_tree_create(runs.size(), int_comparator);
+    EXPECT_NE(tree, nullptr);
+    if (tree == nullptr) {
+        return merged;
+    }
+    loser_tree_build(tree, heads.data());
+    size_t run;
+    while ((run = loser_tree_top(tree)) != LOSER_TREE_EMPTY) {
+        merged.push_back((int *)loser_tree_top_item(tree));
+        pos[run]++;
+        loser_tree_replace(tree, (pos[run] < runs[run].size()) ? &runs[run][pos[run]] : nullptr);
+    }
+    loser_tree_free(tree);
+    return merged;
+}
+
+// 测试败者树参数检查
+TEST(SortTest, LoserTreeCreate) {
+    EXPECT_EQ(loser_tree_create(0, int_comparator), nullptr);
+    EXPECT_EQ(loser_tree_create(4, nullptr), nullptr);
+    loser_tree_free(nullptr);  // 不应该崩溃
+    EXPECT_EQ(loser_tree_top(nullptr), LOSER_TREE_EMPTY);
+}
+
+// 测试不同路数(含非2的幂与空路)的归并结果有序且不丢元素
+TEST(SortTest, LoserTreeMergesRuns) {
+    for (size_t k = 1; k <= 9; k++) {
+        std::vector<std::vector<int> > runs(k);
+        size_t total = 0;
+        for (size_t r = 0; r < k; r++) {
+            size_t length = (r == 2) ? 0 : 50 + r * 13;  // 第3路为空
+            for (size_t i = 0; i < length; i++) {
+                runs[r].push_back((int)((i * 7 + r * 3) % 97 + i * 100));
+            }
+            total += length;
+        }
+        
+        std::vector<int *> merged = merge_with_loser_tree(runs);
+        ASSERT_EQ(merged.size(), total);
+        for (size_t i = 1; i < merged.size(); i++) {
+            EXPECT_LE(*merged[i - 1], *merged[i]);
+        }
+    }
+}
+
+// 测试相等元素按路号顺序输出
+TEST(SortTest, LoserTreeStableOnTies) {
+    std::vector<std::vector<int> > runs(5, std::vector<int>(3, 42));
+    std::vector<int *> merged = merge_with_loser_tree(runs);
+    ASSERT_EQ(merged.size(), 15u);
+    for (size_t i = 0; i < merged.size(); i++) {
+        EXPECT_EQ(merged[i], &runs[i / 3][i % 3]);
+    }
+}
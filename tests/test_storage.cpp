@@ -1,14 +1,31 @@
 #include <gtest/gtest.h>
 #include <cstdio>
 #include <cstring>
+#include <string>
+#include <vector>
+#if defined(_WIN32)
+    #include <direct.h>
+    #define mkdir_for_test(path) _mkdir(path)
+    #define rmdir_for_test(path) _rmdir(path)
+#else
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define mkdir_for_test(path) mkdir(path, 0755)
+    #define rmdir_for_test(path) rmdir(path)
+#endif
+#include "test_helpers.h"
 extern "C" {
     #include "../storage.h"
+    #include "../compact_file.h"
     #include "../model.h"
+    #include "../thread.h"
+
+    /* index.c的故障注入钩子,只在测试构建(INDEX_FAULT_INJECTION)中存在 */
+    void index_partial_fail_after(size_t n);
 }
 
 // 测试文件路径
 const char *TEST_DB_FILE = "test_employees.db";
-const char *TEST_AUTH_FILE = "test_admin.auth";
 const char *TEST_CSV_FILE = "test_export.csv";
 
 // 测试夹具
@@ -17,14 +34,12 @@ protected:
     void SetUp() override {
         // 清理测试文件
         std::remove(TEST_DB_FILE);
-        std::remove(TEST_AUTH_FILE);
         std::remove(TEST_CSV_FILE);
     }
     
     void TearDown() override {
         // 清理测试文件
         std::remove(TEST_DB_FILE);
-        std::remove(TEST_AUTH_FILE);
         std::remove(TEST_CSV_FILE);
     }
 };
@@ -170,6 +185,38 @@ TEST_F(StorageTest, ExportCsv) {
     employee_manager_free(mgr);
 }
 
+// 测试大数据量(并行格式化)导出与fprintf逐行输出逐字节一致
+TEST_F(StorageTest, ExportCsvMatchesPrintf) {
+    EmployeeManager *mgr = employee_manager_create();
+    const char *depts[] = {"研发部", "市场部", "人事部"};
+    for (int i = 0; i < 100000; i++) {
+        employee_manager_add(mgr, (i % 2) ? "张三" : "Li", depts[i % 3], "2024-01-15", i % 31);
+    }
+    ASSERT_EQ(storage_export_csv(TEST_CSV_FILE, mgr), SUCCESS);
+    
+    std::string expected = "工号,姓名,部门,出勤日期,出勤天数\n";
+    char line[256];
+    for (size_t i = 0; i < mgr->employees->size; i++) {
+        const Employee *emp = (const Employee *)mgr->employees->data[i];
+        snprintf(line, sizeof(line), "%d,%s,%s,%s,%d\n", emp->id, emp->name,
+                 emp->department, emp->attend_date, emp->attend_days);
+        expected += line;
+    }
+    
+    FILE *fp = fopen(TEST_CSV_FILE, "r");
+    ASSERT_NE(fp, nullptr);
+    std::string actual;
+    char chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0) {
+        actual.append(chunk, n);
+    }
+    fclose(fp);
+    EXPECT_TRUE(actual == expected);
+    
+    employee_manager_free(mgr);
+}
+
 // 测试storage_export_csv NULL参数
 TEST_F(StorageTest, ExportCsvNullParams) {
     EmployeeManager *mgr = employee_manager_create();
@@ -181,47 +228,6 @@ TEST_F(StorageTest, ExportCsvNullParams) {
     employee_manager_free(mgr);
 }
 
-// 测试storage_save_credential和storage_verify_credential
-TEST_F(StorageTest, SaveAndVerifyCredential) {
-    const char *username = "admin";
-    const char *password = "password123";
-    
-    ErrorCode err = storage_save_credential(TEST_AUTH_FILE, username, password);
-    EXPECT_EQ(err, SUCCESS);
-    
-    // 验证正确的凭证
-    Bool result = storage_verify_credential(TEST_AUTH_FILE, username, password);
-    EXPECT_EQ(result, TRUE);
-    
-    // 验证错误的密码
-    result = storage_verify_credential(TEST_AUTH_FILE, username, "wrongpassword");
-    EXPECT_EQ(result, FALSE);
-    
-    // 验证错误的用户名
-    result = storage_verify_credential(TEST_AUTH_FILE, "wronguser", password);
-    EXPECT_EQ(result, FALSE);
-}
-
-// 测试storage_save_credential NULL参数
-TEST_F(StorageTest, SaveCredentialNullParams) {
-    EXPECT_EQ(storage_save_credential(nullptr, "admin", "password"), ERROR_NULL_POINTER);
-    EXPECT_EQ(storage_save_credential(TEST_AUTH_FILE, nullptr, "password"), ERROR_NULL_POINTER);
-    EXPECT_EQ(storage_save_credential(TEST_AUTH_FILE, "admin", nullptr), ERROR_NULL_POINTER);
-}
-
-// 测试storage_verify_credential NULL参数
-TEST_F(StorageTest, VerifyCredentialNullParams) {
-    EXPECT_EQ(storage_verify_credential(nullptr, "admin", "password"), FALSE);
-    EXPECT_EQ(storage_verify_credential(TEST_AUTH_FILE, nullptr, "password"), FALSE);
-    EXPECT_EQ(storage_verify_credential(TEST_AUTH_FILE, "admin", nullptr), FALSE);
-}
-
-// 测试storage_verify_credential 文件不存在
-TEST_F(StorageTest, VerifyCredentialFileNotFound) {
-    Bool result = storage_verify_credential("nonexistent.auth", "admin", "password");
-    EXPECT_EQ(result, FALSE);
-}
-
 // 测试空manager保存和加载
 TEST_F(StorageTest, SaveAndLoadEmptyManager) {
     EmployeeManager *mgr = employee_manager_create();
@@ -363,3 +369,718 @@ TEST_F(StorageTest, LoadEmployeesChecksumError) {
     employee_manager_free(mgr);
     employee_manager_free(mgr2);
 }
+
+// 后台导出任务
+struct ExportJob {
+    EmployeeSnapshot *snapshot;
+    ErrorCode result;
+};
+
+static void export_job_run(void *arg) {
+    ExportJob *job = (ExportJob *)arg;
+    job->result = storage_export_csv_snapshot(TEST_CSV_FILE, job->snapshot);
+}
+
+// 测试基于快照的后台导出与保存不受并发修改影响
+TEST_F(StorageTest, SnapshotExportWhileEditing) {
+    EmployeeManager *mgr = employee_manager_create();
+    ASSERT_NE(mgr, nullptr);
+    
+    for (int i = 0; i < 5000; i++) {
+        employee_manager_add(mgr, "张三", "研发部", "2024-01-15", 22);
+    }
+    
+    ASSERT_EQ(employee_manager_enable_concurrency(mgr), SUCCESS);
+    ExportJob job;
+    job.snapshot = employee_manager_snapshot(mgr);
+    job.result = ERROR_NULL_POINTER;
+    ASSERT_NE(job.snapshot, nullptr);
+    
+    Thread *worker = thread_create(export_job_run, &job);
+    ASSERT_NE(worker, nullptr);
+    
+    // 导出进行时继续修改
+    for (int i = 0; i < 1000; i++) {
+        employee_manager_remove_at(mgr, 0);
+        employee_manager_add(mgr, "李四", "市场部", "2024-02-01", 1);
+    }
+    thread_join(worker);
+    EXPECT_EQ(job.result, SUCCESS);
+    
+    // 快照中的内容全部来自修改前
+    EXPECT_EQ(storage_save_snapshot(TEST_DB_FILE, job.snapshot), SUCCESS);
+    employee_snapshot_release(job.snapshot);
+    
+    FILE *fp = fopen(TEST_CSV_FILE, "r");
+    ASSERT_NE(fp, nullptr);
+    char line[256];
+    int rows = 0;
+    ASSERT_NE(fgets(line, sizeof(line), fp), nullptr);  // 标题行
+    while (fgets(line, sizeof(line), fp) != nullptr) {
+        EXPECT_TRUE(strstr(line, "张三") != nullptr);
+        rows++;
+    }
+    fclose(fp);
+    EXPECT_EQ(rows, 5000);
+    
+    EmployeeManager *mgr2 = employee_manager_create();
+    ASSERT_NE(mgr2, nullptr);
+    EXPECT_EQ(storage_load_employees(TEST_DB_FILE, mgr2), SUCCESS);
+    EXPECT_EQ(mgr2->employees->size, 5000u);
+    EXPECT_EQ(mgr2->next_id, 6001);
+    
+    EXPECT_EQ(storage_save_snapshot(nullptr, nullptr), ERROR_NULL_POINTER);
+    EXPECT_EQ(storage_export_csv_snapshot(TEST_CSV_FILE, nullptr), ERROR_NULL_POINTER);
+    
+    employee_manager_free(mgr);
+    employee_manager_free(mgr2);
+}
+
+// 测试原子保存: 不留下临时文件,写入失败时保留原文件
+TEST_F(StorageTest, AtomicSaveKeepsOriginal) {
+    EmployeeManager *mgr = employee_manager_create();
+    employee_manager_add(mgr, "张三", "研发部", "2024-01-15", 22);
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, mgr), SUCCESS);
+    
+    std::string temp_path = std::string(TEST_DB_FILE) + ".tmp";
+    FILE *fp = fopen(temp_path.c_str(), "rb");
+    EXPECT_EQ(fp, nullptr);
+    if (fp != NULL) {
+        fclose(fp);
+    }
+    
+    // 临时文件路径被目录占用时保存失败,原文件不受影响
+    employee_manager_add(mgr, "李四", "市场部", "2024-01-16", 23);
+    ASSERT_EQ(mkdir_for_test(temp_path.c_str()), 0);
+    EXPECT_EQ(storage_save_employees(TEST_DB_FILE, mgr), ERROR_FILE_WRITE_FAILED);
+    rmdir_for_test(temp_path.c_str());
+    
+    EmployeeManager *loaded = employee_manager_create();
+    EXPECT_EQ(storage_load_employees(TEST_DB_FILE, loaded), SUCCESS);
+    EXPECT_EQ(loaded->employees->size, 1u);
+    
+    employee_manager_free(mgr);
+    employee_manager_free(loaded);
+}
+
+// 测试跨越多个I/O分块的保存与加载
+TEST_F(StorageTest, SaveAndLoadAcrossChunks) {
+    EmployeeManager *mgr = employee_manager_create();
+    char name[32];
+    for (int i = 0; i < 60000; i++) {
+        snprintf(name, sizeof(name), "员工%d", i);
+        employee_manager_add(mgr, name, "研发部", "2024-01-15", i % 31);
+    }
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, mgr), SUCCESS);
+    
+    EmployeeManager *loaded = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(TEST_DB_FILE, loaded), SUCCESS);
+    ASSERT_EQ(loaded->employees->size, mgr->employees->size);
+    EXPECT_EQ(loaded->next_id, mgr->next_id);
+    for (size_t i = 0; i < mgr->employees->size; i += 997) {
+        EXPECT_EQ(memcmp(mgr->employees->data[i], loaded->employees->data[i], sizeof(Employee)), 0);
+    }
+    EXPECT_EQ(memcmp(mgr->employees->data[59999], loaded->employees->data[59999], sizeof(Employee)), 0);
+    
+    employee_manager_free(mgr);
+    employee_manager_free(loaded);
+}
+
+// 按v1格式写出职工数据(用于兼容性测试)
+static void write_v1_file(const char *filename, EmployeeManager *mgr, unsigned int count_override) {
+    FILE *fp = fopen(filename, "wb");
+    ASSERT_NE(fp, nullptr);
+    
+    FileHeader header;
+    header.magic = MAGIC_NUMBER;
+    header.version = FILE_VERSION_V1;
+    header.count = count_override ? count_override : (unsigned int)mgr->employees->size;
+    header.checksum = 0;
+    for (size_t i = 0; i < mgr->employees->size; i++) {
+        const unsigned char *bytes = (const unsigned char *)mgr->employees->data[i];
+        unsigned int sum = 0;
+        for (size_t b = 0; b < sizeof(Employee); b++) {
+            sum += bytes[b];
+            sum = (sum << 1) | (sum >> 31);
+        }
+        header.checksum += sum;
+    }
+    fwrite(&header, sizeof(FileHeader), 1, fp);
+    for (size_t i = 0; i < mgr->employees->size; i++) {
+        fwrite(mgr->employees->data[i], sizeof(Employee), 1, fp);
+    }
+    fwrite(&mgr->next_id, sizeof(int), 1, fp);
+    fclose(fp);
+}
+
+// 测试记录数与文件长度不符时报错且不加载任何记录
+TEST_F(StorageTest, LoadTruncatedFile) {
+    EmployeeManager *mgr = employee_manager_create();
+    employee_manager_add(mgr, "张三", "研发部", "2024-01-15", 22);
+    employee_manager_add(mgr, "李四", "市场部", "2024-01-16", 23);
+    write_v1_file(TEST_DB_FILE, mgr, 1000000);
+    
+    EmployeeManager *loaded = employee_manager_create();
+    EXPECT_EQ(storage_load_employees(TEST_DB_FILE, loaded), ERROR_FILE_READ_FAILED);
+    EXPECT_EQ(loaded->employees->size, 0u);
+    
+    employee_manager_free(mgr);
+    employee_manager_free(loaded);
+}
+
+// 测试v1文件仍可加载,保存时升级为v2
+TEST_F(StorageTest, LoadV1AndUpgrade) {
+    EmployeeManager *mgr = employee_manager_create();
+    employee_manager_add(mgr, "张三", "研发部", "2024-01-15", 22);
+    employee_manager_add(mgr, "李四", "市场部", "2024-01-16", 23);
+    write_v1_file(TEST_DB_FILE, mgr, 0);
+    
+    EmployeeManager *loaded = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(TEST_DB_FILE, loaded), SUCCESS);
+    ASSERT_EQ(loaded->employees->size, 2u);
+    EXPECT_EQ(loaded->next_id, mgr->next_id);
+    EXPECT_EQ(loaded->index, nullptr);  // v1没有索引段
+    
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, loaded), SUCCESS);
+    FILE *fp = fopen(TEST_DB_FILE, "rb");
+    ASSERT_NE(fp, nullptr);
+    FileHeaderV2 header;
+    ASSERT_EQ(fread(&header, sizeof(FileHeaderV2), 1, fp), 1u);
+    fclose(fp);
+    EXPECT_EQ(header.version, (unsigned int)FILE_VERSION);
+    EXPECT_EQ(header.record_count, 2u);
+    
+    employee_manager_free(mgr);
+    employee_manager_free(loaded);
+}
+
+// 测试v2文件的分块、段目录与索引段
+TEST_F(StorageTest, V2BlocksAndIndexSections) {
+    EmployeeManager *mgr = employee_manager_create();
+    const char *depts[] = {"研发部", "市场部", "人事部"};
+    for (int i = 0; i < FILE_BLOCK_RECORDS * 2 + 10; i++) {
+        employee_manager_add(mgr, "员工", depts[i % 3], "2024-01-15", i % 31);
+    }
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, mgr), SUCCESS);
+    
+    FILE *fp = fopen(TEST_DB_FILE, "rb");
+    ASSERT_NE(fp, nullptr);
+    FileHeaderV2 header;
+    ASSERT_EQ(fread(&header, sizeof(FileHeaderV2), 1, fp), 1u);
+    fclose(fp);
+    EXPECT_EQ(header.header_size, FILE_V2_DATA_OFFSET);
+    EXPECT_EQ(header.directory_count, 3u + 3u);  // 3个记录块 + 3个索引段
+    
+    EmployeeManager *loaded = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(TEST_DB_FILE, loaded), SUCCESS);
+    ASSERT_EQ(loaded->employees->size, mgr->employees->size);
+    EXPECT_EQ(loaded->next_id, mgr->next_id);
+    for (size_t i = 0; i < mgr->employees->size; i += 101) {
+        EXPECT_EQ(memcmp(mgr->employees->data[i], loaded->employees->data[i], sizeof(Employee)), 0);
+    }
+    
+    // 索引段直接附加,查询结果与记录一致
+    ASSERT_NE(loaded->index, nullptr);
+    int id = 1001 + FILE_BLOCK_RECORDS + 5;
+    Vector *result = employee_manager_search(loaded, SEARCH_BY_ID, &id);
+    ASSERT_EQ(result->size, 1u);
+    EXPECT_EQ(((Employee *)result->data[0])->id, id);
+    vector_free(result);
+    result = employee_manager_search(loaded, SEARCH_BY_DEPARTMENT, "人事部");
+    EXPECT_EQ(result->size, (size_t)(FILE_BLOCK_RECORDS * 2 + 10) / 3);
+    vector_free(result);
+    
+    // 加载到非空管理器时不附加索引(位置会错位)
+    EmployeeManager *twice = employee_manager_create();
+    employee_manager_add(twice, "已有", "研发部", "2024-01-01", 1);
+    ASSERT_EQ(storage_load_employees(TEST_DB_FILE, twice), SUCCESS);
+    EXPECT_EQ(twice->index, nullptr);
+    
+    employee_manager_free(mgr);
+    employee_manager_free(loaded);
+    employee_manager_free(twice);
+}
+
+// 测试v2记录块内容被篡改时报告数据损坏
+TEST_F(StorageTest, V2BlockChecksumError) {
+    EmployeeManager *mgr = employee_manager_create();
+    for (int i = 0; i < FILE_BLOCK_RECORDS + 10; i++) {
+        employee_manager_add(mgr, "员工", "研发部", "2024-01-15", 1);
+    }
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, mgr), SUCCESS);
+    
+    // 篡改第二个记录块中的一条记录
+    FILE *fp = fopen(TEST_DB_FILE, "r+b");
+    ASSERT_NE(fp, nullptr);
+    long offset = (long)(FILE_V2_DATA_OFFSET + (FILE_BLOCK_RECORDS + 3) * sizeof(Employee));
+    fseek(fp, offset, SEEK_SET);
+    fputc('X', fp);
+    fclose(fp);
+    
+    EmployeeManager *loaded = employee_manager_create();
+    EXPECT_EQ(storage_load_employees(TEST_DB_FILE, loaded), ERROR_DATA_CORRUPTION);
+    
+    employee_manager_free(mgr);
+    employee_manager_free(loaded);
+}
+
+// 分页查询回调: 收集匹配记录的工号
+static Bool collect_paged_id(void *ctx, const Employee *emp) {
+    ((std::vector<int> *)ctx)->push_back(emp->id);
+    return TRUE;
+}
+
+// 测试分页访问: 缓冲池远小于文件时查询、统计、导出结果与完整加载一致
+TEST_F(StorageTest, PagedMatchesManager) {
+    EmployeeManager *mgr = employee_manager_create();
+    const char *depts[] = {"研发部", "市场部", "人事部"};
+    const int rows = FILE_BLOCK_RECORDS * 3 + 50;
+    for (int i = 0; i < rows; i++) {
+        char date[MAX_DATE_LEN];
+        snprintf(date, sizeof(date), "%d-%02d-15", 2023 + i % 2, i % 12 + 1);
+        employee_manager_add(mgr, (i % 5) ? "员工" : "Smith, John", depts[i % 3], date, i % 31);
+    }
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, mgr), SUCCESS);
+    
+    ErrorCode err = ERROR_NULL_POINTER;
+    PagedStore *store = storage_paged_open(TEST_DB_FILE, 2, &err);
+    ASSERT_NE(store, nullptr);
+    EXPECT_EQ(err, SUCCESS);
+    EXPECT_EQ(storage_paged_record_count(store), (size_t)rows);
+    EXPECT_EQ(storage_paged_page_count(store), 4u);
+    EXPECT_EQ(storage_paged_next_id(store), mgr->next_id);
+    
+    // 随机访问
+    Employee emp;
+    for (size_t i = 0; i < (size_t)rows; i += 997) {
+        ASSERT_EQ(storage_paged_get(store, i, &emp), SUCCESS);
+        EXPECT_EQ(memcmp(&emp, mgr->employees->data[i], sizeof(Employee)), 0);
+    }
+    EXPECT_EQ(storage_paged_get(store, rows, &emp), ERROR_INDEX_OUT_OF_BOUNDS);
+    
+    // 查询
+    std::vector<int> ids;
+    size_t matches = 0;
+    ASSERT_EQ(storage_paged_search(store, SEARCH_BY_DEPARTMENT, "人事部",
+                                   collect_paged_id, &ids, &matches), SUCCESS);
+    Vector *expected = employee_manager_search(mgr, SEARCH_BY_DEPARTMENT, "人事部");
+    ASSERT_EQ(matches, expected->size);
+    ASSERT_EQ(ids.size(), expected->size);
+    for (size_t i = 0; i < ids.size(); i++) {
+        EXPECT_EQ(ids[i], ((Employee *)expected->data[i])->id);
+    }
+    vector_free(expected);
+    
+    int id = 1001 + FILE_BLOCK_RECORDS * 2 + 7;
+    ids.clear();
+    ASSERT_EQ(storage_paged_search(store, SEARCH_BY_ID, &id, collect_paged_id, &ids, &matches), SUCCESS);
+    ASSERT_EQ(matches, 1u);
+    EXPECT_EQ(ids[0], id);
+    
+    // 统计
+    long long total = 0;
+    ASSERT_EQ(storage_paged_attendance(store, "2024", &total), SUCCESS);
+    EXPECT_EQ(total, employee_manager_yearly_attendance(mgr, "2024"));
+    ASSERT_EQ(storage_paged_attendance(store, "2023-03", &total), SUCCESS);
+    EXPECT_EQ(total, employee_manager_monthly_attendance(mgr, "2023-03"));
+    
+    // 导出
+    const char *paged_csv = "test_paged_export.csv";
+    ASSERT_EQ(storage_export_csv(TEST_CSV_FILE, mgr), SUCCESS);
+    ASSERT_EQ(storage_paged_export_csv(store, paged_csv), SUCCESS);
+    EXPECT_TRUE(read_whole_file(TEST_CSV_FILE) == read_whole_file(paged_csv));
+    std::remove(paged_csv);
+    
+    BufferPoolStats stats = {};
+    storage_paged_stats(store, &stats);
+    EXPECT_GT(stats.evictions, 0u);
+    
+    storage_paged_close(store);
+    employee_manager_free(mgr);
+}
+
+// 测试按工号分页查询报告全部重复工号的记录,与完整加载后的查询一致
+TEST_F(StorageTest, PagedSearchReportsDuplicateIds) {
+    EmployeeManager *mgr = employee_manager_create();
+    for (int i = 0; i < FILE_BLOCK_RECORDS + 5; i++) {
+        employee_manager_add(mgr, "员工", "研发部", "2024-01-15", 1);
+    }
+    // 第二个记录块中的一条记录与第一条同工号
+    ((Employee *)mgr->employees->data[FILE_BLOCK_RECORDS + 2])->id = 1001;
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, mgr), SUCCESS);
+    
+    ErrorCode err = SUCCESS;
+    PagedStore *store = storage_paged_open(TEST_DB_FILE, 2, &err);
+    ASSERT_NE(store, nullptr);
+    int id = 1001;
+    std::vector<int> ids;
+    size_t matches = 0;
+    ASSERT_EQ(storage_paged_search(store, SEARCH_BY_ID, &id, collect_paged_id, &ids, &matches), SUCCESS);
+    EXPECT_EQ(matches, 2u);
+    EXPECT_EQ(ids.size(), 2u);
+    storage_paged_close(store);
+    
+    Vector *result = employee_manager_search(mgr, SEARCH_BY_ID, &id);
+    ASSERT_NE(result, nullptr);
+    EXPECT_EQ(result->size, matches);
+    vector_free(result);
+    employee_manager_free(mgr);
+}
+
+// 测试分页访问的错误处理: 非v2文件与被篡改的页
+TEST_F(StorageTest, PagedOpenErrors) {
+    ErrorCode err = SUCCESS;
+    EXPECT_EQ(storage_paged_open(TEST_DB_FILE, 2, &err), nullptr);
+    EXPECT_EQ(err, ERROR_FILE_NOT_FOUND);
+    EXPECT_EQ(storage_paged_open(nullptr, 2, &err), nullptr);
+    EXPECT_EQ(err, ERROR_NULL_POINTER);
+    
+    EmployeeManager *mgr = employee_manager_create();
+    for (int i = 0; i < FILE_BLOCK_RECORDS + 10; i++) {
+        employee_manager_add(mgr, "员工", "研发部", "2024-01-15", 1);
+    }
+    ASSERT_EQ(storage_save_compact(TEST_DB_FILE, mgr), SUCCESS);
+    EXPECT_EQ(storage_paged_open(TEST_DB_FILE, 2, &err), nullptr);
+    EXPECT_EQ(err, ERROR_INVALID_FILE);
+    
+    // 篡改第二个记录块: 打开成功,读到该页时报告数据损坏
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, mgr), SUCCESS);
+    FILE *fp = fopen(TEST_DB_FILE, "r+b");
+    ASSERT_NE(fp, nullptr);
+    fseek(fp, (long)(FILE_V2_DATA_OFFSET + (FILE_BLOCK_RECORDS + 3) * sizeof(Employee)), SEEK_SET);
+    fputc('X', fp);
+    fclose(fp);
+    
+    PagedStore *store = storage_paged_open(TEST_DB_FILE, 2, &err);
+    ASSERT_NE(store, nullptr);
+    Employee emp;
+    EXPECT_EQ(storage_paged_get(store, 0, &emp), SUCCESS);
+    EXPECT_EQ(storage_paged_get(store, FILE_BLOCK_RECORDS, &emp), ERROR_DATA_CORRUPTION);
+    long long total = 0;
+    EXPECT_EQ(storage_paged_attendance(store, "2024", &total), ERROR_DATA_CORRUPTION);
+    storage_paged_close(store);
+    
+    employee_manager_free(mgr);
+}
+
+static FileHeaderV2 read_v2_header(const char *filename) {
+    FileHeaderV2 header;
+    if (storage_read_header(filename, &header) != SUCCESS) {
+        memset(&header, 0, sizeof(header));
+    }
+    return header;
+}
+
+static void expect_same_records(EmployeeManager *expected, EmployeeManager *actual) {
+    ASSERT_EQ(actual->employees->size, expected->employees->size);
+    EXPECT_EQ(actual->next_id, expected->next_id);
+    for (size_t i = 0; i < expected->employees->size; i++) {
+        ASSERT_EQ(memcmp(expected->employees->data[i], actual->employees->data[i], sizeof(Employee)), 0)
+            << "record " << i;
+    }
+}
+
+// 测试增量保存: 只追加修改过的块与新目录,未修改的块保持原位
+TEST_F(StorageTest, IncrementalSaveWritesDirtyBlocks) {
+    EmployeeManager *mgr = employee_manager_create();
+    for (int i = 0; i < FILE_BLOCK_RECORDS * 3 + 10; i++) {
+        employee_manager_add(mgr, "员工", "研发部", "2024-01-15", i % 31);
+    }
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, mgr), SUCCESS);
+    std::string before = read_whole_file(TEST_DB_FILE);
+    FileHeaderV2 full = read_v2_header(TEST_DB_FILE);
+    EXPECT_NE(full.save_stamp, 0u);
+    EXPECT_EQ(full.directory_count, 4u + 3u);
+    
+    ASSERT_EQ(employee_manager_update(mgr, 1001 + FILE_BLOCK_RECORDS + 3, "改名", "市场部",
+                                      "2024-02-01", 9), SUCCESS);
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, mgr), SUCCESS);
+    std::string after = read_whole_file(TEST_DB_FILE);
+    FileHeaderV2 incremental = read_v2_header(TEST_DB_FILE);
+    EXPECT_NE(incremental.save_stamp, full.save_stamp);
+    EXPECT_EQ(incremental.directory_count, 4u);  // 只登记记录块
+    EXPECT_EQ(after.size(), before.size() + FILE_BLOCK_RECORDS * sizeof(Employee) + 4 * sizeof(SectionEntry));
+    // 新文件头写入槽1,槽0与文件头区之后的原有内容都未被改写
+    EXPECT_EQ(incremental.sequence, full.sequence + 1);
+    EXPECT_EQ(after.compare(0, sizeof(FileHeaderV2), before, 0, sizeof(FileHeaderV2)), 0);
+    EXPECT_EQ(after.compare(FILE_V2_DATA_OFFSET, before.size() - FILE_V2_DATA_OFFSET,
+                            before, FILE_V2_DATA_OFFSET, before.size() - FILE_V2_DATA_OFFSET), 0);
+    
+    EmployeeManager *loaded = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(TEST_DB_FILE, loaded), SUCCESS);
+    expect_same_records(mgr, loaded);
+    employee_manager_free(loaded);
+    
+    // 没有修改时不写文件
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, mgr), SUCCESS);
+    EXPECT_EQ(read_whole_file(TEST_DB_FILE), after);
+    
+    employee_manager_free(mgr);
+}
+
+// 测试加载得到的基线、追加记录、排序与文件被替换时的回退
+TEST_F(StorageTest, IncrementalSaveFallsBack) {
+    EmployeeManager *mgr = employee_manager_create();
+    for (int i = 0; i < FILE_BLOCK_RECORDS * 4 + 10; i++) {
+        employee_manager_add(mgr, "员工", (i % 2) ? "研发部" : "人事部", "2024-01-15", i % 31);
+    }
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, mgr), SUCCESS);
+    
+    // 加载到空管理器后即可增量保存: 追加只改写末块
+    EmployeeManager *loaded = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(TEST_DB_FILE, loaded), SUCCESS);
+    ASSERT_EQ(employee_manager_add(loaded, "新人", "市场部", "2024-03-01", 5), SUCCESS);
+    size_t size_before = read_whole_file(TEST_DB_FILE).size();
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, loaded), SUCCESS);
+    EXPECT_EQ(read_v2_header(TEST_DB_FILE).directory_count, 5u);
+    EXPECT_EQ(read_whole_file(TEST_DB_FILE).size(), size_before + 11 * sizeof(Employee) + 5 * sizeof(SectionEntry));
+    
+    EmployeeManager *check = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(TEST_DB_FILE, check), SUCCESS);
+    expect_same_records(loaded, check);
+    employee_manager_free(check);
+    
+    // 排序改动全部位置,完整写出(重新带上索引段)
+    employee_manager_sort(loaded, SORT_BY_ATTEND_DAYS);
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, loaded), SUCCESS);
+    EXPECT_EQ(read_v2_header(TEST_DB_FILE).directory_count, 5u + 3u);
+    check = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(TEST_DB_FILE, check), SUCCESS);
+    expect_same_records(loaded, check);
+    EXPECT_NE(check->index, nullptr);
+    employee_manager_free(check);
+    
+    // 文件被其他管理器覆盖后,保存标记不符,完整写出
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, mgr), SUCCESS);
+    employee_manager_update(loaded, 1001, "再改", "研发部", "2024-01-15", 1);
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, loaded), SUCCESS);
+    EXPECT_EQ(read_v2_header(TEST_DB_FILE).directory_count, 5u + 3u);
+    check = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(TEST_DB_FILE, check), SUCCESS);
+    expect_same_records(loaded, check);
+    employee_manager_free(check);
+    
+    employee_manager_free(mgr);
+    employee_manager_free(loaded);
+}
+
+// 测试增量保存中途崩溃: 追加的数据不完整或新文件头槽写坏时,仍加载到完整的旧版本
+TEST_F(StorageTest, IncrementalSaveCrashSafe) {
+    EmployeeManager *mgr = employee_manager_create();
+    for (int i = 0; i < FILE_BLOCK_RECORDS * 3 + 10; i++) {
+        employee_manager_add(mgr, "员工", "研发部", "2024-01-15", i % 31);
+    }
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, mgr), SUCCESS);
+    EmployeeManager *old = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(TEST_DB_FILE, old), SUCCESS);
+    std::string full = read_whole_file(TEST_DB_FILE);
+    
+    // 追加到一半时崩溃: 文件尾部多出残缺数据,文件头未切换
+    write_whole_file(TEST_DB_FILE, full + std::string(3000, 'x'));
+    EmployeeManager *check = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(TEST_DB_FILE, check), SUCCESS);
+    expect_same_records(old, check);
+    employee_manager_free(check);
+    
+    // 此后的增量保存照常追加,新文件头写入槽1
+    write_whole_file(TEST_DB_FILE, full);
+    ASSERT_EQ(employee_manager_update(mgr, 1001 + FILE_BLOCK_RECORDS, "改名", "市场部",
+                                      "2024-02-01", 9), SUCCESS);
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, mgr), SUCCESS);
+    FileHeaderV2 current = read_v2_header(TEST_DB_FILE);
+    EXPECT_EQ(current.sequence, 1u);
+    EXPECT_EQ(current.directory_count, 4u);
+    std::string updated = read_whole_file(TEST_DB_FILE);
+    
+    // 改写槽1到一半时崩溃: 槽1校验失败,按槽0加载旧版本
+    std::string torn = updated;
+    memset(&torn[sizeof(FileHeaderV2) + 16], 0, 20);
+    write_whole_file(TEST_DB_FILE, torn);
+    EXPECT_EQ(read_v2_header(TEST_DB_FILE).sequence, 0u);
+    check = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(TEST_DB_FILE, check), SUCCESS);
+    expect_same_records(old, check);
+    employee_manager_free(check);
+    
+    // 文件头与内存基线不符,下次保存完整写出
+    ASSERT_EQ(employee_manager_update(mgr, 1002, "再改", "人事部", "2024-02-02", 8), SUCCESS);
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, mgr), SUCCESS);
+    EXPECT_EQ(read_v2_header(TEST_DB_FILE).directory_count, 4u + 3u);
+    check = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(TEST_DB_FILE, check), SUCCESS);
+    expect_same_records(mgr, check);
+    employee_manager_free(check);
+    
+    // 槽0损坏而槽1有效: 按槽1加载
+    torn = updated;
+    torn[20] ^= 0x5A;
+    write_whole_file(TEST_DB_FILE, torn);
+    check = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(TEST_DB_FILE, check), SUCCESS);
+    EXPECT_STREQ(((Employee *)check->employees->data[FILE_BLOCK_RECORDS])->name, "改名");
+    employee_manager_free(check);
+    
+    // 两个槽都损坏
+    torn[sizeof(FileHeaderV2) + 20] ^= 0x5A;
+    write_whole_file(TEST_DB_FILE, torn);
+    check = employee_manager_create();
+    EXPECT_EQ(storage_load_employees(TEST_DB_FILE, check), ERROR_DATA_CORRUPTION);
+    employee_manager_free(check);
+    
+    employee_manager_free(old);
+    employee_manager_free(mgr);
+}
+
+/* 与storage.c相同的校验和,用于构造旧版文件 */
+static unsigned int test_checksum(const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    unsigned int sum = 0;
+    for (size_t i = 0; i < size; i++) {
+        sum += bytes[i];
+        sum = (sum << 1) | (sum >> 31);
+    }
+    return sum;
+}
+
+// 测试旧版单槽文件: 正常加载,增量保存退回完整保存并升级为双槽
+TEST_F(StorageTest, LegacySingleHeaderFile) {
+    EmployeeManager *mgr = employee_manager_create();
+    for (int i = 0; i < FILE_BLOCK_RECORDS + 10; i++) {
+        employee_manager_add(mgr, "员工", "研发部", "2024-01-15", i % 31);
+    }
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, mgr), SUCCESS);
+    
+    // 去掉槽1,各偏移前移一个槽
+    std::string data = read_whole_file(TEST_DB_FILE);
+    FileHeaderV2 header;
+    memcpy(&header, data.data(), sizeof(header));
+    std::vector<SectionEntry> dir((size_t)header.directory_count);
+    memcpy(dir.data(), data.data() + header.directory_offset, dir.size() * sizeof(SectionEntry));
+    for (auto &entry : dir) {
+        entry.offset -= sizeof(FileHeaderV2);
+    }
+    std::string legacy = data.substr(0, (size_t)header.directory_offset);
+    legacy.erase(sizeof(FileHeaderV2), sizeof(FileHeaderV2));
+    legacy.append((const char *)dir.data(), dir.size() * sizeof(SectionEntry));
+    header.header_size = sizeof(FileHeaderV2);
+    header.directory_offset -= sizeof(FileHeaderV2);
+    header.directory_checksum = test_checksum(dir.data(), dir.size() * sizeof(SectionEntry));
+    header.header_checksum = test_checksum(&header, offsetof(FileHeaderV2, header_checksum));
+    memcpy(&legacy[0], &header, sizeof(header));
+    write_whole_file(TEST_DB_FILE, legacy);
+    
+    EmployeeManager *loaded = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(TEST_DB_FILE, loaded), SUCCESS);
+    expect_same_records(mgr, loaded);
+    
+    ASSERT_EQ(employee_manager_update(loaded, 1003, "改名", "市场部", "2024-02-01", 9), SUCCESS);
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, loaded), SUCCESS);
+    FileHeaderV2 upgraded = read_v2_header(TEST_DB_FILE);
+    EXPECT_EQ(upgraded.header_size, FILE_V2_DATA_OFFSET);
+    EXPECT_EQ(upgraded.directory_count, 2u + 3u);
+    EmployeeManager *check = employee_manager_create();
+    ASSERT_EQ(storage_load_employees(TEST_DB_FILE, check), SUCCESS);
+    expect_same_records(loaded, check);
+    
+    employee_manager_free(check);
+    employee_manager_free(loaded);
+    employee_manager_free(mgr);
+}
+
+// 测试多线程加载与单线程加载结果一致,无索引段时合并出索引,损坏时不留下记录
+TEST_F(StorageTest, ParallelLoadMatchesSerial) {
+    EmployeeManager *mgr = employee_manager_create();
+    const char *depts[] = {"研发部", "市场部", "人事部", "财务部", "后勤部"};
+    for (int i = 0; i < FILE_BLOCK_RECORDS * 5 + 17; i++) {
+        employee_manager_add(mgr, "员工", depts[(i / 7) % 5], "2024-01-15", i % 31);
+    }
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, mgr), SUCCESS);
+    
+    ThreadPool *pool = thread_pool_create(3);
+    ASSERT_NE(pool, nullptr);
+    EmployeeManager *loaded = employee_manager_create();
+    ASSERT_EQ(storage_load_employees_parallel(TEST_DB_FILE, loaded, pool), SUCCESS);
+    expect_same_records(mgr, loaded);
+    EXPECT_NE(loaded->index, nullptr);  // 直接读入的索引段
+    employee_manager_free(loaded);
+    
+    // 增量保存后的文件没有索引段,由各线程的部门编码合并建立
+    employee_manager_update(mgr, 1001 + FILE_BLOCK_RECORDS * 2, "改名", "新部门", "2024-02-01", 3);
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, mgr), SUCCESS);
+    ASSERT_EQ(read_v2_header(TEST_DB_FILE).directory_count, 6u);
+    loaded = employee_manager_create();
+    ASSERT_EQ(storage_load_employees_parallel(TEST_DB_FILE, loaded, pool), SUCCESS);
+    expect_same_records(mgr, loaded);
+    ASSERT_NE(loaded->index, nullptr);
+    for (size_t d = 0; d < 5; d++) {
+        Vector *expected = employee_manager_search(mgr, SEARCH_BY_DEPARTMENT, depts[d]);
+        Vector *actual = employee_manager_search(loaded, SEARCH_BY_DEPARTMENT, depts[d]);
+        ASSERT_EQ(actual->size, expected->size);
+        for (size_t i = 0; i < expected->size; i++) {
+            EXPECT_EQ(((Employee *)actual->data[i])->id, ((Employee *)expected->data[i])->id);
+        }
+        vector_free(expected);
+        vector_free(actual);
+    }
+    int id = 1001 + FILE_BLOCK_RECORDS * 2;
+    Vector *result = employee_manager_search(loaded, SEARCH_BY_ID, &id);
+    ASSERT_EQ(result->size, 1u);
+    EXPECT_STREQ(((Employee *)result->data[0])->department, "新部门");
+    vector_free(result);
+    
+    // 加载到非空管理器时追加在已有记录之后
+    ASSERT_EQ(storage_load_employees_parallel(TEST_DB_FILE, loaded, nullptr), SUCCESS);
+    ASSERT_EQ(loaded->employees->size, mgr->employees->size * 2);
+    EXPECT_EQ(memcmp(loaded->employees->data[mgr->employees->size + 3], mgr->employees->data[3],
+                     sizeof(Employee)), 0);
+    employee_manager_free(loaded);
+    
+    // 篡改第四块: 报告损坏,管理器保持为空
+    std::string data = read_whole_file(TEST_DB_FILE);
+    data[FILE_V2_DATA_OFFSET + FILE_BLOCK_RECORDS * 3 * sizeof(Employee) + 40] ^= 0x5A;
+    FILE *fp = fopen(TEST_DB_FILE, "wb");
+    ASSERT_NE(fp, nullptr);
+    fwrite(data.data(), 1, data.size(), fp);
+    fclose(fp);
+    loaded = employee_manager_create();
+    EXPECT_EQ(storage_load_employees_parallel(TEST_DB_FILE, loaded, pool), ERROR_DATA_CORRUPTION);
+    EXPECT_EQ(loaded->employees->size, 0u);
+    employee_manager_free(loaded);
+    
+    EXPECT_EQ(storage_load_employees_parallel(nullptr, mgr, pool), ERROR_NULL_POINTER);
+    thread_pool_free(pool);
+    employee_manager_free(mgr);
+}
+
+// 测试多线程加载时建立索引失败: 放弃索引,记录照常加载
+TEST_F(StorageTest, ParallelLoadSurvivesIndexFailure) {
+    EmployeeManager *mgr = employee_manager_create();
+    for (int i = 0; i < FILE_BLOCK_RECORDS * 4 + 5; i++) {
+        employee_manager_add(mgr, "员工", (i % 3) ? "研发部" : "市场部", "2024-01-15", i % 31);
+    }
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, mgr), SUCCESS);
+    // 增量保存后的文件没有索引段,加载时由各线程编码部门再合并
+    employee_manager_update(mgr, 1003, "改名", "人事部", "2024-02-01", 3);
+    ASSERT_EQ(storage_save_employees(TEST_DB_FILE, mgr), SUCCESS);
+    
+    ThreadPool *pool = thread_pool_create(3);
+    ASSERT_NE(pool, nullptr);
+    for (size_t fail_at = 1; fail_at <= 3; fail_at++) {
+        index_partial_fail_after(fail_at);
+        EmployeeManager *loaded = employee_manager_create();
+        EXPECT_EQ(storage_load_employees_parallel(TEST_DB_FILE, loaded, pool), SUCCESS);
+        index_partial_fail_after(0);
+        expect_same_records(mgr, loaded);
+        EXPECT_EQ(loaded->index, nullptr);
+        
+        Vector *result = employee_manager_search(loaded, SEARCH_BY_DEPARTMENT, "人事部");
+        ASSERT_NE(result, nullptr);
+        ASSERT_EQ(result->size, 1u);
+        EXPECT_EQ(((Employee *)result->data[0])->id, 1003);
+        vector_free(result);
+        employee_manager_free(loaded);
+    }
+    
+    thread_pool_free(pool);
+    employee_manager_free(mgr);
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include "test_helpers.h"
+extern "C" {
+    #include "../sync.h"
+    #include "../storage.h"
+    #include "../model.h"
+}
+
+const char *TEST_SYNC_DB = "test_sync.db";
+
+class SyncTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::remove(TEST_SYNC_DB);
+    }
+    
+    void TearDown() override {
+        std::remove(TEST_SYNC_DB);
+    }
+};
+
+// 测试增量同步: 首次完整复制,之后只传输差异
+TEST_F(SyncTest, SyncFileTransfersDifferences) {
+    const char *replica = "test_replica.db";
+    std::remove(replica);
+    EmployeeManager *mgr = employee_manager_create();
+    for (int i = 0; i < FILE_BLOCK_RECORDS * 3 + 20; i++) {
+        employee_manager_add(mgr, "员工", (i % 3) ? "研发部" : "市场部", "2024-01-15", i % 31);
+    }
+    ASSERT_EQ(storage_save_employees(TEST_SYNC_DB, mgr), SUCCESS);
+    
+    // 备份不存在: 完整复制
+    SyncStats stats = {};
+    ASSERT_EQ(storage_sync_file(TEST_SYNC_DB, replica, &stats), SUCCESS);
+    EXPECT_TRUE(stats.full_copy);
+    EXPECT_EQ(stats.written_bytes, stats.source_bytes);
+    EXPECT_EQ(read_whole_file(replica), read_whole_file(TEST_SYNC_DB));
+    
+    // 没有变化: 不写入
+    ASSERT_EQ(storage_sync_file(TEST_SYNC_DB, replica, &stats), SUCCESS);
+    EXPECT_TRUE(stats.in_place);
+    EXPECT_EQ(stats.written_bytes, 0u);
+    EXPECT_EQ(stats.literal_bytes, 0u);
+    
+    // 修改一条记录(增量保存追加一个记录块): 只传输少量字节,其余从备份自身复制
+    employee_manager_update(mgr, 1001 + 100, "改名", "人事部", "2024-03-01", 7);
+    ASSERT_EQ(storage_save_employees(TEST_SYNC_DB, mgr), SUCCESS);
+    ASSERT_EQ(storage_sync_file(TEST_SYNC_DB, replica, &stats), SUCCESS);
+    EXPECT_TRUE(stats.in_place);
+    EXPECT_FALSE(stats.full_copy);
+    EXPECT_LT(stats.literal_bytes, (unsigned long long)SYNC_BLOCK_SIZE * 4);
+    EXPECT_LT(stats.written_bytes, stats.source_bytes / 3);
+    EXPECT_EQ(read_whole_file(replica), read_whole_file(TEST_SYNC_DB));
+    
+    // 删除第一块中的一条记录(整体改动过多,完整保存): 其后的数据前移,经滚动匹配找到
+    employee_manager_remove_by_id(mgr, 1001 + 5);
+    ASSERT_EQ(storage_save_employees(TEST_SYNC_DB, mgr), SUCCESS);
+    ASSERT_EQ(storage_sync_file(TEST_SYNC_DB, replica, &stats), SUCCESS);
+    EXPECT_FALSE(stats.in_place);
+    EXPECT_FALSE(stats.full_copy);
+    EXPECT_GT(stats.matched_bytes, stats.source_bytes / 2);
+    EXPECT_EQ(stats.matched_bytes + stats.literal_bytes, stats.source_bytes);
+    EXPECT_EQ(read_whole_file(replica), read_whole_file(TEST_SYNC_DB));
+    
+    employee_manager_free(mgr);
+    std::remove(replica);
+}
+
+// 测试任意文件内容: 截短、插入、重复块
+TEST_F(SyncTest, SyncFileArbitraryEdits) {
+    const char *source = "test_sync_source.bin";
+    const char *replica = "test_sync_replica.bin";
+    std::string data;
+    unsigned int x = 12345;
+    for (int i = 0; i < SYNC_BLOCK_SIZE * 10 + 123; i++) {
+        x = x * 1103515245u + 12345u;
+        data.push_back((char)(x >> 16));
+    }
+    data.append(std::string(SYNC_BLOCK_SIZE * 3, '\0'));  // 重复块
+    write_whole_file(source, data);
+    write_whole_file(replica, data + std::string(SYNC_BLOCK_SIZE * 2, 'x'));
+    
+    // 备份更长: 截断
+    SyncStats stats = {};
+    ASSERT_EQ(storage_sync_file(source, replica, &stats), SUCCESS);
+    EXPECT_TRUE(stats.in_place);
+    EXPECT_EQ(read_whole_file(replica), data);
+    
+    // 中间插入几个字节
+    std::string edited = data.substr(0, 5000) + "inserted" + data.substr(5000);
+    write_whole_file(source, edited);
+    ASSERT_EQ(storage_sync_file(source, replica, &stats), SUCCESS);
+    EXPECT_FALSE(stats.full_copy);
+    EXPECT_LT(stats.literal_bytes, (unsigned long long)SYNC_BLOCK_SIZE * 3);
+    EXPECT_EQ(read_whole_file(replica), edited);
+    
+    // 空源文件
+    write_whole_file(source, "");
+    ASSERT_EQ(storage_sync_file(source, replica, nullptr), SUCCESS);
+    EXPECT_EQ(read_whole_file(replica), "");
+    
+    EXPECT_EQ(storage_sync_file(nullptr, replica, &stats), ERROR_NULL_POINTER);
+    EXPECT_EQ(storage_sync_file("no_such_file.db", replica, &stats), ERROR_FILE_NOT_FOUND);
+    std::remove(source);
+    std::remove(replica);
+}
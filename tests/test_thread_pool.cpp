@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <vector>
+extern "C" {
+    #include "../thread.h"
+    #include "../thread_pool.h"
+}
+
+// 任务: 将下标写入对应槽位
+static void fill_index(void *ctx, size_t index) {
+    long *slots = (long *)ctx;
+    slots[index] = (long)index;
+}
+
+// 任务: 原子累加
+static void count_task(void *ctx, size_t index) {
+    (void)index;
+    atomic_long_add((volatile long *)ctx, 1);
+}
+
+// 测试thread_pool_create和thread_pool_free
+TEST(ThreadPoolTest, CreateAndFree) {
+    ThreadPool *pool = thread_pool_create(4);
+    ASSERT_NE(pool, nullptr);
+    EXPECT_EQ(thread_pool_concurrency(pool), 5);
+    thread_pool_free(pool);
+    thread_pool_free(nullptr);  // 不应该崩溃
+    
+    EXPECT_EQ(thread_pool_create(-1), nullptr);
+}
+
+// 测试所有任务恰好执行一次
+TEST(ThreadPoolTest, RunAllTasks) {
+    ThreadPool *pool = thread_pool_create(3);
+    ASSERT_NE(pool, nullptr);
+    
+    std::vector<long> slots(1000, -1);
+    EXPECT_EQ(thread_pool_run(pool, slots.size(), fill_index, slots.data()), SUCCESS);
+    for (size_t i = 0; i < slots.size(); i++) {
+        EXPECT_EQ(slots[i], (long)i);
+    }
+    
+    // 同一线程池可重复提交作业
+    for (int round = 0; round < 50; round++) {
+        volatile long counter = 0;
+        EXPECT_EQ(thread_pool_run(pool, 37, count_task, (void *)&counter), SUCCESS);
+        EXPECT_EQ(atomic_long_load(&counter), 37);
+    }
+    
+    thread_pool_free(pool);
+}
+
+// 测试无工作线程时串行执行
+TEST(ThreadPoolTest, RunWithoutWorkers) {
+    ThreadPool *pool = thread_pool_create(0);
+    ASSERT_NE(pool, nullptr);
+    
+    volatile long counter = 0;
+    EXPECT_EQ(thread_pool_run(pool, 10, count_task, (void *)&counter), SUCCESS);
+    EXPECT_EQ(counter, 10);
+    EXPECT_EQ(thread_pool_run(pool, 0, count_task, (void *)&counter), SUCCESS);
+    EXPECT_EQ(counter, 10);
+    
+    thread_pool_free(pool);
+}
+
+// 测试NULL参数
+TEST(ThreadPoolTest, RunNullParams) {
+    ThreadPool *pool = thread_pool_create(1);
+    ASSERT_NE(pool, nullptr);
+    
+    EXPECT_EQ(thread_pool_run(nullptr, 1, count_task, nullptr), ERROR_NULL_POINTER);
+    EXPECT_EQ(thread_pool_run(pool, 1, nullptr, nullptr), ERROR_NULL_POINTER);
+    
+    thread_pool_free(pool);
+}
+
+// 测试共享线程池
+TEST(ThreadPoolTest, DefaultPool) {
+    ThreadPool *pool = thread_pool_default();
+    ASSERT_NE(pool, nullptr);
+    EXPECT_EQ(thread_pool_default(), pool);
+    EXPECT_EQ(thread_pool_concurrency(pool), thread_cpu_count());
+}
+
+// 线程函数: 在锁保护下累加
+struct LockedCounter {
+    Mutex *mutex;
+    long value;
+};
+
+static void locked_increment(void *arg) {
+    LockedCounter *counter = (LockedCounter *)arg;
+    for (int i = 0; i < 10000; i++) {
+        mutex_lock(counter->mutex);
+        counter->value++;
+        mutex_unlock(counter->mutex);
+    }
+}
+
+// 测试线程与互斥锁
+TEST(ThreadTest, ThreadAndMutex) {
+    LockedCounter counter;
+    counter.mutex = mutex_create();
+    counter.value = 0;
+    ASSERT_NE(counter.mutex, nullptr);
+    
+    Thread *threads[4];
+    for (int i = 0; i < 4; i++) {
+        threads[i] = thread_create(locked_increment, &counter);
+        ASSERT_NE(threads[i], nullptr);
+    }
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(thread_join(threads[i]), SUCCESS);
+    }
+    EXPECT_EQ(counter.value, 40000);
+    
+    EXPECT_EQ(thread_create(nullptr, nullptr), nullptr);
+    EXPECT_EQ(thread_join(nullptr), ERROR_NULL_POINTER);
+    mutex_free(counter.mutex);
+}
+
+// 测试原子指针操作
+TEST(ThreadTest, AtomicPointer) {
+    int a = 1, b = 2;
+    void *volatile slot = &a;
+    
+    EXPECT_EQ(atomic_ptr_load(&slot), &a);
+    EXPECT_EQ(atomic_ptr_cas(&slot, &b, &b), FALSE);
+    EXPECT_EQ(atomic_ptr_cas(&slot, &a, &b), TRUE);
+    EXPECT_EQ(atomic_ptr_load(&slot), &b);
+    atomic_ptr_store(&slot, nullptr);
+    EXPECT_EQ(atomic_ptr_load(&slot), nullptr);
+}
@@ -242,3 +242,21 @@ TEST(VectorTest, ShrinkToInitialCapacity) {
     
     vector_free(v);
 }
+
+// 测试vector_reserve
+TEST(VectorTest, Reserve) {
+    Vector *v = vector_create();
+    ASSERT_NE(v, nullptr);
+    
+    EXPECT_EQ(vector_reserve(v, 100), SUCCESS);
+    EXPECT_EQ(v->capacity, 100);
+    EXPECT_EQ(v->size, 0);
+    
+    // 预留更小的容量不应收缩
+    EXPECT_EQ(vector_reserve(v, 10), SUCCESS);
+    EXPECT_EQ(v->capacity, 100);
+    
+    EXPECT_EQ(vector_reserve(nullptr, 10), ERROR_NULL_POINTER);
+    
+    vector_free(v);
+}
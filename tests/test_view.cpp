@@ -1,4 +1,7 @@
 #include <gtest/gtest.h>
+#include <climits>
+#include <cstdio>
+#include <string>
 extern "C" {
     #include "../view.h"
     #include "../model.h"
@@ -15,6 +18,10 @@ TEST(ViewTest, CreateView) {
     ASSERT_NE(view->vptr->show_message, nullptr);
     ASSERT_NE(view->vptr->get_input_int, nullptr);
     ASSERT_NE(view->vptr->get_input_string, nullptr);
+    ASSERT_NE(view->vptr->show_title, nullptr);
+    ASSERT_NE(view->vptr->show_text, nullptr);
+    ASSERT_NE(view->vptr->pause, nullptr);
+    EXPECT_TRUE(view->interactive);
     view_free(view);
 }
 
@@ -37,7 +44,7 @@ TEST(ViewTest, ShowMenu) {
 TEST(ViewTest, ShowTableHeader) {
     AppView *view = view_create_console();
     ASSERT_NE(view, nullptr);
-    view->vptr->show_table_header();  // 不应该崩溃
+    view->vptr->show_table_header(view);  // 不应该崩溃
     view_free(view);
 }
 
@@ -48,8 +55,8 @@ TEST(ViewTest, RenderRow) {
     
     AppView *view = view_create_console();
     ASSERT_NE(view, nullptr);
-    view->vptr->render_row(emp);  // 不应该崩溃
-    view->vptr->render_row(nullptr);  // 不应该崩溃
+    view->vptr->render_row(view, emp);  // 不应该崩溃
+    view->vptr->render_row(view, nullptr);  // 不应该崩溃
     view_free(view);
     
     employee_free(emp);
@@ -59,8 +66,90 @@ TEST(ViewTest, RenderRow) {
 TEST(ViewTest, ShowMessage) {
     AppView *view = view_create_console();
     ASSERT_NE(view, nullptr);
-    view->vptr->show_message("测试消息", FALSE);  // 不应该崩溃
-    view->vptr->show_message("错误消息", TRUE);  // 不应该崩溃
-    view->vptr->show_message(nullptr, FALSE);  // 不应该崩溃
+    view->vptr->show_message(view, "测试消息", FALSE);  // 不应该崩溃
+    view->vptr->show_message(view, "错误消息", TRUE);  // 不应该崩溃
+    view->vptr->show_message(view, nullptr, FALSE);  // 不应该崩溃
     view_free(view);
 }
+
+// 批处理视图: 输入来自字符串,返回输出内容
+static FILE *make_input(const char *text) {
+    FILE *fp = std::tmpfile();
+    std::fputs(text, fp);
+    std::rewind(fp);
+    return fp;
+}
+
+static std::string read_output(FILE *fp) {
+    std::string text;
+    std::rewind(fp);
+    char buffer[1024];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+        text.append(buffer, n);
+    }
+    return text;
+}
+
+// 测试批处理视图按字段读取输入: 制表符与换行都分隔字段,跳过空行与注释
+TEST(BatchViewTest, ReadsFields) {
+    FILE *in = make_input("# 注释\t行\n1\t张三\t研发部\r\n\n  \n42\n12x\n-7\n99999999999\n-2147483648\n2147483647\n2147483648\n");
+    FILE *out = std::tmpfile();
+    AppView *view = view_create_batch(in, out);
+    ASSERT_NE(view, nullptr);
+    EXPECT_FALSE(view->interactive);
+
+    char buffer[16];
+    EXPECT_EQ(view->vptr->get_input_int(view, "choice: "), 1);
+    view->vptr->get_input_string(view, "name: ", buffer, sizeof(buffer));
+    EXPECT_STREQ(buffer, "张三");
+    view->vptr->get_input_string(view, "dept: ", buffer, sizeof(buffer));
+    EXPECT_STREQ(buffer, "研发部");
+    view->vptr->get_input_string(view, "text: ", buffer, 3);  // 截断到缓冲区大小
+    EXPECT_STREQ(buffer, "  ");
+    EXPECT_EQ(view->vptr->get_input_int(view, nullptr), 42);
+    EXPECT_EQ(view->vptr->get_input_int(view, nullptr), -1);
+    EXPECT_EQ(view->vptr->get_input_int(view, nullptr), -7);
+    EXPECT_EQ(view->vptr->get_input_int(view, nullptr), -1);
+    EXPECT_EQ(view->vptr->get_input_int(view, nullptr), INT_MIN);
+    EXPECT_EQ(view->vptr->get_input_int(view, nullptr), INT_MAX);
+    EXPECT_EQ(view->vptr->get_input_int(view, nullptr), -1);
+
+    // 输入结束: 整数为0,字符串为空
+    EXPECT_EQ(view->vptr->get_input_int(view, nullptr), 0);
+    view->vptr->get_input_string(view, nullptr, buffer, sizeof(buffer));
+    EXPECT_STREQ(buffer, "");
+
+    view->vptr->pause(view);  // 不应阻塞
+    view_free(view);
+    EXPECT_EQ(read_output(out), "");
+    std::fclose(in);
+    std::fclose(out);
+}
+
+// 测试批处理视图的紧凑输出: 只输出消息与CSV记录
+TEST(BatchViewTest, CompactOutput) {
+    FILE *in = make_input("");
+    FILE *out = std::tmpfile();
+    AppView *view = view_create_batch(in, out);
+    ASSERT_NE(view, nullptr);
+    Employee *emp = employee_create(1001, "张三", "研发部", "2024-01-15", 22);
+
+    view->vptr->show_menu(view);
+    view->vptr->show_title(view, "Search Employee");
+    view->vptr->show_text(view, "1. Search by ID\n");
+    view->vptr->show_table_header(view);
+    view->vptr->render_row(view, emp);
+    view->vptr->show_message(view, "Employee added successfully!", FALSE);
+    view->vptr->show_message(view, "Employee ID not found!", TRUE);
+    EXPECT_EQ(view_batch_errors(view), 1u);
+    view_free(view);
+
+    EXPECT_EQ(read_output(out), "1001,张三,研发部,2024-01-15,22\n"
+                                "info: Employee added successfully!\n"
+                                "error: Employee ID not found!\n");
+    employee_free(emp);
+    std::fclose(in);
+    std::fclose(out);
+    EXPECT_EQ(view_create_batch(nullptr, nullptr), nullptr);
+}
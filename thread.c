@@ -0,0 +1,276 @@
+#include "thread.h"
+#include <stdlib.h>
+
+#if defined(_WIN32)
+    #include <windows.h>
+    #include <process.h>
+#else
+    #include <pthread.h>
+    #include <sched.h>
+    #include <unistd.h>
+#endif
+
+/* ========== 线程 ========== */
+
+struct Thread {
+#if defined(_WIN32)
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+    ThreadFunc func;
+    void *arg;
+};
+
+#if defined(_WIN32)
+static unsigned __stdcall thread_entry(void *param) {
+    Thread *thread = (Thread *)param;
+    thread->func(thread->arg);
+    return 0;
+}
+#else
+static void *thread_entry(void *param) {
+    Thread *thread = (Thread *)param;
+    thread->func(thread->arg);
+    return NULL;
+}
+#endif
+
+Thread *thread_create(ThreadFunc func, void *arg) {
+    if (func == NULL) {
+        return NULL;
+    }
+
+    Thread *thread = (Thread *)malloc(sizeof(Thread));
+    if (thread == NULL) {
+        return NULL;
+    }
+
+    thread->func = func;
+    thread->arg = arg;
+
+#if defined(_WIN32)
+    thread->handle = (HANDLE)_beginthreadex(NULL, 0, thread_entry, thread, 0, NULL);
+    if (thread->handle == 0) {
+        free(thread);
+        return NULL;
+    }
+#else
+    if (pthread_create(&thread->handle, NULL, thread_entry, thread) != 0) {
+        free(thread);
+        return NULL;
+    }
+#endif
+
+    return thread;
+}
+
+ErrorCode thread_join(Thread *thread) {
+    if (thread == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+#if defined(_WIN32)
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+#else
+    pthread_join(thread->handle, NULL);
+#endif
+
+    free(thread);
+    return SUCCESS;
+}
+
+void thread_yield(void) {
+#if defined(_WIN32)
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+int thread_cpu_count(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int count = (int)info.dwNumberOfProcessors;
+#else
+    int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return (count > 0) ? count : 1;
+}
+
+/* ========== 互斥锁 ========== */
+
+struct Mutex {
+#if defined(_WIN32)
+    CRITICAL_SECTION handle;
+#else
+    pthread_mutex_t handle;
+#endif
+};
+
+Mutex *mutex_create(void) {
+    Mutex *mutex = (Mutex *)malloc(sizeof(Mutex));
+    if (mutex == NULL) {
+        return NULL;
+    }
+
+#if defined(_WIN32)
+    InitializeCriticalSection(&mutex->handle);
+#else
+    if (pthread_mutex_init(&mutex->handle, NULL) != 0) {
+        free(mutex);
+        return NULL;
+    }
+#endif
+
+    return mutex;
+}
+
+void mutex_free(Mutex *mutex) {
+    if (mutex != NULL) {
+#if defined(_WIN32)
+        DeleteCriticalSection(&mutex->handle);
+#else
+        pthread_mutex_destroy(&mutex->handle);
+#endif
+        free(mutex);
+    }
+}
+
+void mutex_lock(Mutex *mutex) {
+#if defined(_WIN32)
+    EnterCriticalSection(&mutex->handle);
+#else
+    pthread_mutex_lock(&mutex->handle);
+#endif
+}
+
+Bool mutex_trylock(Mutex *mutex) {
+#if defined(_WIN32)
+    return TryEnterCriticalSection(&mutex->handle) ? TRUE : FALSE;
+#else
+    return (pthread_mutex_trylock(&mutex->handle) == 0) ? TRUE : FALSE;
+#endif
+}
+
+void mutex_unlock(Mutex *mutex) {
+#if defined(_WIN32)
+    LeaveCriticalSection(&mutex->handle);
+#else
+    pthread_mutex_unlock(&mutex->handle);
+#endif
+}
+
+/* ========== 条件变量 ========== */
+
+struct CondVar {
+#if defined(_WIN32)
+    CONDITION_VARIABLE handle;
+#else
+    pthread_cond_t handle;
+#endif
+};
+
+CondVar *cond_create(void) {
+    CondVar *cond = (CondVar *)malloc(sizeof(CondVar));
+    if (cond == NULL) {
+        return NULL;
+    }
+
+#if defined(_WIN32)
+    InitializeConditionVariable(&cond->handle);
+#else
+    if (pthread_cond_init(&cond->handle, NULL) != 0) {
+        free(cond);
+        return NULL;
+    }
+#endif
+
+    return cond;
+}
+
+void cond_free(CondVar *cond) {
+    if (cond != NULL) {
+#if !defined(_WIN32)
+        pthread_cond_destroy(&cond->handle);
+#endif
+        free(cond);
+    }
+}
+
+void cond_wait(CondVar *cond, Mutex *mutex) {
+#if defined(_WIN32)
+    SleepConditionVariableCS(&cond->handle, &mutex->handle, INFINITE);
+#else
+    pthread_cond_wait(&cond->handle, &mutex->handle);
+#endif
+}
+
+void cond_signal(CondVar *cond) {
+#if defined(_WIN32)
+    WakeConditionVariable(&cond->handle);
+#else
+    pthread_cond_signal(&cond->handle);
+#endif
+}
+
+void cond_broadcast(CondVar *cond) {
+#if defined(_WIN32)
+    WakeAllConditionVariable(&cond->handle);
+#else
+    pthread_cond_broadcast(&cond->handle);
+#endif
+}
+
+/* ========== 原子操作 ========== */
+
+long atomic_long_load(volatile long *ptr) {
+#if defined(_MSC_VER)
+    return InterlockedCompareExchange(ptr, 0, 0);
+#else
+    return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+#endif
+}
+
+void atomic_long_store(volatile long *ptr, long value) {
+#if defined(_MSC_VER)
+    InterlockedExchange(ptr, value);
+#else
+    __atomic_store_n(ptr, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+long atomic_long_add(volatile long *ptr, long delta) {
+#if defined(_MSC_VER)
+    return InterlockedExchangeAdd(ptr, delta) + delta;
+#else
+    return __atomic_add_fetch(ptr, delta, __ATOMIC_SEQ_CST);
+#endif
+}
+
+void *atomic_ptr_load(void *volatile *ptr) {
+#if defined(_MSC_VER)
+    return InterlockedCompareExchangePointer(ptr, NULL, NULL);
+#else
+    return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+#endif
+}
+
+void atomic_ptr_store(void *volatile *ptr, void *value) {
+#if defined(_MSC_VER)
+    InterlockedExchangePointer(ptr, value);
+#else
+    __atomic_store_n(ptr, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+Bool atomic_ptr_cas(void *volatile *ptr, void *expected, void *desired) {
+#if defined(_MSC_VER)
+    return (InterlockedCompareExchangePointer(ptr, desired, expected) == expected) ? TRUE : FALSE;
+#else
+    return __atomic_compare_exchange_n(ptr, &expected, desired, 0,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST) ? TRUE : FALSE;
+#endif
+}
@@ -0,0 +1,59 @@
+#ifndef THREAD_H
+#define THREAD_H
+
+#include "common.h"
+
+/*
+ * 跨平台线程原语
+ * Windows 使用 Win32 API,其他平台使用 POSIX pthread。
+ * 所有对象均为不透明指针,避免在头文件中引入平台头文件。
+ */
+
+typedef struct Thread Thread;    /* 线程 */
+typedef struct Mutex Mutex;      /* 互斥锁 */
+typedef struct CondVar CondVar;  /* 条件变量 */
+
+/* 线程入口函数类型 */
+typedef void (*ThreadFunc)(void *arg);
+
+/* ========== 线程 ========== */
+
+/* 创建并启动线程,失败返回NULL */
+Thread *thread_create(ThreadFunc func, void *arg);
+
+/* 等待线程结束并释放线程对象 */
+ErrorCode thread_join(Thread *thread);
+
+/* 让出当前线程的CPU时间片 */
+void thread_yield(void);
+
+/* 获取可用的CPU核心数(至少为1) */
+int thread_cpu_count(void);
+
+/* ========== 互斥锁 ========== */
+
+Mutex *mutex_create(void);
+void mutex_free(Mutex *mutex);
+void mutex_lock(Mutex *mutex);
+Bool mutex_trylock(Mutex *mutex);  /* 成功加锁返回TRUE */
+void mutex_unlock(Mutex *mutex);
+
+/* ========== 条件变量 ========== */
+
+CondVar *cond_create(void);
+void cond_free(CondVar *cond);
+void cond_wait(CondVar *cond, Mutex *mutex);  /* 调用前必须持有mutex */
+void cond_signal(CondVar *cond);
+void cond_broadcast(CondVar *cond);
+
+/* ========== 原子操作(顺序一致性) ========== */
+
+long atomic_long_load(volatile long *ptr);
+void atomic_long_store(volatile long *ptr, long value);
+long atomic_long_add(volatile long *ptr, long delta);  /* 返回相加后的新值 */
+
+void *atomic_ptr_load(void *volatile *ptr);
+void atomic_ptr_store(void *volatile *ptr, void *value);
+Bool atomic_ptr_cas(void *volatile *ptr, void *expected, void *desired);
+
+#endif /* THREAD_H */
@@ -0,0 +1,194 @@
+#include "thread_pool.h"
+#include "thread.h"
+#include <stdlib.h>
+
+struct ThreadPool {
+    Thread **workers;        /* 工作线程 */
+    int worker_count;        /* 工作线程数 */
+    Mutex *run_lock;         /* 串行化并发提交的作业 */
+    Mutex *lock;             /* 保护下列作业状态 */
+    CondVar *work_ready;     /* 新作业或关闭通知 */
+    CondVar *work_done;      /* 作业完成通知 */
+    unsigned long generation;/* 作业代数,每提交一次加1 */
+    Bool shutdown;           /* 关闭标志 */
+    ParallelTask task;       /* 当前作业 */
+    void *ctx;
+    long task_count;
+    volatile long next_task; /* 下一个待领取的任务编号 */
+    volatile long finished;  /* 已完成的任务数 */
+    int active;              /* 正在领取当前作业任务的工作线程数 */
+};
+
+/* 循环领取并执行任务,直到任务编号耗尽 */
+static void thread_pool_drain(ThreadPool *pool, ParallelTask task, void *ctx, long count) {
+    for (;;) {
+        long index = atomic_long_add(&pool->next_task, 1) - 1;
+        if (index >= count) {
+            break;
+        }
+        task(ctx, (size_t)index);
+        atomic_long_add(&pool->finished, 1);
+    }
+}
+
+static void thread_pool_worker(void *arg) {
+    ThreadPool *pool = (ThreadPool *)arg;
+    unsigned long seen = 0;
+
+    mutex_lock(pool->lock);
+    for (;;) {
+        while (!pool->shutdown && pool->generation == seen) {
+            cond_wait(pool->work_ready, pool->lock);
+        }
+        if (pool->shutdown) {
+            break;
+        }
+
+        /* 在锁内取出作业快照,调用方在active归零前不会复用作业槽 */
+        seen = pool->generation;
+        ParallelTask task = pool->task;
+        void *ctx = pool->ctx;
+        long count = pool->task_count;
+        pool->active++;
+        mutex_unlock(pool->lock);
+
+        thread_pool_drain(pool, task, ctx, count);
+
+        mutex_lock(pool->lock);
+        pool->active--;
+        cond_broadcast(pool->work_done);
+    }
+    mutex_unlock(pool->lock);
+}
+
+ThreadPool *thread_pool_create(int worker_count) {
+    if (worker_count < 0) {
+        return NULL;
+    }
+
+    ThreadPool *pool = (ThreadPool *)calloc(1, sizeof(ThreadPool));
+    if (pool == NULL) {
+        return NULL;
+    }
+
+    pool->run_lock = mutex_create();
+    pool->lock = mutex_create();
+    pool->work_ready = cond_create();
+    pool->work_done = cond_create();
+    if (worker_count > 0) {
+        pool->workers = (Thread **)calloc((size_t)worker_count, sizeof(Thread *));
+    }
+
+    if (pool->run_lock == NULL || pool->lock == NULL || pool->work_ready == NULL ||
+        pool->work_done == NULL || (worker_count > 0 && pool->workers == NULL)) {
+        thread_pool_free(pool);
+        return NULL;
+    }
+
+    for (int i = 0; i < worker_count; i++) {
+        pool->workers[i] = thread_create(thread_pool_worker, pool);
+        if (pool->workers[i] == NULL) {
+            thread_pool_free(pool);
+            return NULL;
+        }
+        pool->worker_count++;
+    }
+
+    return pool;
+}
+
+void thread_pool_free(ThreadPool *pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    if (pool->lock != NULL && pool->work_ready != NULL) {
+        mutex_lock(pool->lock);
+        pool->shutdown = TRUE;
+        cond_broadcast(pool->work_ready);
+        mutex_unlock(pool->lock);
+    }
+
+    for (int i = 0; i < pool->worker_count; i++) {
+        thread_join(pool->workers[i]);
+    }
+
+    free(pool->workers);
+    cond_free(pool->work_done);
+    cond_free(pool->work_ready);
+    mutex_free(pool->lock);
+    mutex_free(pool->run_lock);
+    free(pool);
+}
+
+int thread_pool_concurrency(const ThreadPool *pool) {
+    if (pool == NULL) {
+        return 1;
+    }
+    return pool->worker_count + 1;
+}
+
+ErrorCode thread_pool_run(ThreadPool *pool, size_t task_count,
+                          ParallelTask task, void *ctx) {
+    if (pool == NULL || task == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+
+    if (task_count == 0) {
+        return SUCCESS;
+    }
+
+    /* 无工作线程、单个任务或线程池正被占用(如任务内嵌套提交)时直接串行执行 */
+    if (pool->worker_count == 0 || task_count == 1 || !mutex_trylock(pool->run_lock)) {
+        for (size_t i = 0; i < task_count; i++) {
+            task(ctx, i);
+        }
+        return SUCCESS;
+    }
+
+    mutex_lock(pool->lock);
+    /* 迟到的工作线程可能仍持有上一作业的快照,待其退出领取循环后再复用作业槽 */
+    while (pool->active > 0) {
+        cond_wait(pool->work_done, pool->lock);
+    }
+    pool->task = task;
+    pool->ctx = ctx;
+    pool->task_count = (long)task_count;
+    atomic_long_store(&pool->next_task, 0);
+    atomic_long_store(&pool->finished, 0);
+    pool->generation++;
+    cond_broadcast(pool->work_ready);
+    mutex_unlock(pool->lock);
+
+    thread_pool_drain(pool, task, ctx, (long)task_count);
+
+    mutex_lock(pool->lock);
+    while (atomic_long_load(&pool->finished) < (long)task_count) {
+        cond_wait(pool->work_done, pool->lock);
+    }
+    mutex_unlock(pool->lock);
+
+    mutex_unlock(pool->run_lock);
+    return SUCCESS;
+}
+
+static void *volatile default_pool = NULL;
+
+ThreadPool *thread_pool_default(void) {
+    ThreadPool *pool = (ThreadPool *)atomic_ptr_load(&default_pool);
+    if (pool != NULL) {
+        return pool;
+    }
+
+    pool = thread_pool_create(thread_cpu_count() - 1);
+    if (pool == NULL) {
+        return NULL;
+    }
+
+    /* 并发初始化时只保留第一个成功发布的线程池 */
+    if (!atomic_ptr_cas(&default_pool, NULL, pool)) {
+        thread_pool_free(pool);
+        pool = (ThreadPool *)atomic_ptr_load(&default_pool);
+    }
+    return pool;
+}
@@ -0,0 +1,28 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "common.h"
+
+/* 并行任务函数: ctx为共享上下文, task_index为任务编号[0, task_count) */
+typedef void (*ParallelTask)(void *ctx, size_t task_index);
+
+/* 线程池(fork-join模型): 调用线程也参与执行任务 */
+typedef struct ThreadPool ThreadPool;
+
+/* 创建线程池, worker_count为后台工作线程数(可为0,此时任务在调用线程串行执行) */
+ThreadPool *thread_pool_create(int worker_count);
+
+/* 释放线程池,等待所有工作线程退出 */
+void thread_pool_free(ThreadPool *pool);
+
+/* 获取并行度(工作线程数 + 调用线程) */
+int thread_pool_concurrency(const ThreadPool *pool);
+
+/* 执行task_count个任务并等待全部完成 */
+ErrorCode thread_pool_run(ThreadPool *pool, size_t task_count,
+                          ParallelTask task, void *ctx);
+
+/* 获取进程级共享线程池(按CPU核心数懒创建,进程退出前无需释放) */
+ThreadPool *thread_pool_default(void);
+
+#endif /* THREAD_POOL_H */
@@ -55,6 +55,19 @@ ErrorCode vector_push_back(Vector *v, void *element) {
     return SUCCESS;
 }
 
+/* 预留容量: 已知元素数量时一次性分配,避免多次扩容 */
+ErrorCode vector_reserve(Vector *v, size_t capacity) {
+    if (v == NULL) {
+        return ERROR_NULL_POINTER;
+    }
+    
+    if (capacity <= v->capacity) {
+        return SUCCESS;
+    }
+    
+    return vector_resize(v, capacity);
+}
+
 /* 获取指定索引的元素 */
 void *vector_get(const Vector *v, size_t index) {
     if (v == NULL || index >= v->size) {
@@ -16,6 +16,7 @@ void vector_free(Vector *v);  /* 释放向量资源 */
 
 /* 向量操作函数 */
 ErrorCode vector_push_back(Vector *v, void *element);  /* 添加元素到末尾 */
+ErrorCode vector_reserve(Vector *v, size_t capacity);   /* 预留至少capacity个元素的容量 */
 void *vector_get(const Vector *v, size_t index);        /* 获取指定索引的元素 */
 ErrorCode vector_remove_at(Vector *v, size_t index);    /* 删除指定索引的元素 */
 void vector_clear(Vector *v);                           /* 清空所有元素 */
@@ -1,4 +1,5 @@
 #include "view.h"
+#include "csv.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -11,6 +12,7 @@ void view_clear_input_buffer(void) {
 
 /* 控制台视图的具体实现函数 */
 static void console_show_menu(AppView *view) {
+    (void)view;
     printf("\n");
     printf("========================================\n");
     printf("  Employee Management System v1.0\n");
@@ -24,17 +26,21 @@ static void console_show_menu(AppView *view) {
     printf("  7. Attendance Statistics\n");
     printf("  8. Export to CSV\n");
     printf("  9. Save and Exit\n");
+    printf(" 10. Save (background)\n");
+    printf(" 11. Import from CSV\n");
     printf("  0. Exit (without saving)\n");
     printf("========================================\n");
 }
 
-static void console_render_row(const Employee *emp) {
+static void console_render_row(AppView *view, const Employee *emp) {
+    (void)view;
     if (emp != NULL) {
         employee_print(emp);
     }
 }
 
-static void console_show_message(const char *msg, Bool is_error) {
+static void console_show_message(AppView *view, const char *msg, Bool is_error) {
+    (void)view;
     if (msg != NULL) {
         if (is_error) {
             printf("\n[ERROR] %s\n", msg);
@@ -44,7 +50,8 @@ static void console_show_message(const char *msg, Bool is_error) {
     }
 }
 
-static int console_get_input_int(const char *prompt) {
+static int console_get_input_int(AppView *view, const char *prompt) {
+    (void)view;
     int value;
     if (prompt != NULL) {
         printf("%s", prompt);
@@ -59,7 +66,8 @@ static int console_get_input_int(const char *prompt) {
     return value;
 }
 
-static void console_get_input_string(const char *prompt, char *buffer, size_t size) {
+static void console_get_input_string(AppView *view, const char *prompt, char *buffer, size_t size) {
+    (void)view;
     if (prompt != NULL) {
         printf("%s", prompt);
     }
@@ -75,13 +83,33 @@ static void console_get_input_string(const char *prompt, char *buffer, size_t si
     }
 }
 
-static void console_show_table_header(void) {
+static void console_show_table_header(AppView *view) {
+    (void)view;
     printf("\n");
     printf("%-8s %-20s %-20s %-12s %-10s\n",
            "ID", "Name", "Department", "Attend Date", "Attend Days");
     printf("------------------------------------------------------------------------\n");
 }
 
+static void console_show_title(AppView *view, const char *title) {
+    (void)view;
+    if (title != NULL) {
+        printf("\n========== %s ==========\n", title);
+    }
+}
+
+static void console_show_text(AppView *view, const char *text) {
+    (void)view;
+    if (text != NULL) {
+        fputs(text, stdout);
+    }
+}
+
+static void console_pause(AppView *view) {
+    (void)view;
+    view_pause();
+}
+
 /* 控制台视图接口实现的静态虚表 */
 static const ViewInterface console_interface = {
     .show_menu = console_show_menu,
@@ -89,7 +117,10 @@ static const ViewInterface console_interface = {
     .show_message = console_show_message,
     .get_input_int = console_get_input_int,
     .get_input_string = console_get_input_string,
-    .show_table_header = console_show_table_header
+    .show_table_header = console_show_table_header,
+    .show_title = console_show_title,
+    .show_text = console_show_text,
+    .pause = console_pause
 };
 
 /* 构造函数 */
@@ -98,13 +129,263 @@ AppView *view_create_console(void) {
     if (view) {
         view->vptr = &console_interface; // 核心：绑定接口
         view->user_data = NULL;
+        view->interactive = TRUE;
+    }
+    return view;
+}
+
+/* ========== 批处理视图 ========== */
+
+/* 输入缓冲初始大小与输出刷新阈值 */
+#define BATCH_INPUT_BUFFER (64 * 1024)
+#define BATCH_FLUSH_BYTES (64 * 1024)
+
+/* 批处理视图状态 */
+typedef struct {
+    FILE *input;        /* 命令来源 */
+    FILE *output;       /* 结果去向 */
+    char *data;         /* 输入缓冲 */
+    size_t size;        /* 缓冲中的有效字节数 */
+    size_t pos;         /* 下一个字段的起点 */
+    size_t capacity;    /* 缓冲容量 */
+    Bool eof;           /* 输入已读完 */
+    Bool line_start;    /* pos位于行首 */
+    CsvBuffer out;      /* 输出缓冲 */
+    size_t errors;      /* 输出过的错误消息数 */
+} BatchView;
+
+/* 读入更多输入: 先把未处理部分移到缓冲开头,缓冲已满时扩容;没有读到数据返回FALSE */
+static Bool batch_fill(BatchView *batch) {
+    if (batch->eof) {
+        return FALSE;
+    }
+    if (batch->pos > 0) {
+        memmove(batch->data, batch->data + batch->pos, batch->size - batch->pos);
+        batch->size -= batch->pos;
+        batch->pos = 0;
+    }
+    if (batch->size == batch->capacity) {
+        char *grown = (char *)realloc(batch->data, batch->capacity * 2);
+        if (grown == NULL) {
+            batch->eof = TRUE;
+            return FALSE;
+        }
+        batch->data = grown;
+        batch->capacity *= 2;
+    }
+    size_t n = fread(batch->data + batch->size, 1, batch->capacity - batch->size, batch->input);
+    batch->size += n;
+    if (n == 0) {
+        batch->eof = TRUE;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/* 取下一个字段(不含分隔符与行尾的\r),跳过空行与注释行;输入结束返回FALSE */
+static Bool batch_next_field(BatchView *batch, const char **field, size_t *length) {
+    for (;;) {
+        char *start = batch->data + batch->pos;
+        size_t remaining = batch->size - batch->pos;
+        char *newline = (char *)memchr(start, '\n', remaining);
+        if (newline == NULL && !batch->eof) {
+            batch_fill(batch);
+            continue;
+        }
+        if (remaining == 0) {
+            return FALSE;
+        }
+
+        char *line_end = (newline != NULL) ? newline : start + remaining;
+        if (batch->line_start) {
+            /* 空行与注释行整行跳过 */
+            size_t line_len = (size_t)(line_end - start);
+            if (line_len > 0 && start[line_len - 1] == '\r') {
+                line_len--;
+            }
+            if (line_len == 0 || start[0] == '#') {
+                batch->pos = (size_t)(line_end - batch->data) + (newline != NULL ? 1 : 0);
+                continue;
+            }
+        }
+
+        char *tab = (char *)memchr(start, '\t', (size_t)(line_end - start));
+        char *end = (tab != NULL) ? tab : line_end;
+        size_t len = (size_t)(end - start);
+        if (tab == NULL && len > 0 && start[len - 1] == '\r') {
+            len--;
+        }
+        *field = start;
+        *length = len;
+        batch->line_start = (tab == NULL) ? TRUE : FALSE;
+        batch->pos = (size_t)(end - batch->data) + ((tab != NULL || newline != NULL) ? 1 : 0);
+        return TRUE;
+    }
+}
+
+/* 输出缓冲达到阈值时写出 */
+static void batch_flush(BatchView *batch, Bool force) {
+    if (batch->out.size > 0 && (force || batch->out.size >= BATCH_FLUSH_BYTES)) {
+        fwrite(batch->out.data, 1, batch->out.size, batch->output);
+        batch->out.size = 0;
+    }
+}
+
+static void batch_show_menu(AppView *view) {
+    (void)view;
+}
+
+static void batch_render_row(AppView *view, const Employee *emp) {
+    BatchView *batch = (BatchView *)view->user_data;
+    if (emp != NULL && csv_append_employee(&batch->out, emp) == SUCCESS) {
+        batch_flush(batch, FALSE);
+    }
+}
+
+static void batch_show_message(AppView *view, const char *msg, Bool is_error) {
+    BatchView *batch = (BatchView *)view->user_data;
+    if (msg == NULL) {
+        return;
+    }
+    if (is_error) {
+        batch->errors++;
+    }
+    const char *tag = is_error ? "error: " : "info: ";
+    csv_buffer_append(&batch->out, tag, strlen(tag));
+    csv_buffer_append(&batch->out, msg, strlen(msg));
+    csv_buffer_append(&batch->out, "\n", 1);
+    batch_flush(batch, FALSE);
+}
+
+static int batch_get_input_int(AppView *view, const char *prompt) {
+    (void)prompt;
+    BatchView *batch = (BatchView *)view->user_data;
+    const char *field = NULL;
+    size_t length = 0;
+    if (!batch_next_field(batch, &field, &length)) {
+        return 0;
+    }
+
+    /* 手工解析,不合法(含溢出)时返回-1 */
+    size_t i = 0;
+    Bool negative = FALSE;
+    if (i < length && (field[i] == '-' || field[i] == '+')) {
+        negative = (field[i] == '-') ? TRUE : FALSE;
+        i++;
+    }
+    if (i == length) {
+        return -1;
+    }
+    /* 负数可到2147483648(即INT_MIN) */
+    long long limit = negative ? 2147483648LL : 2147483647LL;
+    long long value = 0;
+    for (; i < length; i++) {
+        if (field[i] < '0' || field[i] > '9') {
+            return -1;
+        }
+        value = value * 10 + (field[i] - '0');
+        if (value > limit) {
+            return -1;
+        }
+    }
+    return (int)(negative ? -value : value);
+}
+
+static void batch_get_input_string(AppView *view, const char *prompt, char *buffer, size_t size) {
+    (void)prompt;
+    BatchView *batch = (BatchView *)view->user_data;
+    if (buffer == NULL || size == 0) {
+        return;
     }
+    const char *field = NULL;
+    size_t length = 0;
+    if (!batch_next_field(batch, &field, &length)) {
+        buffer[0] = '\0';
+        return;
+    }
+    if (length >= size) {
+        length = size - 1;
+    }
+    memcpy(buffer, field, length);
+    buffer[length] = '\0';
+}
+
+static void batch_show_table_header(AppView *view) {
+    (void)view;
+}
+
+static void batch_show_title(AppView *view, const char *title) {
+    (void)view;
+    (void)title;
+}
+
+static void batch_show_text(AppView *view, const char *text) {
+    (void)view;
+    (void)text;
+}
+
+static void batch_pause(AppView *view) {
+    (void)view;
+}
+
+/* 批处理视图接口实现的静态虚表 */
+static const ViewInterface batch_interface = {
+    .show_menu = batch_show_menu,
+    .render_row = batch_render_row,
+    .show_message = batch_show_message,
+    .get_input_int = batch_get_input_int,
+    .get_input_string = batch_get_input_string,
+    .show_table_header = batch_show_table_header,
+    .show_title = batch_show_title,
+    .show_text = batch_show_text,
+    .pause = batch_pause
+};
+
+AppView *view_create_batch(FILE *input, FILE *output) {
+    if (input == NULL || output == NULL) {
+        return NULL;
+    }
+
+    AppView *view = (AppView *)malloc(sizeof(AppView));
+    BatchView *batch = (BatchView *)calloc(1, sizeof(BatchView));
+    char *data = (char *)malloc(BATCH_INPUT_BUFFER);
+    if (view == NULL || batch == NULL || data == NULL ||
+        csv_buffer_init(&batch->out, BATCH_FLUSH_BYTES + CSV_MAX_ROW_LEN) != SUCCESS) {
+        free(view);
+        free(batch);
+        free(data);
+        return NULL;
+    }
+
+    batch->input = input;
+    batch->output = output;
+    batch->data = data;
+    batch->capacity = BATCH_INPUT_BUFFER;
+    batch->line_start = TRUE;
+    view->vptr = &batch_interface;
+    view->user_data = batch;
+    view->interactive = FALSE;
     return view;
 }
 
+size_t view_batch_errors(const AppView *view) {
+    if (view == NULL || view->vptr != &batch_interface) {
+        return 0;
+    }
+    return ((const BatchView *)view->user_data)->errors;
+}
+
 /* 释放视图对象 */
 void view_free(AppView *view) {
     if (view != NULL) {
+        if (view->vptr == &batch_interface) {
+            BatchView *batch = (BatchView *)view->user_data;
+            batch_flush(batch, TRUE);
+            fflush(batch->output);
+            csv_buffer_free(&batch->out);
+            free(batch->data);
+            free(batch);
+        }
         free(view);
     }
 }
@@ -124,6 +405,8 @@ void view_show_menu(void) {
     printf("  7. Attendance Statistics\n");
     printf("  8. Export to CSV\n");
     printf("  9. Save and Exit\n");
+    printf(" 10. Save (background)\n");
+    printf(" 11. Import from CSV\n");
     printf("  0. Exit (without saving)\n");
     printf("========================================\n");
 }
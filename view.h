@@ -3,6 +3,7 @@
 
 #include "common.h"
 #include "model.h"
+#include <stdio.h>
 
 /* 前置声明：AppView结构体 */
 struct AppView;
@@ -10,28 +11,47 @@ struct AppView;
 /* 视图接口结构体：定义视图组件的所有行为 */
 typedef struct {
     void (*show_menu)(struct AppView *view);           /* 显示主菜单 */
-    void (*render_row)(const Employee *emp);           /* 渲染一行职工信息 */
-    void (*show_message)(const char *msg, Bool is_error); /* 显示消息 */
-    int  (*get_input_int)(const char *prompt);         /* 获取整数输入 */
-    void (*get_input_string)(const char *prompt, char *buffer, size_t size); /* 获取字符串输入 */
-    void (*show_table_header)(void);                   /* 显示表格头部 */
+    void (*render_row)(struct AppView *view, const Employee *emp);  /* 渲染一行职工信息 */
+    void (*show_message)(struct AppView *view, const char *msg, Bool is_error); /* 显示消息 */
+    int  (*get_input_int)(struct AppView *view, const char *prompt); /* 获取整数输入 */
+    void (*get_input_string)(struct AppView *view, const char *prompt,
+                             char *buffer, size_t size);  /* 获取字符串输入 */
+    void (*show_table_header)(struct AppView *view);   /* 显示表格头部 */
+    void (*show_title)(struct AppView *view, const char *title);  /* 显示功能标题 */
+    void (*show_text)(struct AppView *view, const char *text);    /* 显示提示性文字(选项列表等) */
+    void (*pause)(struct AppView *view);               /* 一个操作结束后暂停 */
 } ViewInterface;
 
 /* 视图对象结构体：包含接口指针和用户数据 */
 typedef struct AppView {
     const ViewInterface *vptr;  /* 指向视图接口的指针 */
-    void *user_data;            /* 预留：存储特定UI状态 */
+    void *user_data;            /* 特定UI的状态(批处理视图的输入输出缓冲) */
+    Bool interactive;           /* 是否有人在操作(批处理视图为FALSE) */
 } AppView;
 
 /* 视图创建与释放函数 */
 AppView *view_create_console(void); /* 创建控制台视图 */
 void view_free(AppView *view);       /* 释放视图资源 */
 
+/*
+ * 批处理视图: 从input逐行读取命令,结果写到output,从不暂停。
+ * 每次输入取一个字段: 一行中的字段以制表符分隔,一行也可只有一个字段,
+ * 因此"1\t张三\t研发部\t2024-01-15\t22"与逐行输入等价(菜单1添加职工)。
+ * 以#开头的行为注释。整数字段不合法时得到-1;输入结束后整数输入为0(菜单中即退出不保存),
+ * 字符串输入为空串。标题、选项列表和提示不输出;消息输出为"info: ..."/"error: ..."行,
+ * 职工记录输出为CSV行。输出经缓冲写出,释放视图时刷新。
+ */
+AppView *view_create_batch(FILE *input, FILE *output);
+
+/* 批处理视图输出过的错误消息数(其他视图为0) */
+size_t view_batch_errors(const AppView *view);
+
 /* 其他函数声明 */
 void view_pause(void); /* 暂停并等待用户输入 */
 
 /* 便捷宏：简化视图函数调用 */
 #define VIEW_SHOW_MENU(view) (view)->vptr->show_menu(view)
-#define VIEW_GET_INT(view, prompt) (view)->vptr->get_input_int(prompt)
+#define VIEW_GET_INT(view, prompt) (view)->vptr->get_input_int(view, prompt)
+#define VIEW_PAUSE(view) (view)->vptr->pause(view)
 
 #endif /* VIEW_H */
\ No newline at end of file